@@ -571,6 +571,118 @@ static void dd_cell_sizes_dlb_root_enforce_limits(gmx_domdec_t*      dd,
 }
 
 
+void setCellSizesFromLoadProfile(RowMaster*           rowMaster,
+                                 const domdec_load_t& load,
+                                 int                  ncd,
+                                 real                 changeLimit,
+                                 gmx::ArrayRef<real>  cellSize)
+{
+    /* The resolution of the profile, in bins per cell */
+    constexpr int c_numBinsPerCell = 64;
+    /* The weight of the history relative to the last measurement */
+    constexpr real c_historyWeight = 0.25;
+
+    const int  numBins  = ncd * c_numBinsPerCell;
+    const real binWidth = 1.0_real / numBins;
+
+    std::vector<real>& measured = rowMaster->loadDensityMeasured;
+    std::vector<real>& profile  = rowMaster->loadDensityProfile;
+    measured.assign(numBins, 0);
+
+    gmx::ArrayRef<const real> cellFrac = rowMaster->cellFrac;
+
+    /* Deposit the load density of each cell on the bins it overlaps */
+    real loadSum = 0;
+    for (int i = 0; i < ncd; i++)
+    {
+        loadSum += load.load[i * load.nload + 2];
+    }
+    if (loadSum <= 0)
+    {
+        for (int i = 0; i < ncd; i++)
+        {
+            cellSize[i] = cellFrac[i + 1] - cellFrac[i];
+        }
+        return;
+    }
+    for (int i = 0; i < ncd; i++)
+    {
+        const real density =
+                load.load[i * load.nload + 2] / (loadSum * (cellFrac[i + 1] - cellFrac[i]));
+        const int binStart = std::max(static_cast<int>(cellFrac[i] * numBins), 0);
+        const int binEnd   = std::min(static_cast<int>(cellFrac[i + 1] * numBins), numBins - 1);
+        for (int b = binStart; b <= binEnd; b++)
+        {
+            const real overlap = std::min(cellFrac[i + 1], (b + 1) * binWidth)
+                                 - std::max(cellFrac[i], b * binWidth);
+            if (overlap > 0)
+            {
+                measured[b] += density * overlap / binWidth;
+            }
+        }
+    }
+
+    if (profile.size() != static_cast<size_t>(numBins))
+    {
+        profile = measured;
+    }
+    else
+    {
+        for (int b = 0; b < numBins; b++)
+        {
+            profile[b] = c_historyWeight * profile[b] + (1 - c_historyWeight) * measured[b];
+        }
+    }
+
+    /* Place the boundaries at equal fractions of the integrated density */
+    real profileSum = 0;
+    for (int b = 0; b < numBins; b++)
+    {
+        profileSum += profile[b] * binWidth;
+    }
+    const real loadPerCell = profileSum / ncd;
+
+    real changeMax  = 0;
+    real lowerBound = 0;
+    real integral   = 0;
+    int  b          = 0;
+    for (int i = 0; i < ncd; i++)
+    {
+        real upperBound = 1;
+        if (i < ncd - 1)
+        {
+            const real target = (i + 1) * loadPerCell;
+            while (b < numBins - 1 && integral + profile[b] * binWidth < target)
+            {
+                integral += profile[b] * binWidth;
+                b++;
+            }
+            /* Interpolate linearly within bin b */
+            upperBound = b * binWidth;
+            if (profile[b] > 0)
+            {
+                upperBound += std::min((target - integral) / profile[b], binWidth);
+            }
+        }
+        cellSize[i] = std::max(upperBound - lowerBound, 0.0_real);
+        lowerBound  = upperBound;
+
+        const real oldSize = cellFrac[i + 1] - cellFrac[i];
+        changeMax          = std::max(changeMax, std::abs(cellSize[i] / oldSize - 1));
+    }
+
+    /* Limit the amount of scaling, using the same factor for all cells in the row */
+    if (changeMax > changeLimit)
+    {
+        const real scale = changeLimit / changeMax;
+        for (int i = 0; i < ncd; i++)
+        {
+            const real oldSize = cellFrac[i + 1] - cellFrac[i];
+            cellSize[i]        = oldSize * (1 + scale * (cellSize[i] / oldSize - 1));
+        }
+    }
+}
+
 static void set_dd_cell_sizes_dlb_root(gmx_domdec_t*      dd,
                                        int                d,
                                        int                dim,
@@ -605,6 +717,10 @@ static void set_dd_cell_sizes_dlb_root(gmx_domdec_t*      dd,
             cell_size[i] = 1.0 / ncd;
         }
     }
+    else if (dd_load_count(comm) > 0 && comm->ddSettings.usePredictiveDlb)
+    {
+        setCellSizesFromLoadProfile(rowMaster, comm->load[d], ncd, change_limit, cell_size);
+    }
     else if (dd_load_count(comm) > 0)
     {
         real load_aver  = comm->load[d].sum_m / ncd;
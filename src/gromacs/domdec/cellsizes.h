@@ -53,9 +53,11 @@ namespace gmx
 template<typename>
 class ArrayRef;
 }
+struct domdec_load;
 struct gmx_ddbox_t;
 struct gmx_domdec_comm_t;
 struct gmx_domdec_t;
+struct RowMaster;
 
 /*! \brief Options for setting up a regular, possibly static load balanced, cell grid geometry */
 enum
@@ -77,6 +79,31 @@ real grid_jump_limit(const gmx_domdec_comm_t* comm, real cutoff, int dim_ind);
 gmx::ArrayRef<const std::vector<real>>
 set_dd_cell_sizes_slb(gmx_domdec_t* dd, const gmx_ddbox_t* ddbox, int setmode, ivec numPulses);
 
+/*! \brief Sets the new cell sizes in a row from a history of the load density along the row
+ *
+ * The measured load of each cell is converted to a load density, which is
+ * assumed to be constant within the cell. The density is accumulated, with
+ * exponentially decaying weights for older measurements, on a fixed grid
+ * along the row. As the grid is fixed in space, the history remains valid
+ * when the cell boundaries move. The new boundaries are then set such that
+ * the predicted load, i.e. the integrated density, is equal for all cells.
+ * In contrast to underrelaxation of the measured imbalance, this converges
+ * in a few steps when the load distribution is static and the change limit
+ * is not reached, while the history damps oscillations due to load
+ * fluctuations.
+ *
+ * \param[in,out] rowMaster    The row master, uses the cell boundaries and updates the profile
+ * \param[in]     load         The loads of the cells in the row
+ * \param[in]     ncd          The number of cells in the row
+ * \param[in]     changeLimit  The maximum relative change of a cell size
+ * \param[out]    cellSize     The new cell sizes, not normalized
+ */
+void setCellSizesFromLoadProfile(RowMaster*                rowMaster,
+                                 const struct domdec_load& load,
+                                 int                       ncd,
+                                 real                      changeLimit,
+                                 gmx::ArrayRef<real>       cellSize);
+
 /*! \brief General cell size adjustment, possibly applying dynamic load balancing */
 void set_dd_cell_sizes(gmx_domdec_t*      dd,
                        const gmx_ddbox_t* ddbox,
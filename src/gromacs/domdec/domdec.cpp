@@ -258,70 +258,112 @@ void dd_get_constraint_range(const gmx_domdec_t* dd, int* at_start, int* at_end)
     *at_end   = dd->comm->atomRanges.end(DDAtomRanges::Type::Constraints);
 }
 
-void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+/*! \brief Packs the coordinates to send for pulse \p ind along dimension index \p dimIndex
+ *
+ * Applies the PBC shift, and for screw PBC the rotation, when needed.
+ */
+static void packCoordinatesToSend(const gmx_domdec_t&            dd,
+                                  int                            dimIndex,
+                                  const gmx_domdec_ind_t&        ind,
+                                  const matrix                   box,
+                                  gmx::ArrayRef<const gmx::RVec> x,
+                                  gmx::ArrayRef<gmx::RVec>       sendBuffer)
 {
-    wallcycle_start(wcycle, ewcMOVEX);
-
-    int                    nzone, nat_tot;
-    gmx_domdec_comm_t*     comm;
-    gmx_domdec_comm_dim_t* cd;
-    rvec                   shift = { 0, 0, 0 };
-    gmx_bool               bPBC, bScrew;
-
-    comm = dd->comm;
+    const int  dim    = dd.dim[dimIndex];
+    const bool bPBC   = (dd.ci[dim] == 0);
+    const bool bScrew = (bPBC && dd.unitCellInfo.haveScrewPBC && dim == XX);
+    rvec       shift  = { 0, 0, 0 };
+    if (bPBC)
+    {
+        copy_rvec(box[dim], shift);
+    }
 
-    nzone   = 1;
-    nat_tot = comm->atomRanges.numHomeAtoms();
-    for (int d = 0; d < dd->ndim; d++)
+    int n = 0;
+    if (!bPBC)
     {
-        bPBC   = (dd->ci[dd->dim[d]] == 0);
-        bScrew = (bPBC && dd->unitCellInfo.haveScrewPBC && dd->dim[d] == XX);
-        if (bPBC)
+        for (int j : ind.index)
         {
-            copy_rvec(box[dd->dim[d]], shift);
+            sendBuffer[n] = x[j];
+            n++;
         }
-        cd = &comm->cd[d];
-        for (const gmx_domdec_ind_t& ind : cd->ind)
+    }
+    else if (!bScrew)
+    {
+        for (int j : ind.index)
         {
-            DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
-            gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
-            int                       n          = 0;
-            if (!bPBC)
+            /* We need to shift the coordinates */
+            for (int d = 0; d < DIM; d++)
             {
-                for (int j : ind.index)
-                {
-                    sendBuffer[n] = x[j];
-                    n++;
-                }
+                sendBuffer[n][d] = x[j][d] + shift[d];
             }
-            else if (!bScrew)
-            {
-                for (int j : ind.index)
-                {
-                    /* We need to shift the coordinates */
-                    for (int d = 0; d < DIM; d++)
-                    {
-                        sendBuffer[n][d] = x[j][d] + shift[d];
-                    }
-                    n++;
-                }
-            }
-            else
+            n++;
+        }
+    }
+    else
+    {
+        for (int j : ind.index)
+        {
+            /* Shift x */
+            sendBuffer[n][XX] = x[j][XX] + shift[XX];
+            /* Rotate y and z.
+             * This operation requires a special shift force
+             * treatment, which is performed in calc_vir.
+             */
+            sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
+            sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
+            n++;
+        }
+    }
+}
+
+//! Copies the received coordinates for pulse \p ind to their location in \p x
+static void unpackReceivedCoordinates(const gmx_domdec_ind_t&        ind,
+                                      int                            nzone,
+                                      gmx::ArrayRef<const gmx::RVec> receiveBuffer,
+                                      gmx::ArrayRef<gmx::RVec>       x)
+{
+    int j = 0;
+    for (int zone = 0; zone < nzone; zone++)
+    {
+        for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
+        {
+            x[i] = receiveBuffer[j++];
+        }
+    }
+}
+
+/*! \brief Communicates the coordinates for all pulses
+ *
+ * When \p skipFirstPulse is true, the first pulse along the first
+ * dimension is assumed to have been communicated already.
+ */
+static void moveCoordinates(gmx_domdec_t*            dd,
+                            const matrix             box,
+                            gmx::ArrayRef<gmx::RVec> x,
+                            bool                     skipFirstPulse)
+{
+    gmx_domdec_comm_t* comm = dd->comm;
+
+    int nzone   = 1;
+    int nat_tot = comm->atomRanges.numHomeAtoms();
+    for (int d = 0; d < dd->ndim; d++)
+    {
+        gmx_domdec_comm_dim_t* cd = &comm->cd[d];
+        for (int p = 0; p < cd->numPulses(); p++)
+        {
+            const gmx_domdec_ind_t& ind = cd->ind[p];
+
+            if (skipFirstPulse && d == 0 && p == 0)
             {
-                for (int j : ind.index)
-                {
-                    /* Shift x */
-                    sendBuffer[n][XX] = x[j][XX] + shift[XX];
-                    /* Rotate y and z.
-                     * This operation requires a special shift force
-                     * treatment, which is performed in calc_vir.
-                     */
-                    sendBuffer[n][YY] = box[YY][YY] - x[j][YY];
-                    sendBuffer[n][ZZ] = box[ZZ][ZZ] - x[j][ZZ];
-                    n++;
-                }
+                nat_tot += ind.nrecv[nzone + 1];
+                continue;
             }
 
+            DDBufferAccess<gmx::RVec> sendBufferAccess(comm->rvecBuffer, ind.nsend[nzone + 1]);
+            gmx::ArrayRef<gmx::RVec>& sendBuffer = sendBufferAccess.buffer;
+
+            packCoordinatesToSend(*dd, d, ind, box, x, sendBuffer);
+
             DDBufferAccess<gmx::RVec> receiveBufferAccess(
                     comm->rvecBuffer2, cd->receiveInPlace ? 0 : ind.nrecv[nzone + 1]);
 
@@ -339,19 +381,88 @@ void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, g
 
             if (!cd->receiveInPlace)
             {
-                int j = 0;
-                for (int zone = 0; zone < nzone; zone++)
-                {
-                    for (int i = ind.cell2at0[zone]; i < ind.cell2at1[zone]; i++)
-                    {
-                        x[i] = receiveBuffer[j++];
-                    }
-                }
+                unpackReceivedCoordinates(ind, nzone, receiveBuffer, x);
             }
             nat_tot += ind.nrecv[nzone + 1];
         }
         nzone += nzone;
     }
+}
+
+void dd_move_x(gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    moveCoordinates(dd, box, x, false);
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+bool ddUsesNonblockingCoordinateHalo(const gmx_domdec_t& dd)
+{
+    return dd.comm->ddSettings.useNonblockingCoordinateHalo;
+}
+
+void dd_move_x_begin(gmx_domdec_t*            dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    gmx_domdec_comm_t*         comm = dd->comm;
+    NonblockingCoordinateHalo& halo = comm->nonblockingCoordinateHalo;
+
+    GMX_ASSERT(!halo.inFlight, "Can only have one coordinate communication in flight");
+
+    /* The first pulse only sends home atoms, so it can be started directly */
+    constexpr int                nzone   = 1;
+    const int                    nat_tot = comm->atomRanges.numHomeAtoms();
+    const gmx_domdec_comm_dim_t& cd      = comm->cd[0];
+    const gmx_domdec_ind_t&      ind     = cd.ind[0];
+
+    halo.sendBuffer.resize(ind.nsend[nzone + 1]);
+    packCoordinatesToSend(*dd, 0, ind, box, x, halo.sendBuffer);
+
+    gmx::ArrayRef<gmx::RVec> receiveBuffer;
+    if (cd.receiveInPlace)
+    {
+        receiveBuffer = gmx::arrayRefFromArray(x.data() + nat_tot, ind.nrecv[nzone + 1]);
+    }
+    else
+    {
+        halo.receiveBuffer.resize(ind.nrecv[nzone + 1]);
+        receiveBuffer = halo.receiveBuffer;
+    }
+    ddIsendrecvRvec(dd, 0, dddirBackward, halo.sendBuffer, receiveBuffer, &halo.requests);
+
+    halo.inFlight = true;
+
+    wallcycle_stop(wcycle, ewcMOVEX);
+}
+
+void dd_move_x_finish(gmx_domdec_t*            dd,
+                      const matrix             box,
+                      gmx::ArrayRef<gmx::RVec> x,
+                      gmx_wallcycle*           wcycle)
+{
+    wallcycle_start(wcycle, ewcMOVEX);
+
+    gmx_domdec_comm_t*         comm = dd->comm;
+    NonblockingCoordinateHalo& halo = comm->nonblockingCoordinateHalo;
+
+    GMX_ASSERT(halo.inFlight, "dd_move_x_finish() should be preceded by dd_move_x_begin()");
+
+    ddWaitForRequests(&halo.requests);
+
+    if (!comm->cd[0].receiveInPlace)
+    {
+        constexpr int nzone = 1;
+        unpackReceivedCoordinates(comm->cd[0].ind[0], nzone, halo.receiveBuffer, x);
+    }
+    halo.inFlight = false;
+
+    moveCoordinates(dd, box, x, true);
 
     wallcycle_stop(wcycle, ewcMOVEX);
 }
@@ -2922,6 +3033,11 @@ static DDSettings getDDSettings(const gmx::MDLogger&     mdlog,
     ddSettings.nstDDDump           = dd_getenv(mdlog, "GMX_DD_NST_DUMP", 0);
     ddSettings.nstDDDumpGrid       = dd_getenv(mdlog, "GMX_DD_NST_DUMP_GRID", 0);
     ddSettings.DD_debug            = dd_getenv(mdlog, "GMX_DD_DEBUG", 0);
+    ddSettings.useIncrementalLocalTopology =
+            (dd_getenv(mdlog, "GMX_DD_NO_INCREMENTAL_TOP", 0) == 0);
+    ddSettings.useNonblockingCoordinateHalo =
+            (dd_getenv(mdlog, "GMX_DD_NONBLOCKING_HALO", 0) != 0);
+    ddSettings.usePredictiveDlb = (dd_getenv(mdlog, "GMX_DLB_PREDICTIVE", 0) != 0);
 
     if (ddSettings.useSendRecv2)
     {
@@ -209,6 +209,28 @@ void dd_cycles_add(const gmx_domdec_t* dd, float cycles, int ddCycl);
 /*! \brief Communicate the coordinates to the neighboring cells and do pbc. */
 void dd_move_x(struct gmx_domdec_t* dd, const matrix box, gmx::ArrayRef<gmx::RVec> x, gmx_wallcycle* wcycle);
 
+/*! \brief Returns whether dd_move_x_begin() and dd_move_x_finish() should be used
+ * to overlap the coordinate communication with computation */
+bool ddUsesNonblockingCoordinateHalo(const gmx_domdec_t& dd);
+
+/*! \brief Starts communicating the coordinates to the neighboring cells
+ *
+ * The first communication pulse is started without blocking. Later pulses
+ * forward coordinates received in earlier pulses, so these are performed by
+ * dd_move_x_finish(). The non-local coordinates in \p x should not be accessed
+ * before dd_move_x_finish() has been called.
+ */
+void dd_move_x_begin(struct gmx_domdec_t*     dd,
+                     const matrix             box,
+                     gmx::ArrayRef<gmx::RVec> x,
+                     gmx_wallcycle*           wcycle);
+
+/*! \brief Completes the coordinate communication started by dd_move_x_begin() */
+void dd_move_x_finish(struct gmx_domdec_t*     dd,
+                      const matrix             box,
+                      gmx::ArrayRef<gmx::RVec> x,
+                      gmx_wallcycle*           wcycle);
+
 /*! \brief Sum the forces over the neighboring cells.
  *
  * When fshift!=NULL the shift forces are updated to obtain
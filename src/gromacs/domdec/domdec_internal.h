@@ -51,6 +51,7 @@
 #include "gromacs/mdlib/updategroupscog.h"
 #include "gromacs/timing/cyclecounter.h"
 #include "gromacs/topology/block.h"
+#include "gromacs/utility/gmxmpi.h"
 
 struct t_commrec;
 
@@ -121,6 +122,10 @@ struct RowMaster
     bool dlbIsLimited = false;
     /**< Temp. var.  */
     std::vector<real> buf_ncd;
+    /**< State var.: relative load density along the row averaged over the history, used with predictive DLB */
+    std::vector<real> loadDensityProfile;
+    /**< Temp. var.: relative load density along the row at the last measurement */
+    std::vector<real> loadDensityMeasured;
 };
 
 /*! \brief Struct for managing cell sizes with DLB along a dimension */
@@ -417,6 +422,19 @@ struct dd_comm_setup_work_t
     int nsend_zone = 0;
 };
 
+/*! \brief Buffers and MPI requests for a coordinate halo exchange in flight */
+struct NonblockingCoordinateHalo
+{
+    //! Whether communication has been started and not yet completed
+    bool inFlight = false;
+    //! Send buffer for the first pulse
+    std::vector<gmx::RVec> sendBuffer;
+    //! Receive buffer for the first pulse, only used when not receiving in place
+    std::vector<gmx::RVec> receiveBuffer;
+    //! The MPI requests for the communication in flight
+    std::vector<MPI_Request> requests;
+};
+
 /*! \brief Information about the simulated system */
 struct DDSystemInfo
 {
@@ -482,6 +500,15 @@ struct DDSettings
     //! Whether we should record the load
     bool recordLoad = false;
 
+    //! Whether to reuse the home interactions of the previous local topology
+    bool useIncrementalLocalTopology = true;
+
+    //! Whether to overlap the first coordinate halo pulse with local non-bonded work
+    bool useNonblockingCoordinateHalo = false;
+
+    //! Whether to set DLB cell sizes using a load density profile with history
+    bool usePredictiveDlb = false;
+
     /* Debugging */
     //! Step interval for dumping the local+non-local atoms to pdb
     int nstDDDump = 0;
@@ -661,6 +688,9 @@ struct gmx_domdec_comm_t // NOLINT (clang-analyzer-optin.performance.Padding)
     /**< Another rvec comm. buffer */
     DDBuffer<gmx::RVec> rvecBuffer2;
 
+    /**< Coordinate halo communication that overlaps with computation */
+    NonblockingCoordinateHalo nonblockingCoordinateHalo;
+
     /* Communication buffers for local redistribution */
     /**< Charge group flag comm. buffers */
     std::array<std::vector<int>, DIM * 2> cggl_flag;
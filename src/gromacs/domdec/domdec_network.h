@@ -49,7 +49,10 @@
 #ifndef GMX_DOMDEC_DOMDEC_NETWORK_H
 #define GMX_DOMDEC_DOMDEC_NETWORK_H
 
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
+#include "gromacs/utility/gmxmpi.h"
 
 struct gmx_domdec_t;
 
@@ -145,6 +148,24 @@ extern template void ddSendrecv<gmx::RVec>(const gmx_domdec_t*      dd,
                                            gmx::ArrayRef<gmx::RVec> sendBuffer,
                                            gmx::ArrayRef<gmx::RVec> receiveBuffer);
 
+/*! \brief Starts a non-blocking move of rvec's in the communication region
+ * one cell along the domain decomposition
+ *
+ * Moves in the dimension indexed by ddDimensionIndex, either forward
+ * (direction=dddirFoward) or backward (direction=dddirBackward).
+ * The MPI requests are appended to \p requests. The buffers should
+ * not be accessed before ddWaitForRequests() has been called.
+ */
+void ddIsendrecvRvec(const gmx_domdec_t*       dd,
+                     int                       ddDimensionIndex,
+                     int                       direction,
+                     gmx::ArrayRef<gmx::RVec>  sendBuffer,
+                     gmx::ArrayRef<gmx::RVec>  receiveBuffer,
+                     std::vector<MPI_Request>* requests);
+
+//! Waits for completion of all MPI requests in \p requests and clears the list
+void ddWaitForRequests(std::vector<MPI_Request>* requests);
+
 /*! \brief Move revc's in the comm. region one cell along the domain decomposition
  *
  * Moves in dimension indexed by ddimind, simultaneously in the forward
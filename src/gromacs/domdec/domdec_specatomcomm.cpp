@@ -470,14 +470,18 @@ int setup_specat_communication(gmx_domdec_t*             dd,
             spas->a.clear();
             spac->ibuf.clear();
             nsend[0] = 0;
+            /* Look up all requested atoms that are home atoms in one pass */
+            spac->homeIndices.resize(nr);
+            dd->ga2la->findHome(gmx::constArrayRefFromArray(ireq->data() + start, nr),
+                                spac->homeIndices);
             for (int i = 0; i < nr; i++)
             {
                 const int indr = (*ireq)[start + i];
                 int       ind;
                 /* Check if this is a home atom and if so ind will be set */
-                if (const int* homeIndex = dd->ga2la->findHome(indr))
+                if (spac->homeIndices[i] >= 0)
                 {
-                    ind = *homeIndex;
+                    ind = spac->homeIndices[i];
                 }
                 else
                 {
@@ -570,6 +574,7 @@ int setup_specat_communication(gmx_domdec_t*             dd,
         }
 
         /* Make a global to local index for the communication atoms */
+        ga2la_specat->reserve(ga2la_specat->size() + nat_tot_specat - nat_tot_prev);
         for (int i = nat_tot_prev; i < nat_tot_specat; i++)
         {
             ga2la_specat->insert_or_assign(dd->globalAtomIndices[i], i);
@@ -126,6 +126,37 @@ struct thread_work_t
     int                            nbonded  = 0;       /**< The number of bondeds in this struct */
     ListOfLists<int>               excl;               /**< List of exclusions */
     int                            excl_count = 0;     /**< The total exclusion count for \p excl */
+    std::vector<int> homeCache;         /**< Home interaction cache entries stored by this thread */
+    std::vector<int> previousHomeCache; /**< Entries stored at the previous partitioning */
+    std::vector<int> homeCacheScratch;  /**< Temporary storage for a single cache entry */
+};
+
+/*! \brief The home interaction cache for incremental local topology updates
+ *
+ * With incremental local topology updates, we store for each home atom
+ * for which all interactions linked to it involve only home atoms,
+ * these interactions with global atom indices. Each entry consists of
+ * the global atom index, the number of integers that follow and
+ * the interactions as type, parameter index and global atom indices.
+ *
+ * At the next partitioning, the home atoms that departed and arrived are
+ * determined from the entries and the new global to local atom lookup.
+ * The entries of departed atoms are dropped. The interactions of atoms
+ * that stayed are assigned again with only global to local atom lookups,
+ * without the reverse topology search and the zone and distance checks.
+ * Only the interactions of arrived atoms, and of atoms whose interactions
+ * now involve non-home atoms, are assigned using the reverse topology.
+ */
+struct HomeInteractionCache
+{
+    //! Global indices of the atoms with entries stored at the previous partitioning
+    std::vector<int> previousAtoms;
+    //! Pointers to the entries of \p previousAtoms
+    std::vector<const int*> previousEntries;
+    //! The new local home atom indices of \p previousAtoms, -1 for departed atoms
+    std::vector<int> localAtomIndices;
+    //! The previous entries for the current home atoms, nullptr for arrived atoms
+    std::vector<const int*> entries;
 };
 
 /*! \brief Struct for the reverse topology: links bonded interactions to atomsx */
@@ -157,6 +188,11 @@ struct gmx_reverse_top_t
     /* Work data structures for multi-threading */
     //! \brief Thread work array for local topology generation
     std::vector<thread_work_t> th_work;
+
+    //! \brief Whether we update the home interactions incrementally
+    bool useIncrementalUpdate = false;
+    //! \brief The home interaction cache, only used with incremental updates
+    HomeInteractionCache homeCache;
     //! @endcond
 };
 
@@ -764,6 +800,14 @@ void dd_make_reverse_top(FILE*                           fplog,
                                         bBCheck,
                                         &dd->nbonded_global);
 
+    /* Intermolecular interactions are not linked to molecules and thus
+     * not cached, the cache is useless without interactions between atoms.
+     */
+    gmx_reverse_top_t* rt = dd->reverse_top;
+    rt->useIncrementalUpdate = (dd->comm->ddSettings.useIncrementalLocalTopology
+                                && rt->bInterAtomicInteractions
+                                && !rt->bIntermolecularInteractions);
+
     dd->haveExclusions = false;
     for (const gmx_molblock_t& molb : mtop->molblock)
     {
@@ -1063,6 +1107,10 @@ static void combine_idef(InteractionDefinitions* dest, gmx::ArrayRef<const threa
 }
 
 /*! \brief Check and when available assign bonded interactions for local atom i
+ *
+ * When \p cacheEntry is not nullptr, the assigned interactions are appended
+ * to it with global atom indices and \p isCacheable is set to false when
+ * not all interactions for this atom were assigned with only home atoms.
  */
 static inline void check_assign_interactions_atom(int                       i,
                                                   int                       i_gl,
@@ -1087,7 +1135,9 @@ static inline void check_assign_interactions_atom(int                       i,
                                                   InteractionDefinitions*   idef,
                                                   int                       iz,
                                                   gmx_bool                  bBCheck,
-                                                  int*                      nbonded_local)
+                                                  int*                      nbonded_local,
+                                                  std::vector<int>*         cacheEntry,
+                                                  bool*                     isCacheable)
 {
     gmx::ArrayRef<const DDPairInteractionRanges> iZones = zones->iZones;
 
@@ -1095,6 +1145,9 @@ static inline void check_assign_interactions_atom(int                       i,
     while (j < ind_end)
     {
         t_iatom tiatoms[1 + MAXATOMLIST];
+        int     globalAtoms[MAXATOMLIST];
+        /* Whether all atoms of the interaction are home atoms */
+        bool isHomeInteraction = false;
 
         const int ftype  = rtil[j++];
         auto      iatoms = gmx::constArrayRefFromArray(rtil.data() + j, rtil.size() - j);
@@ -1107,6 +1160,10 @@ static inline void check_assign_interactions_atom(int                       i,
             {
                 add_vsite(*dd->ga2la, index, rtil, ftype, nral, TRUE, i, i_gl, i_mol, iatoms.data(), idef);
             }
+            if (cacheEntry != nullptr)
+            {
+                *isCacheable = false;
+            }
         }
         else
         {
@@ -1155,6 +1212,10 @@ static inline void check_assign_interactions_atom(int                       i,
                 }
                 if (const auto* entry = dd->ga2la->find(k_gl))
                 {
+                    globalAtoms[0]    = i_gl;
+                    globalAtoms[1]    = k_gl;
+                    isHomeInteraction = (iz == 0 && entry->cell == 0);
+
                     int kz = entry->cell;
                     if (kz >= zones->n)
                     {
@@ -1193,7 +1254,8 @@ static inline void check_assign_interactions_atom(int                       i,
                 ivec k_zero, k_plus;
                 int  k;
 
-                bUse = TRUE;
+                bUse              = TRUE;
+                isHomeInteraction = (iz == 0);
                 clear_ivec(k_zero);
                 clear_ivec(k_plus);
                 for (k = 1; k <= nral && bUse; k++)
@@ -1221,7 +1283,9 @@ static inline void check_assign_interactions_atom(int                       i,
                     {
                         int d;
 
-                        tiatoms[k] = entry->la;
+                        tiatoms[k]         = entry->la;
+                        globalAtoms[k - 1] = k_gl;
+                        isHomeInteraction  = isHomeInteraction && (entry->cell == 0);
                         for (d = 0; d < DIM; d++)
                         {
                             if (zones->shift[entry->cell][d] == 0)
@@ -1266,11 +1330,144 @@ static inline void check_assign_interactions_atom(int                       i,
                     (*nbonded_local)++;
                 }
             }
+            if (cacheEntry != nullptr)
+            {
+                if (bUse && isHomeInteraction)
+                {
+                    cacheEntry->push_back(ftype);
+                    cacheEntry->push_back(tiatoms[0]);
+                    cacheEntry->insert(cacheEntry->end(), globalAtoms, globalAtoms + nral);
+                }
+                else
+                {
+                    *isCacheable = false;
+                }
+            }
         }
         j += 1 + nral_rt(ftype);
     }
 }
 
+/*! \brief Assigns the interactions in home cache entry \p entry
+ *
+ * Returns false, without assigning interactions, when not all atoms in
+ * the entry are home atoms or a two-body interaction fails the distance
+ * check; the interactions then need to be assigned using the reverse
+ * topology.
+ */
+static bool assignCachedHomeInteractions(const gmx_ga2la_t&      ga2la,
+                                         const int*              entry,
+                                         gmx_bool                bRCheck2B,
+                                         real                    rc2,
+                                         t_pbc*                  pbc_null,
+                                         rvec*                   cg_cm,
+                                         gmx_bool                bBCheck,
+                                         std::vector<int>*       localEntry,
+                                         InteractionDefinitions* idef,
+                                         int*                    nbonded_local)
+{
+    const int* entryEnd = entry + 2 + entry[1];
+
+    /* First convert all atom indices, so we can bail out before assigning */
+    localEntry->clear();
+    for (const int* interaction = entry + 2; interaction < entryEnd;)
+    {
+        const int ftype = interaction[0];
+        const int nral  = NRAL(ftype);
+
+        localEntry->push_back(ftype);
+        localEntry->push_back(interaction[1]);
+        for (int k = 0; k < nral; k++)
+        {
+            const auto* atomEntry = ga2la.find(interaction[2 + k]);
+            if (atomEntry == nullptr || atomEntry->cell != 0)
+            {
+                return false;
+            }
+            localEntry->push_back(atomEntry->la);
+        }
+        if (nral == 2 && bRCheck2B)
+        {
+            const int* localAtoms = localEntry->data() + localEntry->size() - 2;
+            if (dd_dist2(pbc_null, cg_cm, localAtoms[0], localAtoms[1]) >= rc2)
+            {
+                return false;
+            }
+        }
+        interaction += 2 + nral;
+    }
+
+    for (auto interaction = localEntry->begin(); interaction != localEntry->end();)
+    {
+        const int ftype = interaction[0];
+        const int nral  = NRAL(ftype);
+
+        idef->il[ftype].push_back(interaction[1], nral, &interaction[2]);
+        if (bBCheck || !(interaction_function[ftype].flags & IF_LIMZERO))
+        {
+            (*nbonded_local)++;
+        }
+        interaction += 2 + nral;
+    }
+
+    return true;
+}
+
+/*! \brief Applies the changes in the home atom set to the home interaction cache
+ *
+ * The entries stored at the previous partitioning are linked to the new
+ * local indices of the atoms that stayed home atoms, the entries of
+ * departed atoms are dropped. New entries are stored in the thread caches
+ * for use at the next partitioning.
+ */
+static void updateHomeInteractionCache(const gmx_ga2la_t& ga2la,
+                                       int                numHomeAtoms,
+                                       gmx_reverse_top_t* rt)
+{
+    HomeInteractionCache& cache = rt->homeCache;
+
+    cache.previousAtoms.clear();
+    cache.previousEntries.clear();
+    for (thread_work_t& th_work : rt->th_work)
+    {
+        std::swap(th_work.homeCache, th_work.previousHomeCache);
+        th_work.homeCache.clear();
+
+        const int* entry    = th_work.previousHomeCache.data();
+        const int* entryEnd = entry + th_work.previousHomeCache.size();
+        for (; entry < entryEnd; entry += 2 + entry[1])
+        {
+            cache.previousAtoms.push_back(entry[0]);
+            cache.previousEntries.push_back(entry);
+        }
+    }
+
+    cache.localAtomIndices.resize(cache.previousAtoms.size());
+    ga2la.findHome(cache.previousAtoms, cache.localAtomIndices);
+
+    /* Arrived atoms have no entry and are assigned using the reverse topology */
+    cache.entries.assign(numHomeAtoms, nullptr);
+    int numStayed = 0;
+    for (size_t a = 0; a < cache.previousAtoms.size(); a++)
+    {
+        const int localIndex = cache.localAtomIndices[a];
+        if (localIndex >= 0)
+        {
+            cache.entries[localIndex] = cache.previousEntries[a];
+            numStayed++;
+        }
+    }
+
+    if (debug)
+    {
+        fprintf(debug,
+                "Home interaction cache: %d atoms stayed, %zu departed, %d arrived or uncached\n",
+                numStayed,
+                cache.previousAtoms.size() - numStayed,
+                numHomeAtoms - numStayed);
+    }
+}
+
 /*! \brief This function looks up and assigns bonded interactions for zone iz.
  *
  * With thread parallelizing each thread acts on a different atom range:
@@ -1288,7 +1485,8 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
                              const t_iparams*                   ip_in,
                              InteractionDefinitions*            idef,
                              int                                izone,
-                             const gmx::Range<int>&             atomRange)
+                             const gmx::Range<int>&             atomRange,
+                             int                                thread)
 {
     int                mb, mt, mol, i_mol;
     gmx_bool           bBCheck;
@@ -1301,10 +1499,45 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
 
     nbonded_local = 0;
 
+    thread_work_t& threadWork = rt->th_work[thread];
+    /* Interactions with only home atoms are assigned in the home zone */
+    const bool useHomeCache = (rt->useIncrementalUpdate && izone == 0);
+
     for (int i : atomRange)
     {
         /* Get the global atom number */
         const int i_gl = dd->globalAtomIndices[i];
+
+        std::vector<int>* cacheEntry  = nullptr;
+        bool              isCacheable = false;
+        if (useHomeCache)
+        {
+            const int* entry = rt->homeCache.entries[i];
+            if (entry != nullptr
+                && assignCachedHomeInteractions(*dd->ga2la,
+                                                entry,
+                                                bRCheck2B,
+                                                rc2,
+                                                pbc_null,
+                                                cg_cm,
+                                                bBCheck,
+                                                &threadWork.homeCacheScratch,
+                                                idef,
+                                                &nbonded_local))
+            {
+                /* Store the entry again for the next partitioning */
+                threadWork.homeCache.insert(
+                        threadWork.homeCache.end(), entry, entry + 2 + entry[1]);
+
+                continue;
+            }
+
+            /* Record the interactions we assign below in a new entry */
+            cacheEntry = &threadWork.homeCacheScratch;
+            cacheEntry->assign({ i_gl, 0 });
+            isCacheable = true;
+        }
+
         global_atomnr_to_moltype_ind(rt, i_gl, &mb, &mt, &mol, &i_mol);
         /* Check all intramolecular interactions assigned to this atom */
         gmx::ArrayRef<const int>     index = rt->ril_mt[mt].index;
@@ -1333,8 +1566,17 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
                                        idef,
                                        izone,
                                        bBCheck,
-                                       &nbonded_local);
+                                       &nbonded_local,
+                                       cacheEntry,
+                                       &isCacheable);
+
+        if (isCacheable)
+        {
+            (*cacheEntry)[1] = cacheEntry->size() - 2;
 
+            threadWork.homeCache.insert(
+                    threadWork.homeCache.end(), cacheEntry->begin(), cacheEntry->end());
+        }
 
         if (rt->bIntermolecularInteractions)
         {
@@ -1365,7 +1607,9 @@ static int make_bondeds_zone(gmx_domdec_t*                      dd,
                                            idef,
                                            izone,
                                            bBCheck,
-                                           &nbonded_local);
+                                           &nbonded_local,
+                                           nullptr,
+                                           nullptr);
         }
     }
 
@@ -1488,6 +1732,11 @@ static int make_local_bondeds_excls(gmx_domdec_t*           dd,
     idef->clear();
     nbonded_local = 0;
 
+    if (rt->useIncrementalUpdate)
+    {
+        updateHomeInteractionCache(*dd->ga2la, zones->cg_range[1], rt);
+    }
+
     lexcls->clear();
     *excl_count = 0;
 
@@ -1530,7 +1779,8 @@ static int make_local_bondeds_excls(gmx_domdec_t*           dd,
                                                                 idef->iparams.data(),
                                                                 idef_t,
                                                                 izone,
-                                                                gmx::Range<int>(cg0t, cg1t));
+                                                                gmx::Range<int>(cg0t, cg1t),
+                                                                thread);
 
                 if (izone < numIZonesForExclusions)
                 {
@@ -49,9 +49,11 @@
 #ifndef GMX_DOMDEC_GA2LA_H
 #define GMX_DOMDEC_GA2LA_H
 
+#include <algorithm>
 #include <vector>
 
 #include "gromacs/domdec/hashedmap.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/gmxassert.h"
 
 /*! \libinternal \brief Global to local atom mapping
@@ -130,6 +132,45 @@ public:
         return (e && e->cell == 0) ? &(e->la) : nullptr;
     }
 
+    /*! \brief Looks up the local indices of home atoms for multiple global atoms
+     *
+     * \param[in]  globalAtomIndices  The global atom indices
+     * \param[out] localAtomIndices   The local atom indices, -1 for atoms that are not home atoms
+     */
+    void findHome(gmx::ArrayRef<const int> globalAtomIndices,
+                  gmx::ArrayRef<int>       localAtomIndices) const
+    {
+        GMX_ASSERT(globalAtomIndices.size() == localAtomIndices.size(),
+                   "Need as many local as global indices");
+
+        if (usingDirect_)
+        {
+            for (gmx::index i = 0; i < globalAtomIndices.ssize(); i++)
+            {
+                const Entry& entry  = data_.direct[globalAtomIndices[i]];
+                localAtomIndices[i] = (entry.cell == 0) ? entry.la : -1;
+            }
+        }
+        else
+        {
+            /* Look up in batches to avoid a large pointer buffer */
+            constexpr int c_batchSize = 64;
+            const Entry*  entries[c_batchSize];
+            for (gmx::index i0 = 0; i0 < globalAtomIndices.ssize(); i0 += c_batchSize)
+            {
+                const int batchSize =
+                        std::min(globalAtomIndices.ssize() - i0, gmx::index(c_batchSize));
+                data_.hashed.find(globalAtomIndices.subArray(i0, batchSize),
+                                  gmx::arrayRefFromArray(entries, batchSize));
+                for (int i = 0; i < batchSize; i++)
+                {
+                    localAtomIndices[i0 + i] =
+                            (entries[i] && entries[i]->cell == 0) ? entries[i]->la : -1;
+                }
+            }
+        }
+    }
+
     /*! \brief Returns a reference to the entry for a_gl
      *
      * A non-release assert checks that a_gl is present.
@@ -149,6 +190,18 @@ public:
         }
     }
 
+    /*! \brief Makes sure \p numAtoms atoms can be inserted without resizing
+     *
+     * Should be called before inserting many atoms.
+     */
+    void reserve(int numAtoms)
+    {
+        if (!usingDirect_)
+        {
+            data_.hashed.reserve(numAtoms);
+        }
+    }
+
     //! Clear all the entries in the list.
     void clear()
     {
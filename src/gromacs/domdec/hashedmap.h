@@ -35,7 +35,7 @@
 /*! \libinternal \file
  * \brief
  * Defines structures and functions for mapping from keys to entries
- * indices using a hash table.
+ * indices using an open-addressing hash table.
  * The functions are performance critical and should be inlined.
  *
  * \inlibraryapi
@@ -48,14 +48,17 @@
 #define GMX_DOMDEC_HASHEDMAP_H
 
 #include <climits>
+#include <cstdint>
 
 #include <algorithm>
 #include <utility>
 #include <vector>
 
 #include "gromacs/compat/utility.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
 
 namespace gmx
 {
@@ -65,6 +68,17 @@ namespace gmx
  * Efficiently manages mapping from integer keys to values.
  * Note that this basically implements a subset of the functionality of
  * std::unordered_map, but is an order of magnitude faster.
+ *
+ * The entries are stored in a single, contiguous table using open
+ * addressing with linear probing and Robin Hood hashing: on insertion
+ * an entry takes over the slot of an entry that is closer to its hash
+ * slot. This keeps the variance of the probe lengths low, so a lookup
+ * usually touches only a single cache line, and a lookup of a key that
+ * is not present can stop as soon as it encounters an entry closer to
+ * its hash slot than the key searched for. Erasing uses backward
+ * shifting, so no tombstones are needed.
+ *
+ * All integer keys except INT_MIN are supported.
  */
 template<class T>
 class HashedMap
@@ -73,11 +87,15 @@ private:
     /*! \libinternal \brief Structure for the key/value hash table */
     struct hashEntry
     {
-        int key = -1;  /**< The key */
-        T   value;     /**< The value(s) */
-        int next = -1; /**< Index in the list of the next element with the same hash, -1 if none */
+        int key = c_emptyKey; /**< The key, c_emptyKey when the entry is empty */
+        T   value;            /**< The value(s) */
     };
 
+    //! Key value used for marking an empty entry
+    static constexpr int c_emptyKey = INT_MIN;
+    //! The number of keys for which lookups are overlapped in the batched find()
+    static constexpr index c_findBatchSize = 16;
+
     /*! \brief The table size is set to at least this factor time the nr of keys */
     static constexpr float c_relTableSizeSetMin = 1.5;
     /*! \brief Threshold for increasing the table size */
@@ -85,32 +103,73 @@ private:
     /*! \brief Threshold for decreasing the table size */
     static constexpr float c_relTableSizeThresholdMax = 3.5;
 
-    /*! \brief Resizes the table
+    /*! \brief Resizes the table, existing entries are kept
      *
      * \param[in] numElementsEstimate  An estimate of the number of elements that will be stored
      */
     void resize(int numElementsEstimate)
     {
-        GMX_RELEASE_ASSERT(numElements_ == 0, "Table needs to be empty for resize");
-
-        /* The fraction of table entries with 0   size lists is e^-f.
-         * The fraction of table entries with >=1 size lists is 1 - e^-f
-         * where f is: the #elements / tableSize
-         * The fraction of elements not in the direct list is: 1 - (1 - e^-f)/f.
-         * Thus the optimal table size is roughly double #elements.
-         */
         /* Make the hash table a power of 2 and at least 1.5 * #elements */
         int tableSize = 64;
+        int log2Size  = 6;
         while (tableSize <= INT_MAX / 2
                && static_cast<float>(numElementsEstimate) * c_relTableSizeSetMin > tableSize)
         {
             tableSize *= 2;
+            log2Size++;
+        }
+
+        std::vector<hashEntry> oldTable(tableSize);
+        std::swap(table_, oldTable);
+
+        /* Table size is a power of 2, so a binary mask gives the slot index */
+        bitMask_        = tableSize - 1;
+        hashShift_      = 32 - log2Size;
+        maxNumElements_ = static_cast<int>(tableSize / c_relTableSizeThresholdMin);
+
+        numElements_ = 0;
+        for (const hashEntry& entry : oldTable)
+        {
+            if (entry.key != c_emptyKey)
+            {
+                insert_assign<false>(entry.key, entry.value);
+            }
         }
-        table_.resize(tableSize);
+    }
 
-        /* Table size is a power of 2, so a binary mask gives the hash */
-        bitMask_                        = tableSize - 1;
-        startIndexForSpaceForListEntry_ = tableSize;
+    /*! \brief Returns the hash slot for \p key
+     *
+     * Uses multiplicative (Fibonacci) hashing, which spreads keys with
+     * regular strides, such as atom indices, evenly over the table.
+     */
+    size_t hashSlot(int key) const
+    {
+        return (static_cast<uint32_t>(key) * 2654435769U) >> hashShift_;
+    }
+
+    //! Returns the distance of the entry with key \p key stored at \p slot to its hash slot
+    int probeDistance(int key, size_t slot) const { return (slot - hashSlot(key)) & bitMask_; }
+
+    //! Returns the slot index for \p key or -1 when not present
+    int findSlot(int key) const
+    {
+        size_t slot = hashSlot(key);
+        for (int distance = 0;; distance++)
+        {
+            const int slotKey = table_[slot].key;
+            if (slotKey == key)
+            {
+                return slot;
+            }
+            /* With Robin Hood hashing we can stop when we encounter an entry
+             * that is closer to its hash slot than our key would be.
+             */
+            if (slotKey == c_emptyKey || probeDistance(slotKey, slot) < distance)
+            {
+                return -1;
+            }
+            slot = (slot + 1) & bitMask_;
+        }
     }
 
 public:
@@ -130,6 +189,19 @@ public:
     /*! \brief Returns the number of buckets, i.e. the number of possible hashes */
     int bucket_count() const { return bitMask_ + 1; }
 
+    /*! \brief Makes sure \p numElements elements can be stored without resizing the table
+     *
+     * Calling this before inserting many elements avoids repeated
+     * rehashing of the table during insertion.
+     */
+    void reserve(int numElements)
+    {
+        if (numElements > maxNumElements_)
+        {
+            resize(numElements);
+        }
+    }
+
 private:
     /*! \brief Inserts or assigns a key and value
      *
@@ -138,71 +210,55 @@ private:
      * \param[in] value        The value for the entry
      * \throws InvalidInputError from a debug build when attempting to insert a duplicate key with \p allowAssign=true
      */
-    // cppcheck-suppress unusedPrivateFunction
     template<bool allowAssign>
     void insert_assign(int key, const T& value)
     {
-        size_t ind = (key & bitMask_);
+        GMX_ASSERT(key != c_emptyKey, "The key INT_MIN is not supported");
 
-        if (table_[ind].key >= 0)
+        if (numElements_ >= maxNumElements_)
         {
-            /* Loop over the entries for this hash.
-             * If we find the matching key, return the value.
-             */
-            int ind_prev = ind;
-            if (table_[ind_prev].key == key)
+            resize(numElements_ + 1);
+        }
+
+        int    keyToPlace   = key;
+        T      valueToPlace = value;
+        size_t slot         = hashSlot(key);
+        for (int distance = 0;; distance++)
+        {
+            hashEntry& entry = table_[slot];
+            if (entry.key == c_emptyKey)
             {
-                if (allowAssign)
-                {
-                    table_[ind].value = value;
-                    return;
-                }
-                else
-                {
-// Note: This is performance critical, so we only throw in debug mode
-#ifndef NDEBUG
-                    GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
-#endif
-                }
+                entry.key   = keyToPlace;
+                entry.value = valueToPlace;
+
+                numElements_ += 1;
+
+                return;
             }
-            while (table_[ind_prev].next >= 0)
+            /* Once key has been placed, it can not occur further on */
+            if (entry.key == key)
             {
-                ind_prev = table_[ind_prev].next;
-                if (table_[ind_prev].key == key)
+                if (!allowAssign)
                 {
-                    if (allowAssign)
-                    {
-                        table_[ind_prev].value = value;
-                        return;
-                    }
-                    else
-                    {
+// Note: This is performance critical, so we only throw in debug mode
 #ifndef NDEBUG
-                        GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
+                    GMX_THROW(InvalidInputError("Attempt to insert duplicate key"));
 #endif
-                    }
                 }
+                entry.value = value;
+
+                return;
             }
-            /* Search for space in table_ */
-            ind = startIndexForSpaceForListEntry_;
-            while (ind < table_.size() && table_[ind].key >= 0)
-            {
-                ind++;
-            }
-            /* If we are at the end of the list we need to increase the size */
-            if (ind == table_.size())
+            /* Take the slot from entries closer to their hash slot */
+            const int entryDistance = probeDistance(entry.key, slot);
+            if (entryDistance < distance)
             {
-                table_.resize(table_.size() + 1);
+                std::swap(keyToPlace, entry.key);
+                std::swap(valueToPlace, entry.value);
+                distance = entryDistance;
             }
-            table_[ind_prev].next = ind;
-
-            startIndexForSpaceForListEntry_ = ind + 1;
+            slot = (slot + 1) & bitMask_;
         }
-
-        table_[ind].key   = key;
-        table_[ind].value = value;
-
-        numElements_ += 1;
     }
 
 public:
@@ -213,6 +269,23 @@ public:
      * \throws InvalidInputError from a debug build when attempting to inser         */
     void insert(int key, const T& value) { insert_assign<false>(key, value); }
 
+    /*! \brief Inserts entries, keys should not already be present
+     *
+     * \param[in] keys    The keys for the entries
+     * \param[in] values  The values for the entries, should have the same size as \p keys
+     * \throws InvalidInputError from a debug build when attempting to insert a duplicate key
+     */
+    void insert(ArrayRef<const int> keys, ArrayRef<const T> values)
+    {
+        GMX_ASSERT(keys.size() == values.size(), "Need as many values as keys");
+
+        reserve(numElements_ + keys.ssize());
+        for (index i = 0; i < keys.ssize(); i++)
+        {
+            insert_assign<false>(keys[i], values[i]);
+        }
+    }
+
     /*! \brief Inserts an entry when the key is not present, otherwise sets the value
      *
      * \param[in] key    The key for the entry
@@ -226,34 +299,24 @@ public:
      */
     void erase(int key)
     {
-        int ind_prev = -1;
-        int ind      = (key & bitMask_);
-        do
+        int slot = findSlot(key);
+        if (slot < 0)
         {
-            if (table_[ind].key == key)
-            {
-                if (ind_prev >= 0)
-                {
-                    table_[ind_prev].next = table_[ind].next;
-
-                    /* This index is a linked entry, so we free an entry.
-                     * Check if we are creating the first empty space.
-                     */
-                    if (ind < startIndexForSpaceForListEntry_)
-                    {
-                        startIndexForSpaceForListEntry_ = ind;
-                    }
-                }
-                table_[ind].key  = -1;
-                table_[ind].next = -1;
+            return;
+        }
 
-                numElements_ -= 1;
+        /* Shift back the following entries that are not in their hash slot */
+        size_t nextSlot = (slot + 1) & bitMask_;
+        while (table_[nextSlot].key != c_emptyKey
+               && probeDistance(table_[nextSlot].key, nextSlot) > 0)
+        {
+            table_[slot] = table_[nextSlot];
+            slot         = nextSlot;
+            nextSlot     = (nextSlot + 1) & bitMask_;
+        }
+        table_[slot].key = c_emptyKey;
 
-                return;
-            }
-            ind_prev = ind;
-            ind      = table_[ind].next;
-        } while (ind >= 0);
+        numElements_ -= 1;
     }
 
     /*! \brief Returns a pointer to the value for the given key or nullptr when not present
@@ -272,17 +335,42 @@ public:
      */
     const T* find(int key) const
     {
-        int ind = (key & bitMask_);
-        do
+        const int slot = findSlot(key);
+
+        return (slot >= 0) ? &table_[slot].value : nullptr;
+    }
+
+    /*! \brief Looks up multiple keys
+     *
+     * Sets the elements of \p values to pointers to the values for the keys
+     * in \p keys, or to nullptr for keys that are not present.
+     *
+     * With keys spread over a large table, lookups are dominated by cache
+     * misses. The keys are processed in batches: first the hash slots of
+     * all keys in a batch are prefetched, so the cache misses overlap,
+     * then the slots are probed.
+     *
+     * \param[in]  keys    The keys
+     * \param[out] values  Pointers to the values, should have the same size as \p keys
+     */
+    void find(ArrayRef<const int> keys, ArrayRef<const T*> values) const
+    {
+        GMX_ASSERT(keys.size() == values.size(), "Need as many values as keys");
+
+        for (index batchStart = 0; batchStart < keys.ssize(); batchStart += c_findBatchSize)
         {
-            if (table_[ind].key == key)
+            const index batchEnd = std::min(batchStart + c_findBatchSize, keys.ssize());
+#if defined(__GNUC__)
+            for (index i = batchStart; i < batchEnd; i++)
             {
-                return &table_[ind].value;
+                __builtin_prefetch(&table_[hashSlot(keys[i])]);
             }
-            ind = table_[ind].next;
-        } while (ind >= 0);
-
-        return nullptr;
+#endif
+            for (index i = batchStart; i < batchEnd; i++)
+            {
+                values[i] = find(keys[i]);
+            }
+        }
     }
 
     /*! \brief Clear all the entries in the list
@@ -296,11 +384,9 @@ public:
 
         for (hashEntry& entry : table_)
         {
-            entry.key  = -1;
-            entry.next = -1;
+            entry.key = c_emptyKey;
         }
-        startIndexForSpaceForListEntry_ = bucket_count();
-        numElements_                    = 0;
+        numElements_ = 0;
 
         /* Resize the hash table when the occupation is far from optimal.
          * Do not resize with 0 elements to avoid minimal size when clear()
@@ -315,12 +401,14 @@ public:
     }
 
 private:
-    /*! \brief The hash table list */
+    /*! \brief The hash table */
     std::vector<hashEntry> table_;
-    /*! \brief The bit mask for computing the hash of a key */
+    /*! \brief The bit mask for computing the slot index of a key */
     int bitMask_ = 0;
-    /*! \brief Index in table_ at which to start looking for empty space for a new linked list entry */
-    int startIndexForSpaceForListEntry_ = 0;
+    /*! \brief The right-shift for extracting the hash slot from the scrambled key */
+    int hashShift_ = 0;
+    /*! \brief The number of elements above which the table is resized */
+    int maxNumElements_ = 0;
     /*! \brief The number of elements currently stored in the table */
     int numElements_ = 0;
 };
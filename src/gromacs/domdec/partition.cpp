@@ -506,6 +506,8 @@ static void make_dd_indices(gmx_domdec_t* dd, const int atomStart)
     /* Make the local to global and global to local atom index */
     int a = atomStart;
     globalAtomIndices.resize(a);
+    /* Avoid rehashing the global to local index during insertion */
+    ga2la.reserve(zone2cg[numZones]);
     for (int zone = 0; zone < numZones; zone++)
     {
         int cg0;
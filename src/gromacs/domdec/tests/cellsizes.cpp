@@ -0,0 +1,204 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the predictive dynamic load balancing of the cell sizes in a row.
+ *
+ * The cell loads are generated from a static model load density along
+ * the row, so the imbalance after each repartitioning can be computed
+ * exactly.
+ *
+ * \ingroup module_domdec
+ */
+#include "gmxpre.h"
+
+#include "gromacs/domdec/cellsizes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/domdec/domdec_internal.h"
+#include "gromacs/utility/arrayref.h"
+
+namespace
+{
+
+/*! \brief Model of a row of DD cells with a region of higher load density
+ *
+ * The load density is 1, except for the region from \p c_regionStart
+ * to \p c_regionEnd, relative to the row length, where it is \p c_regionDensity.
+ */
+class PredictiveDlbRow
+{
+public:
+    //! The start of the high-density region
+    static constexpr real c_regionStart = 0.3;
+    //! The end of the high-density region
+    static constexpr real c_regionEnd = 0.5;
+    //! The load density in the region
+    static constexpr real c_regionDensity = 4;
+
+    //! Constructs a row with \p numCells cells of equal size
+    PredictiveDlbRow(int numCells) : numCells_(numCells), loadBuffer_(numCells * c_numLoads)
+    {
+        for (int i = 0; i <= numCells; i++)
+        {
+            rowMaster_.cellFrac.push_back(static_cast<real>(i) / numCells);
+        }
+        rowMaster_.buf_ncd.resize(numCells);
+        load_.nload = c_numLoads;
+        load_.load  = loadBuffer_.data();
+    }
+
+    //! Returns the load of the cell from \p x0 to \p x1 in the model
+    static real modelLoad(real x0, real x1)
+    {
+        const real overlap =
+                std::max(std::min(x1, c_regionEnd) - std::max(x0, c_regionStart), real(0));
+
+        return (x1 - x0) + (c_regionDensity - 1) * overlap;
+    }
+
+    //! Returns the imbalance, the maximum cell load relative to the average minus 1
+    real imbalance() const
+    {
+        real loadMax = 0;
+        real loadSum = 0;
+        for (int i = 0; i < numCells_; i++)
+        {
+            const real load = modelLoad(rowMaster_.cellFrac[i], rowMaster_.cellFrac[i + 1]);
+            loadMax         = std::max(loadMax, load);
+            loadSum += load;
+        }
+
+        return loadMax * numCells_ / loadSum - 1;
+    }
+
+    //! Measures the model loads and repartitions using predictive DLB
+    void repartition(real changeLimit)
+    {
+        for (int i = 0; i < numCells_; i++)
+        {
+            loadBuffer_[i * c_numLoads + 2] =
+                    modelLoad(rowMaster_.cellFrac[i], rowMaster_.cellFrac[i + 1]);
+        }
+
+        setCellSizesFromLoadProfile(&rowMaster_, load_, numCells_, changeLimit, rowMaster_.buf_ncd);
+
+        real sizeSum = 0;
+        for (int i = 0; i < numCells_; i++)
+        {
+            EXPECT_GT(rowMaster_.buf_ncd[i], 0);
+            sizeSum += rowMaster_.buf_ncd[i];
+        }
+        for (int i = 0; i < numCells_ - 1; i++)
+        {
+            rowMaster_.cellFrac[i + 1] = rowMaster_.cellFrac[i] + rowMaster_.buf_ncd[i] / sizeSum;
+        }
+    }
+
+    //! Returns the current cell boundaries
+    gmx::ArrayRef<const real> cellFrac() const { return rowMaster_.cellFrac; }
+
+private:
+    //! The number of load entries per cell, we only use the entry with index 2
+    static constexpr int c_numLoads = 3;
+
+    //! The number of cells in the row
+    int numCells_;
+    //! The row master, stores the cell boundaries and the load profile
+    RowMaster rowMaster_;
+    //! The storage for the cell loads
+    std::vector<float> loadBuffer_;
+    //! The cell loads
+    domdec_load_t load_;
+};
+
+TEST(PredictiveDlbTest, ConvergesWithinFiveRepartitionings)
+{
+    PredictiveDlbRow row(4);
+
+    EXPECT_GT(row.imbalance(), 1);
+
+    /* Use a change limit that does not restrict the cell sizes here */
+    const real changeLimit = 1;
+
+    for (int step = 0; step < 5; step++)
+    {
+        row.repartition(changeLimit);
+    }
+    EXPECT_LT(row.imbalance(), 0.01);
+
+    /* The history should not cause drift or oscillations */
+    for (int step = 0; step < 10; step++)
+    {
+        row.repartition(changeLimit);
+        EXPECT_LT(row.imbalance(), 0.01) << "at repartitioning " << 5 + step;
+    }
+}
+
+TEST(PredictiveDlbTest, RespectsTheChangeLimit)
+{
+    PredictiveDlbRow row(4);
+
+    /* The default maximum change of 10% */
+    const real changeLimit = 0.1;
+
+    real imbalance = row.imbalance();
+    for (int step = 0; step < 20; step++)
+    {
+        const std::vector<real> oldCellFrac(row.cellFrac().begin(), row.cellFrac().end());
+
+        row.repartition(changeLimit);
+
+        for (int i = 0; i < 4; i++)
+        {
+            const real oldSize = oldCellFrac[i + 1] - oldCellFrac[i];
+            const real newSize = row.cellFrac()[i + 1] - row.cellFrac()[i];
+            EXPECT_LE(std::abs(newSize / oldSize - 1), changeLimit * (1 + 1e-4))
+                    << "for cell " << i << " at repartitioning " << step;
+        }
+
+        /* With the change limited, the imbalance should decrease monotonically */
+        EXPECT_LT(row.imbalance(), imbalance + 1e-4) << "at repartitioning " << step;
+        imbalance = row.imbalance();
+    }
+    EXPECT_LT(imbalance, 0.01);
+}
+
+} // namespace
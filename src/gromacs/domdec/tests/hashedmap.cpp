@@ -43,6 +43,8 @@
 
 #include "gromacs/domdec/hashedmap.h"
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "testutils/testasserts.h"
@@ -137,30 +139,105 @@ TEST(HashedMap, Clears)
     checkDoesNotFind(map, 7);
 }
 
-// Check that entries with the same hash are handled correctly
-TEST(HashedMap, LinkedEntries)
+// Check that entries with colliding hash slots are handled correctly
+TEST(HashedMap, CollidingEntries)
 {
-    // HashedMap uses bit masking, so keys that differ by exactly
-    // a power of 2 larger than the table size will have the same hash
+    // With many more keys than the initial table size and keys with
+    // large power of 2 strides, many keys will share hash slots.
 
     gmx::HashedMap<char> map(20);
 
     const int largePowerOf2 = 2048;
 
-    map.insert(3 + 0 * largePowerOf2, 'a');
-    map.insert(3 + 1 * largePowerOf2, 'b');
-    map.insert(3 + 2 * largePowerOf2, 'c');
+    for (int i = 0; i < 100; i++)
+    {
+        map.insert(3 + i * largePowerOf2, 'a' + i % 26);
+    }
+    EXPECT_EQ(map.size(), 100);
+
+    for (int i = 0; i < 100; i++)
+    {
+        checkFinds(map, 3 + i * largePowerOf2, 'a' + i % 26);
+    }
+
+    // Erase every third entry, this shifts back entries after them
+    for (int i = 0; i < 100; i += 3)
+    {
+        map.erase(3 + i * largePowerOf2);
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        if (i % 3 == 0)
+        {
+            checkDoesNotFind(map, 3 + i * largePowerOf2);
+        }
+        else
+        {
+            checkFinds(map, 3 + i * largePowerOf2, 'a' + i % 26);
+        }
+    }
+}
+
+TEST(HashedMap, InsertsFindsMultiple)
+{
+    gmx::HashedMap<char> map(2);
+
+    const std::vector<int>  keys   = { 10, 5, 7, -2 };
+    const std::vector<char> values = { 'a', 'b', 'c', 'd' };
+    map.insert(keys, values);
+    EXPECT_EQ(map.size(), 4);
+
+    const std::vector<int>   keysToFind = { 7, 4, -2, 10, 5 };
+    std::vector<const char*> found(keysToFind.size());
+    map.find(keysToFind, found);
+
+    ASSERT_NE(found[0], nullptr);
+    EXPECT_EQ(*found[0], 'c');
+    EXPECT_EQ(found[1], nullptr);
+    ASSERT_NE(found[2], nullptr);
+    EXPECT_EQ(*found[2], 'd');
+    ASSERT_NE(found[3], nullptr);
+    EXPECT_EQ(*found[3], 'a');
+    ASSERT_NE(found[4], nullptr);
+    EXPECT_EQ(*found[4], 'b');
+}
 
-    checkFinds(map, 3 + 0 * largePowerOf2, 'a');
-    checkFinds(map, 3 + 1 * largePowerOf2, 'b');
-    checkFinds(map, 3 + 2 * largePowerOf2, 'c');
+TEST(HashedMap, FindsMultipleInBatches)
+{
+    gmx::HashedMap<int> map(0);
+
+    /* Use more keys than fit in a single lookup batch */
+    const int        numKeys = 1000;
+    std::vector<int> keys;
+    std::vector<int> values;
+    for (int i = 0; i < numKeys; i++)
+    {
+        keys.push_back(3 * i);
+        values.push_back(i);
+    }
+    map.insert(keys, values);
 
-    // Erase the middle entry in the linked list
-    map.erase(3 + 1 * largePowerOf2);
+    std::vector<int> keysToFind;
+    for (int key = 0; key < 3 * numKeys; key++)
+    {
+        keysToFind.push_back(key);
+    }
+    std::vector<const int*> found(keysToFind.size());
+    map.find(keysToFind, found);
 
-    checkFinds(map, 3 + 0 * largePowerOf2, 'a');
-    checkDoesNotFind(map, 3 + 1 * largePowerOf2);
-    checkFinds(map, 3 + 2 * largePowerOf2, 'c');
+    for (int key = 0; key < 3 * numKeys; key++)
+    {
+        if (key % 3 == 0)
+        {
+            ASSERT_NE(found[key], nullptr);
+            EXPECT_EQ(*found[key], key / 3);
+        }
+        else
+        {
+            EXPECT_EQ(found[key], nullptr);
+        }
+    }
 }
 
 // HashedMap only throws in debug mode, so only test in debug mode
@@ -185,13 +262,14 @@ TEST(HashedMap, ResizesTable)
     // This test assumes the minimum bucket count is 64 or less
     EXPECT_LT(map.bucket_count(), 128);
 
+    // Check that the table grows when it gets too full
     for (int i = 0; i < 60; i++)
     {
         map.insert(2 * i + 3, 'a');
     }
-    EXPECT_LT(map.bucket_count(), 128);
+    EXPECT_EQ(map.bucket_count(), 128);
 
-    // Check that the table size is double #elements after clear()
+    // Check that the table size is not changed by clear() with this occupation
     map.clear();
     EXPECT_EQ(map.bucket_count(), 128);
 
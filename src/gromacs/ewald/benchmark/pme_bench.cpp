@@ -0,0 +1,487 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * This file defines functions for running the CPU PME stage benchmarks
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include "pme_bench.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "gromacs/domdec/domdec.h"
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_gather.h"
+#include "gromacs/ewald/pme_grid.h"
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/ewald/pme_solve.h"
+#include "gromacs/ewald/pme_spread.h"
+#include "gromacs/fft/calcgrid.h"
+#include "gromacs/fft/parallel_3dfft.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/simd/simd.h"
+#include "gromacs/timing/walltime_accounting.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/logger.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+// A rigid 3-site water model with SPC/E geometry and charges
+//! The number of water molecules per unit of system size
+constexpr int c_numMoleculesPerSizeUnit = 1000;
+//! The number density of water molecules in nm^-3
+constexpr real c_waterNumberDensity = 33.0;
+//! The oxygen-hydrogen distance in nm
+constexpr real c_distanceOH = 0.1;
+//! The hydrogen-oxygen-hydrogen angle in degrees
+constexpr real c_angleHOH = 109.47;
+//! The charge of the oxygen atom
+constexpr real c_chargeOxygen = -0.8476;
+//! The charge of the hydrogen atom
+constexpr real c_chargeHydrogen = 0.4238;
+
+//! The synthetic water system the benchmarks operate on
+struct PmeBenchSystem
+{
+    //! The atom coordinates, all inside the box
+    std::vector<RVec> coordinates;
+    //! The atom partial charges
+    std::vector<real> charges;
+    //! The cubic periodic box
+    matrix box;
+};
+
+//! Returns a uniformly distributed random unit vector
+RVec randomUnitVector(DefaultRandomEngine* rng, UniformRealDistribution<real>* dist)
+{
+    const real z   = 2 * (*dist)(*rng) - 1;
+    const real phi = 2 * M_PI * (*dist)(*rng);
+    const real r   = std::sqrt(std::max(1 - z * z, real(0)));
+
+    return { r * std::cos(phi), r * std::sin(phi), z };
+}
+
+/*! \brief Generates \p numMolecules randomly oriented water molecules
+ *
+ * The oxygen atoms are placed on a simple cubic lattice in a cubic box
+ * with the density of liquid water.
+ */
+PmeBenchSystem generateWaterSystem(int numMolecules)
+{
+    PmeBenchSystem system;
+
+    const real boxLength   = std::cbrt(numMolecules / c_waterNumberDensity);
+    const int  numSitesDim = static_cast<int>(std::ceil(std::cbrt(real(numMolecules))));
+    const real spacing     = boxLength / numSitesDim;
+    clear_mat(system.box);
+    for (int d = 0; d < DIM; d++)
+    {
+        system.box[d][d] = boxLength;
+    }
+
+    const real halfAngle = 0.5 * c_angleHOH * DEG2RAD;
+
+    DefaultRandomEngine           rng(numMolecules);
+    UniformRealDistribution<real> dist;
+
+    system.coordinates.reserve(3 * numMolecules);
+    system.charges.reserve(3 * numMolecules);
+    for (int m = 0; m < numMolecules; m++)
+    {
+        const RVec latticeSite = { real(m % numSitesDim),
+                                   real((m / numSitesDim) % numSitesDim),
+                                   real(m / (numSitesDim * numSitesDim)) };
+        const RVec oxygen      = spacing * (latticeSite + RVec(0.5, 0.5, 0.5));
+
+        /* Construct an orthonormal pair of a random bisector and in-plane direction */
+        const RVec bisector = randomUnitVector(&rng, &dist);
+        RVec       inPlane  = randomUnitVector(&rng, &dist);
+        inPlane -= iprod(inPlane, bisector) * bisector;
+        while (norm2(inPlane) < 1e-4)
+        {
+            inPlane = randomUnitVector(&rng, &dist);
+            inPlane -= iprod(inPlane, bisector) * bisector;
+        }
+        inPlane *= invsqrt(norm2(inPlane));
+
+        const RVec alongBisector = c_distanceOH * std::cos(halfAngle) * bisector;
+        const RVec alongPlane    = c_distanceOH * std::sin(halfAngle) * inPlane;
+
+        system.coordinates.push_back(oxygen);
+        system.coordinates.push_back(oxygen + alongBisector + alongPlane);
+        system.coordinates.push_back(oxygen + alongBisector - alongPlane);
+        system.charges.push_back(c_chargeOxygen);
+        system.charges.push_back(c_chargeHydrogen);
+        system.charges.push_back(c_chargeHydrogen);
+    }
+
+    put_atoms_in_box(PbcType::Xyz, system.box, system.coordinates);
+
+    return system;
+}
+
+//! Deleter for gmx_pme_t, for use with std::unique_ptr
+struct PmeDeleter
+{
+    //! Destroys the PME data structure
+    void operator()(gmx_pme_t* pme) const { gmx_pme_destroy(pme); }
+};
+
+//! Owning pointer to the PME data structure
+using PmePointer = std::unique_ptr<gmx_pme_t, PmeDeleter>;
+
+//! The PME stages that are timed separately
+enum class PmeStage : int
+{
+    Spread,
+    FftRealToComplex,
+    Solve,
+    FftComplexToReal,
+    Gather,
+    Count
+};
+
+//! The average wall-clock time per iteration in microseconds for each stage
+using PmeStageTimes = std::array<double, static_cast<int>(PmeStage::Count)>;
+
+//! Spreads the charges, including the grid reduction and wrapping
+void runSpread(gmx_pme_t* pme)
+{
+    PmeAtomComm* atc     = &pme->atc[0];
+    pmegrids_t*  pmegrid = &pme->pmegrid[0];
+
+    spread_on_grid(pme, atc, pmegrid, TRUE, TRUE, pme->fftgrid[0], FALSE, 0);
+    if (!pme->bUseThreads)
+    {
+        wrap_periodic_pmegrid(pme, pmegrid->grid.grid);
+        copy_pmegrid_to_fftgrid(pme, pmegrid->grid.grid, pme->fftgrid[0], 0);
+    }
+}
+
+//! Runs the 3D FFT in direction \p direction using all PME threads
+void runFft(gmx_pme_t* pme, gmx_fft_direction direction)
+{
+#pragma omp parallel num_threads(pme->nthread)
+    {
+        try
+        {
+            const int thread = gmx_omp_get_thread_num();
+            gmx_parallel_3dfft_execute(pme->pfft_setup[0], direction, thread, nullptr);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+//! Solves in reciprocal space using all PME threads
+void runSolve(gmx_pme_t* pme, real cellVolume, bool computeEnergyAndVirial)
+{
+#pragma omp parallel num_threads(pme->nthread)
+    {
+        try
+        {
+            solve_pme_yzx(pme,
+                          pme->cfftgrid[0],
+                          cellVolume,
+                          computeEnergyAndVirial,
+                          pme->nthread,
+                          gmx_omp_get_thread_num());
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+//! Gathers the forces, including copying back and unwrapping the grid
+void runGather(gmx_pme_t* pme)
+{
+    PmeAtomComm* atc  = &pme->atc[0];
+    real*        grid = pme->pmegrid[0].grid.grid;
+
+#pragma omp parallel num_threads(pme->nthread)
+    {
+        try
+        {
+            const int thread = gmx_omp_get_thread_num();
+            copy_fftgrid_to_pmegrid(pme, pme->fftgrid[0], grid, 0, pme->nthread, thread);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    unwrap_periodic_pmegrid(pme, grid);
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
+    for (int thread = 0; thread < pme->nthread; thread++)
+    {
+        try
+        {
+            gather_f_bsplines(pme, grid, TRUE, atc, &atc->spline[thread], 1.0);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
+/*! \brief Times the PME stages for one setup
+ *
+ * The stages are run in the order of a PME step, each stage is timed
+ * on its own with a separate OpenMP parallel region.
+ */
+PmeStageTimes benchmarkSetup(const PmeBenchSystem&  system,
+                             const PmeBenchOptions& options,
+                             int                    numThreads,
+                             int                    pmeOrder,
+                             const ivec             gridSize,
+                             real                   ewaldCoeffQ)
+{
+    t_inputrec inputrec;
+    inputrec.pbcType     = PbcType::Xyz;
+    inputrec.coulombtype = eelPME;
+    inputrec.vdwtype     = evdwCUT;
+    inputrec.efep        = efepNO;
+    inputrec.epsilon_r   = 1;
+    inputrec.pme_order   = pmeOrder;
+    inputrec.nkx         = gridSize[XX];
+    inputrec.nky         = gridSize[YY];
+    inputrec.nkz         = gridSize[ZZ];
+
+    const MDLogger dummyLogger;
+    t_commrec      dummyCommrec = { 0 };
+    PmePointer     pme(gmx_pme_init(&dummyCommrec,
+                                NumPmeDomains{ 1, 1 },
+                                &inputrec,
+                                false,
+                                false,
+                                false,
+                                ewaldCoeffQ,
+                                0,
+                                numThreads,
+                                PmeRunMode::CPU,
+                                nullptr,
+                                nullptr,
+                                nullptr,
+                                nullptr,
+                                dummyLogger));
+    invertBoxMatrix(system.box, pme->recipbox);
+
+    const int numAtoms = static_cast<int>(system.coordinates.size());
+    gmx_pme_reinit_atoms(pme.get(), numAtoms, system.charges.data(), nullptr);
+
+    std::vector<RVec> forces(numAtoms);
+    PmeAtomComm*      atc = &pme->atc[0];
+    atc->x                = system.coordinates;
+    atc->coefficient      = system.charges;
+    atc->f                = forces;
+
+    const real cellVolume = system.box[XX][XX] * system.box[YY][YY] * system.box[ZZ][ZZ];
+
+    PmeStageTimes times = {};
+    for (int iter = -options.numWarmupIterations; iter < options.numIterations; iter++)
+    {
+        PmeStageTimes iterationTimes;
+        double        startTime = gmx_gettime();
+        auto          timeStage = [&iterationTimes, &startTime](PmeStage stage) {
+            const double endTime                    = gmx_gettime();
+            iterationTimes[static_cast<int>(stage)] = endTime - startTime;
+            startTime                               = endTime;
+        };
+
+        runSpread(pme.get());
+        timeStage(PmeStage::Spread);
+        runFft(pme.get(), GMX_FFT_REAL_TO_COMPLEX);
+        timeStage(PmeStage::FftRealToComplex);
+        runSolve(pme.get(), cellVolume, options.computeEnergyAndVirial);
+        timeStage(PmeStage::Solve);
+        runFft(pme.get(), GMX_FFT_COMPLEX_TO_REAL);
+        timeStage(PmeStage::FftComplexToReal);
+        runGather(pme.get());
+        timeStage(PmeStage::Gather);
+
+        if (iter >= 0)
+        {
+            for (size_t s = 0; s < times.size(); s++)
+            {
+                times[s] += iterationTimes[s];
+            }
+        }
+    }
+    for (double& time : times)
+    {
+        time *= 1e6 / std::max(options.numIterations, 1);
+    }
+
+    return times;
+}
+
+} // namespace
+
+void pmeBench(int sizeFactor, const PmeBenchOptions& options)
+{
+    if (sizeFactor < 1)
+    {
+        gmx_fatal(FARGS, "The size factor should be at least 1");
+    }
+    if (options.numIterations < 1)
+    {
+        gmx_fatal(FARGS, "The number of iterations should be at least 1");
+    }
+
+    const PmeBenchSystem system = generateWaterSystem(sizeFactor * c_numMoleculesPerSizeUnit);
+    const real           ewaldCoeffQ = calc_ewaldcoeff_q(options.cutoff, options.ewaldRTol);
+
+    FILE* csv = nullptr;
+    if (!options.outputFile.empty())
+    {
+        csv = fopen(options.outputFile.c_str(), "w");
+        if (csv == nullptr)
+        {
+            gmx_fatal(FARGS, "Could not open '%s' for writing", options.outputFile.c_str());
+        }
+        fprintf(csv,
+                "\"atoms\",\"box\",\"threads\",\"order\",\"grid x\",\"grid y\",\"grid z\","
+                "\"iter\",\"energy\",\"spread (us)\",\"fft r2c (us)\",\"solve (us)\","
+                "\"fft c2r (us)\",\"gather (us)\",\"total (us)\"\n");
+    }
+
+#if GMX_SIMD
+    fprintf(stdout, "SIMD width:           %d\n", GMX_SIMD_REAL_WIDTH);
+#endif
+    fprintf(stdout, "System size:          %zu atoms\n", system.coordinates.size());
+    fprintf(stdout, "Box size:             %.3f nm\n", system.box[XX][XX]);
+    fprintf(stdout, "Ewald coefficient:    %g nm^-1\n", ewaldCoeffQ);
+    fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
+    fprintf(stdout, "Compute energies:     %s\n", options.computeEnergyAndVirial ? "yes" : "no");
+    fprintf(stdout, "\nTimes are wall-clock microseconds per iteration\n");
+    fprintf(stdout,
+            "threads order       grid     spread  fft r2c    solve  fft c2r   gather    total\n");
+
+    for (int numThreads : options.numThreads)
+    {
+        if (numThreads < 1)
+        {
+            gmx_fatal(FARGS, "The number of threads should be at least 1");
+        }
+        if (!GMX_OPENMP && numThreads > 1)
+        {
+            gmx_fatal(FARGS, "Multiple threads are only supported with OpenMP");
+        }
+        for (int pmeOrder : options.pmeOrders)
+        {
+            if (pmeOrder < 3 || pmeOrder > PME_ORDER_MAX)
+            {
+                gmx_fatal(FARGS, "The PME order should be between 3 and %d", PME_ORDER_MAX);
+            }
+            for (real spacing : options.fourierSpacings)
+            {
+                ivec gridSize = { 0, 0, 0 };
+                calcFftGrid(nullptr,
+                            system.box,
+                            spacing,
+                            minimalPmeGridSize(pmeOrder),
+                            &gridSize[XX],
+                            &gridSize[YY],
+                            &gridSize[ZZ]);
+
+                const PmeStageTimes times = benchmarkSetup(
+                        system, options, numThreads, pmeOrder, gridSize, ewaldCoeffQ);
+                double totalTime = 0;
+                for (double time : times)
+                {
+                    totalTime += time;
+                }
+
+                fprintf(stdout,
+                        "%7d %5d %3dx%3dx%3d %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f\n",
+                        numThreads,
+                        pmeOrder,
+                        gridSize[XX],
+                        gridSize[YY],
+                        gridSize[ZZ],
+                        times[static_cast<int>(PmeStage::Spread)],
+                        times[static_cast<int>(PmeStage::FftRealToComplex)],
+                        times[static_cast<int>(PmeStage::Solve)],
+                        times[static_cast<int>(PmeStage::FftComplexToReal)],
+                        times[static_cast<int>(PmeStage::Gather)],
+                        totalTime);
+                if (csv)
+                {
+                    fprintf(csv,
+                            "%zu,%g,%d,%d,%d,%d,%d,%d,\"%s\",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                            system.coordinates.size(),
+                            system.box[XX][XX],
+                            numThreads,
+                            pmeOrder,
+                            gridSize[XX],
+                            gridSize[YY],
+                            gridSize[ZZ],
+                            options.numIterations,
+                            options.computeEnergyAndVirial ? "yes" : "no",
+                            times[static_cast<int>(PmeStage::Spread)],
+                            times[static_cast<int>(PmeStage::FftRealToComplex)],
+                            times[static_cast<int>(PmeStage::Solve)],
+                            times[static_cast<int>(PmeStage::FftComplexToReal)],
+                            times[static_cast<int>(PmeStage::Gather)],
+                            totalTime);
+                }
+            }
+        }
+    }
+
+    if (csv)
+    {
+        fclose(csv);
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,96 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * This file declares functions for running the CPU PME stage benchmarks
+ *
+ * \inlibraryapi
+ * \ingroup module_ewald
+ */
+
+#ifndef GMX_EWALD_PME_BENCH_H
+#define GMX_EWALD_PME_BENCH_H
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \internal \brief
+ * The options for the PME benchmarks
+ */
+struct PmeBenchOptions
+{
+    //! The numbers of OpenMP threads to run with
+    std::vector<int> numThreads = { 1 };
+    //! The interpolation orders to run with
+    std::vector<int> pmeOrders = { 4 };
+    //! The Fourier grid spacings to derive the grid sizes from
+    std::vector<real> fourierSpacings = { 0.12 };
+    //! The real-space cut-off, used to set the Ewald coefficient
+    real cutoff = 1.0;
+    //! The relative strength of the Ewald interaction at the cut-off
+    real ewaldRTol = 1e-5;
+    //! Whether the solver also computes the energy and the virial
+    bool computeEnergyAndVirial = false;
+    //! The number of timed iterations for each setup
+    int numIterations = 20;
+    //! The number of (untimed) iterations to run before timing each setup
+    int numWarmupIterations = 2;
+    //! Also report into a csv file
+    std::string outputFile;
+};
+
+/*! \brief
+ * Sets up and runs the CPU PME stage benchmarks
+ *
+ * The system is a box of water molecules with 1000 times \p sizeFactor
+ * molecules. For every combination of thread count, interpolation order
+ * and grid spacing in \p options the spreading, the forward and backward
+ * 3D FFT, the reciprocal-space solver and the force gathering are timed
+ * separately. Timings are printed to stdout and, when requested, to
+ * a csv file.
+ *
+ * \param[in] sizeFactor  The system size in units of 1000 water molecules
+ * \param[in] options     How the benchmark will be run
+ */
+void pmeBench(int sizeFactor, const PmeBenchOptions& options);
+
+} // namespace gmx
+
+#endif
@@ -803,16 +803,6 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                       pme->nky,
                       (div_round_up(pme->nkx, pme->nnodes_major) + pme->pme_order + 1) * pme->nkz);
 
-    /* Double-check for a limitation of the (current) sum_fftgrid_dd code.
-     * Note that gmx_pme_check_restrictions checked for this already.
-     */
-    if (pme->bUseThreads && (pme->overlap[0].comm_data.size() > 1))
-    {
-        gmx_incons(
-                "More than one communication pulse required for grid overlap communication along "
-                "the major dimension while using threads");
-    }
-
     snew(pme->bsp_mod[XX], pme->nkx);
     snew(pme->bsp_mod[YY], pme->nky);
     snew(pme->bsp_mod[ZZ], pme->nkz);
@@ -839,6 +829,39 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
     make_gridindex_to_localindex(
             pme->nkz, pme->pmegrid_start_iz, pme->pmegrid_nz_base, &pme->nnz, &pme->fshz);
 
+    /* With colored spreading the threads spread directly on the full grid,
+     * each on a slab along x. Each slab is spread in two halves, one after
+     * the other, so the halves should have at least pme_order-1 grid lines.
+     * This avoids the thread-local grids and their reduction.
+     * This changes the grid communication, so all ranks should agree.
+     */
+    int use_colored_spread =
+            (pme->bUseThreads && getenv("GMX_PME_COLORED_SPREAD") != nullptr
+             && (pme->pmegrid_nx - (pme->pme_order - 1)) / pme->nthread >= 2 * (pme->pme_order - 1))
+                    ? 1
+                    : 0;
+#if GMX_MPI
+    if (pme->nnodes > 1)
+    {
+        int min_use_colored_spread;
+        MPI_Allreduce(
+                &use_colored_spread, &min_use_colored_spread, 1, MPI_INT, MPI_MIN, pme->mpi_comm);
+        use_colored_spread = min_use_colored_spread;
+    }
+#endif
+    pme->useColoredSpread = (use_colored_spread > 0);
+
+    /* Double-check for a limitation of the (current) sum_fftgrid_dd code.
+     * Note that gmx_pme_check_restrictions checked for this already.
+     * Colored spreading communicates the full grid with gmx_sum_qgrid_dd instead.
+     */
+    if (pme->bUseThreads && !pme->useColoredSpread && (pme->overlap[0].comm_data.size() > 1))
+    {
+        gmx_incons(
+                "More than one communication pulse required for grid overlap communication along "
+                "the major dimension while using threads");
+    }
+
     pme->spline_work = make_pme_spline_work(pme->pme_order);
 
     ndata[0] = pme->nkx;
@@ -872,6 +895,7 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                           pme->pmegrid_nz_base,
                           pme->pme_order,
                           pme->bUseThreads,
+                          pme->useColoredSpread,
                           pme->nthread,
                           pme->overlap[0].s2g1[pme->nodeid_major]
                                   - pme->overlap[0].s2g0[pme->nodeid_major + 1],
@@ -437,11 +437,13 @@ void wrap_periodic_pmegrid(const gmx_pme_t* pme, real* pmegrid)
     overlap = pme->pme_order - 1;
 
     /* Add periodic overlap in z */
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
     for (ix = 0; ix < pme->pmegrid_nx; ix++)
     {
-        for (iy = 0; iy < pme->pmegrid_ny; iy++)
+        // Trivial OpenMP region that does not throw, no need for try/catch
+        for (int iy = 0; iy < pme->pmegrid_ny; iy++)
         {
-            for (iz = 0; iz < overlap; iz++)
+            for (int iz = 0; iz < overlap; iz++)
             {
                 pmegrid[(ix * pny + iy) * pnz + iz] += pmegrid[(ix * pny + iy) * pnz + nz + iz];
             }
@@ -450,11 +452,13 @@ void wrap_periodic_pmegrid(const gmx_pme_t* pme, real* pmegrid)
 
     if (pme->nnodes_minor == 1)
     {
+#pragma omp parallel for num_threads(pme->nthread) schedule(static)
         for (ix = 0; ix < pme->pmegrid_nx; ix++)
         {
-            for (iy = 0; iy < overlap; iy++)
+            // Trivial OpenMP region that does not throw, no need for try/catch
+            for (int iy = 0; iy < overlap; iy++)
             {
-                for (iz = 0; iz < nz; iz++)
+                for (int iz = 0; iz < nz; iz++)
                 {
                     pmegrid[(ix * pny + iy) * pnz + iz] += pmegrid[(ix * pny + ny + iy) * pnz + iz];
                 }
@@ -696,6 +700,7 @@ void pmegrids_init(pmegrids_t* grids,
                    int         nz_base,
                    int         pme_order,
                    gmx_bool    bUseThreads,
+                   bool        useColoredSpread,
                    int         nthread,
                    int         overlap_x,
                    int         overlap_y)
@@ -715,9 +720,19 @@ void pmegrids_init(pmegrids_t* grids,
 
     grids->nthread = nthread;
 
-    make_subgrid_division(n_base, pme_order - 1, grids->nthread, grids->nc);
+    if (useColoredSpread)
+    {
+        /* The threads spread directly on the full grid, in slabs along x */
+        grids->nc[XX] = grids->nthread;
+        grids->nc[YY] = 1;
+        grids->nc[ZZ] = 1;
+    }
+    else
+    {
+        make_subgrid_division(n_base, pme_order - 1, grids->nthread, grids->nc);
+    }
 
-    if (bUseThreads)
+    if (bUseThreads && !useColoredSpread)
     {
         ivec nst;
         int  gridsize;
@@ -772,7 +787,8 @@ void pmegrids_init(pmegrids_t* grids,
     }
     else
     {
-        grids->grid_th = nullptr;
+        grids->grid_th  = nullptr;
+        grids->grid_all = nullptr;
     }
 
     tfac = 1;
@@ -917,7 +933,9 @@ void reuse_pmegrids(const pmegrids_t* oldgrid, pmegrids_t* newgrid)
     sfree_aligned(newgrid->grid.grid);
     newgrid->grid.grid = oldgrid->grid.grid;
 
-    if (newgrid->grid_th != nullptr && newgrid->nthread == oldgrid->nthread)
+    /* With colored spreading there are no thread-local grids */
+    if (newgrid->grid_th != nullptr && oldgrid->grid_th != nullptr
+        && newgrid->nthread == oldgrid->nthread)
     {
         sfree_aligned(newgrid->grid_all);
         newgrid->grid_all = oldgrid->grid_all;
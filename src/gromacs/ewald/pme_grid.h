@@ -88,6 +88,7 @@ void pmegrids_init(pmegrids_t* grids,
                    int         nz_base,
                    int         pme_order,
                    gmx_bool    bUseThreads,
+                   bool        useColoredSpread,
                    int         nthread,
                    int         overlap_x,
                    int         overlap_y);
@@ -182,6 +182,9 @@ struct splinedata_t
     SplineCoefficients theta;
     SplineCoefficients dtheta;
     int                nalloc = 0;
+
+    /* With colored spreading, the first nFirstColor atoms in ind are spread in the first pass */
+    int nFirstColor = 0;
 };
 
 /*! \brief PME slab MPI communication setup */
@@ -322,6 +325,7 @@ struct gmx_pme_t
 
     gmx_bool bUseThreads; /* Does any of the PME ranks have nthread>1 ?  */
     int      nthread;     /* The number of threads doing PME on our rank */
+    bool     useColoredSpread; /* Threads spread directly on the full grid in two passes */
 
     gmx_bool bPPnode;   /* Node also does particle-particle forces */
     bool     doCoulomb; /* Apply PME to electrostatics */
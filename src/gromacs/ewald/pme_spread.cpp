@@ -207,6 +207,45 @@ static void make_thread_local_ind(const PmeAtomComm* atc, int thread, splinedata
     spline->n = n;
 }
 
+/* As make_thread_local_ind, but with the atoms spread in the first colored
+ * pass, i.e. those with grid index below xSplit, first.
+ */
+static void make_thread_local_ind_colored(const PmeAtomComm* atc,
+                                          int                thread,
+                                          int                xSplit,
+                                          splinedata_t*      spline)
+{
+    int n = 0;
+    for (int color = 0; color < 2; color++)
+    {
+        int start = 0;
+        for (int t = 0; t < atc->nthread; t++)
+        {
+            const AtomToThreadMap& threadMap = atc->threadMap[t];
+            /* Copy our part (start - end) from the list of thread t */
+            if (thread > 0)
+            {
+                start = threadMap.n[thread - 1];
+            }
+            int end = threadMap.n[thread];
+            for (int i = start; i < end; i++)
+            {
+                const int a = threadMap.i[i];
+                if ((atc->idx[a][XX] < xSplit) == (color == 0))
+                {
+                    spline->ind[n++] = a;
+                }
+            }
+        }
+        if (color == 0)
+        {
+            spline->nFirstColor = n;
+        }
+    }
+
+    spline->n = n;
+}
+
 // At run time, the values of order used and asserted upon mean that
 // indexing out of bounds does not occur. However compilers don't
 // always understand that, so we suppress this warning for this code
@@ -322,27 +361,42 @@ static void make_bsplines(splinevec  theta,
     }
 
 
+/* Clears the grid lines x0 to x1 of pmegrid */
+static void clear_pmegrid_lines(const pmegrid_t* pmegrid, int x0, int x1)
+{
+    const int lineSize = pmegrid->s[YY] * pmegrid->s[ZZ];
+    real*     grid     = pmegrid->grid;
+    for (int i = x0 * lineSize; i < x1 * lineSize; i++)
+    {
+        grid[i] = 0;
+    }
+}
+
+/* Spreads the coefficients of the atoms with indices atomStart to atomEnd
+ * in spline on pmegrid, the grid should be cleared beforehand.
+ */
 static void spread_coefficients_bsplines_thread(const pmegrid_t*       pmegrid,
                                                 const PmeAtomComm*     atc,
-                                                splinedata_t*          spline,
+                                                const splinedata_t*    spline,
+                                                int                    atomStart,
+                                                int                    atomEnd,
                                                 struct pme_spline_work gmx_unused* work)
 {
 
     /* spread coefficients from home atoms to local grid */
     real*      grid;
-    int        i, nn, n, ithx, ithy, ithz, i0, j0, k0;
+    int        nn, n, ithx, ithy, ithz, i0, j0, k0;
     const int* idxptr;
     int        order, norder, index_x, index_xy, index_xyz;
     real       valx, valxy, coefficient;
     real *     thx, *thy, *thz;
-    int        pnx, pny, pnz, ndatatot;
+    int        pny, pnz;
     int        offx, offy, offz;
 
 #if defined PME_SIMD4_SPREAD_GATHER && !defined PME_SIMD4_UNALIGNED
     alignas(GMX_SIMD_ALIGNMENT) real thz_aligned[GMX_SIMD4_WIDTH * 2];
 #endif
 
-    pnx = pmegrid->s[XX];
     pny = pmegrid->s[YY];
     pnz = pmegrid->s[ZZ];
 
@@ -350,16 +404,11 @@ static void spread_coefficients_bsplines_thread(const pmegrid_t*       pmegrid,
     offy = pmegrid->offset[YY];
     offz = pmegrid->offset[ZZ];
 
-    ndatatot = pnx * pny * pnz;
-    grid     = pmegrid->grid;
-    for (i = 0; i < ndatatot; i++)
-    {
-        grid[i] = 0;
-    }
+    grid = pmegrid->grid;
 
     order = pmegrid->order;
 
-    for (nn = 0; nn < spline->n; nn++)
+    for (nn = atomStart; nn < atomEnd; nn++)
     {
         n           = spline->ind[nn];
         coefficient = atc->coefficient[n];
@@ -454,6 +503,46 @@ static void copy_local_grid(const gmx_pme_t* pme, const pmegrids_t* pmegrids, in
     }
 }
 
+/* Returns the first grid line of the slab of \p thread with colored spreading */
+static int colored_spread_slab_start(const pmegrids_t* grids, int thread)
+{
+    const int numLines = grids->grid.n[XX] - (grids->grid.order - 1);
+
+    /* This should match the grid to thread index set up in pmegrids_init */
+    return (numLines * thread) / grids->nthread;
+}
+
+/* Copies the part of the wrapped full grid for \p thread to the FFT grid */
+static void copy_pmegrid_to_fftgrid_thread(const gmx_pme_t* pme,
+                                           const real*      pmegrid,
+                                           real*            fftgrid,
+                                           int              grid_index,
+                                           int              nthread,
+                                           int              thread)
+{
+    ivec local_fft_ndata, local_fft_offset, local_fft_size;
+
+    gmx_parallel_3dfft_real_limits(
+            pme->pfft_setup[grid_index], local_fft_ndata, local_fft_offset, local_fft_size);
+
+    /* The fftgrid is always 'justified' to the lower-left corner of the PME grid */
+    const int ixy0 = (thread * local_fft_ndata[XX] * local_fft_ndata[YY]) / nthread;
+    const int ixy1 = ((thread + 1) * local_fft_ndata[XX] * local_fft_ndata[YY]) / nthread;
+
+    for (int ixy = ixy0; ixy < ixy1; ixy++)
+    {
+        const int ix = ixy / local_fft_ndata[YY];
+        const int iy = ixy - ix * local_fft_ndata[YY];
+
+        const int pmeidx = (ix * pme->pmegrid_ny + iy) * pme->pmegrid_nz;
+        const int fftidx = (ix * local_fft_size[YY] + iy) * local_fft_size[ZZ];
+        for (int iz = 0; iz < local_fft_ndata[ZZ]; iz++)
+        {
+            fftgrid[fftidx + iz] = pmegrid[pmeidx + iz];
+        }
+    }
+}
+
 static void reduce_threadgrid_overlap(const gmx_pme_t*  pme,
                                       const pmegrids_t* pmegrids,
                                       int               thread,
@@ -958,7 +1047,15 @@ void spread_on_grid(const gmx_pme_t*  pme,
                 if (grids->nthread == 1)
                 {
                     /* One thread, we operate on all coefficients */
-                    spline->n = atc->numAtoms();
+                    spline->n           = atc->numAtoms();
+                    spline->nFirstColor = spline->n;
+                }
+                else if (pme->useColoredSpread)
+                {
+                    /* Get our indices, ordered on the half of our slab */
+                    const int xStart = colored_spread_slab_start(grids, thread);
+                    const int xEnd   = colored_spread_slab_start(grids, thread + 1);
+                    make_thread_local_ind_colored(atc, thread, (xStart + xEnd) / 2, spline);
                 }
                 else
                 {
@@ -979,7 +1076,20 @@ void spread_on_grid(const gmx_pme_t*  pme,
                               bDoSplines);
             }
 
-            if (bSpread)
+            if (bSpread && pme->useColoredSpread)
+            {
+                /* Clear our slab of the full grid, the last thread also the overlap.
+                 * Our first half is spread within our own slab.
+                 */
+                const int xStart = colored_spread_slab_start(grids, thread);
+                const int xEnd   = (thread + 1 < grids->nthread)
+                                         ? colored_spread_slab_start(grids, thread + 1)
+                                         : grids->grid.s[XX];
+                clear_pmegrid_lines(&grids->grid, xStart, xEnd);
+                spread_coefficients_bsplines_thread(
+                        &grids->grid, atc, spline, 0, spline->nFirstColor, pme->spline_work);
+            }
+            else if (bSpread)
             {
                 /* put local atoms on grid. */
                 const pmegrid_t* grid = pme->bUseThreads ? &grids->grid_th[thread] : &grids->grid;
@@ -987,7 +1097,9 @@ void spread_on_grid(const gmx_pme_t*  pme,
 #ifdef PME_TIME_SPREAD
                 ct1a = omp_cyc_start();
 #endif
-                spread_coefficients_bsplines_thread(grid, atc, spline, pme->spline_work);
+                clear_pmegrid_lines(grid, 0, grid->s[XX]);
+                spread_coefficients_bsplines_thread(
+                        grid, atc, spline, 0, spline->n, pme->spline_work);
 
                 if (pme->bUseThreads)
                 {
@@ -1006,7 +1118,45 @@ void spread_on_grid(const gmx_pme_t*  pme,
     cs2 += (double)c2;
 #endif
 
-    if (bSpread && pme->bUseThreads)
+    if (bSpread && pme->useColoredSpread)
+    {
+        /* The second halves of the slabs extend into the first halves of
+         * the next slabs, which have been spread in the first pass.
+         */
+#pragma omp parallel for num_threads(grids->nthread) schedule(static)
+        for (int thread = 0; thread < grids->nthread; thread++)
+        {
+            try
+            {
+                const splinedata_t* spline = &atc->spline[thread];
+
+                spread_coefficients_bsplines_thread(&grids->grid,
+                                                    atc,
+                                                    spline,
+                                                    spline->nFirstColor,
+                                                    spline->n,
+                                                    pme->spline_work);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        /* The full grid is now complete, process it as without threads */
+        wrap_periodic_pmegrid(pme, grids->grid.grid);
+
+        if (pme->nnodes > 1)
+        {
+            gmx_sum_qgrid_dd(const_cast<gmx_pme_t*>(pme), grids->grid.grid, GMX_SUM_GRID_FORWARD);
+        }
+
+#pragma omp parallel for num_threads(grids->nthread) schedule(static)
+        for (int thread = 0; thread < grids->nthread; thread++)
+        {
+            // Trivial OpenMP region that does not throw, no need for try/catch
+            copy_pmegrid_to_fftgrid_thread(
+                    pme, grids->grid.grid, fftgrid, grid_index, grids->nthread, thread);
+        }
+    }
+    else if (bSpread && pme->bUseThreads)
     {
 #ifdef PME_TIME_THREADS
         c3 = omp_cyc_start();
@@ -42,14 +42,23 @@
 
 #include "gmxpre.h"
 
+#include <cmath>
+
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/ewald/pme_simd.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/refdata.h"
+#include "testutils/setenv.h"
 #include "testutils/test_hardware_environment.h"
 #include "testutils/testasserts.h"
 
@@ -396,6 +405,163 @@ INSTANTIATE_TEST_CASE_P(SaneInput13,
                                            c_inputGridSizes,
                                            ::testing::Values(c_sampleCoordinates13),
                                            ::testing::Values(c_sampleCharges13)));
+
+//! The number of PME threads used for the colored spreading tests
+constexpr int c_numColoredSpreadThreads = 4;
+
+//! Sets up \p inputRec for the colored spreading tests with grid size \p nkx x 12 x 14
+void setColoredSpreadInputRecord(t_inputrec* inputRec, int nkx)
+{
+    inputRec->nkx         = nkx;
+    inputRec->nky         = 12;
+    inputRec->nkz         = 14;
+    inputRec->pme_order   = 4;
+    inputRec->coulombtype = eelPME;
+    inputRec->epsilon_r   = 1.0;
+}
+
+//! Returns \p numAtoms coordinates spread over \p box, some outside the unit cell
+CoordinatesVector makeColoredSpreadCoordinates(int numAtoms, const Matrix3x3& box)
+{
+    CoordinatesVector coordinates(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            const real fraction = std::fmod(0.37 * i + 0.61 * i * d + 0.1 * d, 1.1) - 0.05;
+            coordinates[i][d]   = fraction * box[d * DIM + d];
+        }
+    }
+    return coordinates;
+}
+
+/*! \brief Spreads the charges with \p pme and returns the wrapped grid
+ *
+ * With multiple threads the grid is reduced over the threads directly into
+ * the FFT grid, which is what is returned.
+ */
+SparseRealGridValuesOutput spreadColoredSpreadTestCharges(gmx_pme_t*               pme,
+                                                          const CoordinatesVector& coordinates,
+                                                          const std::vector<real>& charges)
+{
+    pmeInitAtoms(pme, nullptr, CodePath::CPU, coordinates, charges);
+    pmePerformSplineAndSpread(pme, CodePath::CPU, true, true);
+    pmeFinalizeTest(pme, CodePath::CPU);
+    return pmeGetRealGrid(pme, CodePath::CPU);
+}
+
+//! Checks that \p grid matches \p referenceGrid up to rounding
+void checkSpreadGridsMatch(const SparseRealGridValuesOutput& referenceGrid,
+                           const SparseRealGridValuesOutput& grid)
+{
+    // All charges are positive, so there are no zero values due to cancellation
+    ASSERT_FALSE(referenceGrid.empty());
+    EXPECT_EQ(referenceGrid.size(), grid.size());
+    const auto tolerance = relativeToleranceAsFloatingPoint(10.0, 1e-5);
+    for (const auto& point : referenceGrid)
+    {
+        const auto found = grid.find(point.first);
+        ASSERT_NE(found, grid.end()) << "for grid point " << point.first;
+        EXPECT_REAL_EQ_TOL(point.second, found->second, tolerance)
+                << "for grid point " << point.first;
+    }
+}
+
+//! The box for the colored spreading tests
+const Matrix3x3 c_coloredSpreadBox = { { 8.0F, 0.0F, 0.0F, 0.0F, 3.4F, 0.0F, 0.0F, 0.0F, 2.0F } };
+
+//! Initializes PME on the CPU with multiple threads for the colored spreading tests
+PmeSafePointer initColoredSpreadTestPme(const t_inputrec& inputRec)
+{
+    return pmeInitWrapper(&inputRec,
+                          CodePath::CPU,
+                          nullptr,
+                          nullptr,
+                          nullptr,
+                          c_coloredSpreadBox,
+                          1.0F,
+                          1.0F,
+                          c_numColoredSpreadThreads);
+}
+
+/*! \brief Tests colored spreading with threads on the full grid against thread-local grids
+ *
+ * With 4 threads and order 4, colored spreading is used from 24 grid lines
+ * along x on. With 23 lines both runs use thread-local grids.
+ */
+TEST(PmeColoredSpreadTest, MatchesThreadLocalSpread)
+{
+    const CoordinatesVector coordinates = makeColoredSpreadCoordinates(200, c_coloredSpreadBox);
+    std::vector<real>       charges(coordinates.size());
+    for (size_t i = 0; i < charges.size(); i++)
+    {
+        charges[i] = 0.5 + (i % 7) * 0.25;
+    }
+
+    for (const int nkx : { 23, 24, 40 })
+    {
+        SCOPED_TRACE(formatString("with %d grid lines along x", nkx));
+
+        t_inputrec inputRec;
+        setColoredSpreadInputRecord(&inputRec, nkx);
+
+        PmeSafePointer threadLocalPme = initColoredSpreadTestPme(inputRec);
+        ASSERT_FALSE(threadLocalPme->useColoredSpread);
+        const SparseRealGridValuesOutput referenceGrid =
+                spreadColoredSpreadTestCharges(threadLocalPme.get(), coordinates, charges);
+
+        gmxSetenv("GMX_PME_COLORED_SPREAD", "1", true);
+        PmeSafePointer coloredPme = initColoredSpreadTestPme(inputRec);
+        gmxUnsetenv("GMX_PME_COLORED_SPREAD");
+        EXPECT_EQ(nkx >= 24, coloredPme->useColoredSpread);
+
+        const SparseRealGridValuesOutput grid =
+                spreadColoredSpreadTestCharges(coloredPme.get(), coordinates, charges);
+        checkSpreadGridsMatch(referenceGrid, grid);
+    }
+}
+
+/*! \brief Tests reinitializing PME from colored spreading to thread-local grids
+ *
+ * This happens with PME tuning, when the grid becomes too small for
+ * colored spreading. The new setup reuses the grid memory of the old one.
+ */
+TEST(PmeColoredSpreadTest, ReinitToThreadLocalSpreadWorks)
+{
+    const CoordinatesVector coordinates = makeColoredSpreadCoordinates(200, c_coloredSpreadBox);
+    const std::vector<real> charges(coordinates.size(), 1.0);
+
+    t_inputrec inputRec;
+    setColoredSpreadInputRecord(&inputRec, 32);
+
+    gmxSetenv("GMX_PME_COLORED_SPREAD", "1", true);
+    PmeSafePointer coloredPme = initColoredSpreadTestPme(inputRec);
+    ASSERT_TRUE(coloredPme->useColoredSpread);
+    spreadColoredSpreadTestCharges(coloredPme.get(), coordinates, charges);
+
+    const ivec smallGridSize = { 20, inputRec.nky, inputRec.nkz };
+    t_commrec  dummyCommrec  = { 0 };
+    gmx_pme_t* newPmeRaw     = nullptr;
+    gmx_pme_reinit(&newPmeRaw, &dummyCommrec, coloredPme.get(), &inputRec, smallGridSize, 1.0, 1.0);
+    gmxUnsetenv("GMX_PME_COLORED_SPREAD");
+    PmeSafePointer newPme(newPmeRaw);
+    ASSERT_FALSE(newPme->useColoredSpread);
+    copy_mat(coloredPme->recipbox, newPme->recipbox);
+    const SparseRealGridValuesOutput grid =
+            spreadColoredSpreadTestCharges(newPme.get(), coordinates, charges);
+
+    t_inputrec smallInputRec;
+    setColoredSpreadInputRecord(&smallInputRec, smallGridSize[XX]);
+    PmeSafePointer threadLocalPme = initColoredSpreadTestPme(smallInputRec);
+    const SparseRealGridValuesOutput referenceGrid =
+            spreadColoredSpreadTestCharges(threadLocalPme.get(), coordinates, charges);
+    checkSpreadGridsMatch(referenceGrid, grid);
+
+    // The new setup shares the full grid with the old one, give it its own again
+    // so both can be destroyed
+    snew_aligned(newPme->pmegrid[PME_GRID_QA].grid.grid, 1, SIMD4_ALIGNMENT);
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -114,7 +114,8 @@ PmeSafePointer pmeInitWrapper(const t_inputrec*    inputRec,
                               const PmeGpuProgram* pmeGpuProgram,
                               const Matrix3x3&     box,
                               const real           ewaldCoeff_q,
-                              const real           ewaldCoeff_lj)
+                              const real           ewaldCoeff_lj,
+                              const int            numThreads)
 {
     const MDLogger dummyLogger;
     const auto     runMode       = (mode == CodePath::CPU) ? PmeRunMode::CPU : PmeRunMode::Mixed;
@@ -128,7 +129,7 @@ PmeSafePointer pmeInitWrapper(const t_inputrec*    inputRec,
                                          true,
                                          ewaldCoeff_q,
                                          ewaldCoeff_lj,
-                                         1,
+                                         numThreads,
                                          runMode,
                                          nullptr,
                                          deviceContext,
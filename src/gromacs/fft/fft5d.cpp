@@ -434,6 +434,21 @@ fft5d_plan fft5d_plan_3d(int                NG,
     /* int lsize = fmax(N[0]*M[0]*K[0]*nP[0],N[1]*M[1]*K[1]*nP[1]); */
     lsize = std::max(N[0] * M[0] * K[0] * nP[0], std::max(N[1] * M[1] * K[1] * nP[1], C[2] * M[2] * K[2]));
     /* int lsize = fmax(C[0]*M[0]*K[0],fmax(C[1]*M[1]*K[1],C[2]*M[2]*K[2])); */
+
+    /* The transposes can be done in chunks, so the communication of a chunk
+     * overlaps with the local reordering of the other chunks.
+     * This needs transpose buffers separate from the input and output.
+     */
+    int numTransposeChunks = 1;
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+    const char* numTransposeChunksEnv = getenv("GMX_FFT5D_TRANSPOSE_CHUNKS");
+    if (numTransposeChunksEnv != nullptr && (P[0] > 1 || P[1] > 1))
+    {
+        numTransposeChunks =
+                std::max(1, static_cast<int>(strtol(numTransposeChunksEnv, nullptr, 10)));
+    }
+#endif
+
     if (!(flags & FFT5D_NOMALLOC))
     {
         // only needed for PME GPU mixed mode
@@ -448,7 +463,7 @@ fft5d_plan fft5d_plan_3d(int                NG,
             snew_aligned(lin, lsize, 32);
         }
         snew_aligned(lout, lsize, 32);
-        if (nthreads > 1)
+        if (nthreads > 1 || numTransposeChunks > 1)
         {
             /* We need extra transpose buffers to avoid OpenMP barriers */
             snew_aligned(lout2, lsize, 32);
@@ -465,7 +480,7 @@ fft5d_plan fft5d_plan_3d(int                NG,
     {
         lin  = *rlin;
         lout = *rlout;
-        if (nthreads > 1)
+        if ((nthreads > 1 || numTransposeChunks > 1) && *rlout2 != nullptr)
         {
             lout2 = *rlout2;
             lout3 = *rlout3;
@@ -474,6 +489,8 @@ fft5d_plan fft5d_plan_3d(int                NG,
         {
             lout2 = lin;
             lout3 = lout;
+            /* Pipelining needs separate transpose buffers */
+            numTransposeChunks = 1;
         }
     }
 
@@ -739,13 +756,14 @@ fft5d_plan fft5d_plan_3d(int                NG,
         plan->direction=direction;
         plan->realcomplex=realcomplex;
      */
-    plan->flags         = flags;
-    plan->nthreads      = nthreads;
-    plan->pinningPolicy = realGridAllocationPinningPolicy;
-    *rlin               = lin;
-    *rlout              = lout;
-    *rlout2             = lout2;
-    *rlout3             = lout3;
+    plan->flags              = flags;
+    plan->nthreads           = nthreads;
+    plan->numTransposeChunks = numTransposeChunks;
+    plan->pinningPolicy      = realGridAllocationPinningPolicy;
+    *rlin                    = lin;
+    *rlout                   = lout;
+    *rlout2                  = lout2;
+    *rlout3                  = lout3;
     return plan;
 }
 
@@ -765,7 +783,8 @@ enum order
    x (and N) is mayor (consecutive) dimension, y (M) middle and z (K) major
    maxN,maxM,maxK is max size of local data
    pN, pM, pK is local size specific to current processor (only different to max if not divisible)
-   NG, MG, KG is size of global data*/
+   NG, MG, KG is size of global data
+   zStart is the first z of the chunk of maxK planes in lout (0 without chunking)*/
 static void splitaxes(t_complex*       lout,
                       const t_complex* lin,
                       int              maxN,
@@ -779,7 +798,8 @@ static void splitaxes(t_complex*       lout,
                       int              starty,
                       int              startz,
                       int              endy,
-                      int              endz)
+                      int              endz,
+                      int              zStart)
 {
     int x, y, z, i;
     int in_i, out_i, in_z, out_z, in_y, out_y;
@@ -803,7 +823,7 @@ static void splitaxes(t_complex*       lout,
         {
             e_y = pM;
         }
-        out_z = z * maxN * maxM;
+        out_z = (z - zStart) * maxN * maxM;
         in_z  = z * NG * pM;
 
         for (i = 0; i < P; i++) /*index cube along long axis*/
@@ -830,7 +850,8 @@ static void splitaxes(t_complex*       lout,
    variables see above
    the major, middle, minor order is only correct for x,y,z (N,M,K) for the input
    N,M,K local dimensions
-   KG global size*/
+   KG global size
+   only z in [zStart,zStart+maxK) is joined, lin holds this chunk*/
 static void joinAxesTrans13(t_complex*       lout,
                             const t_complex* lin,
                             int              maxN,
@@ -844,7 +865,8 @@ static void joinAxesTrans13(t_complex*       lout,
                             int              starty,
                             int              startx,
                             int              endy,
-                            int              endx)
+                            int              endx,
+                            int              zStart)
 {
     int i, x, y, z;
     int out_i, in_i, out_x, in_x, out_z, in_z;
@@ -876,10 +898,10 @@ static void joinAxesTrans13(t_complex*       lout,
         {
             out_i = out_x + oK[i];
             in_i  = in_x + i * maxM * maxN * maxK;
-            for (z = 0; z < K[i]; z++) /*3.l*/
+            for (z = zStart; z < std::min(K[i], zStart + maxK); z++) /*3.l*/
             {
                 out_z = out_i + z;
-                in_z  = in_i + z * maxM * maxN;
+                in_z  = in_i + (z - zStart) * maxM * maxN;
                 for (y = s_y; y < e_y; y++) /*2.k*/
                 {
                     lout[out_z + y * KG] = lin[in_z + y * maxN]; /*out=x*KG*pM+oK[i]+z+y*KG*/
@@ -894,7 +916,8 @@ static void joinAxesTrans13(t_complex*       lout,
    variables see above
    the minor, middle, major order is only correct for x,y,z (N,M,K) for the input
    N,M,K local size
-   MG, global size*/
+   MG, global size
+   lin holds the chunk of maxK planes starting at zStart*/
 static void joinAxesTrans12(t_complex*       lout,
                             const t_complex* lin,
                             int              maxN,
@@ -908,7 +931,8 @@ static void joinAxesTrans12(t_complex*       lout,
                             int              startx,
                             int              startz,
                             int              endx,
-                            int              endz)
+                            int              endz,
+                            int              zStart)
 {
     int i, z, y, x;
     int out_i, in_i, out_z, in_z, out_x, in_x;
@@ -933,7 +957,7 @@ static void joinAxesTrans12(t_complex*       lout,
             e_x = pN;
         }
         out_z = z * MG * pN;
-        in_z  = z * maxM * maxN;
+        in_z  = (z - zStart) * maxM * maxN;
 
         for (i = 0; i < P; i++) /*index cube along long axis*/
         {
@@ -1112,6 +1136,167 @@ static void print_localdata(const t_complex* lin, const char* txt, int s, fft5d_
     }
 }
 
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE && !defined NOGMX
+/*split, transpose and join for step s in chunks of planes along the major (z) axis
+   the all-to-all of chunk c is started non-blocking (with an MPI library) and
+   overlaps with the split of chunk c+1 and the join of chunk c-1
+   must be called by all threads, lout2 and lout3 should not alias lin and lout*/
+static void splitTransposeJoinPipelined(fft5d_plan plan, int s, int thread, fft5d_time times)
+{
+    t_complex* lin   = plan->lin;
+    t_complex* lout  = plan->lout;
+    t_complex* lout2 = plan->lout2;
+    t_complex* lout3 = plan->lout3;
+    int *N = plan->N, *M = plan->M, *K = plan->K, *pN = plan->pN, *pM = plan->pM, *pK = plan->pK,
+        *C = plan->C, *P = plan->P, **iNin = plan->iNin, **oNin = plan->oNin,
+        **iNout = plan->iNout, **oNout = plan->oNout;
+    int nthreads = plan->nthreads;
+
+    const bool bTrans13 = (s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
+                          || (s == 1 && (plan->flags & FFT5D_ORDER_YZ));
+    /* The number of planes and the plane size sent to each rank, as in the
+     * non-pipelined transpose
+     */
+    const int numPlanes  = bTrans13 ? K[s] : pK[s];
+    const int planeSize  = N[s] * (bTrans13 ? pM[s] : M[s]);
+    const int numChunks  = std::max(std::min(plan->numTransposeChunks, numPlanes), 1);
+    const int chunkDepth = (numPlanes + numChunks - 1) / numChunks;
+
+#    if GMX_LIB_MPI
+    MPI_Request request[2];
+#    endif
+
+    /* the chunks contain data from the FFTs of all threads */
+#    pragma omp barrier
+
+    for (int c = 0; c <= numChunks; c++)
+    {
+        if (c < numChunks)
+        {
+            const int zStart = std::min(c * chunkDepth, numPlanes);
+            const int zEnd   = std::min(zStart + chunkDepth, numPlanes);
+            const int offset = zStart * planeSize * P[s];
+
+            /* only the pK local planes contain data */
+            if (pM[s] > 0)
+            {
+                int numLocal = std::max(std::min(zEnd, pK[s]) - zStart, 0);
+                int tstart   = zStart * pM[s] + thread * numLocal * pM[s] / nthreads;
+                int tend     = zStart * pM[s] + (thread + 1) * numLocal * pM[s] / nthreads;
+                splitaxes(lout2 + offset,
+                          lout,
+                          N[s],
+                          M[s],
+                          zEnd - zStart,
+                          pM[s],
+                          P[s],
+                          C[s],
+                          iNout[s],
+                          oNout[s],
+                          tstart % pM[s],
+                          tstart / pM[s],
+                          tend % pM[s],
+                          tend / pM[s],
+                          zStart);
+            }
+#    pragma omp barrier /*the chunk has to be complete before sending*/
+
+            if (thread == 0)
+            {
+                int count = (zEnd - zStart) * planeSize * sizeof(t_complex) / sizeof(real);
+
+                wallcycle_start(times, ewcPME_FFTCOMM);
+#    if GMX_LIB_MPI
+                MPI_Ialltoall(reinterpret_cast<real*>(lout2 + offset),
+                              count,
+                              GMX_MPI_REAL,
+                              reinterpret_cast<real*>(lout3 + offset),
+                              count,
+                              GMX_MPI_REAL,
+                              plan->cart[s],
+                              &request[c % 2]);
+#    else
+                /* thread-MPI has no non-blocking collectives */
+                MPI_Alltoall(reinterpret_cast<real*>(lout2 + offset),
+                             count,
+                             GMX_MPI_REAL,
+                             reinterpret_cast<real*>(lout3 + offset),
+                             count,
+                             GMX_MPI_REAL,
+                             plan->cart[s]);
+#    endif
+                wallcycle_stop(times, ewcPME_FFTCOMM);
+            }
+        }
+
+        if (c > 0)
+        {
+            const int zStart = std::min((c - 1) * chunkDepth, numPlanes);
+            const int zEnd   = std::min(zStart + chunkDepth, numPlanes);
+            const int offset = zStart * planeSize * P[s];
+
+#    if GMX_LIB_MPI
+            if (thread == 0)
+            {
+                wallcycle_start(times, ewcPME_FFTCOMM);
+                MPI_Wait(&request[(c - 1) % 2], MPI_STATUS_IGNORE);
+                wallcycle_stop(times, ewcPME_FFTCOMM);
+            }
+#    endif
+#    pragma omp barrier /*wait for the data of the previous chunk*/
+
+            if (bTrans13)
+            {
+                if (pM[s] > 0)
+                {
+                    int tstart = (thread * pM[s] * pN[s] / nthreads);
+                    int tend   = ((thread + 1) * pM[s] * pN[s] / nthreads);
+                    joinAxesTrans13(lin,
+                                    lout3 + offset,
+                                    N[s],
+                                    pM[s],
+                                    zEnd - zStart,
+                                    pM[s],
+                                    P[s],
+                                    C[s + 1],
+                                    iNin[s + 1],
+                                    oNin[s + 1],
+                                    tstart % pM[s],
+                                    tstart / pM[s],
+                                    tend % pM[s],
+                                    tend / pM[s],
+                                    zStart);
+                }
+            }
+            else
+            {
+                if (pN[s] > 0)
+                {
+                    int numLocal = zEnd - zStart;
+                    int tstart   = zStart * pN[s] + thread * numLocal * pN[s] / nthreads;
+                    int tend     = zStart * pN[s] + (thread + 1) * numLocal * pN[s] / nthreads;
+                    joinAxesTrans12(lin,
+                                    lout3 + offset,
+                                    N[s],
+                                    M[s],
+                                    zEnd - zStart,
+                                    pN[s],
+                                    P[s],
+                                    C[s + 1],
+                                    iNin[s + 1],
+                                    oNin[s + 1],
+                                    tstart % pN[s],
+                                    tstart / pN[s],
+                                    tend % pN[s],
+                                    tend / pN[s],
+                                    zStart);
+                }
+            }
+        }
+    }
+}
+#endif
+
 void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 {
     t_complex* lin   = plan->lin;
@@ -1133,7 +1318,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
     int *N = plan->N, *M = plan->M, *K = plan->K, *pN = plan->pN, *pM = plan->pM, *pK = plan->pK,
         *C = plan->C, *P = plan->P, **iNin = plan->iNin, **oNin = plan->oNin, **iNout = plan->iNout,
         **oNout = plan->oNout;
-    int s       = 0, tstart, tend, bParallelDim;
+    int s       = 0, tstart, tend, bParallelDim, bPipelined;
 
 
 #if GMX_FFT_FFTW3
@@ -1180,6 +1365,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         {
             bParallelDim = 0;
         }
+        /* with pipelining split, transpose and join are done together per chunk */
+        bPipelined = (bParallelDim && plan->numTransposeChunks > 1);
 
         /* ---------- START FFT ------------ */
 #ifdef NOGMX
@@ -1235,7 +1422,13 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         /* ---------- END FFT ------------ */
 
         /* ---------- START SPLIT + TRANSPOSE------------ (if parallel in in this dimension)*/
-        if (bParallelDim)
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE && !defined NOGMX
+        if (bPipelined)
+        {
+            splitTransposeJoinPipelined(plan, s, thread, times);
+        }
+#endif
+        if (bParallelDim && !bPipelined)
         {
 #ifdef NOGMX
             if (times != NULL && thread == 0)
@@ -1264,7 +1457,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                           tstart % pM[s],
                           tstart / pM[s],
                           tend % pM[s],
-                          tend / pM[s]);
+                          tend / pM[s],
+                          0);
             }
 #pragma omp barrier /*barrier required before AllToAll (all input has to be their) - before timing to make timing more acurate*/
 #ifdef NOGMX
@@ -1350,7 +1544,12 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
            also local transpose 1 and 2/3
            runs on thread used for following FFT (thus needing a barrier before but not afterwards)
          */
-        if ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ)) || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
+        if (bPipelined)
+        {
+            /* already joined per chunk */
+        }
+        else if ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
+                 || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
         {
             if (pM[s] > 0)
             {
@@ -1369,7 +1568,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                                 tstart % pM[s],
                                 tstart / pM[s],
                                 tend % pM[s],
-                                tend / pM[s]);
+                                tend / pM[s],
+                                0);
             }
         }
         else
@@ -1391,7 +1591,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                                 tstart % pN[s],
                                 tstart / pN[s],
                                 tend % pN[s],
-                                tend / pN[s]);
+                                tend / pN[s],
+                                0);
             }
         }
 
@@ -1515,7 +1716,7 @@ void fft5d_destroy(fft5d_plan plan)
         }
         sfree_aligned(plan->lin);
         sfree_aligned(plan->lout);
-        if (plan->nthreads > 1)
+        if (plan->lout2 != plan->lin)
         {
             sfree_aligned(plan->lout2);
             sfree_aligned(plan->lout3);
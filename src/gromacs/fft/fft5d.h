@@ -122,6 +122,7 @@ struct fft5d_plan_t
     /*int P[2];*/
     int                coor[2];
     int                nthreads;
+    int                numTransposeChunks; /*number of chunks the transposes are pipelined in*/
     gmx::PinningPolicy pinningPolicy;
 };
 
@@ -0,0 +1,214 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the parallel 3D FFT over multiple ranks
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fft/parallel_3dfft.h"
+#include "gromacs/utility/gmxmpi.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The grid size, chosen such that the transposes cannot be split evenly
+const int c_gridSize[DIM] = { 14, 10, 9 };
+
+//! Returns the input value for the grid point with global indices \p x, \p y, \p z
+real gridValue(int x, int y, int z)
+{
+    return std::sin(0.7 * x + 1.3 * y + 0.3 * z);
+}
+
+/*! \brief Runs a forward and a backward parallel 3D FFT over the ranks in \p comm
+ *
+ * \param[in] comm       The communicators for the two decomposition dimensions
+ * \param[in] numChunks  The value for GMX_FFT5D_TRANSPOSE_CHUNKS, nullptr leaves it unset
+ * \returns The local part of the complex grid after the forward transform,
+ *          followed by the local part of the real grid after the backward transform
+ */
+std::vector<real> runParallelFft(MPI_Comm comm[2], const char* numChunks)
+{
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // With thread-MPI all ranks share the environment
+    if (rank == 0)
+    {
+        if (numChunks)
+        {
+            gmxSetenv("GMX_FFT5D_TRANSPOSE_CHUNKS", numChunks, true);
+        }
+        else
+        {
+            gmxUnsetenv("GMX_FFT5D_TRANSPOSE_CHUNKS");
+        }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    int                  ndata[DIM] = { c_gridSize[XX], c_gridSize[YY], c_gridSize[ZZ] };
+    gmx_parallel_3dfft_t fft;
+    real*                rdata;
+    t_complex*           cdata;
+    gmx_parallel_3dfft_init(&fft, ndata, &rdata, &cdata, comm, TRUE, 1);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    ivec realNData, realOffset, realSize;
+    gmx_parallel_3dfft_real_limits(fft, realNData, realOffset, realSize);
+    for (int x = 0; x < realNData[XX]; x++)
+    {
+        for (int y = 0; y < realNData[YY]; y++)
+        {
+            for (int z = 0; z < realNData[ZZ]; z++)
+            {
+                rdata[(x * realSize[YY] + y) * realSize[ZZ] + z] =
+                        gridValue(realOffset[XX] + x, realOffset[YY] + y, realOffset[ZZ] + z);
+            }
+        }
+    }
+
+    gmx_parallel_3dfft_execute(fft, GMX_FFT_REAL_TO_COMPLEX, 0, nullptr);
+
+    ivec complexOrder, complexNData, complexOffset, complexSize;
+    gmx_parallel_3dfft_complex_limits(fft, complexOrder, complexNData, complexOffset, complexSize);
+    std::vector<real> result;
+    for (int i = 0; i < complexNData[XX]; i++)
+    {
+        for (int j = 0; j < complexNData[YY]; j++)
+        {
+            for (int k = 0; k < complexNData[ZZ]; k++)
+            {
+                const t_complex& value = cdata[(i * complexSize[YY] + j) * complexSize[ZZ] + k];
+                result.push_back(value.re);
+                result.push_back(value.im);
+            }
+        }
+    }
+
+    gmx_parallel_3dfft_execute(fft, GMX_FFT_COMPLEX_TO_REAL, 0, nullptr);
+
+    // The backward transform should give back the input, scaled by the number of grid points
+    const real scale     = 1.0 / (c_gridSize[XX] * c_gridSize[YY] * c_gridSize[ZZ]);
+    const auto tolerance = relativeToleranceAsFloatingPoint(1.0, 1e-4);
+    for (int x = 0; x < realNData[XX]; x++)
+    {
+        for (int y = 0; y < realNData[YY]; y++)
+        {
+            for (int z = 0; z < realNData[ZZ]; z++)
+            {
+                const real value = rdata[(x * realSize[YY] + y) * realSize[ZZ] + z];
+                EXPECT_REAL_EQ_TOL(
+                        gridValue(realOffset[XX] + x, realOffset[YY] + y, realOffset[ZZ] + z),
+                        value * scale,
+                        tolerance);
+                result.push_back(value);
+            }
+        }
+    }
+
+    gmx_parallel_3dfft_destroy(fft);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rank == 0)
+    {
+        gmxUnsetenv("GMX_FFT5D_TRANSPOSE_CHUNKS");
+    }
+
+    return result;
+}
+
+//! Checks that the transposes in chunks give the same grids as without chunks
+void testTransposeChunks(MPI_Comm comm[2])
+{
+    const std::vector<real> reference = runParallelFft(comm, nullptr);
+    for (const char* numChunks : { "2", "3" })
+    {
+        SCOPED_TRACE(formatString("with %s transpose chunks", numChunks));
+
+        const std::vector<real> result = runParallelFft(comm, numChunks);
+        ASSERT_EQ(reference.size(), result.size());
+        for (size_t i = 0; i < reference.size(); i++)
+        {
+            // Chunking only changes the order of the communication
+            EXPECT_REAL_EQ_TOL(reference[i], result[i], ulpTolerance(0)) << "for element " << i;
+        }
+    }
+}
+
+TEST(ParallelFFTTest, TransposeChunksDoNotChangeResultWith1DDecomposition)
+{
+    GMX_MPI_TEST(4);
+
+    MPI_Comm comm[2] = { MPI_COMM_WORLD, MPI_COMM_NULL };
+    testTransposeChunks(comm);
+}
+
+TEST(ParallelFFTTest, TransposeChunksDoNotChangeResultWith2DDecomposition)
+{
+    GMX_MPI_TEST(4);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm comm[2];
+    MPI_Comm_split(MPI_COMM_WORLD, rank / 2, rank, &comm[0]);
+    MPI_Comm_split(MPI_COMM_WORLD, rank % 2, rank, &comm[1]);
+
+    testTransposeChunks(comm);
+
+    MPI_Comm_free(&comm[0]);
+    MPI_Comm_free(&comm[1]);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -43,8 +43,10 @@
 
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
 #include <vector>
 
 #if HAVE_IO_H
@@ -53,11 +55,19 @@
 #ifdef HAVE_UNISTD_H
 #    include <unistd.h>
 #endif
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    define GMX_FIO_HAVE_MMAP 1
+#else
+#    define GMX_FIO_HAVE_MMAP 0
+#endif
 
 #include "thread_mpi/threads.h"
 
 #include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/md5.h"
+#include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/mutex.h"
@@ -116,6 +126,93 @@ void gmx_fio_unlock(t_fileio* fio)
     tMPI_Lock_unlock(&(fio->mtx));
 }
 
+/* The number of bytes ahead of the current read position of a memory
+   mapped file that we ask the OS to page in. */
+static const gmx_off_t c_mappedReadaheadSize = 16 * 1024 * 1024;
+
+/* Map a file that is opened for reading only into memory, so that large
+   arrays can be decoded directly from the page cache instead of being
+   copied through the stdio and XDR buffers. Leaves fio->mappedData NULL
+   when the file can not or should not be mapped. */
+static void gmx_fio_map_for_reading(t_fileio* fio)
+{
+    fio->mappedData      = nullptr;
+    fio->mappedSize      = 0;
+    fio->mappedReadahead = 0;
+#if GMX_FIO_HAVE_MMAP
+    if (getenv("GMX_NO_TRAJECTORY_MMAP") != nullptr)
+    {
+        return;
+    }
+    int         fd = fileno(fio->fp);
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size == 0)
+    {
+        return;
+    }
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        /* Not an error, we simply read through stdio instead */
+        return;
+    }
+    madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+    fio->mappedData = static_cast<const unsigned char*>(data);
+    fio->mappedSize = fileStat.st_size;
+#endif
+}
+
+static void gmx_fio_unmap(t_fileio* fio)
+{
+#if GMX_FIO_HAVE_MMAP
+    if (fio->mappedData != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(fio->mappedData), fio->mappedSize);
+    }
+#endif
+    fio->mappedData = nullptr;
+    fio->mappedSize = 0;
+}
+
+gmx_bool gmx_fio_mapped_range_valid(t_fileio* fio, gmx_off_t end)
+{
+#if GMX_FIO_HAVE_MMAP
+    if (fio->mappedData == nullptr || end > fio->mappedSize)
+    {
+        return FALSE;
+    }
+    /* Accessing pages of a shared map beyond the end of the file raises
+       SIGBUS, so check that the file has not been truncated since it was
+       mapped, as happens when mdrun appends to it after a restart. */
+    struct stat fileStat;
+    return (fstat(fileno(fio->fp), &fileStat) == 0 && end <= fileStat.st_size);
+#else
+    GMX_UNUSED_VALUE(fio);
+    GMX_UNUSED_VALUE(end);
+    return FALSE;
+#endif
+}
+
+void gmx_fio_mapped_readahead(t_fileio* fio, gmx_off_t end)
+{
+#if GMX_FIO_HAVE_MMAP
+    if (fio->mappedData == nullptr || end <= fio->mappedReadahead)
+    {
+        return;
+    }
+    /* Advise in large chunks, so we do not make a system call per frame */
+    const gmx_off_t pageSize = sysconf(_SC_PAGESIZE);
+    const gmx_off_t begin    = (fio->mappedReadahead / pageSize) * pageSize;
+    fio->mappedReadahead     = std::min(end + c_mappedReadaheadSize, fio->mappedSize);
+    madvise(const_cast<unsigned char*>(fio->mappedData) + begin,
+            fio->mappedReadahead - begin,
+            MADV_WILLNEED);
+#else
+    GMX_UNUSED_VALUE(fio);
+    GMX_UNUSED_VALUE(end);
+#endif
+}
+
 /* make a dummy head element, assuming we locked everything. */
 static void gmx_fio_make_dummy()
 {
@@ -326,6 +423,12 @@ t_fileio* gmx_fio_open(const char* fn, const char* mode)
             }
             snew(fio->xdr, 1);
             xdrstdio_create(fio->xdr, fio->fp, fio->xdrmode);
+            /* Trajectories are read sequentially and often repeatedly,
+               so for those we decode the bulk data from a memory map */
+            if (bRead && fio->iFTP == efTRR)
+            {
+                gmx_fio_map_for_reading(fio);
+            }
         }
 
         /* for appending seek to end of file to make sure ftell gives correct position
@@ -353,6 +456,8 @@ static int gmx_fio_close_locked(t_fileio* fio)
 {
     int rc = 0;
 
+    gmx_fio_unmap(fio);
+
     if (fio->xdr != nullptr)
     {
         xdr_destroy(fio->xdr);
@@ -731,6 +836,8 @@ int gmx_fio_seek(t_fileio* fio, gmx_off_t fpos)
     if (fio->fp)
     {
         rc = gmx_fseek(fio->fp, fpos, SEEK_SET);
+        /* Restart the readahead of a memory mapped file at the new position */
+        fio->mappedReadahead = fpos;
     }
     else
     {
@@ -57,6 +57,7 @@
 #include "thread_mpi/lock.h"
 
 #include "gromacs/fileio/xdrf.h"
+#include "gromacs/utility/futil.h"
 
 struct t_fileio
 {
@@ -69,6 +70,10 @@ struct t_fileio
     enum xdr_op xdrmode; /* the xdr mode */
     int         iFTP;    /* the file type identifier */
 
+    const unsigned char* mappedData;      /* read-only memory map of the file, or NULL */
+    gmx_off_t            mappedSize;      /* the number of bytes mapped */
+    gmx_off_t            mappedReadahead; /* the end of the region advised for readahead */
+
     t_fileio *next, *prev; /* next and previous file pointers in the
                               linked list */
     tMPI_Lock_t mtx;       /* content locking mutex. This is a fast lock
@@ -82,4 +87,11 @@ void gmx_fio_lock(t_fileio* fio);
 /** unlock the mutex associated with a fio  */
 void gmx_fio_unlock(t_fileio* fio);
 
+/** return whether the memory map of a fio covers the file up to \p end,
+ *  also when the file was truncated after it was mapped */
+gmx_bool gmx_fio_mapped_range_valid(t_fileio* fio, gmx_off_t end);
+
+/** advise the OS to page in the memory map of a fio up to at least \p end */
+void gmx_fio_mapped_readahead(t_fileio* fio, gmx_off_t end);
+
 #endif
@@ -40,6 +40,7 @@
 #include "gmxfio_xdr.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 
@@ -48,6 +49,7 @@
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/smalloc.h"
 
@@ -137,6 +139,81 @@ static void gmx_fio_check_nitem(int eio, std::size_t nitem, const char* file, in
               line);
 }
 
+/* Decodes an XDR (big-endian) float or double at \p data */
+template<typename T>
+static inline T decodeXdrValue(const unsigned char* data);
+
+template<>
+inline float decodeXdrValue<float>(const unsigned char* data)
+{
+    uint32_t bits = (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8)
+                    | uint32_t(data[3]);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<>
+inline double decodeXdrValue<double>(const unsigned char* data)
+{
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        bits = (bits << 8) | uint64_t(data[i]);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<typename T>
+static void decodeXdrRvecs(const unsigned char* data, rvec* item, std::size_t nitem)
+{
+    for (std::size_t j = 0; j < nitem; j++)
+    {
+        for (int m = 0; m < DIM; m++)
+        {
+            item[j][m] = decodeXdrValue<T>(data + (j * DIM + m) * sizeof(T));
+        }
+    }
+}
+
+/* Arrays smaller than this are read through stdio. Decoding them from the
+   map would need a seek, which discards the contents of the stdio buffer. */
+static const gmx_off_t c_minMappedReadSize = 64 * 1024;
+
+/* Reads nitem rvecs of a memory mapped file directly from the map into
+   \p item and moves the file position past them. Returns FALSE, without
+   side effects, when the array is small or when the data does not lie
+   completely within the map and the file, as is the case when the file
+   was extended or truncated after it was opened. */
+static gmx_bool do_xdr_mapped_nrvec(t_fileio* fio, rvec* item, std::size_t nitem)
+{
+    const gmx_off_t size = nitem * DIM * (fio->bDouble ? sizeof(double) : sizeof(float));
+    if (size < c_minMappedReadSize)
+    {
+        return FALSE;
+    }
+    const gmx_off_t position = gmx_ftell(fio->fp);
+    if (position < 0 || !gmx_fio_mapped_range_valid(fio, position + size))
+    {
+        return FALSE;
+    }
+    gmx_fio_mapped_readahead(fio, position + size);
+    if (item != nullptr)
+    {
+        if (fio->bDouble)
+        {
+            decodeXdrRvecs<double>(fio->mappedData + position, item, nitem);
+        }
+        else
+        {
+            decodeXdrRvecs<float>(fio->mappedData + position, item, nitem);
+        }
+    }
+    return gmx_fseek(fio->fp, position + size, SEEK_SET) == 0;
+}
+
 /* This is the part that reads xdr files.  */
 
 static gmx_bool
@@ -340,6 +417,12 @@ do_xdr(t_fileio* fio, void* item, std::size_t nitem, int eio, const char* desc,
             }
             break;
         case eioNRVEC:
+            if (fio->bRead && fio->mappedData != nullptr
+                && do_xdr_mapped_nrvec(fio, static_cast<rvec*>(item), nitem))
+            {
+                res = 1;
+                break;
+            }
             ptr = nullptr;
             res = 1;
             for (std::size_t j = 0; j < nitem && res; j++)
@@ -44,10 +44,16 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
+#include <vector>
 
 #include "gromacs/fileio/xdr_datatype.h"
 #include "gromacs/fileio/xdrf.h"
+#include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 
 /* This is just for clarity - it can never be anything but 4! */
 #define XDR_INT_SIZE 4
@@ -370,6 +376,226 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
     nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
 }
 
+/*____________________________________________________________________________
+ |
+ | numQuantizationThreads - number of OpenMP threads for (de)quantization
+ |
+ | The conversion between floats and integers is independent for each
+ | coordinate and is done in parallel for large frames. Small frames are
+ | not worth the threading overhead. The bit stream itself is sequential.
+ |
+ */
+
+static int numQuantizationThreads(const int numAtoms)
+{
+    constexpr int c_minAtomsPerThread = 16384;
+
+    return std::max(1, std::min(gmx_omp_get_max_threads(), numAtoms / c_minAtomsPerThread));
+}
+
+/*____________________________________________________________________________
+ |
+ | quantizeRange - convert coordinates to the nearest integers
+ |
+ | Converts the floats fp[begin] to fp[end-1] to the nearest integer after
+ | multiplication by precision, stores them in ip and updates the per
+ | dimension minimum and maximum. begin should be a multiple of 3.
+ | Returns 0 when scaling would cause integer overflow, 1 otherwise.
+ |
+ */
+
+static int quantizeRange(const float* fp, int* ip, const int begin, const int end, const float precision, int minint[3], int maxint[3])
+{
+    int errval = 1;
+    int i      = begin;
+
+#if GMX_SIMD_HAVE_FLOAT && GMX_SIMD_HAVE_LOADU && GMX_SIMD_HAVE_STOREU
+    /* Process three SIMD registers at a time. Since 3*width floats
+     * contain whole atoms, lane l of register r always holds dimension
+     * (r*width + l) % 3, so we can track the range per lane and reduce
+     * over the lanes of the same dimension at the end. The rounded
+     * values are truncated in floating point, since the float to int
+     * conversion is monotonic this gives the same range as the ints.
+     */
+    constexpr int c_width = GMX_SIMD_FLOAT_WIDTH;
+    if (end - i >= 3 * c_width)
+    {
+        const gmx::SimdFloat half(0.5F);
+        const gmx::SimdFloat precisionS(precision);
+        gmx::SimdFloat       minS[3], maxS[3];
+        gmx::SimdFloat       maxAbsS(0.0F);
+        for (int r = 0; r < 3; r++)
+        {
+            minS[r] = gmx::SimdFloat(maxAbsoluteInt);
+            maxS[r] = gmx::SimdFloat(-maxAbsoluteInt);
+        }
+        for (; i + 3 * c_width <= end; i += 3 * c_width)
+        {
+            for (int r = 0; r < 3; r++)
+            {
+                gmx::SimdFloat x = gmx::simdLoadU(fp + i + r * c_width);
+                /* Don't use FMA, that would change the rounding compared to the scalar code */
+                gmx::SimdFloat lf = x * precisionS;
+                lf                = lf + gmx::copysign(half, x);
+                maxAbsS           = gmx::max(maxAbsS, gmx::abs(lf));
+                gmx::storeU(ip + i + r * c_width, gmx::cvttR2I(lf));
+                lf      = gmx::trunc(lf);
+                minS[r] = gmx::min(minS[r], lf);
+                maxS[r] = gmx::max(maxS[r], lf);
+            }
+        }
+        if (gmx::anyTrue(gmx::SimdFloat(maxAbsoluteInt) < maxAbsS))
+        {
+            /* scaling would cause overflow, the range is irrelevant */
+            errval = 0;
+        }
+        else
+        {
+            alignas(GMX_SIMD_ALIGNMENT) float minBuf[3 * c_width];
+            alignas(GMX_SIMD_ALIGNMENT) float maxBuf[3 * c_width];
+            for (int r = 0; r < 3; r++)
+            {
+                gmx::store(minBuf + r * c_width, minS[r]);
+                gmx::store(maxBuf + r * c_width, maxS[r]);
+            }
+            for (int l = 0; l < 3 * c_width; l++)
+            {
+                minint[l % 3] = std::min(minint[l % 3], static_cast<int>(minBuf[l]));
+                maxint[l % 3] = std::max(maxint[l % 3], static_cast<int>(maxBuf[l]));
+            }
+        }
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        float lf;
+        /* find nearest integer */
+        if (fp[i] >= 0.0)
+        {
+            lf = fp[i] * precision + 0.5;
+        }
+        else
+        {
+            lf = fp[i] * precision - 0.5;
+        }
+        if (std::fabs(lf) > maxAbsoluteInt)
+        {
+            /* scaling would cause overflow */
+            errval = 0;
+        }
+        const int lint = static_cast<int>(lf);
+        const int d    = (i - begin) % 3;
+        minint[d]      = std::min(minint[d], lint);
+        maxint[d]      = std::max(maxint[d], lint);
+        ip[i]          = lint;
+    }
+
+    return errval;
+}
+
+/*____________________________________________________________________________
+ |
+ | xdr_quantize_coordinates - convert all coordinates to integers
+ |
+ | Fills ip with the integer coordinates, returns the range per dimension
+ | in minint and maxint and the smallest sum over dimensions of the absolute
+ | differences between successive coordinates in mindiff.
+ | Returns 0 when scaling would cause integer overflow, 1 otherwise.
+ |
+ */
+
+int xdr_quantize_coordinates(const float* fp, int* ip, const int numAtoms, const float precision, int minint[3], int maxint[3], int* mindiff)
+{
+    const int numThreads = numQuantizationThreads(numAtoms);
+
+    /* Per thread results, reduced after the parallel regions */
+    std::vector<std::array<int, 3>> threadMinint(numThreads, { INT_MAX, INT_MAX, INT_MAX });
+    std::vector<std::array<int, 3>> threadMaxint(numThreads, { INT_MIN, INT_MIN, INT_MIN });
+    std::vector<int>                threadErrval(numThreads);
+    std::vector<int>                threadMindiff(numThreads, INT_MAX);
+
+    /* Divide the atoms in multiples of 16, so all but the last thread
+     * process full SIMD blocks. Use 64 bits, numAtoms*thread can overflow.
+     */
+    auto atomRangeBegin = [numAtoms, numThreads](int thread) {
+        if (thread == numThreads)
+        {
+            return numAtoms;
+        }
+        const int64_t begin = static_cast<int64_t>(numAtoms) * thread / numThreads;
+        return static_cast<int>((begin / 16) * 16);
+    };
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        try
+        {
+            threadErrval[thread] = quantizeRange(fp,
+                                                 ip,
+                                                 3 * atomRangeBegin(thread),
+                                                 3 * atomRangeBegin(thread + 1),
+                                                 precision,
+                                                 threadMinint[thread].data(),
+                                                 threadMaxint[thread].data());
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
+    /* The differences need the integer coordinates of the preceding atom,
+     * which can belong to the range of another thread.
+     */
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        int minDiff = INT_MAX;
+        for (int a = std::max(atomRangeBegin(thread), 1); a < atomRangeBegin(thread + 1); a++)
+        {
+            const int* thiscoord = ip + 3 * a;
+            const int  diff      = std::abs(thiscoord[-3] - thiscoord[0])
+                             + std::abs(thiscoord[-2] - thiscoord[1])
+                             + std::abs(thiscoord[-1] - thiscoord[2]);
+            minDiff = std::min(minDiff, diff);
+        }
+        threadMindiff[thread] = minDiff;
+    }
+
+    int errval = 1;
+    minint[0] = minint[1] = minint[2] = INT_MAX;
+    maxint[0] = maxint[1] = maxint[2] = INT_MIN;
+    *mindiff                          = INT_MAX;
+    for (int thread = 0; thread < numThreads; thread++)
+    {
+        errval = std::min(errval, threadErrval[thread]);
+        for (int d = 0; d < 3; d++)
+        {
+            minint[d] = std::min(minint[d], threadMinint[thread][d]);
+            maxint[d] = std::max(maxint[d], threadMaxint[thread][d]);
+        }
+        *mindiff = std::min(*mindiff, threadMindiff[thread]);
+    }
+
+    return errval;
+}
+
+/*____________________________________________________________________________
+ |
+ | dequantizeCoordinates - convert integer coordinates back to floats
+ |
+ */
+
+static void dequantizeCoordinates(const int* ip, float* fp, const int numAtoms, const float inv_precision)
+{
+    const int numThreads = numQuantizationThreads(numAtoms);
+
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (int i = 0; i < 3 * numAtoms; i++)
+    {
+        fp[i] = ip[i] * inv_precision;
+    }
+}
+
 /*____________________________________________________________________________
  |
  | xdr3dfcoord - read or write compressed 3d coordinates to xdr file.
@@ -409,13 +635,12 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
     int      prealloc_ip[3 * 16], prealloc_buf[3 * 20];
     int      we_should_free = 0;
 
-    int          minint[3], maxint[3], mindiff, *lip, diff;
-    int          lint1, lint2, lint3, oldlint1, oldlint2, oldlint3, smallidx;
+    int          minint[3], maxint[3], mindiff, *lip;
+    int          smallidx;
     int          minidx, maxidx;
     unsigned     sizeint[3], sizesmall[3], bitsizeint[3], size3, *luip;
     int          flag, k;
     int          smallnum, smaller, larger, i, is_small, is_smaller, run, prevrun;
-    float *      lfp, lf;
     int          tmp, *thiscoord, prevcoord[3];
     unsigned int tmpcoord[30];
 
@@ -482,97 +707,8 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         }
         /* buf[0-2] are special and do not contain actual data */
         buf[0] = buf[1] = buf[2] = 0;
-        minint[0] = minint[1] = minint[2] = INT_MAX;
-        maxint[0] = maxint[1] = maxint[2] = INT_MIN;
-        prevrun                           = -1;
-        lfp                               = fp;
-        lip                               = ip;
-        mindiff                           = INT_MAX;
-        oldlint1 = oldlint2 = oldlint3 = 0;
-        while (lfp < fp + size3)
-        {
-            /* find nearest integer */
-            if (*lfp >= 0.0)
-            {
-                lf = *lfp * *precision + 0.5;
-            }
-            else
-            {
-                lf = *lfp * *precision - 0.5;
-            }
-            if (std::fabs(lf) > maxAbsoluteInt)
-            {
-                /* scaling would cause overflow */
-                errval = 0;
-            }
-            lint1 = static_cast<int>(lf);
-            if (lint1 < minint[0])
-            {
-                minint[0] = lint1;
-            }
-            if (lint1 > maxint[0])
-            {
-                maxint[0] = lint1;
-            }
-            *lip++ = lint1;
-            lfp++;
-            if (*lfp >= 0.0)
-            {
-                lf = *lfp * *precision + 0.5;
-            }
-            else
-            {
-                lf = *lfp * *precision - 0.5;
-            }
-            if (std::fabs(lf) > maxAbsoluteInt)
-            {
-                /* scaling would cause overflow */
-                errval = 0;
-            }
-            lint2 = static_cast<int>(lf);
-            if (lint2 < minint[1])
-            {
-                minint[1] = lint2;
-            }
-            if (lint2 > maxint[1])
-            {
-                maxint[1] = lint2;
-            }
-            *lip++ = lint2;
-            lfp++;
-            if (*lfp >= 0.0)
-            {
-                lf = *lfp * *precision + 0.5;
-            }
-            else
-            {
-                lf = *lfp * *precision - 0.5;
-            }
-            if (std::abs(lf) > maxAbsoluteInt)
-            {
-                /* scaling would cause overflow */
-                errval = 0;
-            }
-            lint3 = static_cast<int>(lf);
-            if (lint3 < minint[2])
-            {
-                minint[2] = lint3;
-            }
-            if (lint3 > maxint[2])
-            {
-                maxint[2] = lint3;
-            }
-            *lip++ = lint3;
-            lfp++;
-            diff = std::abs(oldlint1 - lint1) + std::abs(oldlint2 - lint2) + std::abs(oldlint3 - lint3);
-            if (diff < mindiff && lfp > fp + 3)
-            {
-                mindiff = diff;
-            }
-            oldlint1 = lint1;
-            oldlint2 = lint2;
-            oldlint3 = lint3;
-        }
+        prevrun = -1;
+        errval  = xdr_quantize_coordinates(fp, ip, *size, *precision, minint, maxint, &mindiff);
         if ((xdr_int(xdrs, &(minint[0])) == 0) || (xdr_int(xdrs, &(minint[1])) == 0)
             || (xdr_int(xdrs, &(minint[2])) == 0) || (xdr_int(xdrs, &(maxint[0])) == 0)
             || (xdr_int(xdrs, &(maxint[1])) == 0) || (xdr_int(xdrs, &(maxint[2])) == 0))
@@ -901,7 +1037,6 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
 
         buf[0] = buf[1] = buf[2] = 0;
 
-        lfp           = fp;
         inv_precision = 1.0 / *precision;
         run           = 0;
         i             = 0;
@@ -964,9 +1099,9 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                         tmp          = thiscoord[2];
                         thiscoord[2] = prevcoord[2];
                         prevcoord[2] = tmp;
-                        *lfp++       = prevcoord[0] * inv_precision;
-                        *lfp++       = prevcoord[1] * inv_precision;
-                        *lfp++       = prevcoord[2] * inv_precision;
+                        thiscoord[-3] = prevcoord[0];
+                        thiscoord[-2] = prevcoord[1];
+                        thiscoord[-1] = prevcoord[2];
                     }
                     else
                     {
@@ -974,17 +1109,9 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
                         prevcoord[1] = thiscoord[1];
                         prevcoord[2] = thiscoord[2];
                     }
-                    *lfp++ = thiscoord[0] * inv_precision;
-                    *lfp++ = thiscoord[1] * inv_precision;
-                    *lfp++ = thiscoord[2] * inv_precision;
+                    thiscoord += 3;
                 }
             }
-            else
-            {
-                *lfp++ = thiscoord[0] * inv_precision;
-                *lfp++ = thiscoord[1] * inv_precision;
-                *lfp++ = thiscoord[2] * inv_precision;
-            }
             smallidx += is_smaller;
             if (is_smaller < 0)
             {
@@ -1005,6 +1132,7 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
             }
             sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
         }
+        dequantizeCoordinates(ip, fp, lsize, inv_precision);
     }
     if (we_should_free)
     {
@@ -0,0 +1,314 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the trajectory frame index.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/trajectoryindex.h"
+
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/timecontrol.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/futil.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Writes \p numBytes zero bytes to \p fileName, standing in for a trajectory
+void writeDummyTrajectory(const std::string& fileName, int numBytes)
+{
+    FILE* fp = std::fopen(fileName.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    std::vector<char> data(numBytes, 0);
+    std::fwrite(data.data(), 1, data.size(), fp);
+    std::fclose(fp);
+}
+
+//! Returns index entries for frames of 100 bytes, 0.5 ps apart
+std::vector<TrajectoryIndexEntry> makeEntries(int numFrames)
+{
+    std::vector<TrajectoryIndexEntry> entries;
+    for (int i = 0; i < numFrames; i++)
+    {
+        entries.push_back({ 10 * i, 0.5 * i, 100 * i, 3 });
+    }
+    return entries;
+}
+
+class TrajectoryIndexTest : public ::testing::Test
+{
+public:
+    //! Manages the temporary files
+    TestFileManager fileManager_;
+    //! The name of the dummy trajectory
+    const std::string trajectoryName_ = fileManager_.getTemporaryFilePath("traj.xtc");
+    //! Registers the index file for clean-up
+    const std::string indexName_ = fileManager_.getTemporaryFilePath("traj.xtc.idx");
+};
+
+TEST_F(TrajectoryIndexTest, IsEmptyWithoutIndexFile)
+{
+    writeDummyTrajectory(trajectoryName_, 1000);
+    TrajectoryIndex index(trajectoryName_);
+    EXPECT_TRUE(index.empty());
+}
+
+TEST_F(TrajectoryIndexTest, RoundTrips)
+{
+    const auto entries = makeEntries(10);
+    writeDummyTrajectory(trajectoryName_, 1000);
+    {
+        TrajectoryIndexWriter writer(trajectoryName_, false);
+        for (const auto& entry : entries)
+        {
+            writer.addFrame(entry);
+        }
+    }
+
+    TrajectoryIndex index(trajectoryName_);
+    ASSERT_EQ(index.entries().size(), entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        EXPECT_EQ(index.entries()[i].step, entries[i].step);
+        EXPECT_EQ(index.entries()[i].time, entries[i].time);
+        EXPECT_EQ(index.entries()[i].offset, entries[i].offset);
+        EXPECT_EQ(index.entries()[i].natoms, entries[i].natoms);
+    }
+    EXPECT_EQ(index.firstFrameAtOrAfter(-1.0), 0U);
+    EXPECT_EQ(index.firstFrameAtOrAfter(1.0), 2U);
+    EXPECT_EQ(index.firstFrameAtOrAfter(1.2), 3U);
+    EXPECT_EQ(index.firstFrameAtOrAfter(100.0), entries.size());
+}
+
+TEST_F(TrajectoryIndexTest, IgnoresFramesBeyondTruncatedTrajectory)
+{
+    writeDummyTrajectory(trajectoryName_, 1000);
+    {
+        TrajectoryIndexWriter writer(trajectoryName_, false);
+        for (const auto& entry : makeEntries(10))
+        {
+            writer.addFrame(entry);
+        }
+    }
+
+    /* Truncate in the middle of the fifth frame, as on a restart */
+    writeDummyTrajectory(trajectoryName_, 450);
+    EXPECT_EQ(TrajectoryIndex(trajectoryName_).entries().size(), 5U);
+
+    /* Appending keeps the valid entries and continues after them */
+    {
+        TrajectoryIndexWriter writer(trajectoryName_, true);
+        writer.addFrame({ 50, 2.5, 450, 3 });
+    }
+    EXPECT_EQ(TrajectoryIndex(trajectoryName_).entries().size(), 5U);
+    writeDummyTrajectory(trajectoryName_, 1000);
+    TrajectoryIndex index(trajectoryName_);
+    ASSERT_EQ(index.entries().size(), 6U);
+    EXPECT_EQ(index.entries().back().step, 50);
+}
+
+/*! \brief Writes a trajectory with index, times are not representable in float
+ *
+ * This is what mdrun does, both with synchronous and asynchronous output.
+ */
+void writeIndexedTrajectory(const std::string& fileName, bool isXtc, int numFrames)
+{
+    const int         numAtoms = 2;
+    const matrix      box      = { { 2, 0, 0 }, { 0, 2, 0 }, { 0, 0, 2 } };
+    std::vector<RVec> x(numAtoms, { 0.5, 0.5, 0.5 });
+
+    t_fileio* fio = isXtc ? open_xtc(fileName.c_str(), "w") : gmx_trr_open(fileName.c_str(), "w");
+    TrajectoryIndexWriter index(fileName, false);
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        const int64_t   step   = 10 * frame;
+        const double    t      = 0.1 * frame;
+        const gmx_off_t offset = gmx_fio_ftell(fio);
+        if (isXtc)
+        {
+            write_xtc(fio, numAtoms, step, t, box, as_rvec_array(x.data()), 1000);
+        }
+        else
+        {
+            gmx_trr_write_frame(
+                    fio, step, t, 0, box, numAtoms, as_rvec_array(x.data()), nullptr, nullptr);
+        }
+        gmx_fio_flush(fio);
+        index.addFrame({ step, t, offset, numAtoms });
+    }
+    if (isXtc)
+    {
+        close_xtc(fio);
+    }
+    else
+    {
+        gmx_trr_close(fio);
+    }
+}
+
+//! Returns the times of all frames in \p fileName, read without using the index
+std::vector<real> readFrameTimes(const gmx_output_env_t* oenv, const std::string& fileName)
+{
+    std::vector<real> times;
+    t_trxstatus*      status;
+    t_trxframe        fr;
+    bool haveFrame = read_first_frame(oenv, &status, fileName.c_str(), &fr, TRX_READ_X);
+    while (haveFrame)
+    {
+        times.push_back(fr.time);
+        haveFrame = read_next_frame(oenv, status, &fr);
+    }
+    close_trx(status);
+    done_frame(&fr);
+
+    return times;
+}
+
+class TrajectoryIndexSeekTest : public ::testing::TestWithParam<const char*>
+{
+};
+
+TEST_P(TrajectoryIndexSeekTest, StoresFileTimesAndSeeksToThem)
+{
+    TestFileManager   fileManager;
+    const std::string extension = GetParam();
+    const std::string fileName  = fileManager.getTemporaryFilePath("seek." + extension);
+    fileManager.getTemporaryFilePath("seek." + extension + ".idx");
+    const int numFrames = 8;
+    writeIndexedTrajectory(fileName, extension == "xtc", numFrames);
+
+    gmx_output_env_t* oenv = nullptr;
+    output_env_init_default(&oenv);
+
+    // The index times should be exactly the times stored in the frames
+    const auto times = readFrameTimes(oenv, fileName);
+    ASSERT_EQ(times.size(), size_t(numFrames));
+    TrajectoryIndex index(fileName);
+    ASSERT_EQ(index.entries().size(), size_t(numFrames));
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        EXPECT_EQ(index.entries()[frame].time, times[frame]);
+    }
+
+    // Seeking to the time of a frame, as read from the file, gives that frame
+    for (int frame : { 3, 7 })
+    {
+        setTimeValue(TBEGIN, times[frame]);
+        t_trxstatus* status;
+        t_trxframe   fr;
+        ASSERT_TRUE(read_first_frame(oenv, &status, fileName.c_str(), &fr, TRX_READ_X));
+        EXPECT_EQ(fr.step, 10 * frame);
+        close_trx(status);
+        done_frame(&fr);
+        unsetTimeValue(TBEGIN);
+    }
+
+    output_env_done(oenv);
+}
+
+TEST_P(TrajectoryIndexSeekTest, IgnoresIndexWithOffsetsBetweenFrames)
+{
+    TestFileManager   fileManager;
+    const std::string extension = GetParam();
+    const std::string fileName  = fileManager.getTemporaryFilePath("stale." + extension);
+    fileManager.getTemporaryFilePath("stale." + extension + ".idx");
+    const int numFrames = 8;
+    writeIndexedTrajectory(fileName, extension == "xtc", numFrames);
+
+    // Replace the index by one for a different trajectory with the same
+    // name: its offsets are within the file, but not at frame headers
+    const auto entries = TrajectoryIndex(fileName).entries();
+    ASSERT_EQ(entries.size(), size_t(numFrames));
+    {
+        TrajectoryIndexWriter writer(fileName, false);
+        for (auto entry : entries)
+        {
+            entry.offset += 8;
+            writer.addFrame(entry);
+        }
+    }
+    ASSERT_EQ(TrajectoryIndex(fileName).entries().size(), size_t(numFrames));
+
+    gmx_output_env_t* oenv = nullptr;
+    output_env_init_default(&oenv);
+    const auto times = readFrameTimes(oenv, fileName);
+    ASSERT_EQ(times.size(), size_t(numFrames));
+
+    // All frames from the begin time should be read sequentially
+    setTimeValue(TBEGIN, times[5]);
+    std::vector<int64_t> steps;
+    t_trxstatus*         status;
+    t_trxframe           fr;
+    bool haveFrame = read_first_frame(oenv, &status, fileName.c_str(), &fr, TRX_READ_X);
+    while (haveFrame)
+    {
+        steps.push_back(fr.step);
+        haveFrame = read_next_frame(oenv, status, &fr);
+    }
+    close_trx(status);
+    done_frame(&fr);
+    unsetTimeValue(TBEGIN);
+
+    EXPECT_EQ(steps, std::vector<int64_t>({ 50, 60, 70 }));
+
+    output_env_done(oenv);
+}
+
+INSTANTIATE_TEST_CASE_P(WithTrrAndXtc, TrajectoryIndexSeekTest, ::testing::Values("trr", "xtc"));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,218 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for reading and writing TRR files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/trrio.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/real.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The number of atoms in the test frames, large enough for the arrays to be read from a memory map
+const int c_numAtoms = 10000;
+
+//! Returns deterministic, distinct coordinates for frame \p frame
+std::vector<RVec> makeFrame(int frame)
+{
+    std::vector<RVec> x(c_numAtoms);
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        x[i] = { 0.001_real * i, 0.5_real * frame, -0.25_real * (i % 7) };
+    }
+    return x;
+}
+
+//! Writes \p numFrames frames with coordinates and velocities to \p fio
+void writeFrames(t_fileio* fio, int firstFrame, int numFrames)
+{
+    const matrix box = { { 3, 0, 0 }, { 0, 4, 0 }, { 0, 0, 5 } };
+    for (int frame = firstFrame; frame < firstFrame + numFrames; frame++)
+    {
+        std::vector<RVec> x = makeFrame(frame);
+        std::vector<RVec> v = makeFrame(-frame);
+        gmx_trr_write_frame(fio,
+                            frame,
+                            0.1 * frame,
+                            0,
+                            box,
+                            c_numAtoms,
+                            as_rvec_array(x.data()),
+                            as_rvec_array(v.data()),
+                            nullptr);
+    }
+}
+
+//! Reads the next frame from \p fio and checks it against what writeFrames() wrote
+void readAndCheckFrame(t_fileio* fio, int expectedFrame)
+{
+    matrix            box;
+    gmx_trr_header_t  header;
+    gmx_bool          bOK;
+    std::vector<RVec> x(c_numAtoms), v(c_numAtoms);
+
+    ASSERT_TRUE(gmx_trr_read_frame_header(fio, &header, &bOK));
+    ASSERT_TRUE(bOK);
+    EXPECT_EQ(c_numAtoms, header.natoms);
+    EXPECT_EQ(expectedFrame, header.step);
+    EXPECT_EQ(0, header.f_size);
+    ASSERT_TRUE(gmx_trr_read_frame_data(
+            fio, &header, box, as_rvec_array(x.data()), as_rvec_array(v.data()), nullptr));
+    EXPECT_REAL_EQ(4, box[YY][YY]);
+    std::vector<RVec> refX = makeFrame(expectedFrame);
+    std::vector<RVec> refV = makeFrame(-expectedFrame);
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(refX[i][d], x[i][d]);
+            EXPECT_EQ(refV[i][d], v[i][d]);
+        }
+    }
+}
+
+TEST(TrrIOTest, FramesRoundTrip)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.trr");
+
+    t_fileio* fio = gmx_trr_open(fileName.c_str(), "w");
+    writeFrames(fio, 0, 5);
+    gmx_trr_close(fio);
+
+    fio = gmx_trr_open(fileName.c_str(), "r");
+    for (int frame = 0; frame < 5; frame++)
+    {
+        readAndCheckFrame(fio, frame);
+    }
+    gmx_trr_header_t header;
+    gmx_bool         bOK;
+    EXPECT_FALSE(gmx_trr_read_frame_header(fio, &header, &bOK));
+    gmx_trr_close(fio);
+}
+
+TEST(TrrIOTest, ReadsFramesAppendedAfterOpening)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.trr");
+
+    t_fileio* writer = gmx_trr_open(fileName.c_str(), "w");
+    writeFrames(writer, 0, 2);
+    gmx_fio_flush(writer);
+
+    t_fileio* reader = gmx_trr_open(fileName.c_str(), "r");
+    readAndCheckFrame(reader, 0);
+    // These frames are not part of what was in the file when the
+    // reader opened it, so they can not be decoded from a map of it
+    writeFrames(writer, 2, 2);
+    gmx_trr_close(writer);
+    for (int frame = 1; frame < 4; frame++)
+    {
+        readAndCheckFrame(reader, frame);
+    }
+    gmx_trr_close(reader);
+}
+
+TEST(TrrIOTest, ReadsFramesWithoutMemoryMap)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.trr");
+
+    t_fileio* fio = gmx_trr_open(fileName.c_str(), "w");
+    writeFrames(fio, 0, 3);
+    gmx_trr_close(fio);
+
+    gmxSetenv("GMX_NO_TRAJECTORY_MMAP", "1", true);
+    fio = gmx_trr_open(fileName.c_str(), "r");
+    gmxUnsetenv("GMX_NO_TRAJECTORY_MMAP");
+    for (int frame = 0; frame < 3; frame++)
+    {
+        readAndCheckFrame(fio, frame);
+    }
+    gmx_trr_close(fio);
+}
+
+TEST(TrrIOTest, StopsAtFrameTruncatedAfterOpening)
+{
+    TestFileManager   fileManager;
+    const std::string fileName = fileManager.getTemporaryFilePath("traj.trr");
+
+    t_fileio* writer = gmx_trr_open(fileName.c_str(), "w");
+    writeFrames(writer, 0, 2);
+    const gmx_off_t endOfSecondFrame = gmx_fio_ftell(writer);
+    writeFrames(writer, 2, 2);
+    gmx_trr_close(writer);
+
+    t_fileio* reader = gmx_trr_open(fileName.c_str(), "r");
+    readAndCheckFrame(reader, 0);
+    // As on a restart with appending, truncate the file in the middle of
+    // the coordinates of the third frame, which are mapped in memory
+    ASSERT_EQ(0, gmx_truncate(fileName, endOfSecondFrame + 1000));
+    readAndCheckFrame(reader, 1);
+
+    matrix            box;
+    gmx_trr_header_t  header;
+    gmx_bool          bOK;
+    std::vector<RVec> x(c_numAtoms), v(c_numAtoms);
+    ASSERT_TRUE(gmx_trr_read_frame_header(reader, &header, &bOK));
+    EXPECT_FALSE(gmx_trr_read_frame_data(
+            reader, &header, box, as_rvec_array(x.data()), as_rvec_array(v.data()), nullptr));
+    gmx_trr_close(reader);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
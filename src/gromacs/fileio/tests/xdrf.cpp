@@ -0,0 +1,172 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider code modification or any other derived work
+ * interpreted as an integral part of GROMACS as the basis for
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the XTC coordinate quantization.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xdrf.h"
+
+#include <climits>
+#include <cmath>
+
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/gmxomp.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The scalar reference quantization, as done before threading and SIMD
+int referenceQuantize(const std::vector<float>& fp,
+                      float                     precision,
+                      std::vector<int>*         ip,
+                      int                       minint[3],
+                      int                       maxint[3],
+                      int*                      mindiff)
+{
+    const int numAtoms = fp.size() / 3;
+    int       errval   = 1;
+    minint[0] = minint[1] = minint[2] = INT_MAX;
+    maxint[0] = maxint[1] = maxint[2] = INT_MIN;
+    *mindiff                          = INT_MAX;
+    ip->resize(fp.size());
+    for (int i = 0; i < 3 * numAtoms; i++)
+    {
+        float lf;
+        if (fp[i] >= 0.0)
+        {
+            lf = fp[i] * precision + 0.5;
+        }
+        else
+        {
+            lf = fp[i] * precision - 0.5;
+        }
+        if (std::fabs(lf) > std::nextafterf(float(INT_MAX), 0.F))
+        {
+            errval = 0;
+        }
+        const int lint = static_cast<int>(lf);
+        minint[i % 3]  = std::min(minint[i % 3], lint);
+        maxint[i % 3]  = std::max(maxint[i % 3], lint);
+        (*ip)[i]       = lint;
+    }
+    for (int a = 1; a < numAtoms; a++)
+    {
+        const int* c    = ip->data() + 3 * a;
+        const int  diff = std::abs(c[-3] - c[0]) + std::abs(c[-2] - c[1]) + std::abs(c[-1] - c[2]);
+        *mindiff        = std::min(*mindiff, diff);
+    }
+    return errval;
+}
+
+//! Returns coordinates of \p numAtoms atoms with both signs and rounding ties
+std::vector<float> makeCoordinates(int numAtoms)
+{
+    std::vector<float> x(3 * numAtoms);
+    for (int i = 0; i < 3 * numAtoms; i++)
+    {
+        // Multiples of 0.0005 hit the rounding midpoints at precision 1000
+        x[i] = 0.0005F * ((i * 7919) % 20011) - 3.0F;
+    }
+    return x;
+}
+
+//! Quantizes \p numAtoms atoms and compares with the scalar reference
+void checkQuantization(int numAtoms)
+{
+    SCOPED_TRACE(testing::Message() << "with " << numAtoms << " atoms");
+    const float precision = 1000;
+    const auto  x         = makeCoordinates(numAtoms);
+
+    std::vector<int> ipRef;
+    int              minRef[3], maxRef[3], mindiffRef;
+    const int errvalRef = referenceQuantize(x, precision, &ipRef, minRef, maxRef, &mindiffRef);
+
+    std::vector<int> ip(3 * numAtoms);
+    int              minint[3], maxint[3], mindiff;
+    const int        errval = xdr_quantize_coordinates(
+            x.data(), ip.data(), numAtoms, precision, minint, maxint, &mindiff);
+
+    EXPECT_EQ(errval, errvalRef);
+    EXPECT_EQ(ip, ipRef);
+    for (int d = 0; d < 3; d++)
+    {
+        EXPECT_EQ(minint[d], minRef[d]);
+        EXPECT_EQ(maxint[d], maxRef[d]);
+    }
+    EXPECT_EQ(mindiff, mindiffRef);
+}
+
+TEST(XtcQuantization, MatchesScalarReference)
+{
+    // Sizes below, at and around multiples of the 16-atom SIMD blocks
+    for (int numAtoms : { 1, 2, 5, 16, 17, 31, 48, 100, 16 * 37 + 7 })
+    {
+        checkQuantization(numAtoms);
+    }
+}
+
+TEST(XtcQuantization, MatchesScalarReferenceWithThreads)
+{
+    // Large enough for multiple threads, with a tail that is not a multiple of 16
+    const int numThreadsOld = gmx_omp_get_max_threads();
+    gmx_omp_set_num_threads(3);
+    checkQuantization(3 * 16384 + 16 * 5 + 11);
+    gmx_omp_set_num_threads(numThreadsOld);
+}
+
+TEST(XtcQuantization, DetectsOverflow)
+{
+    // Overflow in a SIMD block and in the tail
+    for (int atom : { 5, 35 })
+    {
+        std::vector<float> x = makeCoordinates(40);
+        x[3 * atom + 1]      = 1e7;
+
+        std::vector<int> ip(x.size());
+        int              minint[3], maxint[3], mindiff;
+        EXPECT_EQ(xdr_quantize_coordinates(
+                          x.data(), ip.data(), x.size() / 3, 1000, minint, maxint, &mindiff),
+                  0);
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,232 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Defines functionality for the frame index sidecar files of
+ * XTC and TRR trajectories.
+ *
+ * The index file starts with a magic number and a version, followed by
+ * one record per frame, all in XDR format: step (int64), time (double),
+ * offset (int64) and number of atoms (int).
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "trajectoryindex.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/fatalerror.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number at the start of index files
+constexpr int c_trajectoryIndexMagic = 0x47584449;
+//! Version of the index file format
+constexpr int c_trajectoryIndexVersion = 1;
+
+//! Reads or writes an index file header, returns whether it is valid
+bool serializeHeader(XDR* xdrs)
+{
+    int magic   = c_trajectoryIndexMagic;
+    int version = c_trajectoryIndexVersion;
+
+    return xdr_int(xdrs, &magic) != 0 && xdr_int(xdrs, &version) != 0
+           && magic == c_trajectoryIndexMagic && version == c_trajectoryIndexVersion;
+}
+
+//! Reads or writes an index entry, returns whether this succeeded
+bool serializeEntry(XDR* xdrs, TrajectoryIndexEntry* entry)
+{
+    int64_t offset = entry->offset;
+    bool    ok     = xdr_int64(xdrs, &entry->step) != 0 && xdr_double(xdrs, &entry->time) != 0
+              && xdr_int64(xdrs, &offset) != 0 && xdr_int(xdrs, &entry->natoms) != 0;
+    entry->offset = offset;
+
+    return ok;
+}
+
+//! Returns the size of file \p fileName, or -1 when it can not be opened
+gmx_off_t fileSize(const std::string& fileName)
+{
+    FILE* fp = std::fopen(fileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return -1;
+    }
+    gmx_off_t size = -1;
+    if (gmx_fseek(fp, 0, SEEK_END) == 0)
+    {
+        size = gmx_ftell(fp);
+    }
+    std::fclose(fp);
+
+    return size;
+}
+
+/*! \brief Reads the entries of the index of \p trajectoryFileName that refer
+ * to frames inside the trajectory file
+ */
+std::vector<TrajectoryIndexEntry> readValidEntries(const std::string& trajectoryFileName)
+{
+    std::vector<TrajectoryIndexEntry> entries;
+
+    const std::string indexFileName  = trajectoryIndexFileName(trajectoryFileName);
+    const gmx_off_t   trajectorySize = fileSize(trajectoryFileName);
+    if (trajectorySize <= 0 || !gmx_fexist(indexFileName))
+    {
+        return entries;
+    }
+
+    FILE* fp = std::fopen(indexFileName.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return entries;
+    }
+    XDR xdrs;
+    xdrstdio_create(&xdrs, fp, XDR_DECODE);
+    if (serializeHeader(&xdrs))
+    {
+        TrajectoryIndexEntry entry;
+        while (serializeEntry(&xdrs, &entry))
+        {
+            /* Offsets increase monotonically, frames past the end of the
+             * trajectory have been truncated away.
+             */
+            if (entry.offset >= trajectorySize || entry.natoms < 0
+                || (!entries.empty() && entry.offset <= entries.back().offset))
+            {
+                break;
+            }
+            entries.push_back(entry);
+        }
+    }
+    xdr_destroy(&xdrs);
+    std::fclose(fp);
+
+    return entries;
+}
+
+} // namespace
+
+std::string trajectoryIndexFileName(const std::string& trajectoryFileName)
+{
+    return trajectoryFileName + ".idx";
+}
+
+bool writeTrajectoryIndexRequested()
+{
+    return std::getenv("GMX_WRITE_TRAJECTORY_INDEX") != nullptr;
+}
+
+TrajectoryIndex::TrajectoryIndex(const std::string& trajectoryFileName) :
+    entries_(readValidEntries(trajectoryFileName))
+{
+}
+
+size_t TrajectoryIndex::firstFrameAtOrAfter(double time) const
+{
+    /* Times increase monotonically in trajectories written by mdrun */
+    auto it = std::lower_bound(
+            entries_.begin(), entries_.end(), time, [](const TrajectoryIndexEntry& entry, double t) {
+                return entry.time < t;
+            });
+
+    return it - entries_.begin();
+}
+
+TrajectoryIndexWriter::TrajectoryIndexWriter(const std::string& trajectoryFileName, bool appendToExisting) :
+    fp_(nullptr),
+    timeIsFloat_(fn2ftp(trajectoryFileName.c_str()) == efXTC),
+    fileName_(trajectoryIndexFileName(trajectoryFileName))
+{
+    std::vector<TrajectoryIndexEntry> entries;
+    if (appendToExisting)
+    {
+        entries = readValidEntries(trajectoryFileName);
+    }
+
+    /* Rewrite the whole index, this removes entries for truncated frames */
+    fp_ = std::fopen(fileName_.c_str(), "wb");
+    if (fp_ == nullptr)
+    {
+        gmx_file(fileName_);
+    }
+    XDR xdrs;
+    xdrstdio_create(&xdrs, fp_, XDR_ENCODE);
+    serializeHeader(&xdrs);
+    for (auto& entry : entries)
+    {
+        serializeEntry(&xdrs, &entry);
+    }
+    xdr_destroy(&xdrs);
+    std::fflush(fp_);
+}
+
+TrajectoryIndexWriter::~TrajectoryIndexWriter()
+{
+    std::fclose(fp_);
+}
+
+void TrajectoryIndexWriter::addFrame(const TrajectoryIndexEntry& entry)
+{
+    TrajectoryIndexEntry entryCopy = entry;
+    XDR                  xdrs;
+
+    entryCopy.time = timeIsFloat_ ? static_cast<float>(entry.time) : static_cast<real>(entry.time);
+
+    xdrstdio_create(&xdrs, fp_, XDR_ENCODE);
+    const bool ok = serializeEntry(&xdrs, &entryCopy);
+    xdr_destroy(&xdrs);
+    /* Flush, so readers of a running simulation see complete entries.
+     * xdr_destroy() can already have flushed, so also check the error flag.
+     */
+    if (!ok || std::fflush(fp_) != 0 || std::ferror(fp_) != 0)
+    {
+        GMX_THROW(FileIOError("Cannot write trajectory index " + fileName_
+                              + "; maybe you are out of disk space?"));
+    }
+}
+
+} // namespace gmx
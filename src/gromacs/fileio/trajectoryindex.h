@@ -0,0 +1,153 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief Declares functionality for the frame index sidecar files of
+ * XTC and TRR trajectories.
+ *
+ * An index file stores, for every frame of a trajectory, the step, time,
+ * byte offset in the trajectory file and number of atoms. Readers use it
+ * to jump directly to the frames selected with -b, -e and -dt instead of
+ * reading or bisecting through the trajectory. The index is an optional
+ * cache: it is only trusted for frames that lie within the current
+ * trajectory file, and readers verify the frame they seek to.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_TRAJECTORYINDEX_H
+#define GMX_FILEIO_TRAJECTORYINDEX_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+//! An entry for a single frame in a trajectory index
+struct TrajectoryIndexEntry
+{
+    //! The MD step of the frame
+    int64_t step;
+    //! The time of the frame
+    double time;
+    //! The byte offset of the frame header in the trajectory file
+    gmx_off_t offset;
+    //! The number of atoms in the frame
+    int natoms;
+};
+
+//! Returns the name of the index file that belongs to \p trajectoryFileName
+std::string trajectoryIndexFileName(const std::string& trajectoryFileName);
+
+/*! \brief Returns whether mdrun should write index files, set through the
+ * GMX_WRITE_TRAJECTORY_INDEX environment variable
+ */
+bool writeTrajectoryIndexRequested();
+
+/*! \libinternal
+ * \brief Frame index of a trajectory file, read from its sidecar file
+ */
+class TrajectoryIndex
+{
+public:
+    /*! \brief Reads the index of \p trajectoryFileName, when present
+     *
+     * Entries pointing beyond the end of the trajectory file, which occur
+     * after truncation of the trajectory, are ignored. When the index file
+     * does not exist or is not valid, the index is empty.
+     */
+    explicit TrajectoryIndex(const std::string& trajectoryFileName);
+
+    //! Returns whether there are no index entries
+    bool empty() const { return entries_.empty(); }
+
+    //! Returns the index entries
+    const std::vector<TrajectoryIndexEntry>& entries() const { return entries_; }
+
+    //! Returns the index of the first frame with time >= \p time, or the number of entries
+    size_t firstFrameAtOrAfter(double time) const;
+
+private:
+    //! The entries in file order
+    std::vector<TrajectoryIndexEntry> entries_;
+};
+
+/*! \libinternal
+ * \brief Writes the index file for a trajectory that is being written
+ */
+class TrajectoryIndexWriter
+{
+public:
+    /*! \brief Opens the index for the trajectory \p trajectoryFileName
+     *
+     * With \p appendToExisting, the existing entries for frames that are
+     * still present in the trajectory are kept, so this should be called
+     * after the trajectory has been truncated to its restart position.
+     * Otherwise a new index is started.
+     */
+    TrajectoryIndexWriter(const std::string& trajectoryFileName, bool appendToExisting);
+    ~TrajectoryIndexWriter();
+
+    /*! \brief Appends the entry for a frame, should be called after the frame is written
+     *
+     * The time of \p entry should be the unrounded simulation time. It is
+     * stored with the precision of the trajectory file, i.e. single for XTC
+     * and real for TRR, so searching the index gives the same result as
+     * searching the frames themselves.
+     *
+     * \throws FileIOError when the entry could not be written.
+     */
+    void addFrame(const TrajectoryIndexEntry& entry);
+
+private:
+    //! The index file
+    FILE* fp_;
+    //! Whether the trajectory stores times in single precision, otherwise in real
+    bool timeIsFloat_;
+    //! The name of the index file
+    std::string fileName_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(TrajectoryIndexWriter);
+};
+
+} // namespace gmx
+
+#endif
@@ -136,6 +136,19 @@ void gmx_trr_write_frame(struct t_fileio* fio,
                          const rvec*      f);
 /* Write a trr frame to file fp, box, x, v, f may be NULL */
 
+gmx_bool gmx_trr_try_write_frame(struct t_fileio* fio,
+                                 int64_t          step,
+                                 real             t,
+                                 real             lambda,
+                                 const rvec*      box,
+                                 int              natoms,
+                                 const rvec*      x,
+                                 const rvec*      v,
+                                 const rvec*      f);
+/* As gmx_trr_write_frame, but returns FALSE on a write error instead of
+ * issuing a fatal error, for use on threads that can not terminate the run
+ */
+
 void gmx_trr_read_single_header(const char* fn, gmx_trr_header_t* header);
 /* Read the header of a trr file from fn, and close the file afterwards.
  */
@@ -57,6 +57,7 @@
 #include "gromacs/fileio/timecontrol.h"
 #include "gromacs/fileio/tngio.h"
 #include "gromacs/fileio/tpxio.h"
+#include "gromacs/fileio/trajectoryindex.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/fileio/xtcio.h"
@@ -94,6 +95,8 @@ struct t_trxstatus
     double               DT, BOX[3];
     gmx_bool             bReadBox;
     char*                persistent_line; /* Persistent line for reading g96 trajectories */
+    gmx::TrajectoryIndex* index;          /* Frame index for XTC/TRR, nullptr when absent */
+    size_t                nextIndexEntry; /* Index entry of the next frame in the file */
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
@@ -173,6 +176,8 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->index           = nullptr;
+    status->nextIndexEntry  = 0;
 }
 
 
@@ -640,6 +645,7 @@ void close_trx(t_trxstatus* status)
         gmx_fio_close(status->fio);
     }
     sfree(status->persistent_line);
+    delete status->index;
 #if GMX_USE_PLUGINS
     sfree(status->vmdplugin);
 #endif
@@ -806,6 +812,121 @@ static int pdb_first_x(t_trxstatus* status, FILE* fp, t_trxframe* fr)
     return fr->natoms;
 }
 
+/* Discards a stale frame index and sets the file position back to
+ * \p fallbackPosition, so reading continues sequentially from there.
+ */
+static void discardIndex(t_trxstatus* status, gmx_off_t fallbackPosition)
+{
+    fprintf(stderr,
+            "\nWARNING: Frame index %s does not match the trajectory, ignoring it\n",
+            gmx::trajectoryIndexFileName(gmx_fio_getname(status->fio)).c_str());
+    delete status->index;
+    status->index = nullptr;
+    gmx_fio_seek(status->fio, fallbackPosition);
+}
+
+/* Returns whether there is a frame header matching \p entry at the offset
+ * of \p entry. The full TRR header is only read after the magic number
+ * matched, so an offset that is not at a frame boundary does not cause
+ * a fatal error. The file position is left at the offset.
+ */
+static bool frameHeaderMatchesIndexEntry(t_fileio* fio, const gmx::TrajectoryIndexEntry& entry)
+{
+    const int c_trrMagic = 1993;
+    const int c_xtcMagic = 1995;
+
+    if (gmx_fio_seek(fio, entry.offset) != 0)
+    {
+        return false;
+    }
+    int  magic = 0;
+    bool bOK   = gmx_fio_do_int(fio, magic);
+    if (gmx_fio_getftp(fio) == efXTC)
+    {
+        int natoms = 0;
+        int step   = 0;
+        bOK        = bOK && magic == c_xtcMagic && gmx_fio_do_int(fio, natoms)
+              && gmx_fio_do_int(fio, step) && natoms == entry.natoms && step == entry.step;
+    }
+    else
+    {
+        bOK = bOK && magic == c_trrMagic;
+        if (bOK)
+        {
+            gmx_trr_header_t sh;
+            gmx_bool         bHeaderOK;
+            gmx_fio_seek(fio, entry.offset);
+            bOK = gmx_trr_read_frame_header(fio, &sh, &bHeaderOK) && bHeaderOK
+                  && sh.natoms == entry.natoms && sh.step == entry.step;
+        }
+    }
+    gmx_fio_seek(fio, entry.offset);
+
+    return bOK;
+}
+
+/* Uses the frame index to move the file position directly to the next
+ * frame that passes the -b, -e and -dt selection, instead of reading
+ * and discarding all frames in between. When the index does not cover
+ * the next frame, the file position is not changed. When there is no
+ * matching frame header at the indexed position, the index is discarded.
+ * Returns whether the file position was moved.
+ */
+static bool skipToNextSelectedFrame(t_trxstatus* status, gmx_bool bDouble)
+{
+    const auto& entries = status->index->entries();
+    size_t      next    = status->nextIndexEntry;
+
+    if (next >= entries.size() || (status->flags & TRX_DONT_SKIP))
+    {
+        return false;
+    }
+    if (bTimeSet(TBEGIN))
+    {
+        next = std::max(next, status->index->firstFrameAtOrAfter(rTimeValue(TBEGIN)));
+    }
+    /* Use the same selection as for frames that are actually read */
+    while (next < entries.size() && check_times2(entries[next].time, status->t0, bDouble) < 0)
+    {
+        next++;
+    }
+    if (next > status->nextIndexEntry && next < entries.size())
+    {
+        const gmx_off_t currentPosition = gmx_fio_ftell(status->fio);
+        if (!frameHeaderMatchesIndexEntry(status->fio, entries[next]))
+        {
+            discardIndex(status, currentPosition);
+            return false;
+        }
+        status->nextIndexEntry = next;
+        return true;
+    }
+    return false;
+}
+
+/* Checks that the frame just read matches its index entry. When it does
+ * not, the index is stale: it is discarded and the file position is set
+ * back to \p fallbackPosition, so the caller can read the frame again.
+ * Returns whether the frame was valid.
+ */
+static bool checkFrameAgainstIndex(t_trxstatus* status, const t_trxframe* fr, gmx_off_t fallbackPosition)
+{
+    const auto& entries = status->index->entries();
+    if (status->nextIndexEntry >= entries.size())
+    {
+        return true;
+    }
+    const gmx::TrajectoryIndexEntry& entry = entries[status->nextIndexEntry];
+    if (fr->natoms == entry.natoms && fr->step == entry.step)
+    {
+        status->nextIndexEntry++;
+        return true;
+    }
+    discardIndex(status, fallbackPosition);
+
+    return false;
+}
+
 bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxframe* fr)
 {
     real     pt;
@@ -829,6 +950,13 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
         {
             ftp = gmx_fio_getftp(status->fio);
         }
+        gmx_off_t positionBeforeSkip = 0;
+        bool      skippedWithIndex   = false;
+        if (status->index)
+        {
+            positionBeforeSkip = gmx_fio_ftell(status->fio);
+            skippedWithIndex   = skipToNextSelectedFrame(status, fr->bDouble);
+        }
         switch (ftp)
         {
             case efTRR: bRet = gmx_next_frame(status, fr); break;
@@ -843,7 +971,7 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                 break;
             }
             case efXTC:
-                if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
+                if (!status->index && bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
                 {
                     if (xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
                     {
@@ -882,6 +1010,21 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                           gmx_fio_getname(status->fio));
 #endif
         }
+        if (!bRet && skippedWithIndex)
+        {
+            /* The frame at the indexed position could not be read,
+             * read again from where we were without using the index */
+            discardIndex(status, positionBeforeSkip);
+            bRet  = true;
+            bSkip = TRUE;
+            continue;
+        }
+        if (bRet && status->index && !checkFrameAgainstIndex(status, fr, positionBeforeSkip))
+        {
+            /* Read again without using the index */
+            bSkip = TRUE;
+            continue;
+        }
         status->tf = fr->time;
 
         if (bRet)
@@ -948,6 +1091,17 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
     {
         fio = (*status)->fio = gmx_fio_open(fn, "r");
     }
+    if ((ftp == efXTC || ftp == efTRR) && !(flags & TRX_DONT_SKIP)
+        && (bTimeSet(TBEGIN) || bTimeSet(TEND) || bTimeSet(TDELTA)))
+    {
+        /* The index is only useful when frames are selected on time */
+        (*status)->index = new gmx::TrajectoryIndex(fn);
+        if ((*status)->index->empty())
+        {
+            delete (*status)->index;
+            (*status)->index = nullptr;
+        }
+    }
     switch (ftp)
     {
         case efTRR: break;
@@ -999,6 +1153,12 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
                 fr->bX    = TRUE;
                 fr->bBox  = TRUE;
                 printcount(*status, oenv, fr->time, FALSE);
+                if ((*status)->index && !checkFrameAgainstIndex(*status, fr, 0))
+                {
+                    /* We are back at the start, let read_next_frame read the first frame */
+                    bFirst = TRUE;
+                    break;
+                }
             }
             bFirst = FALSE;
             break;
@@ -1117,6 +1277,7 @@ gmx_bool read_next_x(const gmx_output_env_t* oenv, t_trxstatus* status, real* t,
 void rewind_trj(t_trxstatus* status)
 {
     initcount(status);
+    status->nextIndexEntry = 0;
 
     gmx_fio_rewind(status->fio);
 }
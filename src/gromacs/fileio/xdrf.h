@@ -58,6 +58,20 @@
 /* Read or write reduced precision *float* coordinates */
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision);
 
+/* Convert the coordinates of numAtoms atoms to integers for compression,
+ * as done by xdr3dfcoord. Returns the range per dimension in minint and
+ * maxint and the smallest sum of absolute differences between successive
+ * atoms in mindiff. Returns 0 when scaling would cause integer overflow.
+ * Exposed for testing.
+ */
+int xdr_quantize_coordinates(const float* fp,
+                             int*         ip,
+                             int          numAtoms,
+                             float        precision,
+                             int          minint[3],
+                             int          maxint[3],
+                             int*         mindiff);
+
 
 /* Read or write a *real* value (stored as float) */
 int xdr_real(XDR* xdrs, real* r);
@@ -44,6 +44,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <array>
 
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -56,6 +57,7 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
 #include "gromacs/utility/fatalerror.h"
 
 
@@ -64,27 +66,33 @@ struct ScalarDataTypes
 {
     using RealType                     = real; //!< The data type to use as real.
     using IntType                      = int;  //!< The data type to use as int.
+    using BoolType                     = bool; //!< The data type to use as bool for real value comparison.
     static constexpr int simdRealWidth = 1;    //!< The width of the RealType.
     static constexpr int simdIntWidth  = 1;    //!< The width of the IntType.
 };
 
-#if GMX_SIMD_HAVE_REAL && GMX_SIMD_HAVE_INT32_ARITHMETICS
+#if GMX_SIMD_HAVE_REAL && GMX_SIMD_HAVE_INT32_ARITHMETICS \
+        && GMX_SIMD_HAVE_GATHER_LOADU_BYSIMDINT_TRANSPOSE_REAL
 //! SIMD data types.
 struct SimdDataTypes
 {
     using RealType                     = gmx::SimdReal;         //!< The data type to use as real.
     using IntType                      = gmx::SimdInt32;        //!< The data type to use as int.
+    using BoolType                     = gmx::SimdBool;         //!< The data type to use as bool for real value comparison.
     static constexpr int simdRealWidth = GMX_SIMD_REAL_WIDTH;   //!< The width of the RealType.
     static constexpr int simdIntWidth  = GMX_SIMD_FINT32_WIDTH; //!< The width of the IntType.
 };
+#    define GMX_NB_FREE_ENERGY_HAVE_SIMD 1
+#else
+#    define GMX_NB_FREE_ENERGY_HAVE_SIMD 0
 #endif
 
-//! Computes r^(1/p) and 1/r^(1/p) for the standard p=6
-template<class RealType>
-static inline void pthRoot(const RealType r, RealType* pthRoot, RealType* invPthRoot)
+//! Computes r^(1/p) and 1/r^(1/p) for the standard p=6, returns zero for masked out entries
+template<class RealType, class BoolType>
+static inline void pthRoot(const RealType r, RealType* pthRoot, RealType* invPthRoot, const BoolType mask)
 {
-    *invPthRoot = gmx::invsqrt(std::cbrt(r));
-    *pthRoot    = 1 / (*invPthRoot);
+    *invPthRoot = gmx::maskzInvsqrt(gmx::cbrt(r), mask);
+    *pthRoot    = gmx::maskzInv(*invPthRoot, mask);
 }
 
 template<class RealType>
@@ -158,45 +166,43 @@ static inline RealType lennardJonesPotential(const RealType v6,
 }
 
 /* Ewald LJ */
-static inline real ewaldLennardJonesGridSubtract(const real c6grid, const real potentialShift, const real oneSixth)
+template<class RealType>
+static inline RealType ewaldLennardJonesGridSubtract(const RealType c6grid,
+                                                     const real     potentialShift,
+                                                     const real     oneSixth)
 {
     return (c6grid * potentialShift * oneSixth);
 }
 
-/* LJ Potential switch */
-template<class RealType>
+/* LJ Potential switch, returns zero for masked out entries (beyond the cut-off) */
+template<class RealType, class BoolType>
 static inline RealType potSwitchScalarForceMod(const RealType fScalarInp,
                                                const RealType potential,
                                                const RealType sw,
                                                const RealType r,
-                                               const RealType rVdw,
                                                const RealType dsw,
-                                               const real     zero)
+                                               const BoolType mask)
 {
-    if (r < rVdw)
-    {
-        real fScalar = fScalarInp * sw - r * potential * dsw;
-        return (fScalar);
-    }
-    return (zero);
+    return gmx::selectByMask(fScalarInp * sw - r * potential * dsw, mask);
 }
-template<class RealType>
-static inline RealType potSwitchPotentialMod(const RealType potentialInp,
-                                             const RealType sw,
-                                             const RealType r,
-                                             const RealType rVdw,
-                                             const real     zero)
+template<class RealType, class BoolType>
+static inline RealType potSwitchPotentialMod(const RealType potentialInp, const RealType sw, const BoolType mask)
 {
-    if (r < rVdw)
-    {
-        real potential = potentialInp * sw;
-        return (potential);
-    }
-    return (zero);
+    return gmx::selectByMask(potentialInp * sw, mask);
 }
 
 
-//! Templated free-energy non-bonded kernel
+/*! \brief Templated free-energy non-bonded kernel
+ *
+ * The j-particles of each i-entry are processed in chunks of
+ * DataTypes::simdRealWidth. The j-coordinates are gathered into SIMD
+ * registers, parameters are gathered lane by lane into aligned buffers.
+ * Exclusions, the cut-off, zero parameters and the padding at the end
+ * of a j-list are handled with masks, so all code paths are evaluated for
+ * all lanes and only the contributions of masked-in lanes are kept.
+ * With ScalarDataTypes all masks are plain booleans and the kernel
+ * processes one pair at a time.
+ */
 template<typename DataTypes, bool useSoftCore, bool scLambdasOrAlphasDiffer, bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
 static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                   rvec* gmx_restrict         xx,
@@ -212,15 +218,16 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
 
     using RealType = typename DataTypes::RealType;
     using IntType  = typename DataTypes::IntType;
+    using BoolType = typename DataTypes::BoolType;
+
+    constexpr int simdWidth = DataTypes::simdRealWidth;
 
-    /* FIXME: How should these be handled with SIMD? */
     constexpr real oneTwelfth = 1.0 / 12.0;
     constexpr real oneSixth   = 1.0 / 6.0;
     constexpr real zero       = 0.0;
     constexpr real half       = 0.5;
     constexpr real one        = 1.0;
     constexpr real two        = 2.0;
-    constexpr real six        = 6.0;
 
     /* Extract pointer to non-bonded interaction constants */
     const interaction_const_t* ic = fr->ic;
@@ -343,8 +350,8 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
     GMX_RELEASE_ASSERT(!(vdwInteractionTypeIsEwald && vdwModifierIsPotSwitch),
                        "Can not apply soft-core to switched Ewald potentials");
 
-    real dvdlCoul = 0;
-    real dvdlVdw  = 0;
+    RealType dvdlCoul = zero;
+    RealType dvdlVdw  = zero;
 
     /* Lambda factor for state A, 1-lambda*/
     real LFC[NSTATES], LFV[NSTATES];
@@ -379,88 +386,122 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
 
     int numExcludedPairsBeyondRlist = 0;
 
+    /* Buffers for gathering the j-particle data of one chunk into SIMD lanes */
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t preloadJnr[simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadLaneIsValid[simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadPairIncluded[simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadSelfScale[simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadQq[NSTATES][simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC6[NSTATES][simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC12[NSTATES][simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         preloadC6Grid[NSTATES][simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         forceBuffer[DIM][simdWidth];
+
     for (int n = 0; n < nri; n++)
     {
-        int npair_within_cutoff = 0;
-
-        const int  is3   = 3 * shift[n];
-        const real shX   = shiftvec[is3];
-        const real shY   = shiftvec[is3 + 1];
-        const real shZ   = shiftvec[is3 + 2];
-        const int  nj0   = jindex[n];
-        const int  nj1   = jindex[n + 1];
-        const int  ii    = iinr[n];
-        const int  ii3   = 3 * ii;
-        const real ix    = shX + x[ii3 + 0];
-        const real iy    = shY + x[ii3 + 1];
-        const real iz    = shZ + x[ii3 + 2];
-        const real iqA   = facel * chargeA[ii];
-        const real iqB   = facel * chargeB[ii];
-        const int  ntiA  = 2 * ntype * typeA[ii];
-        const int  ntiB  = 2 * ntype * typeB[ii];
-        real       vCTot = 0;
-        real       vVTot = 0;
-        real       fIX   = 0;
-        real       fIY   = 0;
-        real       fIZ   = 0;
-
-        for (int k = nj0; k < nj1; k++)
+        bool haveInteractionsWithinCutoff = false;
+
+        const int      is3   = 3 * shift[n];
+        const real     shX   = shiftvec[is3];
+        const real     shY   = shiftvec[is3 + 1];
+        const real     shZ   = shiftvec[is3 + 2];
+        const int      nj0   = jindex[n];
+        const int      nj1   = jindex[n + 1];
+        const int      ii    = iinr[n];
+        const int      ii3   = 3 * ii;
+        const RealType ix    = shX + x[ii3 + 0];
+        const RealType iy    = shY + x[ii3 + 1];
+        const RealType iz    = shZ + x[ii3 + 2];
+        const real     iqA   = facel * chargeA[ii];
+        const real     iqB   = facel * chargeB[ii];
+        const int      ntiA  = 2 * ntype * typeA[ii];
+        const int      ntiB  = 2 * ntype * typeB[ii];
+        RealType       vCTot = zero;
+        RealType       vVTot = zero;
+        RealType       fIX   = zero;
+        RealType       fIY   = zero;
+        RealType       fIZ   = zero;
+
+        for (int k = nj0; k < nj1; k += simdWidth)
         {
-            int            tj[NSTATES];
-            const int      jnr = jjnr[k];
-            const int      j3  = 3 * jnr;
-            RealType       c6[NSTATES], c12[NSTATES], qq[NSTATES], vCoul[NSTATES], vVdw[NSTATES];
-            RealType       r, rInv, rp, rpm2;
-            RealType       alphaVdwEff, alphaCoulEff, sigma6[NSTATES];
-            const RealType dX  = ix - x[j3];
-            const RealType dY  = iy - x[j3 + 1];
-            const RealType dZ  = iz - x[j3 + 2];
-            const RealType rSq = dX * dX + dY * dY + dZ * dZ;
-            RealType       fScalC[NSTATES], fScalV[NSTATES];
-            /* Check if this pair on the exlusions list.*/
-            const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k];
-
-            if (rSq >= rcutoff_max2 && bPairIncluded)
+            /* Gather the parameters of this chunk of j-particles. Lanes beyond
+             * the end of the list repeat the last pair and are masked out.
+             */
+            for (int lane = 0; lane < simdWidth; lane++)
             {
-                /* We save significant time by skipping all code below.
-                 * Note that with soft-core interactions, the actual cut-off
-                 * check might be different. But since the soft-core distance
-                 * is always larger than r, checking on r here is safe.
-                 * Exclusions outside the cutoff can not be skipped as
-                 * when using Ewald: the reciprocal-space
-                 * Ewald component still needs to be subtracted.
-                 */
-
-                continue;
+                const bool laneIsValid = (k + lane < nj1);
+                const int  kk          = laneIsValid ? k + lane : nj1 - 1;
+                const int  jnr         = jjnr[kk];
+                const int  tjA         = ntiA + 2 * typeA[jnr];
+                const int  tjB         = ntiB + 2 * typeB[jnr];
+
+                preloadJnr[lane]          = jnr;
+                preloadLaneIsValid[lane]  = laneIsValid ? one : zero;
+                preloadPairIncluded[lane] = (nlist->excl_fep == nullptr || nlist->excl_fep[kk]) ? one : zero;
+                /* A self-interaction (ii == jnr) occurs twice, so we scale it by half */
+                preloadSelfScale[lane]      = (ii == jnr) ? half : one;
+                preloadQq[STATE_A][lane]    = iqA * chargeA[jnr];
+                preloadQq[STATE_B][lane]    = iqB * chargeB[jnr];
+                preloadC6[STATE_A][lane]    = nbfp[tjA];
+                preloadC6[STATE_B][lane]    = nbfp[tjB];
+                preloadC12[STATE_A][lane]   = nbfp[tjA + 1];
+                preloadC12[STATE_B][lane]   = nbfp[tjB + 1];
+                if (vdwInteractionTypeIsEwald)
+                {
+                    preloadC6Grid[STATE_A][lane] = nbfp_grid[tjA];
+                    preloadC6Grid[STATE_B][lane] = nbfp_grid[tjB];
+                }
             }
-            npair_within_cutoff++;
 
-            if (rSq > rlistSquared)
-            {
-                numExcludedPairsBeyondRlist++;
-            }
+            RealType jx, jy, jz;
+            gmx::gatherLoadUTranspose<3>(x, preloadJnr, &jx, &jy, &jz);
 
-            if (rSq > 0)
-            {
-                /* Note that unlike in the nbnxn kernels, we do not need
-                 * to clamp the value of rSq before taking the invsqrt
-                 * to avoid NaN in the LJ calculation, since here we do
-                 * not calculate LJ interactions when C6 and C12 are zero.
-                 */
+            const RealType dX  = ix - jx;
+            const RealType dY  = iy - jy;
+            const RealType dZ  = iz - jz;
+            const RealType rSq = dX * dX + dY * dY + dZ * dZ;
 
-                rInv = gmx::invsqrt(rSq);
-                r    = rSq * rInv;
+            /* Check if the pairs are on the exclusions list */
+            const RealType pairIncluded  = gmx::load<RealType>(preloadPairIncluded);
+            const BoolType bPairIncluded = (pairIncluded != zero);
+            const BoolType bPairExcluded = (pairIncluded == zero);
+            const BoolType laneIsValid   = (gmx::load<RealType>(preloadLaneIsValid) != zero);
+
+            /* We save significant time by skipping all code below for pairs
+             * beyond the cut-off. Note that with soft-core interactions, the actual
+             * cut-off check might be different. But since the soft-core distance
+             * is always larger than r, checking on r here is safe.
+             * Exclusions outside the cutoff can not be skipped as
+             * when using Ewald: the reciprocal-space
+             * Ewald component still needs to be subtracted.
+             */
+            const BoolType computeMask = laneIsValid && (rSq < rcutoff_max2 || bPairExcluded);
+            if (!gmx::anyTrue(computeMask))
+            {
+                continue;
             }
-            else
+            haveInteractionsWithinCutoff = true;
+
+            const BoolType beyondRlist = computeMask && (rlistSquared < rSq);
+            if (gmx::anyTrue(beyondRlist))
             {
-                /* The force at r=0 is zero, because of symmetry.
-                 * But note that the potential is in general non-zero,
-                 * since the soft-cored r will be non-zero.
-                 */
-                rInv = 0;
-                r    = 0;
+                numExcludedPairsBeyondRlist += static_cast<int>(
+                        gmx::reduce(gmx::selectByMask(RealType(one), beyondRlist)));
             }
 
+            /* Note that unlike in the nbnxn kernels, we do not need
+             * to clamp the value of rSq before taking the invsqrt
+             * to avoid NaN in the LJ calculation, since here we do
+             * not calculate LJ interactions when C6 and C12 are zero.
+             *
+             * The force at r=0 is zero, because of symmetry.
+             * But note that the potential is in general non-zero,
+             * since the soft-cored r will be non-zero.
+             */
+            const RealType rInv = gmx::maskzInvsqrt(rSq, computeMask && (zero < rSq));
+            const RealType r    = rSq * rInv;
+
+            RealType rp, rpm2;
             if (useSoftCore)
             {
                 rpm2 = rSq * rSq;  /* r4 */
@@ -473,223 +514,221 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * the simplest math and cheapest code.
                  */
                 rpm2 = rInv * rInv;
-                rp   = 1;
+                rp   = one;
             }
 
-            RealType fScal = 0;
-
-            qq[STATE_A] = iqA * chargeA[jnr];
-            qq[STATE_B] = iqB * chargeB[jnr];
+            RealType fScal = zero;
 
-            tj[STATE_A] = ntiA + 2 * typeA[jnr];
-            tj[STATE_B] = ntiB + 2 * typeB[jnr];
+            RealType qq[NSTATES];
+            qq[STATE_A] = gmx::load<RealType>(preloadQq[STATE_A]);
+            qq[STATE_B] = gmx::load<RealType>(preloadQq[STATE_B]);
 
-            if (bPairIncluded)
+            const BoolType includedMask = computeMask && bPairIncluded;
+            if (gmx::anyTrue(includedMask))
             {
-                c6[STATE_A] = nbfp[tj[STATE_A]];
-                c6[STATE_B] = nbfp[tj[STATE_B]];
+                RealType c6[NSTATES], c12[NSTATES], sigma6[NSTATES];
+                RealType alphaVdwEff, alphaCoulEff;
+                RealType vCoul[NSTATES], vVdw[NSTATES], fScalC[NSTATES], fScalV[NSTATES];
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    c12[i] = nbfp[tj[i] + 1];
+                    c6[i]  = gmx::load<RealType>(preloadC6[i]);
+                    c12[i] = gmx::load<RealType>(preloadC12[i]);
                     if (useSoftCore)
                     {
-                        if ((c6[i] > 0) && (c12[i] > 0))
-                        {
-                            /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct for this */
-                            sigma6[i] = half * c12[i] / c6[i];
-                            if (sigma6[i] < sigma6_min) /* for disappearing coul and vdw with soft core at the same time */
-                            {
-                                sigma6[i] = sigma6_min;
-                            }
-                        }
-                        else
-                        {
-                            sigma6[i] = sigma6_def;
-                        }
+                        /* c12 is stored scaled with 12.0 and c6 is scaled with 6.0 - correct for this.
+                         * The minimum is for disappearing coul and vdw with soft core at the same time.
+                         */
+                        const BoolType haveSigma = (zero < c6[i]) && (zero < c12[i]);
+                        const RealType sigma6FromC6C12 =
+                                gmx::max(half * c12[i] * gmx::maskzInv(c6[i], haveSigma), sigma6_min);
+                        sigma6[i] = gmx::blend(RealType(sigma6_def), sigma6FromC6C12, haveSigma);
                     }
                 }
 
                 if (useSoftCore)
                 {
                     /* only use softcore if one of the states has a zero endstate - softcore is for avoiding infinities!*/
-                    if ((c12[STATE_A] > 0) && (c12[STATE_B] > 0))
-                    {
-                        alphaVdwEff  = 0;
-                        alphaCoulEff = 0;
-                    }
-                    else
-                    {
-                        alphaVdwEff  = alpha_vdw;
-                        alphaCoulEff = alpha_coul;
-                    }
+                    const BoolType bothHaveRepulsion = (zero < c12[STATE_A]) && (zero < c12[STATE_B]);
+                    alphaVdwEff  = gmx::selectByNotMask(RealType(alpha_vdw), bothHaveRepulsion);
+                    alphaCoulEff = gmx::selectByNotMask(RealType(alpha_coul), bothHaveRepulsion);
                 }
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    fScalC[i] = 0;
-                    fScalV[i] = 0;
-                    vCoul[i]  = 0;
-                    vVdw[i]   = 0;
+                    fScalC[i] = zero;
+                    fScalV[i] = zero;
+                    vCoul[i]  = zero;
+                    vVdw[i]   = zero;
+
+                    /* Only spend time on A or B state if it is non-zero */
+                    const BoolType nonZeroState =
+                            includedMask && ((qq[i] != zero) || (c6[i] != zero) || (c12[i] != zero));
+                    if (!gmx::anyTrue(nonZeroState))
+                    {
+                        continue;
+                    }
 
                     RealType rInvC, rInvV, rC, rV, rPInvC, rPInvV;
 
-                    /* Only spend time on A or B state if it is non-zero */
-                    if ((qq[i] != 0) || (c6[i] != 0) || (c12[i] != 0))
+                    /* this section has to be inside the loop because of the dependence on sigma6 */
+                    if (useSoftCore)
                     {
-                        /* this section has to be inside the loop because of the dependence on sigma6 */
-                        if (useSoftCore)
+                        rPInvC = gmx::maskzInv(alphaCoulEff * lFacCoul[i] * sigma6[i] + rp, nonZeroState);
+                        pthRoot(rPInvC, &rInvC, &rC, nonZeroState);
+                        if (scLambdasOrAlphasDiffer)
                         {
-                            rPInvC = one / (alphaCoulEff * lFacCoul[i] * sigma6[i] + rp);
-                            pthRoot(rPInvC, &rInvC, &rC);
-                            if (scLambdasOrAlphasDiffer)
-                            {
-                                rPInvV = one / (alphaVdwEff * lFacVdw[i] * sigma6[i] + rp);
-                                pthRoot(rPInvV, &rInvV, &rV);
-                            }
-                            else
-                            {
-                                /* We can avoid one expensive pow and one / operation */
-                                rPInvV = rPInvC;
-                                rInvV  = rInvC;
-                                rV     = rC;
-                            }
+                            rPInvV = gmx::maskzInv(alphaVdwEff * lFacVdw[i] * sigma6[i] + rp, nonZeroState);
+                            pthRoot(rPInvV, &rInvV, &rV, nonZeroState);
                         }
                         else
                         {
-                            rPInvC = 1;
-                            rInvC  = rInv;
-                            rC     = r;
-
-                            rPInvV = 1;
-                            rInvV  = rInv;
-                            rV     = r;
+                            /* We can avoid one expensive pow and one / operation */
+                            rPInvV = rPInvC;
+                            rInvV  = rInvC;
+                            rV     = rC;
                         }
+                    }
+                    else
+                    {
+                        rPInvC = one;
+                        rInvC  = rInv;
+                        rC     = r;
 
-                        /* Only process the coulomb interactions if we have charges,
-                         * and if we either include all entries in the list (no cutoff
-                         * used in the kernel), or if we are within the cutoff.
-                         */
-                        bool computeElecInteraction = (elecInteractionTypeIsEwald && r < rCoulomb)
-                                                      || (!elecInteractionTypeIsEwald && rC < rCoulomb);
+                        rPInvV = one;
+                        rInvV  = rInv;
+                        rV     = r;
+                    }
 
-                        if ((qq[i] != 0) && computeElecInteraction)
+                    /* Only process the coulomb interactions if we have charges,
+                     * and if we either include all entries in the list (no cutoff
+                     * used in the kernel), or if we are within the cutoff.
+                     */
+                    const BoolType computeElecInteraction =
+                            nonZeroState && (qq[i] != zero)
+                            && ((elecInteractionTypeIsEwald ? r : rC) < rCoulomb);
+                    if (gmx::anyTrue(computeElecInteraction))
+                    {
+                        if (elecInteractionTypeIsEwald)
                         {
-                            if (elecInteractionTypeIsEwald)
-                            {
-                                vCoul[i]  = ewaldPotential(qq[i], rInvC, sh_ewald);
-                                fScalC[i] = ewaldScalarForce(qq[i], rInvC);
-                            }
-                            else
-                            {
-                                vCoul[i]  = reactionFieldPotential(qq[i], rInvC, rC, krf, crf);
-                                fScalC[i] = reactionFieldScalarForce(qq[i], rInvC, rC, krf, two);
-                            }
+                            vCoul[i]  = ewaldPotential(qq[i], rInvC, sh_ewald);
+                            fScalC[i] = ewaldScalarForce(qq[i], rInvC);
                         }
-
-                        /* Only process the VDW interactions if we have
-                         * some non-zero parameters, and if we either
-                         * include all entries in the list (no cutoff used
-                         * in the kernel), or if we are within the cutoff.
-                         */
-                        bool computeVdwInteraction = (vdwInteractionTypeIsEwald && r < rVdw)
-                                                     || (!vdwInteractionTypeIsEwald && rV < rVdw);
-                        if ((c6[i] != 0 || c12[i] != 0) && computeVdwInteraction)
+                        else
                         {
-                            RealType rInv6;
-                            if (useSoftCore)
-                            {
-                                rInv6 = rPInvV;
-                            }
-                            else
-                            {
-                                rInv6 = calculateRinv6(rInvV);
-                            }
-                            RealType vVdw6  = calculateVdw6(c6[i], rInv6);
-                            RealType vVdw12 = calculateVdw12(c12[i], rInv6);
-
-                            vVdw[i] = lennardJonesPotential(
-                                    vVdw6, vVdw12, c6[i], c12[i], repulsionShift, dispersionShift, oneSixth, oneTwelfth);
-                            fScalV[i] = lennardJonesScalarForce(vVdw6, vVdw12);
+                            vCoul[i]  = reactionFieldPotential(qq[i], rInvC, rC, krf, crf);
+                            fScalC[i] = reactionFieldScalarForce(qq[i], rInvC, rC, krf, two);
+                        }
+                        vCoul[i]  = gmx::selectByMask(vCoul[i], computeElecInteraction);
+                        fScalC[i] = gmx::selectByMask(fScalC[i], computeElecInteraction);
+                    }
 
-                            if (vdwInteractionTypeIsEwald)
-                            {
-                                /* Subtract the grid potential at the cut-off */
-                                vVdw[i] += ewaldLennardJonesGridSubtract(
-                                        nbfp_grid[tj[i]], shLjEwald, oneSixth);
-                            }
+                    /* Only process the VDW interactions if we have
+                     * some non-zero parameters, and if we either
+                     * include all entries in the list (no cutoff used
+                     * in the kernel), or if we are within the cutoff.
+                     */
+                    const BoolType computeVdwInteraction =
+                            nonZeroState && ((c6[i] != zero) || (c12[i] != zero))
+                            && ((vdwInteractionTypeIsEwald ? r : rV) < rVdw);
+                    if (gmx::anyTrue(computeVdwInteraction))
+                    {
+                        RealType rInv6;
+                        if (useSoftCore)
+                        {
+                            rInv6 = rPInvV;
+                        }
+                        else
+                        {
+                            rInv6 = calculateRinv6(rInvV);
+                        }
+                        RealType vVdw6  = calculateVdw6(c6[i], rInv6);
+                        RealType vVdw12 = calculateVdw12(c12[i], rInv6);
 
-                            if (vdwModifierIsPotSwitch)
-                            {
-                                RealType d        = rV - ic->rvdw_switch;
-                                d                 = (d > zero) ? d : zero;
-                                const RealType d2 = d * d;
-                                const RealType sw =
-                                        one + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
-                                const RealType dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
+                        vVdw[i] = lennardJonesPotential(
+                                vVdw6, vVdw12, c6[i], c12[i], repulsionShift, dispersionShift, oneSixth, oneTwelfth);
+                        fScalV[i] = lennardJonesScalarForce(vVdw6, vVdw12);
 
-                                fScalV[i] = potSwitchScalarForceMod(
-                                        fScalV[i], vVdw[i], sw, rV, rVdw, dsw, zero);
-                                vVdw[i] = potSwitchPotentialMod(vVdw[i], sw, rV, rVdw, zero);
-                            }
+                        if (vdwInteractionTypeIsEwald)
+                        {
+                            /* Subtract the grid potential at the cut-off */
+                            vVdw[i] = vVdw[i]
+                                      + ewaldLennardJonesGridSubtract(
+                                              gmx::load<RealType>(preloadC6Grid[i]), shLjEwald, oneSixth);
                         }
 
-                        /* fScalC (and fScalV) now contain: dV/drC * rC
-                         * Now we multiply by rC^-p, so it will be: dV/drC * rC^1-p
-                         * Further down we first multiply by r^p-2 and then by
-                         * the vector r, which in total gives: dV/drC * (r/rC)^1-p
-                         */
-                        fScalC[i] *= rPInvC;
-                        fScalV[i] *= rPInvV;
+                        if (vdwModifierIsPotSwitch)
+                        {
+                            const RealType d  = gmx::max(rV - ic->rvdw_switch, zero);
+                            const RealType d2 = d * d;
+                            const RealType sw =
+                                    one + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
+                            const RealType dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
+
+                            fScalV[i] = potSwitchScalarForceMod(
+                                    fScalV[i], vVdw[i], sw, rV, dsw, computeVdwInteraction);
+                            vVdw[i] = potSwitchPotentialMod(vVdw[i], sw, computeVdwInteraction);
+                        }
+                        vVdw[i]   = gmx::selectByMask(vVdw[i], computeVdwInteraction);
+                        fScalV[i] = gmx::selectByMask(fScalV[i], computeVdwInteraction);
                     }
+
+                    /* fScalC (and fScalV) now contain: dV/drC * rC
+                     * Now we multiply by rC^-p, so it will be: dV/drC * rC^1-p
+                     * Further down we first multiply by r^p-2 and then by
+                     * the vector r, which in total gives: dV/drC * (r/rC)^1-p
+                     */
+                    fScalC[i] = fScalC[i] * rPInvC;
+                    fScalV[i] = fScalV[i] * rPInvV;
                 } // end for (int i = 0; i < NSTATES; i++)
 
                 /* Assemble A and B states */
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vCTot += LFC[i] * vCoul[i];
-                    vVTot += LFV[i] * vVdw[i];
+                    vCTot = vCTot + LFC[i] * vCoul[i];
+                    vVTot = vVTot + LFV[i] * vVdw[i];
 
-                    fScal += LFC[i] * fScalC[i] * rpm2;
-                    fScal += LFV[i] * fScalV[i] * rpm2;
+                    fScal = fScal + LFC[i] * fScalC[i] * rpm2;
+                    fScal = fScal + LFV[i] * fScalV[i] * rpm2;
 
                     if (useSoftCore)
                     {
-                        dvdlCoul += vCoul[i] * DLF[i]
-                                    + LFC[i] * alphaCoulEff * dlFacCoul[i] * fScalC[i] * sigma6[i];
-                        dvdlVdw += vVdw[i] * DLF[i]
-                                   + LFV[i] * alphaVdwEff * dlFacVdw[i] * fScalV[i] * sigma6[i];
+                        dvdlCoul = dvdlCoul + vCoul[i] * DLF[i]
+                                   + LFC[i] * alphaCoulEff * dlFacCoul[i] * fScalC[i] * sigma6[i];
+                        dvdlVdw = dvdlVdw + vVdw[i] * DLF[i]
+                                  + LFV[i] * alphaVdwEff * dlFacVdw[i] * fScalV[i] * sigma6[i];
                     }
                     else
                     {
-                        dvdlCoul += vCoul[i] * DLF[i];
-                        dvdlVdw += vVdw[i] * DLF[i];
+                        dvdlCoul = dvdlCoul + vCoul[i] * DLF[i];
+                        dvdlVdw  = dvdlVdw + vVdw[i] * DLF[i];
                     }
                 }
-            } // end if (bPairIncluded)
-            else if (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD)
+            } // end if (gmx::anyTrue(includedMask))
+
+            const BoolType excludedMask = computeMask && bPairExcluded;
+            const RealType selfScale    = gmx::load<RealType>(preloadSelfScale);
+
+            if (icoul == GMX_NBKERNEL_ELEC_REACTIONFIELD && gmx::anyTrue(excludedMask))
             {
                 /* For excluded pairs, which are only in this pair list when
                  * using the Verlet scheme, we don't use soft-core.
                  * As there is no singularity, there is no need for soft-core.
                  */
-                const real FF = -two * krf;
-                RealType   VV = krf * rSq - crf;
-
-                if (ii == jnr)
-                {
-                    VV *= half;
-                }
+                const real     FF = -two * krf;
+                const RealType VV = gmx::selectByMask((krf * rSq - crf) * selfScale, excludedMask);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vCTot += LFC[i] * qq[i] * VV;
-                    fScal += LFC[i] * qq[i] * FF;
-                    dvdlCoul += DLF[i] * qq[i] * VV;
+                    vCTot    = vCTot + LFC[i] * qq[i] * VV;
+                    fScal    = fScal + gmx::selectByMask(LFC[i] * qq[i] * FF, excludedMask);
+                    dvdlCoul = dvdlCoul + DLF[i] * qq[i] * VV;
                 }
             }
 
-            if (elecInteractionTypeIsEwald && (r < rCoulomb || !bPairIncluded))
+            const BoolType computeElecEwaldCorrection =
+                    computeMask && (r < rCoulomb || bPairExcluded);
+            if (elecInteractionTypeIsEwald && gmx::anyTrue(computeElecEwaldCorrection))
             {
                 /* See comment in the preamble. When using Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -698,40 +737,38 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * above. This gets us closer to the ideal case of applying
                  * the softcore to the entire electrostatic interaction,
                  * including the reciprocal-space component.
+                 *
+                 * Masked out lanes use index 0 to stay within the table.
                  */
-                real v_lr, f_lr;
-
-                const RealType ewrt   = r * coulombTableScale;
-                IntType        ewitab = static_cast<IntType>(ewrt);
-                const RealType eweps  = ewrt - ewitab;
-                ewitab                = 4 * ewitab;
-                f_lr                  = ewtab[ewitab] + eweps * ewtab[ewitab + 1];
-                v_lr = (ewtab[ewitab + 2] - coulombTableScaleInvHalf * eweps * (ewtab[ewitab] + f_lr));
-                f_lr *= rInv;
+                const RealType ewrt = gmx::selectByMask(r, computeElecEwaldCorrection) * coulombTableScale;
+                const IntType  ewitab = gmx::cvttR2I(ewrt);
+                const RealType eweps  = ewrt - gmx::cvtI2R(ewitab);
+                RealType       tabF, tabD, tabV, tabUnused;
+                gmx::gatherLoadBySimdIntTranspose<4>(ewtab, ewitab, &tabF, &tabD, &tabV, &tabUnused);
+                RealType f_lr = tabF + eweps * tabD;
+                RealType v_lr = tabV - coulombTableScaleInvHalf * eweps * (tabF + f_lr);
+                f_lr          = gmx::selectByMask(f_lr * rInv, computeElecEwaldCorrection);
 
                 /* Note that any possible Ewald shift has already been applied in
                  * the normal interaction part above.
+                 *
+                 * If the i particle (ii) has itself (jnr) in its neighborlist,
+                 * which can only happen with the Verlet scheme, this is a
+                 * self-interaction that will occur twice. selfScale scales it
+                 * down by 50% to only include it once.
                  */
-
-                if (ii == jnr)
-                {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    v_lr *= half;
-                }
+                v_lr = gmx::selectByMask(v_lr * selfScale, computeElecEwaldCorrection);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    vCTot -= LFC[i] * qq[i] * v_lr;
-                    fScal -= LFC[i] * qq[i] * f_lr;
-                    dvdlCoul -= (DLF[i] * qq[i]) * v_lr;
+                    vCTot    = vCTot - LFC[i] * qq[i] * v_lr;
+                    fScal    = fScal - LFC[i] * qq[i] * f_lr;
+                    dvdlCoul = dvdlCoul - (DLF[i] * qq[i]) * v_lr;
                 }
             }
 
-            if (vdwInteractionTypeIsEwald && (r < rVdw || !bPairIncluded))
+            const BoolType computeVdwEwaldCorrection = computeMask && (r < rVdw || bPairExcluded);
+            if (vdwInteractionTypeIsEwald && gmx::anyTrue(computeVdwEwaldCorrection))
             {
                 /* See comment in the preamble. When using LJ-Ewald interactions
                  * (unless we use a switch modifier) we subtract the reciprocal-space
@@ -746,101 +783,110 @@ static void nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                  * r close to 0 for non-interacting pairs.
                  */
 
-                const RealType rs   = rSq * rInv * vdwTableScale;
-                const IntType  ri   = static_cast<IntType>(rs);
-                const RealType frac = rs - ri;
-                const RealType f_lr = (1 - frac) * tab_ewald_F_lj[ri] + frac * tab_ewald_F_lj[ri + 1];
+                const RealType rs   = gmx::selectByMask(r, computeVdwEwaldCorrection) * vdwTableScale;
+                const IntType  ri   = gmx::cvttR2I(rs);
+                const RealType frac = rs - gmx::cvtI2R(ri);
+                RealType       tabF0, tabF1, tabV0, tabV1;
+                gmx::gatherLoadUBySimdIntTranspose<1>(tab_ewald_F_lj, ri, &tabF0, &tabF1);
+                gmx::gatherLoadUBySimdIntTranspose<1>(tab_ewald_V_lj, ri, &tabV0, &tabV1);
+                const RealType f_lr = (one - frac) * tabF0 + frac * tabF1;
                 /* TODO: Currently the Ewald LJ table does not contain
                  * the factor 1/6, we should add this.
                  */
-                const RealType FF = f_lr * rInv / six;
-                RealType       VV =
-                        (tab_ewald_V_lj[ri] - vdwTableScaleInvHalf * frac * (tab_ewald_F_lj[ri] + f_lr))
-                        / six;
-
-                if (ii == jnr)
-                {
-                    /* If we get here, the i particle (ii) has itself (jnr)
-                     * in its neighborlist. This can only happen with the Verlet
-                     * scheme, and corresponds to a self-interaction that will
-                     * occur twice. Scale it down by 50% to only include it once.
-                     */
-                    VV *= half;
-                }
+                const RealType FF = gmx::selectByMask(f_lr * rInv * oneSixth, computeVdwEwaldCorrection);
+                /* Self-interactions are scaled by half, see the Coulomb correction above */
+                const RealType VV = gmx::selectByMask(
+                        (tabV0 - vdwTableScaleInvHalf * frac * (tabF0 + f_lr)) * oneSixth * selfScale,
+                        computeVdwEwaldCorrection);
 
                 for (int i = 0; i < NSTATES; i++)
                 {
-                    const real c6grid = nbfp_grid[tj[i]];
-                    vVTot += LFV[i] * c6grid * VV;
-                    fScal += LFV[i] * c6grid * FF;
-                    dvdlVdw += (DLF[i] * c6grid) * VV;
+                    const RealType c6grid = gmx::load<RealType>(preloadC6Grid[i]);
+                    vVTot                 = vVTot + LFV[i] * c6grid * VV;
+                    fScal                 = fScal + LFV[i] * c6grid * FF;
+                    dvdlVdw               = dvdlVdw + (DLF[i] * c6grid) * VV;
                 }
             }
 
             if (doForces)
             {
-                const real tX = fScal * dX;
-                const real tY = fScal * dY;
-                const real tZ = fScal * dZ;
-                fIX           = fIX + tX;
-                fIY           = fIY + tY;
-                fIZ           = fIZ + tZ;
-                /* OpenMP atomics are expensive, but this kernels is also
-                 * expensive, so we can take this hit, instead of using
-                 * thread-local output buffers and extra reduction.
-                 *
-                 * All the OpenMP regions in this file are trivial and should
-                 * not throw, so no need for try/catch.
-                 */
+                const RealType tX = fScal * dX;
+                const RealType tY = fScal * dY;
+                const RealType tZ = fScal * dZ;
+                fIX               = fIX + tX;
+                fIY               = fIY + tY;
+                fIZ               = fIZ + tZ;
+
+                gmx::store(forceBuffer[XX], tX);
+                gmx::store(forceBuffer[YY], tY);
+                gmx::store(forceBuffer[ZZ], tZ);
+                const int numLanes = std::min(simdWidth, nj1 - k);
+                for (int lane = 0; lane < numLanes; lane++)
+                {
+                    const int j3 = 3 * preloadJnr[lane];
+                    /* OpenMP atomics are expensive, but this kernels is also
+                     * expensive, so we can take this hit, instead of using
+                     * thread-local output buffers and extra reduction.
+                     *
+                     * All the OpenMP regions in this file are trivial and should
+                     * not throw, so no need for try/catch.
+                     */
 #pragma omp atomic
-                f[j3] -= tX;
+                    f[j3] -= forceBuffer[XX][lane];
 #pragma omp atomic
-                f[j3 + 1] -= tY;
+                    f[j3 + 1] -= forceBuffer[YY][lane];
 #pragma omp atomic
-                f[j3 + 2] -= tZ;
+                    f[j3 + 2] -= forceBuffer[ZZ][lane];
+                }
             }
-        } // end for (int k = nj0; k < nj1; k++)
+        } // end for (int k = nj0; k < nj1; k += simdWidth)
 
         /* The atomics below are expensive with many OpenMP threads.
          * Here unperturbed i-particles will usually only have a few
          * (perturbed) j-particles in the list. Thus with a buffered list
          * we can skip a significant number of i-reductions with a check.
          */
-        if (npair_within_cutoff > 0)
+        if (haveInteractionsWithinCutoff)
         {
-            if (doForces)
+            if (doForces || doShiftForces)
             {
+                const real fIXSum = gmx::reduce(fIX);
+                const real fIYSum = gmx::reduce(fIY);
+                const real fIZSum = gmx::reduce(fIZ);
+                if (doForces)
+                {
 #pragma omp atomic
-                f[ii3] += fIX;
+                    f[ii3] += fIXSum;
 #pragma omp atomic
-                f[ii3 + 1] += fIY;
+                    f[ii3 + 1] += fIYSum;
 #pragma omp atomic
-                f[ii3 + 2] += fIZ;
-            }
-            if (doShiftForces)
-            {
+                    f[ii3 + 2] += fIZSum;
+                }
+                if (doShiftForces)
+                {
 #pragma omp atomic
-                fshift[is3] += fIX;
+                    fshift[is3] += fIXSum;
 #pragma omp atomic
-                fshift[is3 + 1] += fIY;
+                    fshift[is3 + 1] += fIYSum;
 #pragma omp atomic
-                fshift[is3 + 2] += fIZ;
+                    fshift[is3 + 2] += fIZSum;
+                }
             }
             if (doPotential)
             {
                 int ggid = gid[n];
 #pragma omp atomic
-                Vc[ggid] += vCTot;
+                Vc[ggid] += gmx::reduce(vCTot);
 #pragma omp atomic
-                Vv[ggid] += vVTot;
+                Vv[ggid] += gmx::reduce(vVTot);
             }
         }
     } // end for (int n = 0; n < nri; n++)
 
 #pragma omp atomic
-    dvdl[efptCOUL] += dvdlCoul;
+    dvdl[efptCOUL] += gmx::reduce(dvdlCoul);
 #pragma omp atomic
-    dvdl[efptVDW] += dvdlVdw;
+    dvdl[efptVDW] += gmx::reduce(dvdlVdw);
 
     /* Estimate flops, average for free energy stuff:
      * 12  flops per outer iteration
@@ -877,9 +923,8 @@ static KernelFunction dispatchKernelOnUseSimd(const bool useSimd)
 {
     if (useSimd)
     {
-#if GMX_SIMD_HAVE_REAL && GMX_SIMD_HAVE_INT32_ARITHMETICS && GMX_USE_SIMD_KERNELS
-        /* FIXME: Here SimdDataTypes should be used to enable SIMD. So far, the code in nb_free_energy_kernel is not adapted to SIMD */
-        return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
+#if GMX_NB_FREE_ENERGY_HAVE_SIMD && GMX_USE_SIMD_KERNELS
+        return (nb_free_energy_kernel<SimdDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
 #else
         return (nb_free_energy_kernel<ScalarDataTypes, useSoftCore, scLambdasOrAlphasDiffer, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
 #endif
@@ -1027,3 +1072,522 @@ void gmx_nb_free_energy_kernel(const t_nblist*            nlist,
                                 ic);
     kernelFunc(nlist, xx, ff, fr, mdatoms, kernel_data, nrnb);
 }
+
+/*! \brief Templated kernel for the perturbed non-bonded energies at many lambda points
+ *
+ * The pair loop is scalar, all pair quantities that do not depend on lambda
+ * are computed once per pair. The soft-core interactions are then evaluated
+ * for DataTypes::simdRealWidth lambda points at once. Contributions that are
+ * linear in lambda, i.e. the Ewald and reaction-field corrections for excluded
+ * pairs, are summed per state over the whole list and combined per lambda
+ * point at the end.
+ */
+template<typename DataTypes, bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
+static void nb_free_energy_foreign_lambda_kernel(const t_nblist* gmx_restrict nlist,
+                                                 rvec* gmx_restrict        xx,
+                                                 const t_forcerec* gmx_restrict fr,
+                                                 const t_mdatoms* gmx_restrict mdatoms,
+                                                 gmx::ArrayRef<const real> lambdaCoul,
+                                                 gmx::ArrayRef<const real> lambdaVdw,
+                                                 gmx::ArrayRef<real>       energy,
+                                                 gmx::ArrayRef<real>       dvdl,
+                                                 t_nrnb* gmx_restrict nrnb)
+{
+    using RealType = typename DataTypes::RealType;
+    using BoolType = typename DataTypes::BoolType;
+
+    constexpr int simdWidth = DataTypes::simdRealWidth;
+
+    constexpr real oneTwelfth = 1.0 / 12.0;
+    constexpr real oneSixth   = 1.0 / 6.0;
+    constexpr real zero       = 0.0;
+    constexpr real half       = 0.5;
+    constexpr real one        = 1.0;
+
+    const interaction_const_t* ic = fr->ic;
+
+    const int  nri    = nlist->nri;
+    const int* iinr   = nlist->iinr;
+    const int* jindex = nlist->jindex;
+    const int* jjnr   = nlist->jjnr;
+    const int* shift  = nlist->shift;
+
+    const real* shiftvec   = fr->shift_vec[0];
+    const real* chargeA    = mdatoms->chargeA;
+    const real* chargeB    = mdatoms->chargeB;
+    const int*  typeA      = mdatoms->typeA;
+    const int*  typeB      = mdatoms->typeB;
+    const int   ntype      = fr->ntype;
+    const real* nbfp       = fr->nbfp.data();
+    const real* nbfp_grid  = fr->ljpme_c6grid;
+    const auto& scParams   = *ic->softCoreParameters;
+    const real  alpha_coul = scParams.alphaCoulomb;
+    const real  alpha_vdw  = scParams.alphaVdw;
+    const real  lam_power  = scParams.lambdaPower;
+    const real  sigma6_def = scParams.sigma6WithInvalidSigma;
+    const real  sigma6_min = scParams.sigma6Minimum;
+
+    const real facel           = ic->epsfac;
+    const real rCoulomb        = ic->rcoulomb;
+    const real krf             = ic->k_rf;
+    const real crf             = ic->c_rf;
+    const real shLjEwald       = ic->sh_lj_ewald;
+    const real rVdw            = ic->rvdw;
+    const real dispersionShift = ic->dispersion_shift.cpot;
+    const real repulsionShift  = ic->repulsion_shift.cpot;
+
+    real vdw_swV3, vdw_swV4, vdw_swV5, vdw_swF2, vdw_swF3, vdw_swF4;
+    if (vdwModifierIsPotSwitch)
+    {
+        const real d = ic->rvdw - ic->rvdw_switch;
+        vdw_swV3     = -10.0 / (d * d * d);
+        vdw_swV4     = 15.0 / (d * d * d * d);
+        vdw_swV5     = -6.0 / (d * d * d * d * d);
+        vdw_swF2     = -30.0 / (d * d * d);
+        vdw_swF3     = 60.0 / (d * d * d * d);
+        vdw_swF4     = -30.0 / (d * d * d * d * d);
+    }
+    else
+    {
+        vdw_swV3 = vdw_swV4 = vdw_swV5 = vdw_swF2 = vdw_swF3 = vdw_swF4 = 0.0;
+    }
+
+    const bool useReactionField = (ic->eeltype == eelCUT || EEL_RF(ic->eeltype));
+
+    real rcutoff_max2 = std::max(ic->rcoulomb, ic->rvdw);
+    rcutoff_max2      = rcutoff_max2 * rcutoff_max2;
+
+    const real* tab_ewald_F_lj           = nullptr;
+    const real* tab_ewald_V_lj           = nullptr;
+    const real* ewtab                    = nullptr;
+    real        coulombTableScale        = 0;
+    real        coulombTableScaleInvHalf = 0;
+    real        vdwTableScale            = 0;
+    real        vdwTableScaleInvHalf     = 0;
+    real        sh_ewald                 = 0;
+    if (elecInteractionTypeIsEwald || vdwInteractionTypeIsEwald)
+    {
+        sh_ewald = ic->sh_ewald;
+    }
+    if (elecInteractionTypeIsEwald)
+    {
+        const auto& coulombTables = *ic->coulombEwaldTables;
+        ewtab                     = coulombTables.tableFDV0.data();
+        coulombTableScale         = coulombTables.scale;
+        coulombTableScaleInvHalf  = half / coulombTableScale;
+    }
+    if (vdwInteractionTypeIsEwald)
+    {
+        const auto& vdwTables = *ic->vdwEwaldTables;
+        tab_ewald_F_lj        = vdwTables.tableF.data();
+        tab_ewald_V_lj        = vdwTables.tableV.data();
+        vdwTableScale         = vdwTables.scale;
+        vdwTableScaleInvHalf  = half / vdwTableScale;
+    }
+
+    /* Set up the lambda dependent factors for all lambda points, padded
+     * to a multiple of the SIMD width with copies of the first point.
+     */
+    const int numLambdas       = lambdaCoul.ssize();
+    const int numLambdasPadded = ((numLambdas + simdWidth - 1) / simdWidth) * simdWidth;
+
+    constexpr real           DLF[NSTATES] = { -1, 1 };
+    constexpr real           sc_r_power   = 6.0_real;
+    std::array<AlignedVector<real>, NSTATES> LFC, LFV, lFacCoul, dlFacCoul, lFacVdw, dlFacVdw;
+    for (int i = 0; i < NSTATES; i++)
+    {
+        LFC[i].resize(numLambdasPadded);
+        LFV[i].resize(numLambdasPadded);
+        lFacCoul[i].resize(numLambdasPadded);
+        dlFacCoul[i].resize(numLambdasPadded);
+        lFacVdw[i].resize(numLambdasPadded);
+        dlFacVdw[i].resize(numLambdasPadded);
+        for (int l = 0; l < numLambdasPadded; l++)
+        {
+            const int  lambdaIndex = (l < numLambdas ? l : 0);
+            const real lfc = (i == STATE_A ? one - lambdaCoul[lambdaIndex] : lambdaCoul[lambdaIndex]);
+            const real lfv = (i == STATE_A ? one - lambdaVdw[lambdaIndex] : lambdaVdw[lambdaIndex]);
+            LFC[i][l]       = lfc;
+            LFV[i][l]       = lfv;
+            lFacCoul[i][l]  = (lam_power == 2 ? (1 - lfc) * (1 - lfc) : (1 - lfc));
+            dlFacCoul[i][l] = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - lfc) : 1);
+            lFacVdw[i][l]   = (lam_power == 2 ? (1 - lfv) * (1 - lfv) : (1 - lfv));
+            dlFacVdw[i][l]  = DLF[i] * lam_power / sc_r_power * (lam_power == 2 ? (1 - lfv) : 1);
+        }
+    }
+
+    const bool lambdasDiffer = !std::equal(lambdaCoul.begin(), lambdaCoul.end(), lambdaVdw.begin());
+
+    AlignedVector<real> vCoulTot(numLambdasPadded, 0);
+    AlignedVector<real> vVdwTot(numLambdasPadded, 0);
+    AlignedVector<real> dvdlTot(numLambdasPadded, 0);
+
+    /* Sums over the list of the contributions that are linear in lambda */
+    real linearCoul[NSTATES] = { 0 };
+    real linearVdw[NSTATES]  = { 0 };
+
+    const real* x = xx[0];
+
+    const real rlistSquared = gmx::square(fr->rlist);
+
+    int numExcludedPairsBeyondRlist = 0;
+
+    for (int n = 0; n < nri; n++)
+    {
+        const int  is3  = 3 * shift[n];
+        const int  ii   = iinr[n];
+        const int  ii3  = 3 * ii;
+        const real ix   = shiftvec[is3] + x[ii3 + 0];
+        const real iy   = shiftvec[is3 + 1] + x[ii3 + 1];
+        const real iz   = shiftvec[is3 + 2] + x[ii3 + 2];
+        const real iqA  = facel * chargeA[ii];
+        const real iqB  = facel * chargeB[ii];
+        const int  ntiA = 2 * ntype * typeA[ii];
+        const int  ntiB = 2 * ntype * typeB[ii];
+
+        for (int k = jindex[n]; k < jindex[n + 1]; k++)
+        {
+            const int  jnr = jjnr[k];
+            const int  j3  = 3 * jnr;
+            const real dX  = ix - x[j3];
+            const real dY  = iy - x[j3 + 1];
+            const real dZ  = iz - x[j3 + 2];
+            const real rSq = dX * dX + dY * dY + dZ * dZ;
+
+            const bool bPairIncluded = nlist->excl_fep == nullptr || nlist->excl_fep[k];
+
+            if (rSq >= rcutoff_max2 && bPairIncluded)
+            {
+                continue;
+            }
+            if (rSq > rlistSquared)
+            {
+                numExcludedPairsBeyondRlist++;
+            }
+
+            const real rInv = (rSq > 0 ? gmx::invsqrt(rSq) : 0);
+            const real r    = rSq * rInv;
+
+            const int tj[NSTATES] = { ntiA + 2 * typeA[jnr], ntiB + 2 * typeB[jnr] };
+            const real qq[NSTATES] = { iqA * chargeA[jnr], iqB * chargeB[jnr] };
+            /* A self-interaction (ii == jnr) occurs twice, so we scale it by half */
+            const real selfScale = (ii == jnr ? half : one);
+
+            if (bPairIncluded)
+            {
+                const real rpm2 = rSq * rSq;
+                const real rp   = rpm2 * rSq;
+
+                real c6[NSTATES], c12[NSTATES], sigma6[NSTATES];
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    c6[i]  = nbfp[tj[i]];
+                    c12[i] = nbfp[tj[i] + 1];
+                    if ((c6[i] > 0) && (c12[i] > 0))
+                    {
+                        sigma6[i] = std::max(half * c12[i] / c6[i], sigma6_min);
+                    }
+                    else
+                    {
+                        sigma6[i] = sigma6_def;
+                    }
+                }
+
+                /* only use softcore if one of the states has a zero endstate - softcore is for avoiding infinities!*/
+                const bool useSoftCoreForPair = !((c12[STATE_A] > 0) && (c12[STATE_B] > 0));
+                const real alphaVdwEff        = useSoftCoreForPair ? alpha_vdw : 0;
+                const real alphaCoulEff       = useSoftCoreForPair ? alpha_coul : 0;
+                const bool alphasDiffer       = (alphaVdwEff != alphaCoulEff);
+
+                for (int l = 0; l < numLambdasPadded; l += simdWidth)
+                {
+                    RealType vCoulSum = zero;
+                    RealType vVdwSum  = zero;
+                    RealType dvdlSum  = zero;
+
+                    for (int i = 0; i < NSTATES; i++)
+                    {
+                        /* Only spend time on A or B state if it is non-zero */
+                        if (qq[i] == 0 && c6[i] == 0 && c12[i] == 0)
+                        {
+                            continue;
+                        }
+
+                        const RealType lfc = gmx::load<RealType>(LFC[i].data() + l);
+                        const RealType lfv = gmx::load<RealType>(LFV[i].data() + l);
+
+                        RealType rInvC, rC, rInvV, rV;
+
+                        const RealType rPInvC =
+                                gmx::inv(alphaCoulEff * gmx::load<RealType>(lFacCoul[i].data() + l) * sigma6[i] + rp);
+                        pthRoot(rPInvC, &rInvC, &rC, RealType(zero) < rPInvC);
+                        RealType rPInvV;
+                        if (alphasDiffer || lambdasDiffer)
+                        {
+                            rPInvV = gmx::inv(alphaVdwEff * gmx::load<RealType>(lFacVdw[i].data() + l) * sigma6[i] + rp);
+                            pthRoot(rPInvV, &rInvV, &rV, RealType(zero) < rPInvV);
+                        }
+                        else
+                        {
+                            rPInvV = rPInvC;
+                            rInvV  = rInvC;
+                            rV     = rC;
+                        }
+
+                        RealType vCoul  = zero;
+                        RealType fScalC = zero;
+                        if (qq[i] != 0)
+                        {
+                            const BoolType computeElecInteraction =
+                                    (elecInteractionTypeIsEwald ? RealType(r) : rC) < RealType(rCoulomb);
+                            if (elecInteractionTypeIsEwald)
+                            {
+                                vCoul  = ewaldPotential(RealType(qq[i]), rInvC, sh_ewald);
+                                fScalC = ewaldScalarForce(RealType(qq[i]), rInvC);
+                            }
+                            else
+                            {
+                                vCoul  = reactionFieldPotential(RealType(qq[i]), rInvC, rC, krf, crf);
+                                fScalC = reactionFieldScalarForce(RealType(qq[i]), rInvC, rC, krf, real(2));
+                            }
+                            vCoul  = gmx::selectByMask(vCoul, computeElecInteraction);
+                            fScalC = gmx::selectByMask(fScalC * rPInvC, computeElecInteraction);
+                        }
+
+                        RealType vVdw   = zero;
+                        RealType fScalV = zero;
+                        if (c6[i] != 0 || c12[i] != 0)
+                        {
+                            const BoolType computeVdwInteraction =
+                                    (vdwInteractionTypeIsEwald ? RealType(r) : rV) < RealType(rVdw);
+                            const RealType vVdw6  = calculateVdw6(RealType(c6[i]), rPInvV);
+                            const RealType vVdw12 = calculateVdw12(RealType(c12[i]), rPInvV);
+
+                            vVdw   = lennardJonesPotential(vVdw6,
+                                                         vVdw12,
+                                                         RealType(c6[i]),
+                                                         RealType(c12[i]),
+                                                         repulsionShift,
+                                                         dispersionShift,
+                                                         oneSixth,
+                                                         oneTwelfth);
+                            fScalV = lennardJonesScalarForce(vVdw6, vVdw12);
+
+                            if (vdwInteractionTypeIsEwald)
+                            {
+                                /* Subtract the grid potential at the cut-off */
+                                vVdw = vVdw
+                                       + ewaldLennardJonesGridSubtract(
+                                               RealType(nbfp_grid[tj[i]]), shLjEwald, oneSixth);
+                            }
+
+                            if (vdwModifierIsPotSwitch)
+                            {
+                                const RealType d  = gmx::max(rV - ic->rvdw_switch, zero);
+                                const RealType d2 = d * d;
+                                const RealType sw =
+                                        one + d2 * d * (vdw_swV3 + d * (vdw_swV4 + d * vdw_swV5));
+                                const RealType dsw = d2 * (vdw_swF2 + d * (vdw_swF3 + d * vdw_swF4));
+
+                                fScalV = potSwitchScalarForceMod(
+                                        fScalV, vVdw, sw, rV, dsw, computeVdwInteraction);
+                                vVdw = potSwitchPotentialMod(vVdw, sw, computeVdwInteraction);
+                            }
+                            vVdw   = gmx::selectByMask(vVdw, computeVdwInteraction);
+                            fScalV = gmx::selectByMask(fScalV * rPInvV, computeVdwInteraction);
+                        }
+
+                        vCoulSum = vCoulSum + lfc * vCoul;
+                        vVdwSum  = vVdwSum + lfv * vVdw;
+                        dvdlSum  = dvdlSum + (vCoul + vVdw) * DLF[i]
+                                  + lfc * alphaCoulEff * gmx::load<RealType>(dlFacCoul[i].data() + l)
+                                            * fScalC * sigma6[i]
+                                  + lfv * alphaVdwEff * gmx::load<RealType>(dlFacVdw[i].data() + l)
+                                            * fScalV * sigma6[i];
+                    }
+
+                    gmx::store(vCoulTot.data() + l, gmx::load<RealType>(vCoulTot.data() + l) + vCoulSum);
+                    gmx::store(vVdwTot.data() + l, gmx::load<RealType>(vVdwTot.data() + l) + vVdwSum);
+                    gmx::store(dvdlTot.data() + l, gmx::load<RealType>(dvdlTot.data() + l) + dvdlSum);
+                }
+            }
+            else if (useReactionField)
+            {
+                /* For excluded pairs we don't use soft-core */
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    linearCoul[i] += qq[i] * (krf * rSq - crf) * selfScale;
+                }
+            }
+
+            if (elecInteractionTypeIsEwald && (r < rCoulomb || !bPairIncluded))
+            {
+                /* Subtract the reciprocal-space Ewald component, see nb_free_energy_kernel */
+                const real ewrt   = r * coulombTableScale;
+                const int  ewitab = 4 * static_cast<int>(ewrt);
+                const real eweps  = ewrt - static_cast<int>(ewrt);
+                const real f_lr   = ewtab[ewitab] + eweps * ewtab[ewitab + 1];
+                const real v_lr =
+                        (ewtab[ewitab + 2] - coulombTableScaleInvHalf * eweps * (ewtab[ewitab] + f_lr))
+                        * selfScale;
+
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    linearCoul[i] -= qq[i] * v_lr;
+                }
+            }
+
+            if (vdwInteractionTypeIsEwald && (r < rVdw || !bPairIncluded))
+            {
+                /* Subtract the reciprocal-space LJ-Ewald component, see nb_free_energy_kernel */
+                const real rs   = r * vdwTableScale;
+                const int  ri   = static_cast<int>(rs);
+                const real frac = rs - ri;
+                const real f_lr = (1 - frac) * tab_ewald_F_lj[ri] + frac * tab_ewald_F_lj[ri + 1];
+                const real VV =
+                        (tab_ewald_V_lj[ri] - vdwTableScaleInvHalf * frac * (tab_ewald_F_lj[ri] + f_lr))
+                        * oneSixth * selfScale;
+
+                for (int i = 0; i < NSTATES; i++)
+                {
+                    linearVdw[i] += nbfp_grid[tj[i]] * VV;
+                }
+            }
+        }
+    }
+
+    /* Add the results, including the linear contributions, to the output */
+    for (int l = 0; l < numLambdas; l++)
+    {
+        real energyLambda = vCoulTot[l] + vVdwTot[l];
+        real dvdlLambda   = dvdlTot[l];
+        for (int i = 0; i < NSTATES; i++)
+        {
+            energyLambda += LFC[i][l] * linearCoul[i] + LFV[i][l] * linearVdw[i];
+            dvdlLambda += DLF[i] * (linearCoul[i] + linearVdw[i]);
+        }
+#pragma omp atomic
+        energy[l] += energyLambda;
+#pragma omp atomic
+        dvdl[l] += dvdlLambda;
+    }
+
+    /* Estimate flops, we count the same as the full kernel for each chunk of lambda points */
+#pragma omp atomic
+    inc_nrnb(nrnb,
+             eNR_NBKERNEL_FREE_ENERGY,
+             (nlist->nri * 12 + nlist->jindex[nri] * 150) * (numLambdasPadded / simdWidth));
+
+    if (numExcludedPairsBeyondRlist > 0)
+    {
+        gmx_fatal(FARGS,
+                  "There are %d perturbed non-bonded pair interactions beyond the pair-list cutoff "
+                  "of %g nm, which is not supported. This can happen because the system is "
+                  "unstable or because intra-molecular interactions at long distances are "
+                  "excluded. If the "
+                  "latter is the case, you can try to increase nstlist or rlist to avoid this."
+                  "The error is likely triggered by the use of couple-intramol=no "
+                  "and the maximal distance in the decoupled molecule exceeding rlist.",
+                  numExcludedPairsBeyondRlist,
+                  fr->rlist);
+    }
+}
+
+typedef void (*ForeignLambdaKernelFunction)(const t_nblist* gmx_restrict nlist,
+                                            rvec* gmx_restrict        xx,
+                                            const t_forcerec* gmx_restrict fr,
+                                            const t_mdatoms* gmx_restrict mdatoms,
+                                            gmx::ArrayRef<const real> lambdaCoul,
+                                            gmx::ArrayRef<const real> lambdaVdw,
+                                            gmx::ArrayRef<real>       energy,
+                                            gmx::ArrayRef<real>       dvdl,
+                                            t_nrnb* gmx_restrict nrnb);
+
+template<bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald, bool vdwModifierIsPotSwitch>
+static ForeignLambdaKernelFunction dispatchForeignLambdaKernelOnUseSimd(const bool useSimd)
+{
+    if (useSimd)
+    {
+#if GMX_NB_FREE_ENERGY_HAVE_SIMD && GMX_USE_SIMD_KERNELS
+        return (nb_free_energy_foreign_lambda_kernel<SimdDataTypes, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
+#else
+        return (nb_free_energy_foreign_lambda_kernel<ScalarDataTypes, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
+#endif
+    }
+    else
+    {
+        return (nb_free_energy_foreign_lambda_kernel<ScalarDataTypes, vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, vdwModifierIsPotSwitch>);
+    }
+}
+
+template<bool vdwInteractionTypeIsEwald, bool elecInteractionTypeIsEwald>
+static ForeignLambdaKernelFunction dispatchForeignLambdaKernelOnVdwModifier(const bool vdwModifierIsPotSwitch,
+                                                                            const bool useSimd)
+{
+    if (vdwModifierIsPotSwitch)
+    {
+        return (dispatchForeignLambdaKernelOnUseSimd<vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, true>(
+                useSimd));
+    }
+    else
+    {
+        return (dispatchForeignLambdaKernelOnUseSimd<vdwInteractionTypeIsEwald, elecInteractionTypeIsEwald, false>(
+                useSimd));
+    }
+}
+
+template<bool vdwInteractionTypeIsEwald>
+static ForeignLambdaKernelFunction dispatchForeignLambdaKernelOnElecInteractionType(const bool elecInteractionTypeIsEwald,
+                                                                                    const bool vdwModifierIsPotSwitch,
+                                                                                    const bool useSimd)
+{
+    if (elecInteractionTypeIsEwald)
+    {
+        return (dispatchForeignLambdaKernelOnVdwModifier<vdwInteractionTypeIsEwald, true>(
+                vdwModifierIsPotSwitch, useSimd));
+    }
+    else
+    {
+        return (dispatchForeignLambdaKernelOnVdwModifier<vdwInteractionTypeIsEwald, false>(
+                vdwModifierIsPotSwitch, useSimd));
+    }
+}
+
+void gmx_nb_free_energy_foreign_lambda_kernel(const t_nblist*           nlist,
+                                              rvec*                     xx,
+                                              const t_forcerec*         fr,
+                                              const t_mdatoms*          mdatoms,
+                                              gmx::ArrayRef<const real> lambdaCoul,
+                                              gmx::ArrayRef<const real> lambdaVdw,
+                                              gmx::ArrayRef<real>       energy,
+                                              gmx::ArrayRef<real>       dvdl,
+                                              t_nrnb*                   nrnb)
+{
+    const interaction_const_t& ic = *fr->ic;
+    GMX_ASSERT(EEL_PME_EWALD(ic.eeltype) || ic.eeltype == eelCUT || EEL_RF(ic.eeltype),
+               "Unsupported eeltype with free energy");
+    GMX_ASSERT(ic.softCoreParameters, "We need soft-core parameters");
+    GMX_ASSERT(lambdaCoul.size() == lambdaVdw.size() && energy.size() >= lambdaCoul.size()
+                       && dvdl.size() >= lambdaCoul.size(),
+               "We need lambda values and outputs for all lambda points");
+    GMX_RELEASE_ASSERT(!(EVDW_PME(ic.vdwtype) && ic.vdw_modifier == eintmodPOTSWITCH),
+                       "Can not apply soft-core to switched Ewald potentials");
+
+    if (lambdaCoul.empty())
+    {
+        return;
+    }
+
+    ForeignLambdaKernelFunction kernelFunc;
+    if (EVDW_PME(ic.vdwtype))
+    {
+        kernelFunc = dispatchForeignLambdaKernelOnElecInteractionType<true>(
+                EEL_PME_EWALD(ic.eeltype), ic.vdw_modifier == eintmodPOTSWITCH, fr->use_simd_kernels);
+    }
+    else
+    {
+        kernelFunc = dispatchForeignLambdaKernelOnElecInteractionType<false>(
+                EEL_PME_EWALD(ic.eeltype), ic.vdw_modifier == eintmodPOTSWITCH, fr->use_simd_kernels);
+    }
+    kernelFunc(nlist, xx, fr, mdatoms, lambdaCoul, lambdaVdw, energy, dvdl, nrnb);
+}
@@ -42,6 +42,8 @@
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/nblist.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
 
 struct t_forcerec;
 struct t_mdatoms;
@@ -58,4 +60,24 @@ void gmx_nb_free_energy_kernel(const t_nblist* gmx_restrict nlist,
                                nb_kernel_data_t* gmx_restrict kernel_data,
                                t_nrnb* gmx_restrict nrnb);
 
+/*! \brief Computes the perturbed non-bonded energies at multiple lambda points in one pass
+ *
+ * This is used for foreign lambda energies with soft-core interactions, which
+ * are not linear in lambda. Distances, parameters and exclusions are computed
+ * once per pair and reused for all lambda points.
+ * The potential energy and dV/dlambda, both summed over Coulomb and Van der Waals,
+ * of lambda point \p l with Coulomb and VdW lambda values \p lambdaCoul[l] and
+ * \p lambdaVdw[l] are added to \p energy[l] and \p dvdl[l] using atomics.
+ * This function may be called concurrently for different lists.
+ */
+void gmx_nb_free_energy_foreign_lambda_kernel(const t_nblist* gmx_restrict nlist,
+                                              rvec* gmx_restrict        xx,
+                                              const t_forcerec* gmx_restrict fr,
+                                              const t_mdatoms* gmx_restrict mdatoms,
+                                              gmx::ArrayRef<const real> lambdaCoul,
+                                              gmx::ArrayRef<const real> lambdaVdw,
+                                              gmx::ArrayRef<real>       energy,
+                                              gmx::ArrayRef<real>       dvdl,
+                                              t_nrnb* gmx_restrict nrnb);
+
 #endif
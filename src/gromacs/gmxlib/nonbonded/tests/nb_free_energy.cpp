@@ -0,0 +1,488 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the perturbed non-bonded kernels against the scalar reference kernel
+ *
+ * The reference is the free-energy kernel with SIMD kernels disabled.
+ * The SIMD kernel and the foreign lambda kernel should reproduce its
+ * forces, energies and dV/dlambda within rounding.
+ *
+ * \ingroup module_gmxlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/gmxlib/nonbonded/nb_kernel.h"
+#include "gromacs/gmxlib/nonbonded/nonbonded.h"
+#include "gromacs/math/functions.h"
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdtypes/forceoutput.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/nblist.h"
+#include "gromacs/pbcutil/ishift.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The Van der Waals setups that are tested
+enum class VdwSetup
+{
+    PotentialShift,
+    PotentialSwitch,
+    LJPme
+};
+
+//! Parameters: Coulomb type, Van der Waals setup, soft-core alpha
+using FreeEnergyKernelParameters = std::tuple<int, VdwSetup, real>;
+
+//! The number of atoms in the test system
+constexpr int c_numAtoms = 37;
+//! The number of perturbed atoms, these are the i-atoms of the pair list
+constexpr int c_numPerturbedAtoms = 5;
+//! The number of atom types
+constexpr int c_numTypes = 3;
+
+//! The kernel outputs that are compared
+struct KernelOutput
+{
+    //! Forces on all atoms
+    PaddedVector<RVec> forces;
+    //! Shift forces
+    std::vector<RVec> shiftForces;
+    //! Coulomb energy
+    real vCoulomb = 0;
+    //! Van der Waals energy
+    real vVdw = 0;
+    //! dV/dlambda for Coulomb and Van der Waals
+    real dvdl[efptNR] = { 0 };
+};
+
+/*! \brief A small system with perturbed atoms and all the data the kernels need
+ *
+ * The pair list has the perturbed atoms as i-atoms. Each list contains the
+ * self-pair and all atoms with a higher index, so the lists have different
+ * lengths around the SIMD width and many pairs are beyond the cut-off.
+ * A few close pairs are excluded.
+ */
+class FreeEnergyKernelSystem
+{
+public:
+    FreeEnergyKernelSystem(int eeltype, VdwSetup vdwSetup, real scAlpha)
+    {
+        const real cutoff = 0.9;
+
+        interactionConst_.rcoulomb = cutoff;
+        interactionConst_.rvdw     = cutoff;
+        interactionConst_.epsfac   = 138.935458;
+        interactionConst_.eeltype  = eeltype;
+        if (eeltype == eelPME)
+        {
+            interactionConst_.coulomb_modifier = eintmodPOTSHIFT;
+            interactionConst_.ewaldcoeff_q     = 3.47;
+            interactionConst_.sh_ewald =
+                    std::erfc(interactionConst_.ewaldcoeff_q * cutoff) / cutoff;
+        }
+        else
+        {
+            interactionConst_.epsilon_rf = 62;
+            interactionConst_.k_rf       = 0.5 * (62 - 1) / (2 * 62 + 1) / gmx::power3(cutoff);
+            interactionConst_.c_rf       = 1 / cutoff + interactionConst_.k_rf * cutoff * cutoff;
+        }
+        switch (vdwSetup)
+        {
+            case VdwSetup::PotentialShift:
+                interactionConst_.vdw_modifier          = eintmodPOTSHIFT;
+                interactionConst_.dispersion_shift.cpot = -1.0 / gmx::power6(cutoff);
+                interactionConst_.repulsion_shift.cpot  = -1.0 / gmx::power12(cutoff);
+                break;
+            case VdwSetup::PotentialSwitch:
+                interactionConst_.vdw_modifier = eintmodPOTSWITCH;
+                interactionConst_.rvdw_switch  = 0.7;
+                break;
+            case VdwSetup::LJPme:
+            {
+                interactionConst_.vdwtype               = evdwPME;
+                interactionConst_.vdw_modifier          = eintmodPOTSHIFT;
+                interactionConst_.ewaldcoeff_lj         = 2.6;
+                interactionConst_.dispersion_shift.cpot = -1.0 / gmx::power6(cutoff);
+                interactionConst_.repulsion_shift.cpot  = -1.0 / gmx::power12(cutoff);
+                const real br2 = gmx::square(interactionConst_.ewaldcoeff_lj * cutoff);
+                interactionConst_.sh_lj_ewald =
+                        (std::exp(-br2) * (1 + br2 + 0.5 * br2 * br2) - 1) / gmx::power6(cutoff);
+                break;
+            }
+        }
+
+        t_lambda fepvals     = {};
+        fepvals.sc_alpha     = scAlpha;
+        fepvals.sc_power     = 1;
+        fepvals.sc_r_power   = 6;
+        fepvals.sc_sigma     = 0.3;
+        fepvals.sc_sigma_min = 0.3;
+        fepvals.bScCoul      = TRUE;
+        interactionConst_.softCoreParameters =
+                std::make_unique<interaction_const_t::SoftCoreParameters>(fepvals);
+
+        interactionConst_.coulombEwaldTables = std::make_unique<EwaldCorrectionTables>();
+        interactionConst_.vdwEwaldTables     = std::make_unique<EwaldCorrectionTables>();
+        forcerec_.rlist                      = cutoff + 0.1;
+        init_interaction_const_tables(nullptr, &interactionConst_, forcerec_.rlist, 0);
+
+        forcerec_.ic = &interactionConst_;
+        snew(forcerec_.shift_vec, SHIFTS);
+
+        /* Type 2 has zero LJ parameters, which triggers the default soft-core sigma */
+        const real c6[c_numTypes]  = { 0.0026, 0.0012, 0 };
+        const real c12[c_numTypes] = { 2.6e-6, 1.2e-6, 0 };
+        forcerec_.ntype            = c_numTypes;
+        forcerec_.nbfp.resize(2 * c_numTypes * c_numTypes);
+        c6Grid_.resize(2 * c_numTypes * c_numTypes);
+        for (int ti = 0; ti < c_numTypes; ti++)
+        {
+            for (int tj = 0; tj < c_numTypes; tj++)
+            {
+                const int index           = 2 * (c_numTypes * ti + tj);
+                forcerec_.nbfp[index]     = 6 * std::sqrt(c6[ti] * c6[tj]);
+                forcerec_.nbfp[index + 1] = 12 * std::sqrt(c12[ti] * c12[tj]);
+                c6Grid_[index]            = forcerec_.nbfp[index];
+            }
+        }
+        forcerec_.ljpme_c6grid = c6Grid_.data();
+
+        generateAtoms();
+        generatePairList();
+    }
+
+    //! Runs the free-energy kernel and returns its output
+    KernelOutput runKernel(bool useSimd, real lambdaCoulomb, real lambdaVdw)
+    {
+        forcerec_.use_simd_kernels = useSimd;
+
+        KernelOutput output;
+        output.forces.resizeWithPadding(c_numAtoms);
+        std::fill(output.forces.begin(), output.forces.end(), RVec{ 0, 0, 0 });
+        output.shiftForces.resize(SHIFTS, { 0, 0, 0 });
+        ForceWithShiftForces forceWithShiftForces(
+                output.forces.arrayRefWithPadding(), true, output.shiftForces);
+
+        real lambda[efptNR] = { 0 };
+        lambda[efptCOUL]    = lambdaCoulomb;
+        lambda[efptVDW]     = lambdaVdw;
+
+        nb_kernel_data_t kernelData = {};
+        kernelData.flags = (GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE
+                            | GMX_NONBONDED_DO_POTENTIAL);
+
+        kernelData.lambda         = lambda;
+        kernelData.dvdl           = output.dvdl;
+        kernelData.energygrp_elec = &output.vCoulomb;
+        kernelData.energygrp_vdw  = &output.vVdw;
+
+        t_nrnb nrnb;
+        gmx_nb_free_energy_kernel(&nlist_, as_rvec_array(x_.data()), &forceWithShiftForces,
+                                  &forcerec_, &mdatoms_, &kernelData, &nrnb);
+
+        return output;
+    }
+
+    //! Runs the foreign lambda kernel, returns the energies and adds dV/dlambda to \p dvdl
+    std::vector<real> runForeignLambdaKernel(bool                 useSimd,
+                                             ArrayRef<const real> lambdaCoulomb,
+                                             ArrayRef<const real> lambdaVdw,
+                                             std::vector<real>*   dvdl)
+    {
+        forcerec_.use_simd_kernels = useSimd;
+
+        std::vector<real> energy(lambdaCoulomb.size(), 0);
+        dvdl->assign(lambdaCoulomb.size(), 0);
+
+        t_nrnb nrnb;
+        gmx_nb_free_energy_foreign_lambda_kernel(&nlist_, as_rvec_array(x_.data()), &forcerec_,
+                                                 &mdatoms_, lambdaCoulomb, lambdaVdw, energy,
+                                                 *dvdl, &nrnb);
+
+        return energy;
+    }
+
+private:
+    //! Generates coordinates, charges and types
+    void generateAtoms()
+    {
+        ThreeFry2x64<64>              rng(123456, RandomDomain::Other);
+        UniformRealDistribution<real> dist;
+
+        /* Generate random coordinates with a minimum distance between atoms,
+         * apart from the pairs 0-1 and 2-3 which are excluded and close.
+         */
+        const real boxSize     = 1.5;
+        const real minDistance = 0.22;
+        x_.resizeWithPadding(c_numAtoms);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            if (a == 1 || a == 3)
+            {
+                x_[a] = x_[a - 1] + RVec{ 0.1, 0.05, -0.03 };
+                continue;
+            }
+            bool accepted = false;
+            while (!accepted)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    x_[a][d] = boxSize * dist(rng);
+                }
+                accepted = true;
+                for (int b = 0; b < a; b++)
+                {
+                    accepted = accepted && (norm(x_[a] - x_[b]) >= minDistance);
+                }
+            }
+        }
+
+        chargeA_.resize(c_numAtoms);
+        chargeB_.resize(c_numAtoms);
+        typeA_.resize(c_numAtoms);
+        typeB_.resize(c_numAtoms);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            chargeA_[a] = 1.6 * dist(rng) - 0.8;
+            chargeB_[a] = chargeA_[a];
+            typeA_[a]   = a % 2;
+            typeB_[a]   = typeA_[a];
+        }
+        /* Perturb both charges and types, including decoupling to zero */
+        for (int a = 0; a < c_numPerturbedAtoms; a++)
+        {
+            chargeB_[a] = (a % 2 == 0) ? 0 : -0.5 * chargeA_[a];
+            typeB_[a]   = (a % 3 == 0) ? 2 : 1 - typeA_[a];
+        }
+
+        mdatoms_.nr      = c_numAtoms;
+        mdatoms_.homenr  = c_numAtoms;
+        mdatoms_.chargeA = chargeA_.data();
+        mdatoms_.chargeB = chargeB_.data();
+        mdatoms_.typeA   = typeA_.data();
+        mdatoms_.typeB   = typeB_.data();
+    }
+
+    //! Generates a pair list with the perturbed atoms as i-atoms
+    void generatePairList()
+    {
+        jindex_.push_back(0);
+        for (int i = 0; i < c_numPerturbedAtoms; i++)
+        {
+            iinr_.push_back(i);
+            shift_.push_back(CENTRAL);
+            gid_.push_back(0);
+            for (int j = i; j < c_numAtoms; j++)
+            {
+                const bool excluded = (j == i || (i == 0 && j == 1) || (i == 2 && j == 3));
+                jjnr_.push_back(j);
+                exclFep_.push_back(excluded ? 0 : 1);
+            }
+            jindex_.push_back(jjnr_.size());
+        }
+
+        nlist_.nri      = iinr_.size();
+        nlist_.maxnri   = iinr_.size();
+        nlist_.nrj      = jjnr_.size();
+        nlist_.maxnrj   = jjnr_.size();
+        nlist_.iinr     = iinr_.data();
+        nlist_.shift    = shift_.data();
+        nlist_.gid      = gid_.data();
+        nlist_.jindex   = jindex_.data();
+        nlist_.jjnr     = jjnr_.data();
+        nlist_.excl_fep = exclFep_.data();
+    }
+
+    interaction_const_t interactionConst_;
+    t_forcerec          forcerec_;
+    t_mdatoms           mdatoms_ = {};
+    t_nblist            nlist_   = {};
+    std::vector<real>   c6Grid_;
+    PaddedVector<RVec>  x_;
+    std::vector<real>   chargeA_;
+    std::vector<real>   chargeB_;
+    std::vector<int>    typeA_;
+    std::vector<int>    typeB_;
+    std::vector<int>    iinr_;
+    std::vector<int>    shift_;
+    std::vector<int>    gid_;
+    std::vector<int>    jindex_;
+    std::vector<int>    jjnr_;
+    std::vector<char>   exclFep_;
+};
+
+//! Returns a tolerance relative to \p magnitude that allows for differences in summation order
+FloatingPointTolerance kernelTolerance(real magnitude)
+{
+    return relativeToleranceAsFloatingPoint(std::max(magnitude, real(1)),
+                                            GMX_DOUBLE ? 1e-10 : 2e-5);
+}
+
+class FreeEnergyKernelTest : public ::testing::TestWithParam<FreeEnergyKernelParameters>
+{
+};
+
+TEST_P(FreeEnergyKernelTest, SimdKernelMatchesReference)
+{
+    const auto [eeltype, vdwSetup, scAlpha] = GetParam();
+    FreeEnergyKernelSystem system(eeltype, vdwSetup, scAlpha);
+
+    /* Equal and different lambdas select different kernel flavors */
+    for (const auto& lambdas :
+         { std::pair<real, real>(0.35, 0.65), std::pair<real, real>(0.5, 0.5) })
+    {
+        SCOPED_TRACE(formatString("lambda coul %g vdw %g", lambdas.first, lambdas.second));
+
+        const KernelOutput reference = system.runKernel(false, lambdas.first, lambdas.second);
+        const KernelOutput simd      = system.runKernel(true, lambdas.first, lambdas.second);
+
+        real maxForce = 0;
+        for (const RVec& f : reference.forces)
+        {
+            maxForce = std::max(maxForce, norm(f));
+        }
+        /* Check that the system actually interacts and is perturbed */
+        EXPECT_GT(maxForce, 0);
+        EXPECT_NE(reference.dvdl[efptCOUL], 0);
+        EXPECT_NE(reference.dvdl[efptVDW], 0);
+
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_REAL_EQ_TOL(
+                        reference.forces[a][d], simd.forces[a][d], kernelTolerance(maxForce))
+                        << "atom " << a << " dim " << d;
+            }
+        }
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(reference.shiftForces[CENTRAL][d],
+                               simd.shiftForces[CENTRAL][d],
+                               kernelTolerance(maxForce));
+        }
+        EXPECT_REAL_EQ_TOL(
+                reference.vCoulomb, simd.vCoulomb, kernelTolerance(std::abs(reference.vCoulomb)));
+        EXPECT_REAL_EQ_TOL(reference.vVdw, simd.vVdw, kernelTolerance(std::abs(reference.vVdw)));
+        for (int i : { efptCOUL, efptVDW })
+        {
+            EXPECT_REAL_EQ_TOL(
+                    reference.dvdl[i], simd.dvdl[i], kernelTolerance(std::abs(reference.dvdl[i])));
+        }
+    }
+}
+
+TEST_P(FreeEnergyKernelTest, ForeignLambdaKernelMatchesReference)
+{
+    const auto [eeltype, vdwSetup, scAlpha] = GetParam();
+    FreeEnergyKernelSystem system(eeltype, vdwSetup, scAlpha);
+
+    /* Use more lambda points than the SIMD width, with a tail */
+    const int         numLambdas = 19;
+    std::vector<real> lambdaCoulomb;
+    std::vector<real> lambdaVdw;
+    for (int l = 0; l < numLambdas; l++)
+    {
+        lambdaCoulomb.push_back(l / real(numLambdas - 1));
+        lambdaVdw.push_back(((7 * l) % numLambdas) / real(numLambdas - 1));
+    }
+
+    for (bool useSimd : { false, true })
+    {
+        SCOPED_TRACE(useSimd ? "SIMD" : "plain C++");
+
+        std::vector<real>       dvdl;
+        const std::vector<real> energy =
+                system.runForeignLambdaKernel(useSimd, lambdaCoulomb, lambdaVdw, &dvdl);
+
+        for (int l = 0; l < numLambdas; l++)
+        {
+            const KernelOutput reference = system.runKernel(false, lambdaCoulomb[l], lambdaVdw[l]);
+            const real referenceEnergy   = reference.vCoulomb + reference.vVdw;
+            const real referenceDvdl     = reference.dvdl[efptCOUL] + reference.dvdl[efptVDW];
+
+            const real energyMagnitude = std::abs(reference.vCoulomb) + std::abs(reference.vVdw);
+            const real dvdlMagnitude =
+                    std::abs(reference.dvdl[efptCOUL]) + std::abs(reference.dvdl[efptVDW]);
+
+            EXPECT_REAL_EQ_TOL(referenceEnergy, energy[l], kernelTolerance(energyMagnitude))
+                    << "lambda point " << l;
+            EXPECT_REAL_EQ_TOL(referenceDvdl, dvdl[l], kernelTolerance(dvdlMagnitude))
+                    << "lambda point " << l;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Kernels,
+                        FreeEnergyKernelTest,
+                        ::testing::Combine(::testing::Values(eelRF, eelPME),
+                                           ::testing::Values(VdwSetup::PotentialShift,
+                                                             VdwSetup::PotentialSwitch,
+                                                             VdwSetup::LJPme),
+                                           ::testing::Values(real(0), real(0.3))));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -2226,18 +2226,19 @@ rbdihs(int             nbonds,
 
 
 template<BondedKernelFlavor flavor>
-real idihs(int             nbonds,
-           const t_iatom   forceatoms[],
-           const t_iparams forceparams[],
-           const rvec      x[],
-           rvec4           f[],
-           rvec            fshift[],
-           const t_pbc*    pbc,
-           real            lambda,
-           real*           dvdlambda,
-           const t_mdatoms gmx_unused* md,
-           t_fcdata gmx_unused* fcd,
-           int gmx_unused* global_atom_index)
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec            fshift[],
+      const t_pbc*    pbc,
+      real            lambda,
+      real*           dvdlambda,
+      const t_mdatoms gmx_unused* md,
+      t_fcdata gmx_unused* fcd,
+      int gmx_unused* global_atom_index)
 {
     int  i, type, ai, aj, ak, al;
     int  t1, t2, t3;
@@ -2293,6 +2294,111 @@ real idihs(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As idihs above, but using SIMD to calculate multiple dihedrals at once.
+ * This routine does not calculate energies and shift forces.
+ */
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+idihs(int             nbonds,
+      const t_iatom   forceatoms[],
+      const t_iparams forceparams[],
+      const rvec      x[],
+      rvec4           f[],
+      rvec gmx_unused fshift[],
+      const t_pbc*    pbc,
+      real gmx_unused lambda,
+      real gmx_unused* dvdlambda,
+      const t_mdatoms gmx_unused* md,
+      t_fcdata gmx_unused* fcd,
+      int gmx_unused* global_atom_index)
+{
+    constexpr int                            nfa1 = 5;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t al[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         coeff[2 * GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+
+    const SimdReal deg2rad_S(DEG2RAD);
+    const SimdReal twoPi_S(2 * M_PI);
+    const SimdReal invTwoPi_S(1 / (2 * M_PI));
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    /* nbonds is the number of dihedrals times nfa1, here we step GMX_SIMD_REAL_WIDTH dihs */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms quadruplets for GMX_SIMD_REAL_WIDTH dihedrals.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            ak[s]          = forceatoms[iu + 3];
+            al[s]          = forceatoms[iu + 4];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                coeff[s]                       = forceparams[type].harmonic.krA;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = forceparams[type].harmonic.rA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                coeff[s]                       = 0;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = 0;
+            }
+        }
+
+        SimdReal phi_S, p_S, q_S;
+        SimdReal mx_S, my_S, mz_S;
+        SimdReal nx_S, ny_S, nz_S;
+        SimdReal nrkj_m2_S, nrkj_n2_S;
+
+        /* Calculate GMX_SIMD_REAL_WIDTH dihedral angles at once */
+        dih_angle_simd(
+                x, ai, aj, ak, al, pbc_simd, &phi_S, &mx_S, &my_S, &mz_S, &nx_S, &ny_S, &nz_S, &nrkj_m2_S, &nrkj_n2_S, &p_S, &q_S);
+
+        const SimdReal k_S    = load<SimdReal>(coeff);
+        const SimdReal phi0_S = load<SimdReal>(coeff + GMX_SIMD_REAL_WIDTH) * deg2rad_S;
+
+        /* As make_dp_periodic(), put phi - phi0 in the range (-pi,pi) */
+        SimdReal dp_S = phi_S - phi0_S;
+        dp_S          = fnma(twoPi_S, round(dp_S * invTwoPi_S), dp_S);
+
+        const SimdReal mddphi_S = -k_S * dp_S;
+        const SimdReal sf_i_S   = mddphi_S * nrkj_m2_S;
+        const SimdReal msf_l_S  = mddphi_S * nrkj_n2_S;
+
+        /* After this m?_S will contain f[i] */
+        mx_S = sf_i_S * mx_S;
+        my_S = sf_i_S * my_S;
+        mz_S = sf_i_S * mz_S;
+
+        /* After this m?_S will contain -f[l] */
+        nx_S = msf_l_S * nx_S;
+        ny_S = msf_l_S * ny_S;
+        nz_S = msf_l_S * nz_S;
+
+        do_dih_fup_noshiftf_simd(ai, aj, ak, al, p_S, q_S, mx_S, my_S, mz_S, nx_S, ny_S, nz_S, f);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 /*! \brief Computes angle restraints of two different types */
 template<BondedKernelFlavor flavor>
 real low_angres(int             nbonds,
@@ -3394,6 +3500,235 @@ real cmap_dihs(int                 nbonds,
     return vtot;
 }
 
+real cmap_dihs_simd(int                 nbonds,
+                    const t_iatom       forceatoms[],
+                    const t_iparams     forceparams[],
+                    const gmx_cmap_t*   cmap_grid,
+                    const rvec          x[],
+                    rvec4               f[],
+                    rvec                fshift[],
+                    const struct t_pbc* pbc,
+                    real                lambda,
+                    real*               dvdlambda,
+                    const t_mdatoms*    md,
+                    t_fcdata*           fcd,
+                    int*                global_atom_index)
+{
+#if GMX_SIMD_HAVE_REAL
+    GMX_UNUSED_VALUE(fshift);
+    GMX_UNUSED_VALUE(lambda);
+    GMX_UNUSED_VALUE(dvdlambda);
+    GMX_UNUSED_VALUE(md);
+    GMX_UNUSED_VALUE(fcd);
+    GMX_UNUSED_VALUE(global_atom_index);
+
+    constexpr int                            nfa1 = 6;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t al[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t am[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+    /* The grid positions and the 16 grid values (tx in cmap_dihs()) per lane */
+    alignas(GMX_SIMD_ALIGNMENT) real xphi1[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real xphi2[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real iphi1Real[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real iphi2Real[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real laneScale[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real tx[16 * GMX_SIMD_REAL_WIDTH];
+
+    const int  gridSpacing = cmap_grid->grid_spacing;
+    const real dxRad       = 2 * M_PI / gridSpacing;
+    const real dxDeg       = 360.0 / gridSpacing;
+
+    const SimdReal pi_S(M_PI);
+    const SimdReal twoPi_S(2 * M_PI);
+    const SimdReal zero_S(0.0);
+    const SimdReal two_S(2.0);
+    const SimdReal three_S(3.0);
+    /* Converts xphi to grid units and dV/dgrid to dV/dphi */
+    const SimdReal invDx_S(gridSpacing / (2 * M_PI));
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    /* nbonds is the number of CMAP torsion pairs times nfa1,
+     * here we step GMX_SIMD_REAL_WIDTH pairs
+     */
+    for (int n = 0; n < nbonds; n += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect the five atoms for GMX_SIMD_REAL_WIDTH torsion pairs.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = n;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            ai[s] = forceatoms[iu + 1];
+            aj[s] = forceatoms[iu + 2];
+            ak[s] = forceatoms[iu + 3];
+            al[s] = forceatoms[iu + 4];
+            am[s] = forceatoms[iu + 5];
+
+            /* At the end fill the arrays with the last atoms and a zero scale */
+            if (n + s * nfa1 < nbonds)
+            {
+                laneScale[s] = 1;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                laneScale[s] = 0;
+            }
+        }
+
+        SimdReal phi1_S, p1_S, q1_S, nrkj_m21_S, nrkj_n21_S;
+        SimdReal m1x_S, m1y_S, m1z_S, n1x_S, n1y_S, n1z_S;
+        SimdReal phi2_S, p2_S, q2_S, nrkj_m22_S, nrkj_n22_S;
+        SimdReal m2x_S, m2y_S, m2z_S, n2x_S, n2y_S, n2z_S;
+
+        /* The two torsions i-j-k-l and j-k-l-m */
+        dih_angle_simd(
+                x, ai, aj, ak, al, pbc_simd, &phi1_S, &m1x_S, &m1y_S, &m1z_S, &n1x_S, &n1y_S, &n1z_S, &nrkj_m21_S, &nrkj_n21_S, &p1_S, &q1_S);
+        dih_angle_simd(
+                x, aj, ak, al, am, pbc_simd, &phi2_S, &m2x_S, &m2y_S, &m2z_S, &n2x_S, &n2y_S, &n2z_S, &nrkj_m22_S, &nrkj_n22_S, &p2_S, &q2_S);
+
+        /* Shift to the range [0,2 pi) of the grid */
+        SimdReal xphi1_S = phi1_S + pi_S;
+        SimdReal xphi2_S = phi2_S + pi_S;
+        xphi1_S          = xphi1_S - selectByMask(twoPi_S, twoPi_S <= xphi1_S);
+        xphi2_S          = xphi2_S - selectByMask(twoPi_S, twoPi_S <= xphi2_S);
+        xphi1_S          = xphi1_S + selectByMask(twoPi_S, xphi1_S < zero_S);
+        xphi2_S          = xphi2_S + selectByMask(twoPi_S, xphi2_S < zero_S);
+        store(xphi1, xphi1_S);
+        store(xphi2, xphi2_S);
+
+        /* Look up the grid cells, this part is not vectorized */
+        iu = n;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int   cmapA = forceparams[forceatoms[iu]].cmap.cmapA;
+            const real* cmapd = cmap_grid->cmapdata[cmapA].cmap.data();
+
+            int ip1m1, ip1p1, ip1p2;
+            int ip2m1, ip2p1, ip2p2;
+
+            const int iphi1 = cmap_setup_grid_index(
+                    static_cast<int>(xphi1[s] / dxRad), gridSpacing, &ip1m1, &ip1p1, &ip1p2);
+            const int iphi2 = cmap_setup_grid_index(
+                    static_cast<int>(xphi2[s] / dxRad), gridSpacing, &ip2m1, &ip2p1, &ip2p2);
+
+            iphi1Real[s] = iphi1;
+            iphi2Real[s] = iphi2;
+
+            const int pos[4] = { iphi1 * gridSpacing + iphi2,
+                                 ip1p1 * gridSpacing + iphi2,
+                                 ip1p1 * gridSpacing + ip2p1,
+                                 iphi1 * gridSpacing + ip2p1 };
+
+            for (int c = 0; c < 4; c++)
+            {
+                tx[c * GMX_SIMD_REAL_WIDTH + s]        = cmapd[pos[c] * 4];
+                tx[(c + 4) * GMX_SIMD_REAL_WIDTH + s]  = cmapd[pos[c] * 4 + 1] * dxDeg;
+                tx[(c + 8) * GMX_SIMD_REAL_WIDTH + s]  = cmapd[pos[c] * 4 + 2] * dxDeg;
+                tx[(c + 12) * GMX_SIMD_REAL_WIDTH + s] = cmapd[pos[c] * 4 + 3] * dxDeg * dxDeg;
+            }
+
+            if (iu + nfa1 < nbonds)
+            {
+                iu += nfa1;
+            }
+        }
+
+        /* Bicubic interpolation coefficients for GMX_SIMD_REAL_WIDTH pairs at once */
+        SimdReal tc_S[16];
+        for (int idx = 0; idx < 16; idx++)
+        {
+            tc_S[idx] = zero_S;
+        }
+        for (int k = 0; k < 16; k++)
+        {
+            const SimdReal tx_S = load<SimdReal>(tx + k * GMX_SIMD_REAL_WIDTH);
+            for (int idx = 0; idx < 16; idx++)
+            {
+                if (cmap_coeff_matrix[k * 16 + idx] != 0)
+                {
+                    tc_S[idx] = fma(SimdReal(cmap_coeff_matrix[k * 16 + idx]), tx_S, tc_S[idx]);
+                }
+            }
+        }
+
+        const SimdReal tt_S = xphi1_S * invDx_S - load<SimdReal>(iphi1Real);
+        const SimdReal tu_S = xphi2_S * invDx_S - load<SimdReal>(iphi2Real);
+
+        SimdReal df1_S = zero_S;
+        SimdReal df2_S = zero_S;
+        for (int i = 3; i >= 0; i--)
+        {
+            /* Same as loop_index[i][3], [i][2] and [i][1] in cmap_dihs() */
+            const int l1 = i + 12;
+            const int l2 = i + 8;
+            const int l3 = i + 4;
+
+            const int i1 = i * 4 + 1;
+            const int i2 = i * 4 + 2;
+            const int i3 = i * 4 + 3;
+
+            const SimdReal dt_S = fma(three_S * tc_S[l1], tt_S, two_S * tc_S[l2]);
+            const SimdReal du_S = fma(three_S * tc_S[i3], tu_S, two_S * tc_S[i2]);
+
+            df1_S = fma(tu_S, df1_S, fma(dt_S, tt_S, tc_S[l3]));
+            df2_S = fma(tt_S, df2_S, fma(du_S, tu_S, tc_S[i1]));
+        }
+
+        /* Convert to -dV/dphi and zero the padded lanes */
+        const SimdReal mddphi1_S = -df1_S * invDx_S * load<SimdReal>(laneScale);
+        const SimdReal mddphi2_S = -df2_S * invDx_S * load<SimdReal>(laneScale);
+
+        /* Forces for the first torsion */
+        SimdReal sf_i_S  = mddphi1_S * nrkj_m21_S;
+        SimdReal msf_l_S = mddphi1_S * nrkj_n21_S;
+        do_dih_fup_noshiftf_simd(ai,
+                                 aj,
+                                 ak,
+                                 al,
+                                 p1_S,
+                                 q1_S,
+                                 sf_i_S * m1x_S,
+                                 sf_i_S * m1y_S,
+                                 sf_i_S * m1z_S,
+                                 msf_l_S * n1x_S,
+                                 msf_l_S * n1y_S,
+                                 msf_l_S * n1z_S,
+                                 f);
+
+        /* Forces for the second torsion */
+        sf_i_S  = mddphi2_S * nrkj_m22_S;
+        msf_l_S = mddphi2_S * nrkj_n22_S;
+        do_dih_fup_noshiftf_simd(aj,
+                                 ak,
+                                 al,
+                                 am,
+                                 p2_S,
+                                 q2_S,
+                                 sf_i_S * m2x_S,
+                                 sf_i_S * m2y_S,
+                                 sf_i_S * m2z_S,
+                                 msf_l_S * n2x_S,
+                                 msf_l_S * n2y_S,
+                                 msf_l_S * n2z_S,
+                                 f);
+    }
+
+    return 0;
+#else
+    return cmap_dihs(
+            nbonds, forceatoms, forceparams, cmap_grid, x, f, fshift, pbc, lambda, dvdlambda, md, fcd, global_atom_index);
+#endif // GMX_SIMD_HAVE_REAL
+}
+
 namespace
 {
 
@@ -3486,18 +3821,19 @@ real g96bond_angle(const rvec xi, const rvec xj, const rvec xk, const t_pbc* pbc
 }
 
 template<BondedKernelFlavor flavor>
-real g96angles(int             nbonds,
-               const t_iatom   forceatoms[],
-               const t_iparams forceparams[],
-               const rvec      x[],
-               rvec4           f[],
-               rvec            fshift[],
-               const t_pbc*    pbc,
-               real            lambda,
-               real*           dvdlambda,
-               const t_mdatoms gmx_unused* md,
-               t_fcdata gmx_unused* fcd,
-               int gmx_unused* global_atom_index)
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+g96angles(int             nbonds,
+          const t_iatom   forceatoms[],
+          const t_iparams forceparams[],
+          const rvec      x[],
+          rvec4           f[],
+          rvec            fshift[],
+          const t_pbc*    pbc,
+          real            lambda,
+          real*           dvdlambda,
+          const t_mdatoms gmx_unused* md,
+          t_fcdata gmx_unused* fcd,
+          int gmx_unused* global_atom_index)
 {
     int  i, ai, aj, ak, type, m, t1, t2;
     rvec r_ij, r_kj;
@@ -3552,49 +3888,160 @@ real g96angles(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As g96angles above, but using SIMD to calculate many angles at once.
+ * This routine does not calculate energies and shift forces.
+ */
 template<BondedKernelFlavor flavor>
-real cross_bond_bond(int             nbonds,
-                     const t_iatom   forceatoms[],
-                     const t_iparams forceparams[],
-                     const rvec      x[],
-                     rvec4           f[],
-                     rvec            fshift[],
-                     const t_pbc*    pbc,
-                     real gmx_unused lambda,
-                     real gmx_unused* dvdlambda,
-                     const t_mdatoms gmx_unused* md,
-                     t_fcdata gmx_unused* fcd,
-                     int gmx_unused* global_atom_index)
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+g96angles(int             nbonds,
+          const t_iatom   forceatoms[],
+          const t_iparams forceparams[],
+          const rvec      x[],
+          rvec4           f[],
+          rvec gmx_unused fshift[],
+          const t_pbc*    pbc,
+          real gmx_unused lambda,
+          real gmx_unused* dvdlambda,
+          const t_mdatoms gmx_unused* md,
+          t_fcdata gmx_unused* fcd,
+          int gmx_unused* global_atom_index)
 {
-    /* Potential from Lawrence and Skimmer, Chem. Phys. Lett. 372 (2003)
-     * pp. 842-847
-     */
-    int  i, ai, aj, ak, type, m, t1, t2;
-    rvec r_ij, r_kj;
-    real vtot, vrr, s1, s2, r1, r2, r1e, r2e, krr;
-    rvec f_i, f_j, f_k;
+    constexpr int                            nfa1 = 4;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         coeff[2 * GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
 
-    vtot = 0.0;
-    for (i = 0; (i < nbonds);)
-    {
-        type = forceatoms[i++];
-        ai   = forceatoms[i++];
-        aj   = forceatoms[i++];
-        ak   = forceatoms[i++];
-        r1e  = forceparams[type].cross_bb.r1e;
-        r2e  = forceparams[type].cross_bb.r2e;
-        krr  = forceparams[type].cross_bb.krr;
+    set_pbc_simd(pbc, pbc_simd);
 
-        /* Compute distance vectors ... */
-        t1 = pbc_rvec_sub(pbc, x[ai], x[aj], r_ij);
-        t2 = pbc_rvec_sub(pbc, x[ak], x[aj], r_kj);
+    /* nbonds is the number of angles times nfa1, here we step GMX_SIMD_REAL_WIDTH angles */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms for GMX_SIMD_REAL_WIDTH angles.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            ak[s]          = forceatoms[iu + 3];
 
-        /* ... and their lengths */
-        r1 = norm(r_ij);
-        r2 = norm(r_kj);
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                coeff[s]                       = forceparams[type].harmonic.krA;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = forceparams[type].harmonic.rA;
 
-        /* Deviations from ideality */
-        s1 = r1 - r1e;
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                coeff[s]                       = 0;
+                coeff[GMX_SIMD_REAL_WIDTH + s] = 0;
+            }
+        }
+
+        SimdReal xi_S, yi_S, zi_S;
+        SimdReal xj_S, yj_S, zj_S;
+        SimdReal xk_S, yk_S, zk_S;
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), ai, &xi_S, &yi_S, &zi_S);
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), aj, &xj_S, &yj_S, &zj_S);
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), ak, &xk_S, &yk_S, &zk_S);
+        SimdReal rijx_S = xi_S - xj_S;
+        SimdReal rijy_S = yi_S - yj_S;
+        SimdReal rijz_S = zi_S - zj_S;
+        SimdReal rkjx_S = xk_S - xj_S;
+        SimdReal rkjy_S = yk_S - yj_S;
+        SimdReal rkjz_S = zk_S - zj_S;
+
+        pbc_correct_dx_simd(&rijx_S, &rijy_S, &rijz_S, pbc_simd);
+        pbc_correct_dx_simd(&rkjx_S, &rkjy_S, &rkjz_S, pbc_simd);
+
+        const SimdReal k_S    = load<SimdReal>(coeff);
+        const SimdReal cos0_S = load<SimdReal>(coeff + GMX_SIMD_REAL_WIDTH);
+
+        const SimdReal nrij_1_S   = invsqrt(norm2(rijx_S, rijy_S, rijz_S));
+        const SimdReal nrkj_1_S   = invsqrt(norm2(rkjx_S, rkjy_S, rkjz_S));
+        const SimdReal rijrkj_1_S = nrij_1_S * nrkj_1_S;
+
+        const SimdReal cos_S = iprod(rijx_S, rijy_S, rijz_S, rkjx_S, rkjy_S, rkjz_S) * rijrkj_1_S;
+
+        /* The G96 angle potential is harmonic in the cosine */
+        const SimdReal dVdt_S = k_S * (cos0_S - cos_S);
+
+        const SimdReal cik_S = dVdt_S * rijrkj_1_S;
+        const SimdReal cii_S = dVdt_S * cos_S * nrij_1_S * nrij_1_S;
+        const SimdReal ckk_S = dVdt_S * cos_S * nrkj_1_S * nrkj_1_S;
+
+        const SimdReal f_ix_S = fnma(cii_S, rijx_S, cik_S * rkjx_S);
+        const SimdReal f_iy_S = fnma(cii_S, rijy_S, cik_S * rkjy_S);
+        const SimdReal f_iz_S = fnma(cii_S, rijz_S, cik_S * rkjz_S);
+        const SimdReal f_kx_S = fnma(ckk_S, rkjx_S, cik_S * rijx_S);
+        const SimdReal f_ky_S = fnma(ckk_S, rkjy_S, cik_S * rijy_S);
+        const SimdReal f_kz_S = fnma(ckk_S, rkjz_S, cik_S * rijz_S);
+
+        transposeScatterIncrU<4>(reinterpret_cast<real*>(f), ai, f_ix_S, f_iy_S, f_iz_S);
+        transposeScatterDecrU<4>(
+                reinterpret_cast<real*>(f), aj, f_ix_S + f_kx_S, f_iy_S + f_ky_S, f_iz_S + f_kz_S);
+        transposeScatterIncrU<4>(reinterpret_cast<real*>(f), ak, f_kx_S, f_ky_S, f_kz_S);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
+template<BondedKernelFlavor flavor>
+real cross_bond_bond(int             nbonds,
+                     const t_iatom   forceatoms[],
+                     const t_iparams forceparams[],
+                     const rvec      x[],
+                     rvec4           f[],
+                     rvec            fshift[],
+                     const t_pbc*    pbc,
+                     real gmx_unused lambda,
+                     real gmx_unused* dvdlambda,
+                     const t_mdatoms gmx_unused* md,
+                     t_fcdata gmx_unused* fcd,
+                     int gmx_unused* global_atom_index)
+{
+    /* Potential from Lawrence and Skimmer, Chem. Phys. Lett. 372 (2003)
+     * pp. 842-847
+     */
+    int  i, ai, aj, ak, type, m, t1, t2;
+    rvec r_ij, r_kj;
+    real vtot, vrr, s1, s2, r1, r2, r1e, r2e, krr;
+    rvec f_i, f_j, f_k;
+
+    vtot = 0.0;
+    for (i = 0; (i < nbonds);)
+    {
+        type = forceatoms[i++];
+        ai   = forceatoms[i++];
+        aj   = forceatoms[i++];
+        ak   = forceatoms[i++];
+        r1e  = forceparams[type].cross_bb.r1e;
+        r2e  = forceparams[type].cross_bb.r2e;
+        krr  = forceparams[type].cross_bb.krr;
+
+        /* Compute distance vectors ... */
+        t1 = pbc_rvec_sub(pbc, x[ai], x[aj], r_ij);
+        t2 = pbc_rvec_sub(pbc, x[ak], x[aj], r_kj);
+
+        /* ... and their lengths */
+        r1 = norm(r_ij);
+        r2 = norm(r_kj);
+
+        /* Deviations from ideality */
+        s1 = r1 - r1e;
         s2 = r2 - r2e;
 
         /* Energy (can be negative!) */
@@ -3760,19 +4207,84 @@ real bonded_tab(const char*          type,
     /* That was 22 flops */
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/*! \brief Computes the forces for tabulated potentials using SIMD
+ *
+ * As bonded_tab(), but for GMX_SIMD_REAL_WIDTH interactions at once,
+ * without energies and lambda dependence. Lane s uses table \p tables[s]
+ * with number \p tableNr[s]. The table lookups are done per lane,
+ * the spline evaluation uses SIMD.
+ */
+SimdReal gmx_simdcall bonded_tab_simd(const char*                type,
+                                      const int*                 tableNr,
+                                      const bondedtable_t* const tables[],
+                                      SimdReal                   k_S,
+                                      SimdReal                   r_S)
+{
+    alignas(GMX_SIMD_ALIGNMENT) real r[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real buf[5 * GMX_SIMD_REAL_WIDTH];
+    real*                            eps      = buf + 0 * GMX_SIMD_REAL_WIDTH;
+    real*                            Ft       = buf + 1 * GMX_SIMD_REAL_WIDTH;
+    real*                            G        = buf + 2 * GMX_SIMD_REAL_WIDTH;
+    real*                            H        = buf + 3 * GMX_SIMD_REAL_WIDTH;
+    real*                            tabscale = buf + 4 * GMX_SIMD_REAL_WIDTH;
+
+    store(r, r_S);
+    for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+    {
+        const bondedtable_t& table = *tables[s];
+
+        const real rt = r[s] * table.scale;
+        const int  n0 = static_cast<int>(rt);
+        if (n0 >= table.n)
+        {
+            gmx_fatal(FARGS,
+                      "A tabulated %s interaction table number %d is out of the table range: r %f, "
+                      "between table indices %d and %d, table length %d",
+                      type,
+                      tableNr[s],
+                      r[s],
+                      n0,
+                      n0 + 1,
+                      table.n);
+        }
+        const real* VFtab = table.data.data() + 4 * n0;
+
+        eps[s]      = rt - n0;
+        Ft[s]       = VFtab[1];
+        G[s]        = VFtab[2];
+        H[s]        = VFtab[3];
+        tabscale[s] = table.scale;
+    }
+
+    const SimdReal eps_S = load<SimdReal>(eps);
+    const SimdReal G_S   = load<SimdReal>(G);
+    const SimdReal H_S   = load<SimdReal>(H);
+
+    /* FF = Ft + 2 G eps + 3 H eps^2 */
+    SimdReal FF_S = fma(SimdReal(3.0_real) * H_S, eps_S, SimdReal(2.0_real) * G_S);
+    FF_S          = fma(FF_S, eps_S, load<SimdReal>(Ft));
+
+    return -k_S * FF_S * load<SimdReal>(tabscale);
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 template<BondedKernelFlavor flavor>
-real tab_bonds(int             nbonds,
-               const t_iatom   forceatoms[],
-               const t_iparams forceparams[],
-               const rvec      x[],
-               rvec4           f[],
-               rvec            fshift[],
-               const t_pbc*    pbc,
-               real            lambda,
-               real*           dvdlambda,
-               const t_mdatoms gmx_unused* md,
-               t_fcdata*                   fcd,
-               int gmx_unused* global_atom_index)
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+tab_bonds(int             nbonds,
+          const t_iatom   forceatoms[],
+          const t_iparams forceparams[],
+          const rvec      x[],
+          rvec4           f[],
+          rvec            fshift[],
+          const t_pbc*    pbc,
+          real            lambda,
+          real*           dvdlambda,
+          const t_mdatoms gmx_unused* md,
+          t_fcdata*                   fcd,
+          int gmx_unused* global_atom_index)
 {
     int  i, ki, ai, aj, type, table;
     real dr, dr2, fbond, vbond, vtot;
@@ -3815,19 +4327,114 @@ real tab_bonds(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As tab_bonds above, but using SIMD to calculate many bonds at once.
+ * This routine does not calculate energies and shift forces.
+ */
 template<BondedKernelFlavor flavor>
-real tab_angles(int             nbonds,
-                const t_iatom   forceatoms[],
-                const t_iparams forceparams[],
-                const rvec      x[],
-                rvec4           f[],
-                rvec            fshift[],
-                const t_pbc*    pbc,
-                real            lambda,
-                real*           dvdlambda,
-                const t_mdatoms gmx_unused* md,
-                t_fcdata*                   fcd,
-                int gmx_unused* global_atom_index)
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+tab_bonds(int             nbonds,
+          const t_iatom   forceatoms[],
+          const t_iparams forceparams[],
+          const rvec      x[],
+          rvec4           f[],
+          rvec gmx_unused fshift[],
+          const t_pbc*    pbc,
+          real gmx_unused lambda,
+          real gmx_unused* dvdlambda,
+          const t_mdatoms gmx_unused* md,
+          t_fcdata*                   fcd,
+          int gmx_unused* global_atom_index)
+{
+    constexpr int                            nfa1 = 3;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         k[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+    int                                      tableNr[GMX_SIMD_REAL_WIDTH];
+    const bondedtable_t*                     tables[GMX_SIMD_REAL_WIDTH];
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    /* nbonds is the number of bonds times nfa1, here we step GMX_SIMD_REAL_WIDTH bonds */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms for GMX_SIMD_REAL_WIDTH bonds.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            tableNr[s]     = forceparams[type].tab.table;
+            tables[s]      = &fcd->bondtab[tableNr[s]];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                k[s] = forceparams[type].tab.kA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                k[s] = 0;
+            }
+        }
+
+        SimdReal xi, yi, zi;
+        SimdReal xj, yj, zj;
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), ai, &xi, &yi, &zi);
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), aj, &xj, &yj, &zj);
+        SimdReal rij_x = xi - xj;
+        SimdReal rij_y = yi - yj;
+        SimdReal rij_z = zi - zj;
+
+        pbc_correct_dx_simd(&rij_x, &rij_y, &rij_z, pbc_simd);
+
+        const SimdReal dist2 = rij_x * rij_x + rij_y * rij_y + rij_z * rij_z;
+        // Here we avoid sqrt(0), the force will be zero because rij=0
+        const SimdReal invDist = invsqrt(max(dist2, SimdReal(GMX_REAL_EPS)));
+
+        const SimdReal fbond =
+                bonded_tab_simd("bond", tableNr, tables, load<SimdReal>(k), dist2 * invDist);
+
+        // The force divided by the distance
+        const SimdReal forceOverR = fbond * invDist;
+
+        const SimdReal f_x = forceOverR * rij_x;
+        const SimdReal f_y = forceOverR * rij_y;
+        const SimdReal f_z = forceOverR * rij_z;
+
+        transposeScatterIncrU<4>(reinterpret_cast<real*>(f), ai, f_x, f_y, f_z);
+        transposeScatterDecrU<4>(reinterpret_cast<real*>(f), aj, f_x, f_y, f_z);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+tab_angles(int             nbonds,
+           const t_iatom   forceatoms[],
+           const t_iparams forceparams[],
+           const rvec      x[],
+           rvec4           f[],
+           rvec            fshift[],
+           const t_pbc*    pbc,
+           real            lambda,
+           real*           dvdlambda,
+           const t_mdatoms gmx_unused* md,
+           t_fcdata*                   fcd,
+           int gmx_unused* global_atom_index)
 {
     int  i, ai, aj, ak, t1, t2, type, table;
     rvec r_ij, r_kj;
@@ -3895,19 +4502,149 @@ real tab_angles(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As tab_angles above, but using SIMD to calculate many angles at once.
+ * This routine does not calculate energies and shift forces.
+ */
 template<BondedKernelFlavor flavor>
-real tab_dihs(int             nbonds,
-              const t_iatom   forceatoms[],
-              const t_iparams forceparams[],
-              const rvec      x[],
-              rvec4           f[],
-              rvec            fshift[],
-              const t_pbc*    pbc,
-              real            lambda,
-              real*           dvdlambda,
-              const t_mdatoms gmx_unused* md,
-              t_fcdata*                   fcd,
-              int gmx_unused* global_atom_index)
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+tab_angles(int             nbonds,
+           const t_iatom   forceatoms[],
+           const t_iparams forceparams[],
+           const rvec      x[],
+           rvec4           f[],
+           rvec gmx_unused fshift[],
+           const t_pbc*    pbc,
+           real gmx_unused lambda,
+           real gmx_unused* dvdlambda,
+           const t_mdatoms gmx_unused* md,
+           t_fcdata*                   fcd,
+           int gmx_unused* global_atom_index)
+{
+    constexpr int                            nfa1 = 4;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         k[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+    int                                      tableNr[GMX_SIMD_REAL_WIDTH];
+    const bondedtable_t*                     tables[GMX_SIMD_REAL_WIDTH];
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    const SimdReal one_S(1.0);
+    const SimdReal one_min_eps_S(1.0_real - GMX_REAL_EPS); // Largest number < 1
+
+    /* nbonds is the number of angles times nfa1, here we step GMX_SIMD_REAL_WIDTH angles */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms for GMX_SIMD_REAL_WIDTH angles.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            ak[s]          = forceatoms[iu + 3];
+            tableNr[s]     = forceparams[type].tab.table;
+            tables[s]      = &fcd->angletab[tableNr[s]];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                k[s] = forceparams[type].tab.kA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                k[s] = 0;
+            }
+        }
+
+        SimdReal xi_S, yi_S, zi_S;
+        SimdReal xj_S, yj_S, zj_S;
+        SimdReal xk_S, yk_S, zk_S;
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), ai, &xi_S, &yi_S, &zi_S);
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), aj, &xj_S, &yj_S, &zj_S);
+        gatherLoadUTranspose<3>(reinterpret_cast<const real*>(x), ak, &xk_S, &yk_S, &zk_S);
+        SimdReal rijx_S = xi_S - xj_S;
+        SimdReal rijy_S = yi_S - yj_S;
+        SimdReal rijz_S = zi_S - zj_S;
+        SimdReal rkjx_S = xk_S - xj_S;
+        SimdReal rkjy_S = yk_S - yj_S;
+        SimdReal rkjz_S = zk_S - zj_S;
+
+        pbc_correct_dx_simd(&rijx_S, &rijy_S, &rijz_S, pbc_simd);
+        pbc_correct_dx_simd(&rkjx_S, &rkjy_S, &rkjz_S, pbc_simd);
+
+        const SimdReal rij_rkj_S = iprod(rijx_S, rijy_S, rijz_S, rkjx_S, rkjy_S, rkjz_S);
+        const SimdReal nrij2_S   = norm2(rijx_S, rijy_S, rijz_S);
+        const SimdReal nrkj2_S   = norm2(rkjx_S, rkjy_S, rkjz_S);
+        const SimdReal nrij_1_S  = invsqrt(nrij2_S);
+        const SimdReal nrkj_1_S  = invsqrt(nrkj2_S);
+
+        /* As in the SIMD flavor of angles(), we compute cos^2 using
+         * a division and clamp cos and cos^2 to avoid issues at 0 and
+         * 180 degrees.
+         */
+        SimdReal cos_S  = rij_rkj_S * nrij_1_S * nrkj_1_S;
+        SimdReal cos2_S = rij_rkj_S * rij_rkj_S / (nrij2_S * nrkj2_S);
+        cos_S           = max(cos_S, -one_S);
+        cos_S           = min(cos_S, one_S);
+        cos2_S          = min(cos2_S, one_min_eps_S);
+
+        const SimdReal theta_S  = acos(cos_S);
+        const SimdReal invsin_S = invsqrt(one_S - cos2_S);
+
+        const SimdReal dVdt_S =
+                bonded_tab_simd("angle", tableNr, tables, load<SimdReal>(k), theta_S);
+
+        const SimdReal st_S  = dVdt_S * invsin_S;
+        const SimdReal sth_S = st_S * cos_S;
+
+        const SimdReal cik_S = st_S * nrij_1_S * nrkj_1_S;
+        const SimdReal cii_S = sth_S * nrij_1_S * nrij_1_S;
+        const SimdReal ckk_S = sth_S * nrkj_1_S * nrkj_1_S;
+
+        const SimdReal f_ix_S = fnma(cik_S, rkjx_S, cii_S * rijx_S);
+        const SimdReal f_iy_S = fnma(cik_S, rkjy_S, cii_S * rijy_S);
+        const SimdReal f_iz_S = fnma(cik_S, rkjz_S, cii_S * rijz_S);
+        const SimdReal f_kx_S = fnma(cik_S, rijx_S, ckk_S * rkjx_S);
+        const SimdReal f_ky_S = fnma(cik_S, rijy_S, ckk_S * rkjy_S);
+        const SimdReal f_kz_S = fnma(cik_S, rijz_S, ckk_S * rkjz_S);
+
+        transposeScatterIncrU<4>(reinterpret_cast<real*>(f), ai, f_ix_S, f_iy_S, f_iz_S);
+        transposeScatterDecrU<4>(
+                reinterpret_cast<real*>(f), aj, f_ix_S + f_kx_S, f_iy_S + f_ky_S, f_iz_S + f_kz_S);
+        transposeScatterIncrU<4>(reinterpret_cast<real*>(f), ak, f_kx_S, f_ky_S, f_kz_S);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor != BondedKernelFlavor::ForcesSimdWhenAvailable || !GMX_SIMD_HAVE_REAL, real>
+tab_dihs(int             nbonds,
+         const t_iatom   forceatoms[],
+         const t_iparams forceparams[],
+         const rvec      x[],
+         rvec4           f[],
+         rvec            fshift[],
+         const t_pbc*    pbc,
+         real            lambda,
+         real*           dvdlambda,
+         const t_mdatoms gmx_unused* md,
+         t_fcdata*                   fcd,
+         int gmx_unused* global_atom_index)
 {
     int  i, type, ai, aj, ak, al, table;
     int  t1, t2, t3;
@@ -3946,6 +4683,105 @@ real tab_dihs(int             nbonds,
     return vtot;
 }
 
+#if GMX_SIMD_HAVE_REAL
+
+/* As tab_dihs above, but using SIMD to calculate multiple dihedrals at once.
+ * This routine does not calculate energies and shift forces.
+ */
+template<BondedKernelFlavor flavor>
+std::enable_if_t<flavor == BondedKernelFlavor::ForcesSimdWhenAvailable, real>
+tab_dihs(int             nbonds,
+         const t_iatom   forceatoms[],
+         const t_iparams forceparams[],
+         const rvec      x[],
+         rvec4           f[],
+         rvec gmx_unused fshift[],
+         const t_pbc*    pbc,
+         real gmx_unused lambda,
+         real gmx_unused* dvdlambda,
+         const t_mdatoms gmx_unused* md,
+         t_fcdata*                   fcd,
+         int gmx_unused* global_atom_index)
+{
+    constexpr int                            nfa1 = 5;
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ai[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t aj[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t ak[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t al[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         k[GMX_SIMD_REAL_WIDTH];
+    alignas(GMX_SIMD_ALIGNMENT) real         pbc_simd[9 * GMX_SIMD_REAL_WIDTH];
+    int                                      tableNr[GMX_SIMD_REAL_WIDTH];
+    const bondedtable_t*                     tables[GMX_SIMD_REAL_WIDTH];
+
+    set_pbc_simd(pbc, pbc_simd);
+
+    const SimdReal pi_S(M_PI);
+
+    /* nbonds is the number of dihedrals times nfa1, here we step GMX_SIMD_REAL_WIDTH dihs */
+    for (int i = 0; i < nbonds; i += GMX_SIMD_REAL_WIDTH * nfa1)
+    {
+        /* Collect atoms for GMX_SIMD_REAL_WIDTH dihedrals.
+         * iu indexes into forceatoms, we should not let iu go beyond nbonds.
+         */
+        int iu = i;
+        for (int s = 0; s < GMX_SIMD_REAL_WIDTH; s++)
+        {
+            const int type = forceatoms[iu];
+            ai[s]          = forceatoms[iu + 1];
+            aj[s]          = forceatoms[iu + 2];
+            ak[s]          = forceatoms[iu + 3];
+            al[s]          = forceatoms[iu + 4];
+            tableNr[s]     = forceparams[type].tab.table;
+            tables[s]      = &fcd->dihtab[tableNr[s]];
+
+            /* At the end fill the arrays with the last atoms and 0 params */
+            if (i + s * nfa1 < nbonds)
+            {
+                k[s] = forceparams[type].tab.kA;
+
+                if (iu + nfa1 < nbonds)
+                {
+                    iu += nfa1;
+                }
+            }
+            else
+            {
+                k[s] = 0;
+            }
+        }
+
+        SimdReal phi_S, p_S, q_S;
+        SimdReal mx_S, my_S, mz_S;
+        SimdReal nx_S, ny_S, nz_S;
+        SimdReal nrkj_m2_S, nrkj_n2_S;
+
+        /* Calculate GMX_SIMD_REAL_WIDTH dihedral angles at once */
+        dih_angle_simd(
+                x, ai, aj, ak, al, pbc_simd, &phi_S, &mx_S, &my_S, &mz_S, &nx_S, &ny_S, &nz_S, &nrkj_m2_S, &nrkj_n2_S, &p_S, &q_S);
+
+        const SimdReal mddphi_S =
+                bonded_tab_simd("dihedral", tableNr, tables, load<SimdReal>(k), phi_S + pi_S);
+        const SimdReal sf_i_S  = mddphi_S * nrkj_m2_S;
+        const SimdReal msf_l_S = mddphi_S * nrkj_n2_S;
+
+        /* After this m?_S will contain f[i] */
+        mx_S = sf_i_S * mx_S;
+        my_S = sf_i_S * my_S;
+        mz_S = sf_i_S * mz_S;
+
+        /* After this m?_S will contain -f[l] */
+        nx_S = msf_l_S * nx_S;
+        ny_S = msf_l_S * ny_S;
+        nz_S = msf_l_S * nz_S;
+
+        do_dih_fup_noshiftf_simd(ai, aj, ak, al, p_S, q_S, mx_S, my_S, mz_S, nx_S, ny_S, nz_S, f);
+    }
+
+    return 0;
+}
+
+#endif // GMX_SIMD_HAVE_REAL
+
 struct BondedInteractions
 {
     BondedFunction function;
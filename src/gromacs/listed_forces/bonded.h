@@ -129,6 +129,26 @@ real cmap_dihs(int                 nbonds,
                t_fcdata gmx_unused* fcd,
                int gmx_unused* global_atom_index);
 
+/*! \brief Compute CMAP dihedral forces using SIMD when available
+ *
+ * As cmap_dihs(), but does not compute energies and shift forces and
+ * should not be used with perturbed parameters. Calls cmap_dihs() when
+ * SIMD is not supported.
+ */
+real cmap_dihs_simd(int                 nbonds,
+                    const t_iatom       forceatoms[],
+                    const t_iparams     forceparams[],
+                    const gmx_cmap_t*   cmap_grid,
+                    const rvec          x[],
+                    rvec4               f[],
+                    rvec                fshift[],
+                    const struct t_pbc* pbc,
+                    real                lambda,
+                    real*               dvdlambda,
+                    const t_mdatoms*    md,
+                    t_fcdata*           fcd,
+                    int*                global_atom_index);
+
 /*! \brief For selecting which flavor of bonded kernel is used for simple bonded types */
 enum class BondedKernelFlavor
 {
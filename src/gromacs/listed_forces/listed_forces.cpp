@@ -146,7 +146,7 @@ static void selectInteractions(InteractionDefinitions*                  idef,
 
 void ListedForces::setup(const InteractionDefinitions& domainIdef, const int numAtomsForce, const bool useGpu)
 {
-    if (interactionSelection_.all())
+    if (interactionSelection_.all() && !threading_->sortInteractionsByLocality)
     {
         // Avoid the overhead of copying all interaction lists by simply setting the reference to the domain idef
         idef_ = &domainIdef;
@@ -157,7 +157,8 @@ void ListedForces::setup(const InteractionDefinitions& domainIdef, const int num
 
         selectInteractions(&idefSelection_, domainIdef, interactionSelection_);
 
-        idefSelection_.ilsort = domainIdef.ilsort;
+        idefSelection_.ilsort                      = domainIdef.ilsort;
+        idefSelection_.numNonperturbedInteractions = domainIdef.numNonperturbedInteractions;
 
         if (interactionSelection_.test(static_cast<int>(ListedForces::InteractionGroup::Rest)))
         {
@@ -171,6 +172,11 @@ void ListedForces::setup(const InteractionDefinitions& domainIdef, const int num
         }
     }
 
+    if (threading_->sortInteractionsByLocality)
+    {
+        sort_bondeds_by_locality(&idefSelection_);
+    }
+
     setup_bonded_threading(threading_.get(), numAtomsForce, useGpu, *idef_);
 
     if (idef_->ilsort == ilsortFE_SORTED)
@@ -458,19 +464,22 @@ real calc_one_bond(int                           thread,
                nice to account to its own subtimer, but first
                wallcycle needs to be extended to support calling from
                multiple threads. */
-            v = cmap_dihs(nbn,
-                          iatoms.data() + nb0,
-                          iparams.data(),
-                          &idef.cmap_grid,
-                          x,
-                          f,
-                          fshift,
-                          pbc,
-                          lambda[efptFTYPE],
-                          &(dvdl[efptFTYPE]),
-                          md,
-                          fcd,
-                          global_atom_index);
+            auto cmapFunction = (flavor == BondedKernelFlavor::ForcesSimdWhenAvailable)
+                                        ? cmap_dihs_simd
+                                        : cmap_dihs;
+            v = cmapFunction(nbn,
+                             iatoms.data() + nb0,
+                             iparams.data(),
+                             &idef.cmap_grid,
+                             x,
+                             f,
+                             fshift,
+                             pbc,
+                             lambda[efptFTYPE],
+                             &(dvdl[efptFTYPE]),
+                             md,
+                             fcd,
+                             global_atom_index);
         }
         else
         {
@@ -148,6 +148,8 @@ struct bonded_threading_t
      */
     //! Maximum thread count for uniform distribution of bondeds over threads
     int max_nthread_uniform = 0;
+    //! Whether to sort the interactions on atom index before the localized distribution
+    bool sortInteractionsByLocality = false;
 
     //! The division of work in the t_list over threads.
     WorkDivision workDivision;
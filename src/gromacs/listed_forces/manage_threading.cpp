@@ -56,10 +56,14 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "gromacs/listed_forces/gpubonded.h"
 #include "gromacs/pbcutil/ishift.h"
+#include "gromacs/topology/idef.h"
 #include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
@@ -75,6 +79,12 @@ typedef struct
     int                    nat;   /**< nr of atoms involved in a single ftype interaction */
 } ilist_data_t;
 
+//! Returns the lowest atom index of the interaction whose parameter index is at \p iatoms
+static inline int lowestAtomIndex(const int* iatoms, int numAtoms)
+{
+    return *std::min_element(iatoms + 1, iatoms + 1 + numAtoms);
+}
+
 /*! \brief Divides listed interactions over threads
  *
  * This routine attempts to divide all interactions of the numType bondeds
@@ -100,7 +110,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
         ind[f] = 0;
         /* Initialize the next atom index array */
         assert(!ild[f].il->empty());
-        at_ind[f] = ild[f].il->iatoms[1];
+        at_ind[f] = lowestAtomIndex(ild[f].il->iatoms.data(), ild[f].nat);
     }
 
     nat_sum = 0;
@@ -131,8 +141,10 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
         while (nat_sum < nat_thread)
         {
             /* To divide bonds based on atom order, we compare
-             * the index of the first atom in the bonded interaction.
-             * This works well, since the domain decomposition generates
+             * the lowest atom index in the bonded interaction.
+             * This works best when the interactions have been sorted
+             * on this index by sort_bondeds_by_locality(). Otherwise it
+             * still works well, since the domain decomposition generates
              * bondeds in order of the atoms by looking up interactions
              * which are linked to the first atom in each interaction.
              * It usually also works well without DD, since than the atoms
@@ -163,7 +175,8 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
             /* Update the first unassigned atom index for this type */
             if (ind[f_min] < ild[f_min].il->size())
             {
-                at_ind[f_min] = ild[f_min].il->iatoms[ind[f_min] + 1];
+                at_ind[f_min] =
+                        lowestAtomIndex(ild[f_min].il->iatoms.data() + ind[f_min], ild[f_min].nat);
             }
             else
             {
@@ -188,6 +201,75 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
     }
 }
 
+/*! \brief Sorts the interactions in \p iatoms on their lowest atom index
+ *
+ * The sort is stable, so the result does not depend on the sorting
+ * implementation. \p keys and \p buffer are used as temporary storage.
+ */
+static void sortInteractionsOnLowestAtom(gmx::ArrayRef<int>               iatoms,
+                                         int                              numAtoms,
+                                         std::vector<std::pair<int, int>>* keys,
+                                         std::vector<int>*                buffer)
+{
+    const int stride          = 1 + numAtoms;
+    const int numInteractions = iatoms.ssize() / stride;
+
+    keys->resize(numInteractions);
+    bool isSorted = true;
+    for (int i = 0; i < numInteractions; i++)
+    {
+        (*keys)[i] = { lowestAtomIndex(iatoms.data() + i * stride, numAtoms), i };
+        isSorted   = isSorted && (i == 0 || (*keys)[i - 1].first <= (*keys)[i].first);
+    }
+    if (isSorted)
+    {
+        return;
+    }
+
+    /* Sorting on the pair also sorts on the original index for equal keys */
+    std::sort(keys->begin(), keys->end());
+
+    buffer->assign(iatoms.begin(), iatoms.end());
+    for (int i = 0; i < numInteractions; i++)
+    {
+        const int* source = buffer->data() + (*keys)[i].second * stride;
+        std::copy_n(source, stride, iatoms.data() + i * stride);
+    }
+}
+
+void sort_bondeds_by_locality(InteractionDefinitions* idef)
+{
+    std::vector<std::pair<int, int>> keys;
+    std::vector<int>                 buffer;
+
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        /* Restraints can depend on the order of the interactions,
+         * e.g. distance restraint pairs with the same label
+         */
+        if (!ftype_is_bonded_potential(ftype) || IS_RESTRAINT_TYPE(ftype)
+            || idef->il[ftype].empty())
+        {
+            continue;
+        }
+
+        gmx::ArrayRef<int> iatoms = idef->il[ftype].iatoms;
+        const int          nral   = NRAL(ftype);
+
+        /* Perturbed interactions are stored after the non-perturbed ones
+         * and should stay there, so we sort the two parts separately.
+         */
+        const int numNonperturbed = (idef->ilsort == ilsortFE_SORTED)
+                                            ? idef->numNonperturbedInteractions[ftype]
+                                            : iatoms.ssize();
+
+        const int numPerturbed = iatoms.ssize() - numNonperturbed;
+
+        sortInteractionsOnLowestAtom(iatoms.subArray(0, numNonperturbed), nral, &keys, &buffer);
+        sortInteractionsOnLowestAtom(iatoms.subArray(numNonperturbed, numPerturbed), nral, &keys, &buffer);
+    }
+}
+
 //! Return whether function type \p ftype in \p idef has perturbed interactions
 static bool ftypeHasPerturbedEntries(const InteractionDefinitions& idef, int ftype)
 {
@@ -543,4 +625,21 @@ bonded_threading_t::bonded_threading_t(const int numThreads, const int numEnergy
     {
         max_nthread_uniform = max_nthread_uniform_default;
     }
+
+    /* With the localized distribution, sorting the interactions on atom
+     * index gives each thread a spatially compact set of interactions,
+     * as the local atom order follows the spatial grid.
+     */
+    if (getenv("GMX_NO_BONDED_SORTING") != nullptr)
+    {
+        if (fplog != nullptr && nthreads > max_nthread_uniform)
+        {
+            fprintf(fplog, "\nSorting of listed interactions on atom index disabled by env.var.\n");
+        }
+        sortInteractionsByLocality = false;
+    }
+    else
+    {
+        sortInteractionsByLocality = (nthreads > max_nthread_uniform);
+    }
 }
@@ -50,8 +50,11 @@
 
 #include <cmath>
 
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <unordered_map>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -60,10 +63,15 @@
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/mdtypes/fcdata.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
 #include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/enumerationhelpers.h"
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringstream.h"
@@ -828,6 +836,273 @@ INSTANTIATE_TEST_CASE_P(AngleZero,
                                            ::testing::ValuesIn(c_pbcForTests)));
 #endif
 
+/*! \brief Tests that the SIMD force-only kernels match the reference kernels
+ *
+ * The reference is the plain-C flavor that also computes energies and
+ * shift forces. Each interaction acts on its own atoms and the number of
+ * interactions is not a multiple of any SIMD width, so the padding of
+ * the last SIMD batch is also covered.
+ */
+class ListedForcesSimdTest : public ::testing::Test
+{
+protected:
+    //! The number of interactions
+    static constexpr int c_numInteractions = 37;
+    //! The number of interaction types, which alternate
+    static constexpr int c_numTypes = 2;
+
+    ListedForcesSimdTest()
+    {
+        clear_mat(box_);
+        box_[XX][XX] = box_[YY][YY] = box_[ZZ][ZZ] = 3.0;
+        set_pbc(&pbc_, PbcType::Xyz, box_);
+    }
+
+    /*! \brief Generates the atom list and coordinates for \p ftype
+     *
+     * The atoms of each interaction form a chain with bond lengths of
+     * 0.15 nm and bond angles between 70 and 150 degrees. The chains are
+     * put at random positions in the periodic box.
+     */
+    void generateInteractions(int ftype)
+    {
+        const int numAtomsPerInteraction = NRAL(ftype);
+
+        ThreeFry2x64<64>              rng(123456, RandomDomain::Other);
+        UniformRealDistribution<real> dist;
+
+        x_.resizeWithPadding(c_numInteractions * numAtomsPerInteraction);
+        iatoms_.clear();
+        for (int i = 0; i < c_numInteractions; i++)
+        {
+            const int firstAtom = i * numAtomsPerInteraction;
+            iatoms_.push_back(i % c_numTypes);
+            RVec previousBond = { 0, 0, 0 };
+            for (int a = 0; a < numAtomsPerInteraction; a++)
+            {
+                iatoms_.push_back(firstAtom + a);
+                if (a == 0)
+                {
+                    for (int d = 0; d < DIM; d++)
+                    {
+                        x_[firstAtom][d] = box_[d][d] * dist(rng);
+                    }
+                    continue;
+                }
+                RVec bond;
+                bool accepted = false;
+                while (!accepted)
+                {
+                    for (int d = 0; d < DIM; d++)
+                    {
+                        bond[d] = 2 * dist(rng) - 1;
+                    }
+                    const real length = norm(bond);
+                    if (length > 0.1 && length < 1)
+                    {
+                        bond *= 1 / length;
+                        /* The cosine of the bond angle is -previousBond.bond */
+                        accepted = (a == 1 || (iprod(previousBond, bond) > -0.3_real
+                                               && iprod(previousBond, bond) < 0.9_real));
+                    }
+                }
+                x_[firstAtom + a] = x_[firstAtom + a - 1] + 0.15_real * bond;
+                previousBond      = bond;
+            }
+        }
+    }
+
+    //! Runs \p kernel with the reference and SIMD flavors and compares the forces
+    void compareFlavors(const std::function<void(BondedKernelFlavor, rvec4*, rvec*)>& kernel)
+    {
+        const int numAtoms = x_.size();
+
+        std::vector<std::vector<real>> forces;
+        for (const auto flavor : { BondedKernelFlavor::ForcesAndVirialAndEnergy,
+                                   BondedKernelFlavor::ForcesSimdWhenAvailable })
+        {
+            // The SIMD kernels use unaligned 4-wide access to the force buffer
+            std::vector<real, AlignedAllocator<real>> forceBuffer(4 * numAtoms, 0.0_real);
+            rvec fshift[N_IVEC] = { { 0 } };
+            kernel(flavor, reinterpret_cast<rvec4*>(forceBuffer.data()), fshift);
+            forces.emplace_back(forceBuffer.begin(), forceBuffer.end());
+        }
+
+        real maxForce = 0;
+        for (const real f : forces[0])
+        {
+            maxForce = std::max(maxForce, std::abs(f));
+        }
+        EXPECT_GT(maxForce, 0);
+
+        const FloatingPointTolerance tolerance =
+                relativeToleranceAsFloatingPoint(maxForce, GMX_DOUBLE ? 1e-8 : 5e-4);
+        for (int a = 0; a < numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_REAL_EQ_TOL(forces[0][4 * a + d], forces[1][4 * a + d], tolerance)
+                        << "atom " << a << " dim " << d;
+            }
+        }
+    }
+
+    //! Compares the flavors of the tabulated interaction \p ftype
+    void testTabulated(int ftype, real tableRange)
+    {
+        generateInteractions(ftype);
+
+        /* Two tables with different spacing, each type uses its own table */
+        std::vector<bondedtable_t>* tables =
+                (ftype == F_TABBONDS ? &fcd_.bondtab
+                                     : (ftype == F_TABANGLES ? &fcd_.angletab : &fcd_.dihtab));
+        tables->push_back(makeTable(200, tableRange, 1.0));
+        tables->push_back(makeTable(317, tableRange, 2.3));
+
+        t_iparams iparams[c_numTypes];
+        for (int type = 0; type < c_numTypes; type++)
+        {
+            iparams[type].tab.table = type;
+            iparams[type].tab.kA    = 1.3 - 0.6 * type;
+            iparams[type].tab.kB    = iparams[type].tab.kA;
+        }
+
+        std::vector<int> ddgatindex(x_.size());
+        std::iota(ddgatindex.begin(), ddgatindex.end(), 0);
+        t_mdatoms mdatoms = { 0 };
+        compareFlavors([&](BondedKernelFlavor flavor, rvec4* f, rvec* fshift) {
+            real dvdlambda = 0;
+            calculateSimpleBond(ftype,
+                                iatoms_.size(),
+                                iatoms_.data(),
+                                iparams,
+                                as_rvec_array(x_.data()),
+                                f,
+                                fshift,
+                                &pbc_,
+                                0,
+                                &dvdlambda,
+                                &mdatoms,
+                                &fcd_,
+                                ddgatindex.data(),
+                                flavor);
+        });
+    }
+
+    /*! \brief Returns a table of \p n intervals over \p range with cubic spline coefficients
+     *
+     * The potential is a smooth periodic-like function, the spline
+     * coefficients are per point: Y, F, G, H, in units of the table spacing.
+     */
+    static bondedtable_t makeTable(int n, real range, real frequency)
+    {
+        bondedtable_t table;
+        table.n     = n;
+        table.scale = n / range;
+        table.data.resize(4 * (n + 1));
+        auto value = [n, frequency](int i) {
+            return std::sin(frequency * 2 * M_PI * i / n) + 0.3 * std::cos(5.0 * i / n);
+        };
+        auto derivative = [n, frequency](int i) {
+            return frequency * 2 * M_PI / n * std::cos(frequency * 2 * M_PI * i / n)
+                   - 0.3 * 5.0 / n * std::sin(5.0 * i / n);
+        };
+        for (int i = 0; i <= n; i++)
+        {
+            const real y0 = value(i);
+            const real y1 = value(i + 1);
+            const real d0 = derivative(i);
+            const real d1 = derivative(i + 1);
+
+            table.data[4 * i]     = y0;
+            table.data[4 * i + 1] = d0;
+            table.data[4 * i + 2] = 3 * (y1 - y0) - 2 * d0 - d1;
+            table.data[4 * i + 3] = -2 * (y1 - y0) + d0 + d1;
+        }
+        return table;
+    }
+
+    matrix               box_;
+    t_pbc                pbc_;
+    PaddedVector<RVec>   x_;
+    std::vector<t_iatom> iatoms_;
+    t_fcdata             fcd_;
+};
+
+TEST_F(ListedForcesSimdTest, TabulatedBonds)
+{
+    testTabulated(F_TABBONDS, 0.4);
+}
+
+TEST_F(ListedForcesSimdTest, TabulatedAngles)
+{
+    testTabulated(F_TABANGLES, M_PI);
+}
+
+TEST_F(ListedForcesSimdTest, TabulatedDihedrals)
+{
+    testTabulated(F_TABDIHS, 2 * M_PI);
+}
+
+TEST_F(ListedForcesSimdTest, Cmap)
+{
+    generateInteractions(F_CMAP);
+
+    /* Two grids of smooth functions, with derivatives per degree */
+    const int  gridSpacing = 24;
+    const real dx          = 2 * M_PI / gridSpacing;
+    gmx_cmap_t cmapGrid;
+    cmapGrid.grid_spacing = gridSpacing;
+    cmapGrid.cmapdata.resize(c_numTypes);
+    for (int type = 0; type < c_numTypes; type++)
+    {
+        std::vector<real>& data = cmapGrid.cmapdata[type].cmap;
+        data.resize(4 * gridSpacing * gridSpacing);
+        for (int i = 0; i < gridSpacing; i++)
+        {
+            for (int j = 0; j < gridSpacing; j++)
+            {
+                const real phi = -M_PI + i * dx;
+                const real psi = -M_PI + j * dx;
+                const real a   = 1 + type;
+                real*      v   = data.data() + 4 * (i * gridSpacing + j);
+                v[0]           = a * std::cos(phi) * std::sin(2 * psi) + std::cos(psi);
+                v[1]           = -a * std::sin(phi) * std::sin(2 * psi) * DEG2RAD;
+                v[2] = (2 * a * std::cos(phi) * std::cos(2 * psi) - std::sin(psi)) * DEG2RAD;
+                v[3]           = -2 * a * std::sin(phi) * std::cos(2 * psi) * DEG2RAD * DEG2RAD;
+            }
+        }
+    }
+
+    t_iparams iparams[c_numTypes];
+    for (int type = 0; type < c_numTypes; type++)
+    {
+        iparams[type].cmap.cmapA = type;
+        iparams[type].cmap.cmapB = type;
+    }
+
+    std::vector<int> ddgatindex(x_.size());
+    std::iota(ddgatindex.begin(), ddgatindex.end(), 0);
+    compareFlavors([&](BondedKernelFlavor flavor, rvec4* f, rvec* fshift) {
+        auto cmapFunction = (flavor == BondedKernelFlavor::ForcesSimdWhenAvailable) ? cmap_dihs_simd
+                                                                                     : cmap_dihs;
+        real dvdlambda = 0;
+        cmapFunction(iatoms_.size(),
+                     iatoms_.data(),
+                     iparams,
+                     &cmapGrid,
+                     as_rvec_array(x_.data()),
+                     f,
+                     fshift,
+                     &pbc_,
+                     0,
+                     &dvdlambda,
+                     nullptr,
+                     nullptr,
+                     ddgatindex.data());
+    });
+}
+
 } // namespace
 
 } // namespace test
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements tests of sorting listed interactions on atom index
+ *
+ * \ingroup module_listed_forces
+ */
+#include "gmxpre.h"
+
+#include "gromacs/listed_forces/manage_threading.h"
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/forcefieldparameters.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture providing empty interaction definitions
+class SortBondedsByLocalityTest : public ::testing::Test
+{
+public:
+    SortBondedsByLocalityTest() : idef_(ffparams_) { idef_.ilsort = ilsortNO_FE; }
+
+    //! Force-field parameters, not used by the sorting
+    gmx_ffparams_t ffparams_;
+    //! The interactions to sort
+    InteractionDefinitions idef_;
+};
+
+TEST_F(SortBondedsByLocalityTest, SortsOnLowestAtomIndex)
+{
+    InteractionList& bonds = idef_.il[F_BONDS];
+    bonds.push_back(0, std::array<int, 2>{ 9, 8 });
+    bonds.push_back(1, std::array<int, 2>{ 2, 3 });
+    bonds.push_back(2, std::array<int, 2>{ 6, 4 });
+
+    sort_bondeds_by_locality(&idef_);
+
+    const std::vector<int> expected = { 1, 2, 3, 2, 6, 4, 0, 9, 8 };
+    EXPECT_EQ(expected, bonds.iatoms);
+}
+
+TEST_F(SortBondedsByLocalityTest, KeepsOrderOfInteractionsWithEqualKeys)
+{
+    InteractionList& angles = idef_.il[F_ANGLES];
+    angles.push_back(0, std::array<int, 3>{ 7, 5, 8 });
+    angles.push_back(1, std::array<int, 3>{ 5, 6, 7 });
+    angles.push_back(2, std::array<int, 3>{ 1, 2, 3 });
+    angles.push_back(3, std::array<int, 3>{ 6, 7, 5 });
+    angles.push_back(4, std::array<int, 3>{ 8, 5, 6 });
+
+    sort_bondeds_by_locality(&idef_);
+
+    const std::vector<int> expected = {
+        2, 1, 2, 3, 0, 7, 5, 8, 1, 5, 6, 7, 3, 6, 7, 5, 4, 8, 5, 6
+    };
+    EXPECT_EQ(expected, angles.iatoms);
+}
+
+TEST_F(SortBondedsByLocalityTest, SortsPerturbedInteractionsSeparately)
+{
+    idef_.ilsort = ilsortFE_SORTED;
+    idef_.numNonperturbedInteractions.fill(0);
+    InteractionList& bonds = idef_.il[F_BONDS];
+    // Non-perturbed interactions
+    bonds.push_back(0, std::array<int, 2>{ 8, 9 });
+    bonds.push_back(1, std::array<int, 2>{ 4, 5 });
+    bonds.push_back(2, std::array<int, 2>{ 6, 7 });
+    // Perturbed interactions, with lower atom indices
+    bonds.push_back(3, std::array<int, 2>{ 2, 3 });
+    bonds.push_back(4, std::array<int, 2>{ 0, 1 });
+    idef_.numNonperturbedInteractions[F_BONDS] = 3 * (1 + NRAL(F_BONDS));
+
+    sort_bondeds_by_locality(&idef_);
+
+    const std::vector<int> expected = { 1, 4, 5, 2, 6, 7, 0, 8, 9, 4, 0, 1, 3, 2, 3 };
+    EXPECT_EQ(expected, bonds.iatoms);
+    EXPECT_EQ(3 * (1 + NRAL(F_BONDS)), idef_.numNonperturbedInteractions[F_BONDS]);
+}
+
+TEST_F(SortBondedsByLocalityTest, LeavesRestraintsUnsorted)
+{
+    InteractionList& distanceRestraints = idef_.il[F_DISRES];
+    distanceRestraints.push_back(0, std::array<int, 2>{ 6, 7 });
+    distanceRestraints.push_back(0, std::array<int, 2>{ 2, 3 });
+    distanceRestraints.push_back(1, std::array<int, 2>{ 0, 1 });
+    const std::vector<int> original = distanceRestraints.iatoms;
+
+    sort_bondeds_by_locality(&idef_);
+
+    EXPECT_EQ(original, distanceRestraints.iatoms);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,149 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Defines the asynchronous checkpoint writer.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "asynccheckpointwriter.h"
+
+#include <cstdlib>
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+class AsyncCheckpointWriter::Impl
+{
+public:
+    ~Impl();
+
+    //! Joins the background thread and throws when its task failed
+    void waitForCompletion();
+
+    //! The staging buffer for the serialized checkpoint, not initialized
+    std::unique_ptr<char[]> stagingBuffer_;
+    //! The size of stagingBuffer_
+    std::size_t stagingBufferSize_ = 0;
+    //! The thread completing the pending checkpoint, not joinable when there is none
+    std::thread thread_;
+    //! The error message of the pending checkpoint, written by thread_
+    std::string errorMessage_;
+};
+
+AsyncCheckpointWriter::Impl::~Impl()
+{
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+void AsyncCheckpointWriter::Impl::waitForCompletion()
+{
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    if (!errorMessage_.empty())
+    {
+        /* Report each error only once */
+        std::string errorMessage;
+        std::swap(errorMessage, errorMessage_);
+        GMX_THROW(FileIOError(errorMessage));
+    }
+}
+
+AsyncCheckpointWriter::AsyncCheckpointWriter() : impl_(new Impl) {}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() = default;
+
+ArrayRef<char> AsyncCheckpointWriter::stagingBuffer(std::size_t size)
+{
+    impl_->waitForCompletion();
+
+    if (impl_->stagingBufferSize_ < size)
+    {
+        /* Release the old buffer first, as checkpoints can be large.
+         * The buffer is not zero-initialized, as it is only written to.
+         */
+        impl_->stagingBuffer_.reset();
+        impl_->stagingBufferSize_ = 0;
+        impl_->stagingBuffer_.reset(new char[size]);
+        impl_->stagingBufferSize_ = size;
+    }
+
+    return { impl_->stagingBuffer_.get(), impl_->stagingBuffer_.get() + impl_->stagingBufferSize_ };
+}
+
+void AsyncCheckpointWriter::completeInBackground(std::function<std::string()> completeCheckpoint)
+{
+    impl_->waitForCompletion();
+
+    impl_->thread_ = std::thread(
+            [this](const std::function<std::string()>& task) {
+                try
+                {
+                    impl_->errorMessage_ = task();
+                }
+                catch (const std::exception& ex)
+                {
+                    impl_->errorMessage_ = ex.what();
+                }
+            },
+            std::move(completeCheckpoint));
+}
+
+void AsyncCheckpointWriter::waitForCompletion()
+{
+    impl_->waitForCompletion();
+}
+
+bool asyncCheckpointingRequested()
+{
+    return std::getenv("GMX_ASYNC_CHECKPOINT") != nullptr;
+}
+
+} // namespace gmx
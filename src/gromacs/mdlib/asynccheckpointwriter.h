@@ -0,0 +1,113 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief Declares the asynchronous checkpoint writer.
+ *
+ * The checkpoint is serialized at the checkpoint step into a staging
+ * buffer that backs the stdio stream of the temporary checkpoint file.
+ * Flushing that buffer to disk, syncing the output files and moving the
+ * checkpoint into place are then done on a background thread, so the
+ * master rank does not wait for the file system. Serializing and
+ * computing the MD5 sums of the output files are done at the checkpoint
+ * step, as they read data that the next steps modify.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_ASYNCCHECKPOINTWRITER_H
+#define GMX_MDLIB_ASYNCCHECKPOINTWRITER_H
+
+#include <cstddef>
+
+#include <functional>
+#include <string>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+
+namespace gmx
+{
+
+/*! \libinternal
+ * \brief Completes checkpoint files on a background thread
+ *
+ * At most one checkpoint is in flight. All calls must be made from
+ * the same (master) thread. An error in the background task is thrown
+ * as a FileIOError on the calling thread at the next call.
+ */
+class AsyncCheckpointWriter
+{
+public:
+    AsyncCheckpointWriter();
+    //! Destructor, waits for the pending checkpoint to complete
+    ~AsyncCheckpointWriter();
+
+    /*! \brief Returns a staging buffer of at least \p size bytes
+     *
+     * Waits for the pending checkpoint first, as that might still be
+     * using the buffer. The buffer is kept between checkpoints, so it
+     * is only reallocated when a checkpoint needs a larger buffer.
+     * Its contents are not initialized.
+     *
+     * \throws FileIOError when the pending checkpoint failed.
+     */
+    ArrayRef<char> stagingBuffer(std::size_t size);
+
+    /*! \brief Runs \p completeCheckpoint on a background thread
+     *
+     * The task returns an error message, which is empty on success.
+     *
+     * \throws FileIOError when the pending checkpoint failed.
+     */
+    void completeInBackground(std::function<std::string()> completeCheckpoint);
+
+    /*! \brief Blocks until the pending checkpoint, if any, has been completed
+     *
+     * \throws FileIOError when the pending checkpoint failed.
+     */
+    void waitForCompletion();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+//! Returns whether the user requested asynchronous checkpointing through GMX_ASYNC_CHECKPOINT
+bool asyncCheckpointingRequested();
+
+} // namespace gmx
+
+#endif
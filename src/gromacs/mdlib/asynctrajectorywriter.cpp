@@ -0,0 +1,429 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Defines the asynchronous trajectory writer.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "asynctrajectorywriter.h"
+
+#include <cstdlib>
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trajectoryindex.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The trajectory format of a queued frame
+enum class FrameFormat
+{
+    Xtc,
+    Trr
+};
+
+/*! \internal
+ * \brief A snapshot of a trajectory frame, buffers are reused between frames
+ */
+struct QueuedFrame
+{
+    //! The format to write
+    FrameFormat format = FrameFormat::Xtc;
+    //! The file to write to
+    t_fileio* fio = nullptr;
+    //! The frame index to add the frame to, can be nullptr
+    TrajectoryIndexWriter* index = nullptr;
+    //! The MD step
+    int64_t step = 0;
+    //! The time
+    double t = 0;
+    //! The FEP lambda, only used for TRR
+    real lambda = 0;
+    //! The box
+    matrix box = { { 0 } };
+    //! The number of atoms
+    int natoms = 0;
+    //! The XTC precision
+    real precision = 0;
+    //! Whether the x, v and f buffers are written
+    bool haveX = false, haveV = false, haveF = false;
+    //! Coordinates
+    std::vector<RVec> x;
+    //! Velocities
+    std::vector<RVec> v;
+    //! Forces
+    std::vector<RVec> f;
+};
+
+//! Copies \p src into the pooled buffer \p dest, returns whether \p src was not empty
+bool snapshot(ArrayRef<const RVec> src, std::vector<RVec>* dest)
+{
+    dest->assign(src.begin(), src.end());
+    return !src.empty();
+}
+
+//! Returns a pointer to the buffer data or nullptr when the buffer should not be written
+const rvec* bufferOrNull(bool haveBuffer, const std::vector<RVec>& buffer)
+{
+    return haveBuffer ? as_rvec_array(buffer.data()) : nullptr;
+}
+
+} // namespace
+
+class AsyncTrajectoryWriter::Impl
+{
+public:
+    explicit Impl(int maxQueuedFrames);
+    ~Impl();
+
+    //! Returns a frame from the pool, blocks while the queue is full
+    std::unique_ptr<QueuedFrame> getFreeFrame();
+    //! Passes a filled frame to the I/O thread
+    void enqueue(std::unique_ptr<QueuedFrame> frame);
+    //! Blocks until the queue is empty and the I/O thread is idle
+    void waitForCompletion();
+
+private:
+    //! The I/O thread main loop
+    void ioThreadLoop();
+    //! Writes a single frame, returns an error message on failure
+    std::string writeFrame(QueuedFrame* frame);
+    //! Rethrows or issues errors reported by the I/O thread, requires the lock to be held
+    void checkForErrors();
+    //! Returns whether the I/O thread reported an error, requires the lock to be held
+    bool haveError() const { return !errorMessage_.empty() || exception_ != nullptr; }
+
+    //! The maximum number of frames in the queue
+    const int maxQueuedFrames_;
+    //! Protects all members below
+    std::mutex mutex_;
+    //! Signals the I/O thread that there is work or that it should stop
+    std::condition_variable workAvailable_;
+    //! Signals the master thread that a frame has been written
+    std::condition_variable frameWritten_;
+    //! Frames waiting to be written
+    std::queue<std::unique_ptr<QueuedFrame>> queue_;
+    //! Frames with buffers available for reuse
+    std::vector<std::unique_ptr<QueuedFrame>> pool_;
+    //! Whether the I/O thread is writing a frame
+    bool ioThreadBusy_ = false;
+    //! Whether the I/O thread should stop
+    bool stopRequested_ = false;
+    //! The error message of the first failed write, empty when there was none
+    std::string errorMessage_;
+    //! The first exception thrown on the I/O thread, to be rethrown on the master thread
+    std::exception_ptr exception_;
+    //! The I/O thread, started last
+    std::thread ioThread_;
+};
+
+AsyncTrajectoryWriter::Impl::Impl(int maxQueuedFrames) : maxQueuedFrames_(maxQueuedFrames)
+{
+    GMX_RELEASE_ASSERT(maxQueuedFrames_ > 0, "Need at least one frame in the output queue");
+
+    ioThread_ = std::thread(&Impl::ioThreadLoop, this);
+}
+
+AsyncTrajectoryWriter::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopRequested_ = true;
+    }
+    workAvailable_.notify_one();
+    ioThread_.join();
+}
+
+std::unique_ptr<QueuedFrame> AsyncTrajectoryWriter::Impl::getFreeFrame()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Back-pressure: don't let the MD loop run ahead of the disk by more than the queue depth
+    frameWritten_.wait(lock, [this]() {
+        return static_cast<int>(queue_.size()) < maxQueuedFrames_ || haveError();
+    });
+    checkForErrors();
+
+    if (pool_.empty())
+    {
+        return std::make_unique<QueuedFrame>();
+    }
+    auto frame = std::move(pool_.back());
+    pool_.pop_back();
+
+    return frame;
+}
+
+void AsyncTrajectoryWriter::Impl::enqueue(std::unique_ptr<QueuedFrame> frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(std::move(frame));
+    }
+    workAvailable_.notify_one();
+}
+
+void AsyncTrajectoryWriter::Impl::waitForCompletion()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    frameWritten_.wait(lock, [this]() {
+        return (queue_.empty() && !ioThreadBusy_) || haveError();
+    });
+    checkForErrors();
+}
+
+void AsyncTrajectoryWriter::Impl::checkForErrors()
+{
+    if (exception_)
+    {
+        /* Rethrow only once, the writer is unusable after this */
+        std::exception_ptr exception = exception_;
+        exception_                   = nullptr;
+        errorMessage_                = "Trajectory output failed on an earlier frame";
+        std::rethrow_exception(exception);
+    }
+    if (!errorMessage_.empty())
+    {
+        gmx_fatal(FARGS, "%s", errorMessage_.c_str());
+    }
+}
+
+void AsyncTrajectoryWriter::Impl::ioThreadLoop()
+{
+    /* XTC compression can use OpenMP, but this thread runs concurrently
+     * with the MD loop, so it should not compete with the compute threads.
+     */
+    gmx_omp_set_num_threads(1);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        workAvailable_.wait(lock, [this]() { return !queue_.empty() || stopRequested_; });
+        if (queue_.empty())
+        {
+            // Stop is only honored after all pending frames have been written
+            break;
+        }
+
+        auto frame = std::move(queue_.front());
+        queue_.pop();
+        ioThreadBusy_ = true;
+
+        lock.unlock();
+        std::string        errorMessage;
+        std::exception_ptr exception;
+        /* Errors can not terminate the run from this thread, so they are
+         * passed on to the master thread, which reports them at the next call.
+         */
+        try
+        {
+            errorMessage = writeFrame(frame.get());
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        lock.lock();
+
+        ioThreadBusy_ = false;
+        pool_.push_back(std::move(frame));
+        if (!haveError())
+        {
+            errorMessage_ = errorMessage;
+            exception_    = exception;
+        }
+        frameWritten_.notify_all();
+    }
+}
+
+std::string AsyncTrajectoryWriter::Impl::writeFrame(QueuedFrame* frame)
+{
+    const gmx_off_t offset = gmx_fio_ftell(frame->fio);
+    switch (frame->format)
+    {
+        case FrameFormat::Xtc:
+            if (write_xtc(frame->fio,
+                          frame->natoms,
+                          frame->step,
+                          frame->t,
+                          frame->box,
+                          as_rvec_array(frame->x.data()),
+                          frame->precision)
+                == 0)
+            {
+                return "XTC error. This indicates you are out of disk space, or a "
+                       "simulation with major instabilities resulting in coordinates "
+                       "that are NaN or too large to be represented in the XTC format.\n";
+            }
+            break;
+        case FrameFormat::Trr:
+            if (!gmx_trr_try_write_frame(frame->fio,
+                                         frame->step,
+                                         frame->t,
+                                         frame->lambda,
+                                         frame->box,
+                                         frame->natoms,
+                                         bufferOrNull(frame->haveX, frame->x),
+                                         bufferOrNull(frame->haveV, frame->v),
+                                         bufferOrNull(frame->haveF, frame->f)))
+            {
+                return "Cannot write trajectory frame; maybe you are out of disk space?";
+            }
+            break;
+    }
+    if (gmx_fio_flush(frame->fio) != 0)
+    {
+        return "Cannot write trajectory; maybe you are out of disk space?";
+    }
+    if (frame->index)
+    {
+        frame->index->addFrame({ frame->step, frame->t, offset, frame->natoms });
+    }
+
+    return std::string();
+}
+
+AsyncTrajectoryWriter::AsyncTrajectoryWriter(int maxQueuedFrames) :
+    impl_(new Impl(maxQueuedFrames))
+{
+}
+
+AsyncTrajectoryWriter::~AsyncTrajectoryWriter() = default;
+
+void AsyncTrajectoryWriter::writeXtcFrame(t_fileio*              fio,
+                                          TrajectoryIndexWriter* index,
+                                          int64_t                step,
+                                          double                 t,
+                                          const matrix           box,
+                                          ArrayRef<const RVec>   x,
+                                          ArrayRef<const int>    selection,
+                                          real                   precision)
+{
+    auto frame       = impl_->getFreeFrame();
+    frame->format    = FrameFormat::Xtc;
+    frame->fio       = fio;
+    frame->index     = index;
+    frame->step      = step;
+    frame->t         = t;
+    frame->precision = precision;
+    copy_mat(box, frame->box);
+    if (selection.empty())
+    {
+        snapshot(x, &frame->x);
+    }
+    else
+    {
+        frame->x.resize(selection.size());
+        for (size_t i = 0; i < selection.size(); i++)
+        {
+            frame->x[i] = x[selection[i]];
+        }
+    }
+    frame->natoms = frame->x.size();
+    frame->haveX  = true;
+
+    impl_->enqueue(std::move(frame));
+}
+
+void AsyncTrajectoryWriter::writeTrrFrame(t_fileio*              fio,
+                                          TrajectoryIndexWriter* index,
+                                          int64_t                step,
+                                          double                 t,
+                                          real                   lambda,
+                                          const matrix           box,
+                                          int                    natoms,
+                                          ArrayRef<const RVec>   x,
+                                          ArrayRef<const RVec>   v,
+                                          ArrayRef<const RVec>   f)
+{
+    auto frame    = impl_->getFreeFrame();
+    frame->format = FrameFormat::Trr;
+    frame->fio    = fio;
+    frame->index  = index;
+    frame->step   = step;
+    frame->t      = t;
+    frame->lambda = lambda;
+    frame->natoms = natoms;
+    copy_mat(box, frame->box);
+    frame->haveX = snapshot(x, &frame->x);
+    frame->haveV = snapshot(v, &frame->v);
+    frame->haveF = snapshot(f, &frame->f);
+
+    impl_->enqueue(std::move(frame));
+}
+
+void AsyncTrajectoryWriter::waitForCompletion()
+{
+    impl_->waitForCompletion();
+}
+
+int asyncTrajectoryOutputQueueDepth()
+{
+    const char* env = std::getenv("GMX_ASYNC_TRAJECTORY_OUTPUT");
+    if (env == nullptr)
+    {
+        return 0;
+    }
+    // An empty value or a non-number selects the default depth
+    const int c_defaultQueueDepth = 2;
+    char*     end                 = nullptr;
+    const int depth               = static_cast<int>(std::strtol(env, &end, 10));
+
+    return (end != env && depth >= 0) ? depth : c_defaultQueueDepth;
+}
+
+} // namespace gmx
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief Declares the asynchronous trajectory writer.
+ *
+ * The writer takes snapshots of coordinate, velocity and force frames
+ * into a pool of reusable buffers and leaves XTC compression and the
+ * actual XTC/TRR file output to a dedicated I/O thread. The number of
+ * frames in flight is bounded; when the queue is full, the submitting
+ * thread blocks until the I/O thread has caught up.
+ *
+ * \inlibraryapi
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_ASYNCTRAJECTORYWRITER_H
+#define GMX_MDLIB_ASYNCTRAJECTORYWRITER_H
+
+#include <cstdint>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/real.h"
+
+struct t_fileio;
+
+namespace gmx
+{
+class TrajectoryIndexWriter;
+
+/*! \libinternal
+ * \brief Writes XTC and TRR frames on a background thread
+ *
+ * All calls must be made from the same (master) thread. Any pending
+ * output is completed before waitForCompletion() and the destructor
+ * return, so callers must drain the writer before they query file
+ * positions (e.g. for checkpointing) or close the files written to.
+ * Errors on the I/O thread are reported on the submitting thread at the
+ * next call: exceptions thrown while writing are rethrown and write
+ * failures are issued as fatal errors. The destructor does not report
+ * errors, so call waitForCompletion() before destruction.
+ */
+class AsyncTrajectoryWriter
+{
+public:
+    /*! \brief Constructor, starts the I/O thread
+     *
+     * \param[in] maxQueuedFrames  The maximum number of frames waiting to be written
+     */
+    explicit AsyncTrajectoryWriter(int maxQueuedFrames);
+    //! Destructor, writes all pending frames and stops the I/O thread
+    ~AsyncTrajectoryWriter();
+
+    /*! \brief Queues an XTC frame with the coordinates \p x
+     *
+     * When \p selection is not empty, only the coordinates of the atoms
+     * with these indices are written. When \p index is not nullptr,
+     * an entry for the frame is added to it after writing.
+     */
+    void writeXtcFrame(t_fileio*              fio,
+                       TrajectoryIndexWriter* index,
+                       int64_t                step,
+                       double                 t,
+                       const matrix           box,
+                       ArrayRef<const RVec>   x,
+                       ArrayRef<const int>    selection,
+                       real                   precision);
+
+    /*! \brief Queues a TRR frame, empty arrays are not written
+     *
+     * \p natoms is the number of atoms in the frame, which is needed
+     * when only the box is written. When \p index is not nullptr,
+     * an entry for the frame is added to it after writing.
+     */
+    void writeTrrFrame(t_fileio*              fio,
+                       TrajectoryIndexWriter* index,
+                       int64_t                step,
+                       double                 t,
+                       real                   lambda,
+                       const matrix           box,
+                       int                    natoms,
+                       ArrayRef<const RVec>   x,
+                       ArrayRef<const RVec>   v,
+                       ArrayRef<const RVec>   f);
+
+    /*! \brief Blocks until all queued frames have been written and flushed
+     *
+     * \throws any exception thrown while writing an earlier frame.
+     */
+    void waitForCompletion();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+/*! \brief Returns the maximum number of queued output frames requested by
+ * the user through GMX_ASYNC_TRAJECTORY_OUTPUT, 0 means synchronous output
+ */
+int asyncTrajectoryOutputQueueDepth();
+
+} // namespace gmx
+
+#endif
@@ -59,6 +59,8 @@
 #define GMX_FORCE_DHDL (1u << 10u)
 /* Tells whether only the MTS combined force buffer is needed and not the normal force buffer */
 #define GMX_FORCE_DO_NOT_NEED_NORMAL_FORCE (1u << 11u)
+/* Leave the local non-bonded forces in the nbnxm buffer, to be added during the update */
+#define GMX_FORCE_DEFER_LOCAL_NONBONDED_FORCES (1u << 12u)
 
 /* Normally one want all energy terms and forces */
 #define GMX_FORCE_ALLFORCES (GMX_FORCE_LISTED | GMX_FORCE_NONBONDED | GMX_FORCE_FORCES)
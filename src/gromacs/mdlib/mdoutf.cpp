@@ -39,16 +39,25 @@
 
 #include "config.h"
 
+#include <cstdio>
+#include <cstring>
+
+#include <exception>
+#include <string>
+
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/collect.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/tngio.h"
+#include "gromacs/fileio/trajectoryindex.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/asynccheckpointwriter.h"
+#include "gromacs/mdlib/asynctrajectorywriter.h"
 #include "gromacs/mdlib/trajectory_writing.h"
 #include "gromacs/mdrunutility/handlerestart.h"
 #include "gromacs/mdrunutility/multisim.h"
@@ -91,14 +100,22 @@ struct gmx_mdoutf
     int                           natoms_global;
     int                           natoms_x_compressed;
     const SimulationGroups*       groups; /* for compressed position writing */
+    int* x_compressed_indices; /* atom indices for compressed output, only used with async output */
     gmx_wallcycle_t               wcycle;
     rvec*                         f_global;
     gmx::IMDOutputProvider*       outputProvider;
     const gmx::MdModulesNotifier* mdModulesNotifier;
     bool                          simulationsShareState;
     MPI_Comm                      mastersComm;
+    gmx::AsyncTrajectoryWriter*   asyncWriter; /* nullptr when writing XTC/TRR synchronously */
+    gmx::TrajectoryIndexWriter*   xtcIndex;    /* frame index of the XTC file, can be nullptr */
+    gmx::TrajectoryIndexWriter*   trrIndex;    /* frame index of the TRR file, can be nullptr */
+    gmx::AsyncCheckpointWriter* asyncCheckpointWriter; /* nullptr when checkpointing synchronously */
 };
 
+//! The size of the checkpoint staging buffer on top of the atom vectors of the state
+static constexpr size_t c_checkpointStagingBufferMargin = 16 * 1024 * 1024;
+
 
 gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
                          int                           nfile,
@@ -138,6 +155,11 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     of->wcycle                  = wcycle;
     of->f_global                = nullptr;
     of->outputProvider          = outputProvider;
+    of->x_compressed_indices    = nullptr;
+    of->asyncWriter             = nullptr;
+    of->xtcIndex                = nullptr;
+    of->trrIndex                = nullptr;
+    of->asyncCheckpointWriter   = nullptr;
 
     GMX_RELEASE_ASSERT(!simulationsShareState || ms != nullptr,
                        "Need valid multisim object when simulations share state");
@@ -241,6 +263,60 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
         {
             snew(of->f_global, top_global->natoms);
         }
+
+        if (gmx::writeTrajectoryIndexRequested())
+        {
+            /* On appending, the trajectories have already been truncated
+               to the checkpoint, so stale index entries get dropped here. */
+            if (of->fp_xtc)
+            {
+                of->xtcIndex = new gmx::TrajectoryIndexWriter(gmx_fio_getname(of->fp_xtc),
+                                                              restartWithAppending);
+            }
+            if (of->fp_trn)
+            {
+                of->trrIndex = new gmx::TrajectoryIndexWriter(gmx_fio_getname(of->fp_trn),
+                                                              restartWithAppending);
+            }
+        }
+
+        /* The TNG library is not used from a separate thread, so asynchronous
+           output is only used when all trajectory output is XTC and/or TRR. */
+        const int asyncQueueDepth = gmx::asyncTrajectoryOutputQueueDepth();
+        if (asyncQueueDepth > 0 && (of->fp_xtc || of->fp_trn) && !of->tng && !of->tng_low_prec)
+        {
+            of->asyncWriter = new gmx::AsyncTrajectoryWriter(asyncQueueDepth);
+            if (of->natoms_x_compressed != of->natoms_global)
+            {
+                int j = 0;
+                snew(of->x_compressed_indices, of->natoms_x_compressed);
+                for (i = 0; i < top_global->natoms; i++)
+                {
+                    if (getGroupType(*of->groups, SimulationAtomGroupType::CompressedPositionOutput, i) == 0)
+                    {
+                        of->x_compressed_indices[j++] = i;
+                    }
+                }
+            }
+            if (fplog)
+            {
+                fprintf(fplog,
+                        "Writing XTC/TRR output on a separate thread with at most %d queued "
+                        "frames\n",
+                        asyncQueueDepth);
+            }
+        }
+
+        /* The MPI barrier before renaming the checkpoint can not be called
+           from a separate thread, so then we checkpoint synchronously. */
+        if (gmx::asyncCheckpointingRequested() && !simulationsShareState && !GMX_FAHCORE)
+        {
+            of->asyncCheckpointWriter = new gmx::AsyncCheckpointWriter();
+            if (fplog)
+            {
+                fprintf(fplog, "Completing checkpoint files on a separate thread\n");
+            }
+        }
     }
 
     if (bCiteTng)
@@ -300,13 +376,13 @@ static void write_checkpoint(const char*                     fn,
                              const gmx::MdModulesNotifier&   mdModulesNotifier,
                              gmx::WriteCheckpointDataHolder* modularSimulatorCheckpointData,
                              bool                            applyMpiBarrierBeforeRename,
-                             MPI_Comm                        mpiBarrierCommunicator)
+                             MPI_Comm                        mpiBarrierCommunicator,
+                             gmx::AsyncCheckpointWriter*     asyncCheckpointWriter)
 {
     t_fileio* fp;
     char*     fntemp; /* the temporary checkpoint file name */
     int       npmenodes;
     char      buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
-    t_fileio* ret;
 
     if (DOMAINDECOMP(cr))
     {
@@ -339,11 +415,42 @@ static void write_checkpoint(const char*                     fn,
         fprintf(fplog, "Writing checkpoint, step %s at %s\n\n", gmx_step_str(step, buf), timebuf.c_str());
     }
 
+    /* The previous checkpoint file needs to be closed before we get the offsets */
+    if (asyncCheckpointWriter)
+    {
+        asyncCheckpointWriter->waitForCompletion();
+    }
+
     /* Get offsets for open files */
     auto outputfiles = gmx_fio_get_output_file_positions();
 
     fp = gmx_fio_open(fntemp, "w");
 
+    if (asyncCheckpointWriter)
+    {
+        /* Serialize into a staging buffer that backs the file stream,
+         * so nothing is written to disk until the stream is flushed
+         * on the background thread. When the estimate is too low,
+         * stdio writes part of the data here, which is still correct.
+         * Serializing and computing the MD5 sums of the output files
+         * stay on this thread, as they read the state, the observables
+         * history, the module data and the output files that the next
+         * steps modify. Doing them in the background would need deep
+         * copies of all of these, while serializing into memory is
+         * cheap compared to writing to disk.
+         */
+        const int  numAtomVectors = ((state->flags & (1 << estX)) ? 1 : 0)
+                                   + ((state->flags & (1 << estV)) ? 1 : 0)
+                                   + ((state->flags & (1 << estCGP)) ? 1 : 0);
+        const auto stagingBuffer  = asyncCheckpointWriter->stagingBuffer(
+                c_checkpointStagingBufferMargin
+                + static_cast<size_t>(numAtomVectors) * state->natoms * DIM * sizeof(real));
+        if (setvbuf(gmx_fio_getfp(fp), stagingBuffer.data(), _IOFBF, stagingBuffer.size()) != 0)
+        {
+            gmx_file("Cannot set up the buffer for the checkpoint file");
+        }
+    }
+
     /* We can check many more things now (CPU, acceleration, etc), but
      * it is highly unlikely to have two separate builds with exactly
      * the same version, user, time, and build host!
@@ -404,76 +511,107 @@ static void write_checkpoint(const char*                     fn,
                           &outputfiles,
                           modularSimulatorCheckpointData);
 
-    /* we really, REALLY, want to make sure to physically write the checkpoint,
-       and all the files it depends on, out to disk. Because we've
-       opened the checkpoint with gmx_fio_open(), it's in our list
-       of open files.  */
-    ret = gmx_fio_all_output_fsync();
-
-    if (ret)
-    {
-        char buf[STRLEN];
-        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
-
-        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
-        {
-            gmx_file(buf);
-        }
-        else
+    /* Completes the checkpoint, returns an error message on failure */
+    auto completeCheckpoint = [fp,
+                               fntemp = std::string(fntemp),
+                               fn     = std::string(fn),
+                               bNumberAndKeep,
+                               applyMpiBarrierBeforeRename,
+                               mpiBarrierCommunicator]() -> std::string {
+        /* we really, REALLY, want to make sure to physically write the checkpoint,
+           and all the files it depends on, out to disk. Because we've
+           opened the checkpoint with gmx_fio_open(), it's in our list
+           of open files.  The checkpoint data can still be in the stream
+           buffer, so it needs to be flushed before the fsync. */
+        if (gmx_fio_flush(fp) != 0)
         {
-            gmx_warning("%s", buf);
+            gmx_fio_close(fp);
+            return "Cannot write checkpoint; maybe you are out of disk space?";
         }
-    }
+        t_fileio* ret = gmx_fio_all_output_fsync();
 
-    if (gmx_fio_close(fp) != 0)
-    {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
-    }
-
-    /* we don't move the checkpoint if the user specified they didn't want it,
-       or if the fsyncs failed */
-#if !GMX_NO_RENAME
-    if (!bNumberAndKeep && !ret)
-    {
-        if (gmx_fexist(fn))
+        if (ret)
         {
-            /* Rename the previous checkpoint file */
-            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+            char buf[STRLEN];
+            sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
 
-            std::strcpy(buf, fn);
-            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
-            std::strcat(buf, "_prev");
-            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
-            if (!GMX_FAHCORE)
+            if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
             {
-                /* we copy here so that if something goes wrong between now and
-                 * the rename below, there's always a state.cpt.
-                 * If renames are atomic (such as in POSIX systems),
-                 * this copying should be unneccesary.
-                 */
-                gmx_file_copy(fn, buf, FALSE);
-                /* We don't really care if this fails:
-                 * there's already a new checkpoint.
-                 */
+                gmx_fio_close(fp);
+                return buf;
             }
             else
             {
-                gmx_file_rename(fn, buf);
+                gmx_warning("%s", buf);
             }
         }
 
-        /* Rename the checkpoint file from the temporary to the final name */
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+        if (gmx_fio_close(fp) != 0)
+        {
+            return "Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?";
+        }
 
-        if (gmx_file_rename(fntemp, fn) != 0)
+        /* we don't move the checkpoint if the user specified they didn't want it,
+           or if the fsyncs failed */
+#if !GMX_NO_RENAME
+        if (!bNumberAndKeep && !ret)
         {
-            gmx_file("Cannot rename checkpoint file; maybe you are out of disk space?");
+            if (gmx_fexist(fn))
+            {
+                /* Rename the previous checkpoint file */
+                mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+                std::string prevName = fn;
+                prevName.insert(fn.size() - std::strlen(ftp2ext(fn2ftp(fn.c_str()))) - 1, "_prev");
+                if (!GMX_FAHCORE)
+                {
+                    /* we copy here so that if something goes wrong between now and
+                     * the rename below, there's always a state.cpt.
+                     * If renames are atomic (such as in POSIX systems),
+                     * this copying should be unneccesary.
+                     */
+                    gmx_file_copy(fn.c_str(), prevName.c_str(), FALSE);
+                    /* We don't really care if this fails:
+                     * there's already a new checkpoint.
+                     */
+                }
+                else
+                {
+                    gmx_file_rename(fn.c_str(), prevName.c_str());
+                }
+            }
+
+            /* Rename the checkpoint file from the temporary to the final name */
+            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+            if (gmx_file_rename(fntemp.c_str(), fn.c_str()) != 0)
+            {
+                return "Cannot rename checkpoint file; maybe you are out of disk space?";
+            }
         }
-    }
+#else
+        GMX_UNUSED_VALUE(fntemp);
+        GMX_UNUSED_VALUE(bNumberAndKeep);
 #endif /* GMX_NO_RENAME */
 
+        return std::string();
+    };
+
     sfree(fntemp);
 
+    if (asyncCheckpointWriter)
+    {
+        asyncCheckpointWriter->completeInBackground(std::move(completeCheckpoint));
+    }
+    else
+    {
+        const std::string errorMessage = completeCheckpoint();
+        if (!errorMessage.empty())
+        {
+            gmx_file(errorMessage);
+        }
+    }
+
 #if GMX_FAHCORE
     /*code for alternate checkpointing scheme.  moved from top of loop over
        steps */
@@ -496,6 +634,12 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
 {
     fflush_tng(of->tng);
     fflush_tng(of->tng_low_prec);
+    /* The checkpoint stores the output file positions, so all queued
+       frames need to be on disk before we write it. */
+    if (of->asyncWriter)
+    {
+        of->asyncWriter->waitForCompletion();
+    }
     /* Write the checkpoint file.
      * When simulations share the state, an MPI barrier is applied before
      * renaming old and new checkpoint files to minimize the risk of
@@ -519,7 +663,8 @@ void mdoutf_write_checkpoint(gmx_mdoutf_t                    of,
                      *(of->mdModulesNotifier),
                      modularSimulatorCheckpointData,
                      of->simulationsShareState,
-                     of->mastersComm);
+                     of->mastersComm,
+                     of->asyncCheckpointWriter);
 }
 
 void mdoutf_write_to_trajectory_files(FILE*                           fplog,
@@ -600,14 +745,36 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
             const rvec* v = (mdof_flags & MDOF_V) ? state_global->v.rvec_array() : nullptr;
             const rvec* f = (mdof_flags & MDOF_F) ? f_global : nullptr;
 
-            if (of->fp_trn)
+            if (of->fp_trn && of->asyncWriter)
+            {
+                auto asArrayRef = [natoms](const rvec* buffer) {
+                    return gmx::arrayRefFromArray(reinterpret_cast<const gmx::RVec*>(buffer),
+                                                  buffer ? natoms : 0);
+                };
+                of->asyncWriter->writeTrrFrame(of->fp_trn,
+                                               of->trrIndex,
+                                               step,
+                                               t,
+                                               state_local->lambda[efptFEP],
+                                               state_local->box,
+                                               natoms,
+                                               asArrayRef(x),
+                                               asArrayRef(v),
+                                               asArrayRef(f));
+            }
+            else if (of->fp_trn)
             {
+                const gmx_off_t offset = gmx_fio_ftell(of->fp_trn);
                 gmx_trr_write_frame(
                         of->fp_trn, step, t, state_local->lambda[efptFEP], state_local->box, natoms, x, v, f);
                 if (gmx_fio_flush(of->fp_trn) != 0)
                 {
                     gmx_file("Cannot write trajectory; maybe you are out of disk space?");
                 }
+                if (of->trrIndex)
+                {
+                    of->trrIndex->addFrame({ step, t, offset, natoms });
+                }
             }
 
             /* If a TNG file is open for uncompressed coordinate output also write
@@ -633,7 +800,21 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                                f);
             }
         }
-        if (mdof_flags & MDOF_X_COMPRESSED)
+        if ((mdof_flags & MDOF_X_COMPRESSED) && of->asyncWriter)
+        {
+            /* The writer copies the (selected) coordinates into its own buffer */
+            const int numSelected = of->x_compressed_indices ? of->natoms_x_compressed : 0;
+            of->asyncWriter->writeXtcFrame(
+                    of->fp_xtc,
+                    of->xtcIndex,
+                    step,
+                    t,
+                    state_local->box,
+                    gmx::constArrayRefFromArray(state_global->x.data(), of->natoms_global),
+                    gmx::constArrayRefFromArray(of->x_compressed_indices, numSelected),
+                    of->x_compression_precision);
+        }
+        else if (mdof_flags & MDOF_X_COMPRESSED)
         {
             rvec* xxtc = nullptr;
 
@@ -660,6 +841,7 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                     }
                 }
             }
+            const gmx_off_t offset = of->fp_xtc ? gmx_fio_ftell(of->fp_xtc) : 0;
             if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc, of->x_compression_precision)
                 == 0)
             {
@@ -668,6 +850,10 @@ void mdoutf_write_to_trajectory_files(FILE*                           fplog,
                           "simulation with major instabilities resulting in coordinates "
                           "that are NaN or too large to be represented in the XTC format.\n");
             }
+            if (of->xtcIndex)
+            {
+                of->xtcIndex->addFrame({ step, t, offset, of->natoms_x_compressed });
+            }
             gmx_fwrite_tng(of->tng_low_prec,
                            TRUE,
                            step,
@@ -743,6 +929,30 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    /* Write all pending frames and the checkpoint before closing the files.
+     * Errors are rethrown after all files have been closed.
+     */
+    std::exception_ptr backgroundError;
+    try
+    {
+        if (of->asyncWriter)
+        {
+            of->asyncWriter->waitForCompletion();
+        }
+        if (of->asyncCheckpointWriter)
+        {
+            of->asyncCheckpointWriter->waitForCompletion();
+        }
+    }
+    catch (...)
+    {
+        backgroundError = std::current_exception();
+    }
+    delete of->asyncWriter;
+    delete of->asyncCheckpointWriter;
+    sfree(of->x_compressed_indices);
+    delete of->xtcIndex;
+    delete of->trrIndex;
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
@@ -769,6 +979,11 @@ void done_mdoutf(gmx_mdoutf_t of)
     gmx_tng_close(&of->tng_low_prec);
 
     sfree(of);
+
+    if (backgroundError)
+    {
+        std::rethrow_exception(backgroundError);
+    }
 }
 
 int mdoutf_get_tng_box_output_interval(gmx_mdoutf_t of)
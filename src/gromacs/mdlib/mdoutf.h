@@ -100,7 +100,13 @@ gmx_wallcycle_t mdoutf_get_wcycle(gmx_mdoutf_t of);
  */
 void mdoutf_tng_close(gmx_mdoutf_t of);
 
-/*! \brief Close all open output files and free the of pointer */
+/*! \brief Close all open output files and free the of pointer
+ *
+ * Waits for output that is written on background threads.
+ *
+ * \throws FileIOError when writing trajectory frames or completing
+ *         the last checkpoint in the background failed.
+ */
 void done_mdoutf(gmx_mdoutf_t of);
 
 /*! \brief Routine that writes trajectory-like frames.
@@ -939,6 +939,13 @@ static StepWorkload setupStepWorkload(const int                     legacyFlags,
             ((legacyFlags & GMX_FORCE_NONBONDED) != 0) && simulationWork.computeNonbonded
             && !(simulationWork.computeNonbondedAtMtsLevel1 && !computeSlowForces);
     flags.computeDhdl = ((legacyFlags & GMX_FORCE_DHDL) != 0);
+    flags.deferLocalNonbondedForces =
+            ((legacyFlags & GMX_FORCE_DEFER_LOCAL_NONBONDED_FORCES) != 0) && flags.computeForces
+            && flags.computeNonbondedForces;
+    GMX_ASSERT(!flags.deferLocalNonbondedForces
+                       || (simulationWork.useCpuNonbonded && !flags.computeVirial),
+               "Deferring the local non-bonded forces is only supported with CPU non-bondeds "
+               "and without virial");
 
     if (simulationWork.useGpuBufferOps)
     {
@@ -1514,6 +1521,16 @@ void do_force(FILE*                               fplog,
         launchPmeGpuFftAndGather(fr->pmedata, lambda[efptCOUL], wcycle, stepWork);
     }
 
+    /* With the non-bonded work on the CPU, the coordinate halo exchange
+     * can overlap with the local non-bonded work. The exchange is started
+     * below and completed after the local non-bonded kernel.
+     */
+    const bool overlapCoordinateHalo =
+            (havePPDomainDecomposition(cr) && !stepWork.doNeighborSearch
+             && !(simulationWork.useGpuNonbonded || fr->nbv->emulateGpu()) && !stepWork.useGpuXHalo
+             && !stepWork.useGpuXBufferOps && !simulationWork.useGpuUpdate
+             && ddUsesNonblockingCoordinateHalo(*cr->dd));
+
     /* Communicate coordinates and sum dipole if necessary +
        do non-local pair search */
     if (havePPDomainDecomposition(cr))
@@ -1560,7 +1577,14 @@ void do_force(FILE*                               fplog,
                                "a wait should only be triggered if copy has been scheduled");
                     stateGpu->waitCoordinatesReadyOnHost(AtomLocality::Local);
                 }
-                dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                if (overlapCoordinateHalo)
+                {
+                    dd_move_x_begin(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
+                else
+                {
+                    dd_move_x(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+                }
             }
 
             if (stepWork.useGpuXBufferOps)
@@ -1575,7 +1599,7 @@ void do_force(FILE*                               fplog,
                                            stateGpu->getCoordinatesReadyOnDeviceEvent(
                                                    AtomLocality::NonLocal, simulationWork, stepWork));
             }
-            else
+            else if (!overlapCoordinateHalo)
             {
                 nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
             }
@@ -1731,6 +1755,15 @@ void do_force(FILE*                               fplog,
         do_nb_verlet(fr, ic, enerd, stepWork, InteractionLocality::Local, enbvClearFYes, step, nrnb, wcycle);
     }
 
+    if (overlapCoordinateHalo)
+    {
+        /* Complete the coordinate communication started before the local work */
+        wallcycle_stop(wcycle, ewcFORCE);
+        dd_move_x_finish(cr->dd, box, x.unpaddedArrayRef(), wcycle);
+        nbv->convertCoordinates(AtomLocality::NonLocal, false, x.unpaddedArrayRef());
+        wallcycle_start_nocount(wcycle, ewcFORCE);
+    }
+
     if (fr->efep != efepNO && stepWork.computeNonbondedForces)
     {
         /* Calculate the local and non-local free energy interactions here.
@@ -1776,8 +1809,17 @@ void do_force(FILE*                               fplog,
              * communication with calculation with domain decomposition.
              */
             wallcycle_stop(wcycle, ewcFORCE);
-            nbv->atomdata_add_nbat_f_to_f(AtomLocality::All,
-                                          forceOutNonbonded->forceWithShiftForces().force());
+            if (stepWork.deferLocalNonbondedForces)
+            {
+                /* The local forces are added during the update */
+                nbv->atomdata_add_nbat_f_to_f_deferring_local(
+                        forceOutNonbonded->forceWithShiftForces().force());
+            }
+            else
+            {
+                nbv->atomdata_add_nbat_f_to_f(AtomLocality::All,
+                                              forceOutNonbonded->forceWithShiftForces().force());
+            }
             wallcycle_start_nocount(wcycle, ewcFORCE);
         }
 
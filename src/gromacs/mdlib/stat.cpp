@@ -61,6 +61,8 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/smalloc.h"
 
 typedef struct gmx_global_stat
@@ -68,6 +70,16 @@ typedef struct gmx_global_stat
     t_bin* rb;
     int*   itc0;
     int*   itc1;
+    /* Bin for the force terms reduced by global_stat_start_force_terms() */
+    t_bin* rbForce;
+    /* Tells whether a reduction of the force terms has been started */
+    bool haveStartedForceTerms;
+    /* Tells whether the started reduction is still in flight */
+    bool forceTermsInFlight;
+#if GMX_MPI
+    /* MPI request for the non-blocking reduction of the force terms */
+    MPI_Request forceTermsRequest;
+#endif
 } t_gmx_global_stat;
 
 gmx_global_stat_t global_stat_init(const t_inputrec* ir)
@@ -79,15 +91,22 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir)
     gs->rb = mk_bin();
     snew(gs->itc0, ir->opts.ngtc);
     snew(gs->itc1, ir->opts.ngtc);
+    gs->rbForce               = mk_bin();
+    gs->haveStartedForceTerms = false;
+    gs->forceTermsInFlight    = false;
 
     return gs;
 }
 
 void global_stat_destroy(gmx_global_stat_t gs)
 {
+    GMX_RELEASE_ASSERT(!gs->forceTermsInFlight,
+                       "The global reduction of the force terms should have been completed");
+
     destroy_bin(gs->rb);
     sfree(gs->itc0);
     sfree(gs->itc1);
+    destroy_bin(gs->rbForce);
     sfree(gs);
 }
 
@@ -136,7 +155,118 @@ static int filter_enerdterm(const real* afrom, gmx_bool bToBuffer, real* ato, gm
     return to;
 }
 
-void global_stat(const gmx_global_stat*  gs,
+/*! \brief Adds the force terms, i.e. the terms computed before the update, to \p rb
+ *
+ * These are all energy terms, except for the kinetic and pressure terms,
+ * the energy group pairs, the dH/dlambda terms, the foreign lambda energies
+ * and the force virial.
+ */
+static void addForceTermsToBin(t_bin*                rb,
+                               const gmx_enerdata_t& enerd,
+                               const tensor          fvir,
+                               const t_inputrec&     inputrec)
+{
+    real copyenerd[F_NRE];
+
+    const int nener = filter_enerdterm(enerd.term, TRUE, copyenerd, FALSE, FALSE, TRUE);
+    add_binr(rb, nener, copyenerd);
+    for (int j = 0; j < egNR; j++)
+    {
+        add_binr(rb, enerd.grpp.nener, enerd.grpp.ener[j].data());
+    }
+    if (inputrec.efep != efepNO)
+    {
+        add_bind(rb, efptNR, enerd.dvdl_lin);
+        add_bind(rb, efptNR, enerd.dvdl_nonlin);
+        if (enerd.foreignLambdaTerms.numLambdas() > 0)
+        {
+            add_bind(rb,
+                     enerd.foreignLambdaTerms.energies().size(),
+                     enerd.foreignLambdaTerms.energies().data());
+        }
+    }
+    add_binr(rb, DIM * DIM, fvir[0]);
+}
+
+/*! \brief Extracts the force terms added by addForceTermsToBin() from \p rb */
+static void extractForceTermsFromBin(t_bin*            rb,
+                                     gmx_enerdata_t*   enerd,
+                                     tensor            fvir,
+                                     const t_inputrec& inputrec)
+{
+    real copyenerd[F_NRE];
+
+    const int nener = filter_enerdterm(enerd->term, TRUE, copyenerd, FALSE, FALSE, TRUE);
+    int       index = 0;
+    extract_binr(rb, index, nener, copyenerd);
+    index += nener;
+    for (int j = 0; j < egNR; j++)
+    {
+        extract_binr(rb, index, enerd->grpp.nener, enerd->grpp.ener[j].data());
+        index += enerd->grpp.nener;
+    }
+    if (inputrec.efep != efepNO)
+    {
+        extract_bind(rb, index, efptNR, enerd->dvdl_lin);
+        index += efptNR;
+        extract_bind(rb, index, efptNR, enerd->dvdl_nonlin);
+        index += efptNR;
+        if (enerd->foreignLambdaTerms.numLambdas() > 0)
+        {
+            extract_bind(rb,
+                         index,
+                         enerd->foreignLambdaTerms.energies().size(),
+                         enerd->foreignLambdaTerms.energies().data());
+            index += enerd->foreignLambdaTerms.energies().size();
+        }
+    }
+    extract_binr(rb, index, DIM * DIM, fvir[0]);
+
+    filter_enerdterm(copyenerd, FALSE, enerd->term, FALSE, FALSE, TRUE);
+}
+
+void global_stat_start_force_terms(gmx_global_stat*      gs,
+                                   const t_commrec*      cr,
+                                   const gmx_enerdata_t& enerd,
+                                   const tensor          fvir,
+                                   const t_inputrec&     inputrec)
+{
+    GMX_RELEASE_ASSERT(!gs->haveStartedForceTerms,
+                       "Can only start one reduction of the force terms at a time");
+
+    t_bin* rb = gs->rbForce;
+    reset_bin(rb);
+    addForceTermsToBin(rb, enerd, fvir, inputrec);
+    for (int i = rb->nreal; i < rb->maxreal; i++)
+    {
+        rb->rbuf[i] = 0;
+    }
+
+    /* MPI_Iallreduce was introduced with MPI-3 */
+#if GMX_LIB_MPI && MPI_IN_PLACE_EXISTS && MPI_VERSION >= 3
+    if (!cr->nc.bUse)
+    {
+        MPI_Iallreduce(MPI_IN_PLACE,
+                       rb->rbuf,
+                       rb->maxreal,
+                       MPI_DOUBLE,
+                       MPI_SUM,
+                       cr->mpi_comm_mygroup,
+                       &gs->forceTermsRequest);
+        gs->forceTermsInFlight = true;
+    }
+    else
+#endif
+    {
+        /* Thread-MPI, MPI libraries older than MPI-3 and two-step summation
+         * do not support non-blocking collectives, so we sum right away.
+         */
+        sum_bin(rb, cr);
+    }
+    gs->haveStartedForceTerms = true;
+}
+
+void global_stat(gmx_global_stat*        gs,
                  const t_commrec*        cr,
                  gmx_enerdata_t*         enerd,
                  tensor                  fvir,
@@ -154,7 +284,7 @@ void global_stat(const gmx_global_stat*  gs,
 {
     t_bin* rb;
     int *  itc0, *itc1;
-    int    ie = 0, ifv = 0, isv = 0, irmsd = 0;
+    int    ie = 0, ifv = 0, isv = 0, irmsd = 0, idvdlc = 0;
     int idedl = 0, idedlo = 0, idvdll = 0, idvdlnl = 0, iepl = 0, icm = 0, imass = 0, ica = 0, inb = 0;
     int      isig = -1;
     int      icj = -1, ici = -1, icx = -1;
@@ -173,6 +303,18 @@ void global_stat(const gmx_global_stat*  gs,
     bEkinAveVel = (inputrec->eI == eiVV || (inputrec->eI == eiVVAK && bPres));
     bReadEkin   = ((flags & CGLO_READEKIN) != 0);
 
+    /* When the reduction of the force terms was started earlier,
+     * we only need to sum the terms that changed after the force calculation,
+     * which is the constraint contribution to dH/dlambda. The kinetic and
+     * pressure terms in enerd->term are then not communicated, as these are
+     * recomputed from the summed kinetic energy and virials after this call.
+     */
+    const bool haveStartedForceTerms = gs->haveStartedForceTerms;
+    GMX_RELEASE_ASSERT(!haveStartedForceTerms || (bEner && bPres),
+                       "The started reduction of the force terms should be completed by a "
+                       "reduction with energies and pressure");
+    const bool sumForceTerms = !haveStartedForceTerms;
+
     rb   = gs->rb;
     itc0 = gs->itc0;
     itc1 = gs->itc1;
@@ -230,7 +372,7 @@ void global_stat(const gmx_global_stat*  gs,
         }
     }
 
-    if (bPres)
+    if (bPres && sumForceTerms)
     {
         ifv = add_binr(rb, DIM * DIM, fvir[0]);
     }
@@ -238,7 +380,14 @@ void global_stat(const gmx_global_stat*  gs,
     gmx::ArrayRef<real> rmsdData;
     if (bEner)
     {
-        ie = add_binr(rb, nener, copyenerd);
+        if (sumForceTerms)
+        {
+            ie = add_binr(rb, nener, copyenerd);
+        }
+        else
+        {
+            idvdlc = add_binr(rb, 1, &enerd->term[F_DVDL_CONSTR]);
+        }
         if (constr)
         {
             rmsdData = constr->rmsdData();
@@ -247,7 +396,9 @@ void global_stat(const gmx_global_stat*  gs,
                 irmsd = add_binr(rb, 2, rmsdData.data());
             }
         }
-
+    }
+    if (bEner && sumForceTerms)
+    {
         for (j = 0; (j < egNR); j++)
         {
             inn[j] = add_binr(rb, enerd->grpp.nener, enerd->grpp.ener[j].data());
@@ -294,6 +445,19 @@ void global_stat(const gmx_global_stat*  gs,
     }
     sum_bin(rb, cr);
 
+    if (haveStartedForceTerms)
+    {
+#if GMX_MPI
+        if (gs->forceTermsInFlight)
+        {
+            MPI_Wait(&gs->forceTermsRequest, MPI_STATUS_IGNORE);
+            gs->forceTermsInFlight = false;
+        }
+#endif
+        extractForceTermsFromBin(gs->rbForce, enerd, fvir, *inputrec);
+        gs->haveStartedForceTerms = false;
+    }
+
     /* Extract all the data locally */
 
     if (bConstrVir)
@@ -332,19 +496,28 @@ void global_stat(const gmx_global_stat*  gs,
             }
         }
     }
-    if (bPres)
+    if (bPres && sumForceTerms)
     {
         extract_binr(rb, ifv, DIM * DIM, fvir[0]);
     }
 
     if (bEner)
     {
-        extract_binr(rb, ie, nener, copyenerd);
+        if (sumForceTerms)
+        {
+            extract_binr(rb, ie, nener, copyenerd);
+        }
+        else
+        {
+            extract_binr(rb, idvdlc, 1, &enerd->term[F_DVDL_CONSTR]);
+        }
         if (!rmsdData.empty())
         {
             extract_binr(rb, irmsd, rmsdData);
         }
-
+    }
+    if (bEner && sumForceTerms)
+    {
         for (j = 0; (j < egNR); j++)
         {
             extract_binr(rb, inn[j], enerd->grpp.nener, enerd->grpp.ener[j].data());
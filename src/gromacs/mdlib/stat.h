@@ -58,8 +58,23 @@ gmx_global_stat_t global_stat_init(const t_inputrec* ir);
 
 void global_stat_destroy(gmx_global_stat_t gs);
 
+/*! \brief Starts the all-reduce of the energy terms and the force virial over cr->mpi_comm_mysim
+ *
+ * These terms are final after the force calculation. With MPI-3 libraries
+ * the reduction is non-blocking, so it can overlap with the update and
+ * constraints. The reduction is completed, and the results are stored in
+ * \p enerd and the force virial, by the next call to global_stat(), which
+ * should include energies and pressure. Without non-blocking collectives
+ * this sums directly.
+ */
+void global_stat_start_force_terms(gmx_global_stat*      gs,
+                                   const t_commrec*      cr,
+                                   const gmx_enerdata_t& enerd,
+                                   const tensor          fvir,
+                                   const t_inputrec&     inputrec);
+
 /*! \brief All-reduce energy-like quantities over cr->mpi_comm_mysim  */
-void global_stat(const gmx_global_stat*  gs,
+void global_stat(gmx_global_stat*        gs,
                  const t_commrec*        cr,
                  gmx_enerdata_t*         enerd,
                  tensor                  fvir,
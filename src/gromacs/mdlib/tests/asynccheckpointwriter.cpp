@@ -0,0 +1,124 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the AsyncCheckpointWriter class
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/asynccheckpointwriter.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/exceptions.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(AsyncCheckpointWriter, StagingBufferHasRequestedSize)
+{
+    AsyncCheckpointWriter writer;
+
+    EXPECT_GE(writer.stagingBuffer(100).size(), 100);
+    EXPECT_GE(writer.stagingBuffer(10).size(), 10);
+    EXPECT_GE(writer.stagingBuffer(1000).size(), 1000);
+}
+
+TEST(AsyncCheckpointWriter, CompletesTasksInOrder)
+{
+    AsyncCheckpointWriter writer;
+    std::string           log;
+
+    writer.completeInBackground([&log]() {
+        log += "first;";
+        return std::string();
+    });
+    /* Starting the next task waits for the first one */
+    writer.completeInBackground([&log]() {
+        log += "second;";
+        return std::string();
+    });
+    writer.waitForCompletion();
+
+    EXPECT_EQ(log, "first;second;");
+}
+
+TEST(AsyncCheckpointWriter, DestructorWaitsForCompletion)
+{
+    bool completed = false;
+    {
+        AsyncCheckpointWriter writer;
+        writer.completeInBackground([&completed]() {
+            completed = true;
+            return std::string();
+        });
+    }
+    EXPECT_TRUE(completed);
+}
+
+TEST(AsyncCheckpointWriter, KeepsStagingBufferBetweenCheckpoints)
+{
+    AsyncCheckpointWriter writer;
+
+    const char* buffer = writer.stagingBuffer(1000).data();
+    writer.completeInBackground([]() { return std::string(); });
+    EXPECT_EQ(buffer, writer.stagingBuffer(10).data());
+    EXPECT_EQ(buffer, writer.stagingBuffer(1000).data());
+}
+
+TEST(AsyncCheckpointWriter, ThrowsErrorOfBackgroundTaskOnce)
+{
+    AsyncCheckpointWriter writer;
+
+    writer.completeInBackground([]() { return std::string("Cannot write checkpoint"); });
+    EXPECT_THROW_GMX(writer.waitForCompletion(), FileIOError);
+    EXPECT_NO_THROW(writer.waitForCompletion());
+
+    writer.completeInBackground([]() -> std::string { GMX_THROW(InternalError("Task failed")); });
+    EXPECT_THROW_GMX(writer.stagingBuffer(10), FileIOError);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
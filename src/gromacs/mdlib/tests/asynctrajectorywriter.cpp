@@ -0,0 +1,218 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the AsyncTrajectoryWriter class
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/asynctrajectorywriter.h"
+
+#include "config.h"
+
+#include <string>
+#include <vector>
+
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#endif
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/trajectoryindex.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns coordinates for a frame of \p numAtoms atoms that depend on \p frame
+std::vector<RVec> makeCoordinates(int numAtoms, int frame)
+{
+    std::vector<RVec> x(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        x[i] = { 0.1_real * i, 0.2_real * frame, 0.01_real * (i + frame) };
+    }
+    return x;
+}
+
+TEST(AsyncTrajectoryWriter, WritesXtcFramesInOrder)
+{
+    TestFileManager   fileManager;
+    const std::string filename  = fileManager.getTemporaryFilePath("async.xtc");
+    const int         numAtoms  = 7;
+    const int         numFrames = 5;
+    const matrix      box       = { { 2, 0, 0 }, { 0, 2, 0 }, { 0, 0, 2 } };
+    const std::vector<int> selection = { 1, 4, 6 };
+
+    t_fileio* fio = open_xtc(filename.c_str(), "w");
+    {
+        // A queue depth of one exercises the back-pressure
+        AsyncTrajectoryWriter writer(1);
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            auto x = makeCoordinates(numAtoms, frame);
+            writer.writeXtcFrame(fio, nullptr, 10 * frame, 0.5 * frame, box, x, selection, 1000);
+        }
+    }
+    close_xtc(fio);
+
+    fio = open_xtc(filename.c_str(), "r");
+    int      natoms;
+    int64_t  step;
+    real     time;
+    matrix   readBox;
+    rvec*    x = nullptr;
+    real     prec;
+    gmx_bool bOK;
+    ASSERT_TRUE(read_first_xtc(fio, &natoms, &step, &time, readBox, &x, &prec, &bOK));
+    ASSERT_EQ(natoms, ssize(selection));
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        if (frame > 0)
+        {
+            ASSERT_TRUE(read_next_xtc(fio, natoms, &step, &time, readBox, x, &prec, &bOK));
+        }
+        EXPECT_TRUE(bOK);
+        EXPECT_EQ(step, 10 * frame);
+        EXPECT_REAL_EQ_TOL(time, 0.5 * frame, defaultRealTolerance());
+        const auto reference = makeCoordinates(numAtoms, frame);
+        for (int i = 0; i < natoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_NEAR(x[i][d], reference[selection[i]][d], 1e-3);
+            }
+        }
+    }
+    EXPECT_FALSE(read_next_xtc(fio, natoms, &step, &time, readBox, x, &prec, &bOK));
+    sfree(x);
+    close_xtc(fio);
+}
+
+TEST(AsyncTrajectoryWriter, WritesTrrFrames)
+{
+    TestFileManager   fileManager;
+    const std::string filename = fileManager.getTemporaryFilePath("async.trr");
+    const int         numAtoms = 4;
+    const matrix      box      = { { 3, 0, 0 }, { 0, 3, 0 }, { 0, 0, 3 } };
+
+    t_fileio* fio = gmx_trr_open(filename.c_str(), "w");
+    {
+        AsyncTrajectoryWriter writer(2);
+        auto                  x = makeCoordinates(numAtoms, 1);
+        auto                  v = makeCoordinates(numAtoms, 2);
+        writer.writeTrrFrame(fio, nullptr, 3, 1.5, 0.25, box, numAtoms, x, v, {});
+        // The writer works on a snapshot, so changing the source must not affect the output
+        x = makeCoordinates(numAtoms, 3);
+        writer.waitForCompletion();
+    }
+    gmx_trr_close(fio);
+
+    gmx_trr_header_t header;
+    gmx_trr_read_single_header(filename.c_str(), &header);
+    EXPECT_EQ(header.natoms, numAtoms);
+    EXPECT_EQ(header.step, 3);
+    EXPECT_NE(header.x_size, 0);
+    EXPECT_NE(header.v_size, 0);
+    EXPECT_EQ(header.f_size, 0);
+
+    std::vector<RVec> x(numAtoms), v(numAtoms);
+    int64_t           step;
+    real              time, lambda;
+    matrix            readBox;
+    int               natoms;
+    gmx_trr_read_single_frame(filename.c_str(),
+                              &step,
+                              &time,
+                              &lambda,
+                              readBox,
+                              &natoms,
+                              as_rvec_array(x.data()),
+                              as_rvec_array(v.data()),
+                              nullptr);
+    EXPECT_REAL_EQ_TOL(lambda, 0.25, defaultRealTolerance());
+    const auto reference = makeCoordinates(numAtoms, 1);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        EXPECT_REAL_EQ_TOL(x[i][YY], reference[i][YY], defaultRealTolerance());
+    }
+}
+
+#if defined HAVE_UNISTD_H && !GMX_NATIVE_WINDOWS
+TEST(AsyncTrajectoryWriter, RethrowsIOThreadExceptionsOnMasterThread)
+{
+    // Writes to /dev/full fail at flush, which makes the index writer throw
+    if (!gmx_fexist("/dev/full"))
+    {
+        return;
+    }
+    TestFileManager   fileManager;
+    const std::string filename      = fileManager.getTemporaryFilePath("error.xtc");
+    const std::string indexFilename = fileManager.getTemporaryFilePath("error.xtc.idx");
+    ASSERT_EQ(indexFilename, trajectoryIndexFileName(filename));
+    ASSERT_EQ(symlink("/dev/full", indexFilename.c_str()), 0);
+
+    const matrix box      = { { 2, 0, 0 }, { 0, 2, 0 }, { 0, 0, 2 } };
+    const int    numAtoms = 3;
+
+    t_fileio* fio = open_xtc(filename.c_str(), "w");
+    {
+        TrajectoryIndexWriter index(filename, false);
+        AsyncTrajectoryWriter writer(2);
+        auto                  x = makeCoordinates(numAtoms, 0);
+        writer.writeXtcFrame(fio, &index, 0, 0, box, x, {}, 1000);
+        EXPECT_THROW_GMX(writer.waitForCompletion(), FileIOError);
+    }
+    close_xtc(fio);
+}
+#endif
+
+} // namespace
+} // namespace test
+} // namespace gmx
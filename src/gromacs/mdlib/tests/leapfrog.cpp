@@ -60,7 +60,11 @@
 #include "gromacs/hardware/device_management.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdlib/update.h"
 #include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/refdata.h"
@@ -272,6 +276,200 @@ TEST_P(LeapFrogTest, SimpleIntegration)
 
 INSTANTIATE_TEST_CASE_P(WithParameters, LeapFrogTest, ::testing::ValuesIn(parametersSets));
 
+//! The non-bonded force buffer formats to test the deferred force addition with
+const int c_nbnxmForceFormats[] = { nbatXYZ, nbatXYZQ, nbatX4, nbatX8 };
+
+//! Returns the name of non-bonded force buffer format \p fFormat
+const char* nbnxmForceFormatName(int fFormat)
+{
+    switch (fFormat)
+    {
+        case nbatXYZ: return "XYZ";
+        case nbatXYZQ: return "XYZQ";
+        case nbatX4: return "X4";
+        case nbatX8: return "X8";
+        default: return "unknown";
+    }
+}
+
+//! Returns the index of component \p d of non-bonded atom \p c in a buffer with format \p fFormat
+int nbnxmForceIndex(int fFormat, int c, int d)
+{
+    switch (fFormat)
+    {
+        case nbatXYZ: return c * STRIDE_XYZ + d;
+        case nbatXYZQ: return c * STRIDE_XYZQ + d;
+        case nbatX4: return atom_to_x_index<c_packX4>(c) + d * c_packX4;
+        case nbatX8: return atom_to_x_index<c_packX8>(c) + d * c_packX8;
+        default: GMX_RELEASE_ASSERT(false, "Unhandled format"); return -1;
+    }
+}
+
+/*! \brief Test fixture for the leap-frog update adding the deferred local non-bonded forces
+ *
+ * The non-bonded atom order is a permutation of the atoms with holes,
+ * as for a grid with partially filled cells.
+ */
+class LeapFrogDeferredNonbondedForcesTest : public ::testing::Test
+{
+public:
+    //! The number of atoms, not a multiple of the SIMD width
+    static constexpr int c_numAtoms = 37;
+    //! The number of non-bonded atoms, a prime larger than c_numAtoms
+    static constexpr int c_numNbnxmAtoms = 47;
+
+    LeapFrogDeferredNonbondedForcesTest() :
+        nbat_(PinningPolicy::CannotBePinned), cell_(c_numAtoms), fNonbonded_(c_numAtoms)
+    {
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            cell_[a] = (a * 5) % c_numNbnxmAtoms;
+            for (int d = 0; d < DIM; d++)
+            {
+                fNonbonded_[a][d] = 0.25 * (a % 7) - 0.5 * d;
+            }
+        }
+        nbat_.out.emplace_back(
+                Nbnxm::KernelType::Cpu4x4_PlainC, 1, 0, PinningPolicy::CannotBePinned);
+    }
+
+    //! Sets the format of the non-bonded force buffer and stores the non-bonded forces in it
+    void setNonbondedForces(int fFormat)
+    {
+        nbat_.FFormat = fFormat;
+        nbat_.fstride = (fFormat == nbatXYZQ ? STRIDE_XYZQ : DIM);
+        nbat_.out[0].f.assign(c_numNbnxmAtoms * STRIDE_XYZQ, 0);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                nbat_.out[0].f[nbnxmForceIndex(fFormat, cell_[a], d)] = fNonbonded_[a][d];
+            }
+        }
+    }
+
+    /*! \brief Integrates \p testData, adding \p deferredNonbondedForces when not nullptr
+     *
+     * \param[in,out] testData                 Test data object
+     * \param[in]     numSteps                 The number of steps to integrate
+     * \param[in]     deferredNonbondedForces  The deferred non-bonded forces, can be nullptr
+     */
+    static void integrate(LeapFrogTestData*            testData,
+                          int                          numSteps,
+                          const NbnxmLocalForceReader* deferredNonbondedForces)
+    {
+        testData->state_.x.resizeWithPadding(testData->numAtoms_);
+        testData->state_.v.resizeWithPadding(testData->numAtoms_);
+        for (int i = 0; i < testData->numAtoms_; i++)
+        {
+            testData->state_.x[i] = testData->x_[i];
+            testData->state_.v[i] = testData->v_[i];
+        }
+
+        gmx_omp_nthreads_set(emntUpdate, 1);
+
+        for (int step = 0; step < numSteps; step++)
+        {
+            testData->update_->update_coords(testData->inputRecord_,
+                                             step,
+                                             &testData->mdAtoms_,
+                                             &testData->state_,
+                                             testData->f_,
+                                             testData->forceCalculationData_,
+                                             &testData->kineticEnergyData_,
+                                             testData->velocityScalingMatrix_,
+                                             etrtPOSITION,
+                                             nullptr,
+                                             false,
+                                             deferredNonbondedForces);
+            testData->update_->finish_update(
+                    testData->inputRecord_, &testData->mdAtoms_, &testData->state_, nullptr, false);
+        }
+    }
+
+    //! Non-bonded atom data, only the force output is used
+    nbnxn_atomdata_t nbat_;
+    //! The non-bonded atom index for each atom
+    std::vector<int> cell_;
+    //! The non-bonded forces in the atom order
+    std::vector<RVec> fNonbonded_;
+};
+
+TEST_F(LeapFrogDeferredNonbondedForcesTest, ReaderHandlesAllFormats)
+{
+    for (int fFormat : c_nbnxmForceFormats)
+    {
+        SCOPED_TRACE(formatString("Force format %s", nbnxmForceFormatName(fFormat)));
+
+        setNonbondedForces(fFormat);
+
+        NbnxmLocalForceReader reader(nbat_, cell_);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            const RVec f = reader[a];
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(fNonbonded_[a][d], f[d]) << formatString("atom %d dim %d", a, d);
+            }
+        }
+    }
+}
+
+TEST_F(LeapFrogDeferredNonbondedForcesTest, MatchesUpdateWithReducedForces)
+{
+    const rvec v0       = { 1.0, -2.0, 3.0 };
+    const rvec f0       = { -3.0, 2.0, -1.0 };
+    const int  numSteps = 3;
+
+    for (int fFormat : c_nbnxmForceFormats)
+    {
+        setNonbondedForces(fFormat);
+        NbnxmLocalForceReader reader(nbat_, cell_);
+
+        for (int numTCoupleGroups : { 0, 2 })
+        {
+            // With partially frozen atoms the SIMD update is not used
+            for (bool havePartiallyFrozenAtoms : { false, true })
+            {
+                SCOPED_TRACE(formatString(
+                        "Force format %s, %d T-coupling groups, %s partially frozen atoms",
+                        nbnxmForceFormatName(fFormat),
+                        numTCoupleGroups,
+                        havePartiallyFrozenAtoms ? "with" : "without"));
+
+                LeapFrogTestData reference(c_numAtoms, 0.001, v0, f0, numTCoupleGroups, 0);
+                LeapFrogTestData deferred(c_numAtoms, 0.001, v0, f0, numTCoupleGroups, 0);
+                reference.mdAtoms_.havePartiallyFrozenAtoms = havePartiallyFrozenAtoms;
+                deferred.mdAtoms_.havePartiallyFrozenAtoms  = havePartiallyFrozenAtoms;
+                for (int a = 0; a < c_numAtoms; a++)
+                {
+                    reference.f_[a] += fNonbonded_[a];
+                }
+
+                integrate(&reference, numSteps, nullptr);
+                integrate(&deferred, numSteps, &reader);
+
+                const auto xpReference =
+                        makeArrayRef(*reference.update_->xp()).subArray(0, c_numAtoms);
+                const auto xpDeferred =
+                        makeArrayRef(*deferred.update_->xp()).subArray(0, c_numAtoms);
+                for (int a = 0; a < c_numAtoms; a++)
+                {
+                    for (int d = 0; d < DIM; d++)
+                    {
+                        EXPECT_REAL_EQ_TOL(xpReference[a][d], xpDeferred[a][d], ulpTolerance(4))
+                                << formatString("Coordinate %d of atom %d", d, a);
+                        EXPECT_REAL_EQ_TOL(reference.state_.v[a][d],
+                                           deferred.state_.v[a][d],
+                                           ulpTolerance(4))
+                                << formatString("Velocity component %d of atom %d", d, a);
+                    }
+                }
+            }
+        }
+    }
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
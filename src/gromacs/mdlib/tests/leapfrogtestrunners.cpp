@@ -81,7 +81,8 @@ void LeapFrogHostTestRunner::integrate(LeapFrogTestData* testData, int numSteps)
                                          testData->velocityScalingMatrix_,
                                          etrtNONE,
                                          nullptr,
-                                         false);
+                                         false,
+                                         nullptr);
         testData->update_->finish_update(
                 testData->inputRecord_, &testData->mdAtoms_, &testData->state_, nullptr, false);
     }
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for the stochastic dynamics update kernels
+ *
+ * Checks that the SIMD SD update, which generates the random numbers
+ * for batches of atoms together, produces the same result as the
+ * general per-atom update for all three SD update phases.
+ *
+ * \ingroup module_mdlib
+ */
+
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/paddedvector.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/update_sd.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/atoms.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief The number of atoms in the test system
+ *
+ * Three batches of 32 atoms for the SIMD update plus a tail
+ * that is not a multiple of the SIMD width.
+ */
+constexpr int c_numAtoms = 3 * 32 + 5;
+
+//! Atom in the second batch that is a virtual site
+constexpr int c_vsiteAtom = 40;
+
+//! Atom in the second batch that is partially frozen
+constexpr int c_frozenAtom = 50;
+
+//! Input for the SD update kernels, with all atom arrays SIMD aligned and padded
+struct SDUpdateTestSystem
+{
+    SDUpdateTestSystem() : sd(sdInputRecord())
+    {
+        sd.sdc.resize(2);
+        sd.sdsig.resize(2);
+        sd.sdc[0].em  = std::exp(-0.002 / 0.1);
+        sd.sdc[1].em  = std::exp(-0.002 / 1.0);
+        sd.sdsig[0].V = std::sqrt(2.49 * (1 - sd.sdc[0].em * sd.sdc[0].em));
+        sd.sdsig[1].V = std::sqrt(3.74 * (1 - sd.sdc[1].em * sd.sdc[1].em));
+
+        x.resizeWithPadding(c_numAtoms);
+        v.resizeWithPadding(c_numAtoms);
+        f.resizeWithPadding(c_numAtoms);
+        invmass.resizeWithPadding(c_numAtoms);
+        ptype.resize(c_numAtoms, eptAtom);
+        cFREEZE.resize(c_numAtoms, 0);
+        cTC.resize(c_numAtoms);
+        gatindex.resize(c_numAtoms);
+        for (int a = 0; a < c_numAtoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                x[a][d] = 0.1 * a + 0.7 * d;
+                v[a][d] = std::sin(0.3 * a + d);
+                f[a][d] = 100 * std::cos(0.2 * a - d);
+            }
+            invmass[a] = 1.0 / (1 + (a % 7));
+            cTC[a]     = a % 3 == 0 ? 1 : 0;
+            // Scramble the global indices, the random streams depend on them
+            gatindex[a] = (a * 37) % c_numAtoms + 1000;
+        }
+        ptype[c_vsiteAtom]    = eptVSite;
+        invmass[c_vsiteAtom]  = 0;
+        cFREEZE[c_frozenAtom] = 1;
+    }
+
+    //! Returns an SD input record without temperature coupling groups
+    static const t_inputrec& sdInputRecord()
+    {
+        static t_inputrec ir;
+        ir.eI      = eiSD1;
+        ir.delta_t = 0.002;
+        return ir;
+    }
+
+    //! SD friction and noise parameters
+    gmx_stochd_t sd;
+    //! Acceleration group
+    rvec accel[1] = { { 0, 0, 0 } };
+    //! Freeze groups, the second one freezes only y
+    ivec nFreeze[2] = { { 0, 0, 0 }, { 0, 1, 0 } };
+    //! Coordinates
+    PaddedVector<RVec> x;
+    //! Velocities
+    PaddedVector<RVec> v;
+    //! Forces
+    PaddedVector<RVec> f;
+    //! Inverse masses
+    PaddedVector<real> invmass;
+    //! Particle types
+    std::vector<unsigned short> ptype;
+    //! Freeze group indices
+    std::vector<unsigned short> cFREEZE;
+    //! Temperature coupling group indices
+    std::vector<unsigned short> cTC;
+    //! Global atom indices
+    std::vector<int> gatindex;
+};
+
+//! Signature of the SD update kernels
+using SDUpdateFunction = void (*)(const gmx_stochd_t&,
+                                  int,
+                                  int,
+                                  real,
+                                  const rvec[],
+                                  const ivec[],
+                                  const real[],
+                                  const unsigned short[],
+                                  const unsigned short[],
+                                  const unsigned short[],
+                                  const unsigned short[],
+                                  const rvec[],
+                                  rvec[],
+                                  rvec[],
+                                  const rvec[],
+                                  int64_t,
+                                  int,
+                                  const int*);
+
+/*! \brief Runs \p sdUpdate on \p system and returns the updated coordinates and velocities
+ *
+ * Mimics the calls made by the SD integrator for each update phase.
+ */
+template<SDUpdate updateType>
+std::vector<RVec> runSDUpdate(SDUpdateFunction sdUpdate, const SDUpdateTestSystem& system)
+{
+    PaddedVector<RVec> xprime(system.x);
+    PaddedVector<RVec> v(system.v);
+
+    const rvec* f =
+            (updateType == SDUpdate::FrictionAndNoiseOnly) ? nullptr : as_rvec_array(system.f.data());
+    const unsigned short* cTC = (updateType == SDUpdate::ForcesOnly) ? nullptr : system.cTC.data();
+
+    sdUpdate(system.sd,
+             0,
+             c_numAtoms,
+             0.002,
+             system.accel,
+             system.nFreeze,
+             system.invmass.data(),
+             system.ptype.data(),
+             system.cFREEZE.data(),
+             nullptr,
+             cTC,
+             as_rvec_array(system.x.data()),
+             as_rvec_array(xprime.data()),
+             as_rvec_array(v.data()),
+             f,
+             1234,
+             5678,
+             system.gatindex.data());
+
+    std::vector<RVec> result(xprime.begin(), xprime.begin() + c_numAtoms);
+    result.insert(result.end(), v.begin(), v.begin() + c_numAtoms);
+    return result;
+}
+
+//! Checks that the SIMD SD update matches the general update for \p updateType
+template<SDUpdate updateType>
+void testSDUpdateMatchesGeneral()
+{
+    const SDUpdateTestSystem system;
+
+    const auto reference = runSDUpdate<updateType>(doSDUpdateGeneral<updateType>, system);
+    const auto result    = runSDUpdate<updateType>(doSDUpdate<updateType>, system);
+
+    // The SIMD update uses FMA and a different operation order
+    const auto tolerance = relativeToleranceAsFloatingPoint(1.0, 10 * GMX_REAL_EPS);
+    for (int i = 0; i < 2 * c_numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(reference[i][d], result[i][d], tolerance) << formatString(
+                    "for %s of atom %d, dim %d", i < c_numAtoms ? "x" : "v", i % c_numAtoms, d);
+        }
+    }
+}
+
+TEST(SDUpdateTest, ForcesOnlyMatchesGeneralUpdate)
+{
+    testSDUpdateMatchesGeneral<SDUpdate::ForcesOnly>();
+}
+
+TEST(SDUpdateTest, FrictionAndNoiseOnlyMatchesGeneralUpdate)
+{
+    testSDUpdateMatchesGeneral<SDUpdate::FrictionAndNoiseOnly>();
+}
+
+TEST(SDUpdateTest, CombinedMatchesGeneralUpdate)
+{
+    testSDUpdateMatchesGeneral<SDUpdate::Combined>();
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -43,6 +43,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 
 #include "gromacs/domdec/domdec_struct.h"
@@ -70,6 +71,7 @@
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/nbnxm/atomdata.h"
 #include "gromacs/pbcutil/boxutilities.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/pull.h"
@@ -85,31 +87,9 @@
 #include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
-using namespace gmx; // TODO: Remove when this file is moved into gmx namespace
-
-struct gmx_sd_const_t
-{
-    double em = 0;
-};
-
-struct gmx_sd_sigma_t
-{
-    real V = 0;
-};
+#include "update_sd.h"
 
-struct gmx_stochd_t
-{
-    /* BD stuff */
-    std::vector<real> bd_rf;
-    /* SD stuff */
-    std::vector<gmx_sd_const_t> sdc;
-    std::vector<gmx_sd_sigma_t> sdsig;
-    /* andersen temperature control stuff */
-    std::vector<bool> randomize_group;
-    std::vector<real> boltzfac;
-
-    explicit gmx_stochd_t(const t_inputrec& inputRecord);
-};
+using namespace gmx; // TODO: Remove when this file is moved into gmx namespace
 
 //! pImpled implementation for Update
 class Update::Impl
@@ -130,7 +110,8 @@ public:
                        const matrix                                     M,
                        int                                              UpdatePart,
                        const t_commrec*                                 cr,
-                       bool                                             haveConstraints);
+                       bool                                             haveConstraints,
+                       const NbnxmLocalForceReader*                     deferredNonbondedForces);
 
     void finish_update(const t_inputrec& inputRecord,
                        const t_mdatoms*  md,
@@ -210,10 +191,21 @@ void Update::update_coords(const t_inputrec&                                inpu
                            const matrix                                     M,
                            int                                              updatePart,
                            const t_commrec*                                 cr,
-                           const bool                                       haveConstraints)
+                           const bool                                       haveConstraints,
+                           const NbnxmLocalForceReader*                     deferredNonbondedForces)
 {
-    return impl_->update_coords(
-            inputRecord, step, md, state, f, fcdata, ekind, M, updatePart, cr, haveConstraints);
+    return impl_->update_coords(inputRecord,
+                                step,
+                                md,
+                                state,
+                                f,
+                                fcdata,
+                                ekind,
+                                M,
+                                updatePart,
+                                cr,
+                                haveConstraints,
+                                deferredNonbondedForces);
 }
 
 void Update::finish_update(const t_inputrec& inputRecord,
@@ -367,6 +359,64 @@ static void updateMDLeapfrogSimple(int         start,
     }
 }
 
+/*! \brief Integrate as updateMDLeapfrogSimple(), adding the deferred non-bonded forces
+ *
+ * This fuses the last pass over the non-bonded force buffer with the update,
+ * which avoids writing and reading back the full force array.
+ *
+ * \tparam       numTempScaleValues     The number of different T-couple values
+ * \param[in]    start                  Index of first atom to update
+ * \param[in]    nrend                  Last atom to update: \p nrend - 1
+ * \param[in]    dt                     The time step
+ * \param[in]    invMassPerDim          1/mass per atom and dimension
+ * \param[in]    tcstat                 Temperature coupling information
+ * \param[in]    cTC                    T-coupling group index per atom
+ * \param[in]    x                      Input coordinates
+ * \param[out]   xprime                 Updated coordinates
+ * \param[inout] v                      Velocities
+ * \param[in]    f                      Forces, without the local non-bonded forces
+ * \param[in]    fNonbonded             The local non-bonded forces
+ */
+template<NumTempScaleValues numTempScaleValues>
+static void updateMDLeapfrogSimpleAddingNonbondedForces(int         start,
+                                                        int         nrend,
+                                                        real        dt,
+                                                        const rvec* gmx_restrict invMassPerDim,
+                                                        gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                                                        const unsigned short*             cTC,
+                                                        const rvec* gmx_restrict x,
+                                                        rvec* gmx_restrict xprime,
+                                                        rvec* gmx_restrict v,
+                                                        const rvec* gmx_restrict f,
+                                                        const NbnxmLocalForceReader& fNonbonded)
+{
+    real lambdaGroup;
+
+    if (numTempScaleValues == NumTempScaleValues::single)
+    {
+        lambdaGroup = tcstat[0].lambda;
+    }
+
+    for (int a = start; a < nrend; a++)
+    {
+        if (numTempScaleValues == NumTempScaleValues::multiple)
+        {
+            lambdaGroup = tcstat[cTC[a]].lambda;
+        }
+
+        const gmx::RVec fNonbondedAtom = fNonbonded[a];
+
+        for (int d = 0; d < DIM; d++)
+        {
+            const real vNew = lambdaGroup * v[a][d]
+                              + (f[a][d] + fNonbondedAtom[d]) * invMassPerDim[a][d] * dt;
+
+            v[a][d]      = vNew;
+            xprime[a][d] = x[a][d] + vNew * dt;
+        }
+    }
+}
+
 #if GMX_SIMD && GMX_SIMD_HAVE_REAL
 #    define GMX_HAVE_SIMD_UPDATE 1
 #else
@@ -485,6 +535,85 @@ static void updateMDLeapfrogSimpleSimd(int         start,
     }
 }
 
+/*! \brief Integrate as updateMDLeapfrogSimpleSimd(), adding the deferred non-bonded forces
+ *
+ * The non-bonded forces are stored in the nbnxm atom order, so they are
+ * gathered per SIMD block into an aligned buffer in the rvec layout.
+ *
+ * \param[in]    start                  Index of first atom to update
+ * \param[in]    nrend                  Last atom to update: \p nrend - 1
+ * \param[in]    dt                     The time step
+ * \param[in]    invMass                1/mass per atom
+ * \param[in]    tcstat                 Temperature coupling information
+ * \param[in]    x                      Input coordinates
+ * \param[out]   xprime                 Updated coordinates
+ * \param[inout] v                      Velocities
+ * \param[in]    f                      Forces, without the local non-bonded forces
+ * \param[in]    fNonbonded             The local non-bonded forces
+ */
+static void
+updateMDLeapfrogSimpleSimdAddingNonbondedForces(int         start,
+                                                int         nrend,
+                                                real        dt,
+                                                const real* gmx_restrict          invMass,
+                                                gmx::ArrayRef<const t_grp_tcstat> tcstat,
+                                                const rvec* gmx_restrict x,
+                                                rvec* gmx_restrict xprime,
+                                                rvec* gmx_restrict v,
+                                                const rvec* gmx_restrict f,
+                                                const NbnxmLocalForceReader& fNonbonded)
+{
+    SimdReal timestep(dt);
+    SimdReal lambdaSystem(tcstat[0].lambda);
+
+    GMX_ASSERT(isSimdAligned(invMass), "invMass should be aligned");
+
+    alignas(GMX_SIMD_ALIGNMENT) rvec fNonbondedBlock[GMX_SIMD_REAL_WIDTH];
+
+    for (int a = start; a < nrend; a += GMX_SIMD_REAL_WIDTH)
+    {
+        /* The padding atoms beyond nrend get zero non-bonded force */
+        const int numAtomsInBlock = std::min(nrend - a, GMX_SIMD_REAL_WIDTH);
+        for (int i = 0; i < numAtomsInBlock; i++)
+        {
+            copy_rvec(fNonbonded[a + i], fNonbondedBlock[i]);
+        }
+        for (int i = numAtomsInBlock; i < GMX_SIMD_REAL_WIDTH; i++)
+        {
+            clear_rvec(fNonbondedBlock[i]);
+        }
+
+        SimdReal invMass0, invMass1, invMass2;
+        expandScalarsToTriplets(simdLoad(invMass + a), &invMass0, &invMass1, &invMass2);
+
+        SimdReal v0, v1, v2;
+        SimdReal f0, f1, f2;
+        SimdReal fNonbonded0, fNonbonded1, fNonbonded2;
+        simdLoadRvecs(v, a, &v0, &v1, &v2);
+        simdLoadRvecs(f, a, &f0, &f1, &f2);
+        simdLoadRvecs(fNonbondedBlock, 0, &fNonbonded0, &fNonbonded1, &fNonbonded2);
+
+        f0 = f0 + fNonbonded0;
+        f1 = f1 + fNonbonded1;
+        f2 = f2 + fNonbonded2;
+
+        v0 = fma(f0 * invMass0, timestep, lambdaSystem * v0);
+        v1 = fma(f1 * invMass1, timestep, lambdaSystem * v1);
+        v2 = fma(f2 * invMass2, timestep, lambdaSystem * v2);
+
+        simdStoreRvecs(v, a, v0, v1, v2);
+
+        SimdReal x0, x1, x2;
+        simdLoadRvecs(x, a, &x0, &x1, &x2);
+
+        SimdReal xprime0 = fma(v0, timestep, x0);
+        SimdReal xprime1 = fma(v1, timestep, x1);
+        SimdReal xprime2 = fma(v2, timestep, x2);
+
+        simdStoreRvecs(xprime, a, xprime0, xprime1, xprime2);
+    }
+}
+
 #endif // GMX_HAVE_SIMD_UPDATE
 
 /*! \brief Sets the NEMD acceleration type */
@@ -641,7 +770,8 @@ static void do_update_md(int         start,
                          const gmx_ekindata_t*    ekind,
                          const matrix             box,
                          const double* gmx_restrict nh_vxi,
-                         const matrix               M)
+                         const matrix                 M,
+                         const NbnxmLocalForceReader* deferredNonbondedForces)
 {
     GMX_ASSERT(nrend == start || xprime != x,
                "For SIMD optimization certain compilers need to have xprime != x");
@@ -660,6 +790,10 @@ static void do_update_md(int         start,
 
     if (doNoseHoover || doPROffDiagonal || doAcceleration)
     {
+        GMX_RELEASE_ASSERT(deferredNonbondedForces == nullptr,
+                           "Deferred non-bonded forces are only supported with the simple "
+                           "leap-frog update");
+
         matrix stepM;
         if (!doParrinelloRahman)
         {
@@ -714,7 +848,63 @@ static void do_update_md(int         start,
         gmx::ArrayRef<const t_grp_tcstat> tcstat        = ekind->tcstat;
         const rvec*                       invMassPerDim = md->invMassPerDim;
 
-        if (doParrinelloRahman)
+        if (deferredNonbondedForces != nullptr)
+        {
+            GMX_RELEASE_ASSERT(!doParrinelloRahman,
+                               "Deferred non-bonded forces are not supported with "
+                               "Parrinello-Rahman pressure coupling");
+
+            if (haveSingleTempScaleValue)
+            {
+#if GMX_HAVE_SIMD_UPDATE
+                if (!md->havePartiallyFrozenAtoms)
+                {
+                    updateMDLeapfrogSimpleSimdAddingNonbondedForces(
+                            start,
+                            nrend,
+                            dt,
+                            md->invmass,
+                            tcstat,
+                            x,
+                            xprime,
+                            v,
+                            f,
+                            *deferredNonbondedForces);
+                }
+                else
+#endif
+                {
+                    updateMDLeapfrogSimpleAddingNonbondedForces<NumTempScaleValues::single>(
+                            start,
+                            nrend,
+                            dt,
+                            invMassPerDim,
+                            tcstat,
+                            cTC,
+                            x,
+                            xprime,
+                            v,
+                            f,
+                            *deferredNonbondedForces);
+                }
+            }
+            else
+            {
+                updateMDLeapfrogSimpleAddingNonbondedForces<NumTempScaleValues::multiple>(
+                        start,
+                        nrend,
+                        dt,
+                        invMassPerDim,
+                        tcstat,
+                        cTC,
+                        x,
+                        xprime,
+                        v,
+                        f,
+                        *deferredNonbondedForces);
+            }
+        }
+        else if (doParrinelloRahman)
         {
             GMX_ASSERT(!doPROffDiagonal,
                        "updateMDLeapfrogSimple only support diagonal Parrinello-Rahman scaling "
@@ -1003,46 +1193,31 @@ void Update::setNumAtoms(int numAtoms)
     impl_->xp()->resizeWithPadding(numAtoms);
 }
 
-/*! \brief Sets the SD update type */
-enum class SDUpdate : int
-{
-    ForcesOnly,
-    FrictionAndNoiseOnly,
-    Combined
-};
+//! The number of random bits used per normally distributed value for the SD noise
+constexpr int c_sdNormalDistributionTableBits = 14;
+//! The normal distribution used for the SD noise
+using SDNormalDistribution =
+        gmx::TabulatedNormalDistribution<real, c_sdNormalDistributionTableBits>;
 
-/*! \brief SD integrator update
- *
- * Two phases are required in the general case of a constrained
- * update, the first phase from the contribution of forces, before
- * applying constraints, and then a second phase applying the friction
- * and noise, and then further constraining. For details, see
- * Goga2012.
- *
- * Without constraints, the two phases can be combined, for
- * efficiency.
- *
- * Thus three instantiations of this templated function will be made,
- * two with only one contribution, and one with both contributions. */
 template<SDUpdate updateType>
-static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
-                              int                  start,
-                              int                  nrend,
-                              real                 dt,
-                              const rvec           accel[],
-                              const ivec           nFreeze[],
-                              const real           invmass[],
-                              const unsigned short ptype[],
-                              const unsigned short cFREEZE[],
-                              const unsigned short cACC[],
-                              const unsigned short cTC[],
-                              const rvec           x[],
-                              rvec                 xprime[],
-                              rvec                 v[],
-                              const rvec           f[],
-                              int64_t              step,
-                              int                  seed,
-                              const int*           gatindex)
+void doSDUpdateGeneral(const gmx_stochd_t&  sd,
+                       int                  start,
+                       int                  nrend,
+                       real                 dt,
+                       const rvec           accel[],
+                       const ivec           nFreeze[],
+                       const real           invmass[],
+                       const unsigned short ptype[],
+                       const unsigned short cFREEZE[],
+                       const unsigned short cACC[],
+                       const unsigned short cTC[],
+                       const rvec           x[],
+                       rvec                 xprime[],
+                       rvec                 v[],
+                       const rvec           f[],
+                       int64_t              step,
+                       int                  seed,
+                       const int*           gatindex)
 {
     // cTC, cACC and cFREEZE can be nullptr any time, but various
     // instantiations do not make sense with particular pointer
@@ -1063,8 +1238,8 @@ static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
     }
 
     // Even 0 bits internal counter gives 2x64 ints (more than enough for three table lookups)
-    gmx::ThreeFry2x64<0>                       rng(seed, gmx::RandomDomain::UpdateCoordinates);
-    gmx::TabulatedNormalDistribution<real, 14> dist;
+    gmx::ThreeFry2x64<0> rng(seed, gmx::RandomDomain::UpdateCoordinates);
+    SDNormalDistribution dist;
 
     for (int n = start; n < nrend; n++)
     {
@@ -1126,6 +1301,209 @@ static void doSDUpdateGeneral(const gmx_stochd_t&  sd,
     }
 }
 
+template<SDUpdate updateType>
+void doSDUpdate(const gmx_stochd_t&  sd,
+                int                  start,
+                int                  nrend,
+                real                 dt,
+                const rvec           accel[],
+                const ivec           nFreeze[],
+                const real           invmass[],
+                const unsigned short ptype[],
+                const unsigned short cFREEZE[],
+                const unsigned short cACC[],
+                const unsigned short cTC[],
+                const rvec           x[],
+                rvec                 xprime[],
+                rvec                 v[],
+                const rvec           f[],
+                int64_t              step,
+                int                  seed,
+                const int*           gatindex)
+{
+#if GMX_HAVE_SIMD_UPDATE
+    /* The number of atoms for which we generate random numbers together */
+    constexpr int c_batchSize = 32;
+    static_assert(c_batchSize % GMX_SIMD_REAL_WIDTH == 0,
+                  "The SD batch size should be a multiple of the SIMD width");
+
+    constexpr uint64_t c_tableMask = (uint64_t(1) << c_sdNormalDistributionTableBits) - 1;
+    const auto&        normalTable = SDNormalDistribution::table();
+
+    gmx::ThreeFry2x64<0> rng(seed, gmx::RandomDomain::UpdateCoordinates);
+
+    std::array<uint64_t, c_batchSize> counterStep;
+    std::array<uint64_t, c_batchSize> counterAtom;
+    std::array<uint64_t, c_batchSize> randomBits;
+    counterStep.fill(step);
+
+    alignas(GMX_SIMD_ALIGNMENT) real frictionFactor[c_batchSize];
+    alignas(GMX_SIMD_ALIGNMENT) real noise[c_batchSize * DIM];
+
+    const SimdReal timestep(dt);
+    const SimdReal halfTimestep(0.5 * dt);
+
+    int a0 = start;
+    for (; a0 + c_batchSize <= nrend; a0 += c_batchSize)
+    {
+        bool batchIsSimple = true;
+        for (int a = a0; a < a0 + c_batchSize; a++)
+        {
+            const int freezeGroup       = cFREEZE ? cFREEZE[a] : 0;
+            const int accelerationGroup = cACC ? cACC[a] : 0;
+
+            batchIsSimple = batchIsSimple && ptype[a] != eptVSite && ptype[a] != eptShell
+                            && !nFreeze[freezeGroup][XX] && !nFreeze[freezeGroup][YY]
+                            && !nFreeze[freezeGroup][ZZ];
+            if (updateType != SDUpdate::FrictionAndNoiseOnly)
+            {
+                batchIsSimple = batchIsSimple && accel[accelerationGroup][XX] == 0
+                                && accel[accelerationGroup][YY] == 0
+                                && accel[accelerationGroup][ZZ] == 0;
+            }
+        }
+        if (!batchIsSimple)
+        {
+            doSDUpdateGeneral<updateType>(sd,
+                                          a0,
+                                          a0 + c_batchSize,
+                                          dt,
+                                          accel,
+                                          nFreeze,
+                                          invmass,
+                                          ptype,
+                                          cFREEZE,
+                                          cACC,
+                                          cTC,
+                                          x,
+                                          xprime,
+                                          v,
+                                          f,
+                                          step,
+                                          seed,
+                                          gatindex);
+            continue;
+        }
+
+        if (updateType != SDUpdate::ForcesOnly)
+        {
+            for (int i = 0; i < c_batchSize; i++)
+            {
+                counterAtom[i] = gatindex ? gatindex[a0 + i] : a0 + i;
+            }
+            rng.generateFirstInBatch(counterStep, counterAtom, &randomBits);
+
+            // Draw three normally distributed values per atom from the 64 random bits,
+            // in the same order as the distribution used in doSDUpdateGeneral()
+            for (int i = 0; i < c_batchSize; i++)
+            {
+                const int  temperatureGroup = cTC ? cTC[a0 + i] : 0;
+                const real sigma = std::sqrt(invmass[a0 + i]) * sd.sdsig[temperatureGroup].V;
+
+                frictionFactor[i] = sd.sdc[temperatureGroup].em;
+                uint64_t bits     = randomBits[i];
+                for (int d = 0; d < DIM; d++)
+                {
+                    noise[i * DIM + d] = sigma * normalTable[bits & c_tableMask];
+                    bits >>= c_sdNormalDistributionTableBits;
+                }
+            }
+        }
+
+        for (int i = 0; i < c_batchSize; i += GMX_SIMD_REAL_WIDTH)
+        {
+            const int a = a0 + i;
+
+            SimdReal v0, v1, v2;
+            simdLoadRvecs(v, a, &v0, &v1, &v2);
+
+            SimdReal vn0 = v0;
+            SimdReal vn1 = v1;
+            SimdReal vn2 = v2;
+            if (updateType != SDUpdate::FrictionAndNoiseOnly)
+            {
+                SimdReal invMass0, invMass1, invMass2;
+                expandScalarsToTriplets(simdLoad(invmass + a), &invMass0, &invMass1, &invMass2);
+
+                SimdReal f0, f1, f2;
+                simdLoadRvecs(f, a, &f0, &f1, &f2);
+
+                vn0 = fma(f0 * invMass0, timestep, v0);
+                vn1 = fma(f1 * invMass1, timestep, v1);
+                vn2 = fma(f2 * invMass2, timestep, v2);
+            }
+
+            SimdReal x0, x1, x2;
+            if (updateType == SDUpdate::ForcesOnly)
+            {
+                simdLoadRvecs(x, a, &x0, &x1, &x2);
+
+                x0 = fma(vn0, timestep, x0);
+                x1 = fma(vn1, timestep, x1);
+                x2 = fma(vn2, timestep, x2);
+
+                simdStoreRvecs(v, a, vn0, vn1, vn2);
+                simdStoreRvecs(xprime, a, x0, x1, x2);
+            }
+            else
+            {
+                SimdReal em0, em1, em2;
+                expandScalarsToTriplets(simdLoad(frictionFactor + i), &em0, &em1, &em2);
+
+                SimdReal noise0 = simdLoad(noise + i * DIM + 0 * GMX_SIMD_REAL_WIDTH);
+                SimdReal noise1 = simdLoad(noise + i * DIM + 1 * GMX_SIMD_REAL_WIDTH);
+                SimdReal noise2 = simdLoad(noise + i * DIM + 2 * GMX_SIMD_REAL_WIDTH);
+
+                SimdReal vNew0 = fma(vn0, em0, noise0);
+                SimdReal vNew1 = fma(vn1, em1, noise1);
+                SimdReal vNew2 = fma(vn2, em2, noise2);
+
+                simdStoreRvecs(v, a, vNew0, vNew1, vNew2);
+
+                if (updateType == SDUpdate::FrictionAndNoiseOnly)
+                {
+                    // The previous phase already updated the positions with
+                    // a full v*dt term that must now be half removed.
+                    simdLoadRvecs(xprime, a, &x0, &x1, &x2);
+                    x0 = fma(vNew0 - vn0, halfTimestep, x0);
+                    x1 = fma(vNew1 - vn1, halfTimestep, x1);
+                    x2 = fma(vNew2 - vn2, halfTimestep, x2);
+                }
+                else
+                {
+                    // Include half of the friction+noise update of v
+                    simdLoadRvecs(x, a, &x0, &x1, &x2);
+                    x0 = fma(vn0 + vNew0, halfTimestep, x0);
+                    x1 = fma(vn1 + vNew1, halfTimestep, x1);
+                    x2 = fma(vn2 + vNew2, halfTimestep, x2);
+                }
+                simdStoreRvecs(xprime, a, x0, x1, x2);
+            }
+        }
+    }
+    start = a0;
+#endif // GMX_HAVE_SIMD_UPDATE
+
+    doSDUpdateGeneral<updateType>(
+            sd, start, nrend, dt, accel, nFreeze, invmass, ptype, cFREEZE, cACC, cTC, x, xprime, v, f, step, seed, gatindex);
+}
+
+//! Instantiates an SD update kernel for use in tests
+#define INSTANTIATE_SD_UPDATE(function, updateType)                                                \
+    template void function<updateType>(const gmx_stochd_t&, int, int, real, const rvec[],          \
+                                        const ivec[], const real[], const unsigned short[],        \
+                                        const unsigned short[], const unsigned short[],            \
+                                        const unsigned short[], const rvec[], rvec[], rvec[],      \
+                                        const rvec[], int64_t, int, const int*);
+
+INSTANTIATE_SD_UPDATE(doSDUpdateGeneral, SDUpdate::ForcesOnly)
+INSTANTIATE_SD_UPDATE(doSDUpdateGeneral, SDUpdate::FrictionAndNoiseOnly)
+INSTANTIATE_SD_UPDATE(doSDUpdateGeneral, SDUpdate::Combined)
+INSTANTIATE_SD_UPDATE(doSDUpdate, SDUpdate::ForcesOnly)
+INSTANTIATE_SD_UPDATE(doSDUpdate, SDUpdate::FrictionAndNoiseOnly)
+INSTANTIATE_SD_UPDATE(doSDUpdate, SDUpdate::Combined)
+
+#undef INSTANTIATE_SD_UPDATE
 static void do_update_sd(int         start,
                          int         nrend,
                          real        dt,
@@ -1149,29 +1527,29 @@ static void do_update_sd(int         start,
     if (haveConstraints)
     {
         // With constraints, the SD update is done in 2 parts
-        doSDUpdateGeneral<SDUpdate::ForcesOnly>(
+        doSDUpdate<SDUpdate::ForcesOnly>(
                 sd, start, nrend, dt, accel, nFreeze, invmass, ptype, cFREEZE, cACC, nullptr, x, xprime, v, f, step, seed, nullptr);
     }
     else
     {
-        doSDUpdateGeneral<SDUpdate::Combined>(sd,
-                                              start,
-                                              nrend,
-                                              dt,
-                                              accel,
-                                              nFreeze,
-                                              invmass,
-                                              ptype,
-                                              cFREEZE,
-                                              cACC,
-                                              cTC,
-                                              x,
-                                              xprime,
-                                              v,
-                                              f,
-                                              step,
-                                              seed,
-                                              DOMAINDECOMP(cr) ? cr->dd->globalAtomIndices.data() : nullptr);
+        doSDUpdate<SDUpdate::Combined>(sd,
+                                       start,
+                                       nrend,
+                                       dt,
+                                       accel,
+                                       nFreeze,
+                                       invmass,
+                                       ptype,
+                                       cFREEZE,
+                                       cACC,
+                                       cTC,
+                                       x,
+                                       xprime,
+                                       v,
+                                       f,
+                                       step,
+                                       seed,
+                                       DOMAINDECOMP(cr) ? cr->dd->globalAtomIndices.data() : nullptr);
     }
 }
 
@@ -1394,7 +1772,7 @@ void Update::Impl::update_sd_second_half(const t_inputrec& inputRecord,
                 int start_th, end_th;
                 getThreadAtomRange(nth, th, homenr, &start_th, &end_th);
 
-                doSDUpdateGeneral<SDUpdate::FrictionAndNoiseOnly>(
+                doSDUpdate<SDUpdate::FrictionAndNoiseOnly>(
                         sd_,
                         start_th,
                         end_th,
@@ -1503,13 +1881,16 @@ void Update::Impl::update_coords(const t_inputrec&
                                  const matrix                                     M,
                                  int                                              updatePart,
                                  const t_commrec*                                 cr,
-                                 const bool                                       haveConstraints)
+                                 const bool                                       haveConstraints,
+                                 const NbnxmLocalForceReader*                     deferredNonbondedForces)
 {
     /* Running the velocity half does nothing except for velocity verlet */
     if ((updatePart == etrtVELOCITY1 || updatePart == etrtVELOCITY2) && !EI_VV(inputRecord.eI))
     {
         gmx_incons("update_coords called for velocity without VV integrator");
     }
+    GMX_RELEASE_ASSERT(deferredNonbondedForces == nullptr || inputRecord.eI == eiMD,
+                       "Deferred non-bonded forces are only supported with leap-frog");
 
     int homenr = md->homenr;
 
@@ -1562,7 +1943,8 @@ void Update::Impl::update_coords(const t_inputrec&
                                  ekind,
                                  state->box,
                                  state->nosehoover_vxi.data(),
-                                 M);
+                                 M,
+                                 deferredNonbondedForces);
                     break;
                 case (eiSD1):
                     do_update_sd(start_th,
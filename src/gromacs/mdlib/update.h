@@ -48,6 +48,7 @@
 #include "gromacs/utility/real.h"
 
 class ekinstate_t;
+class NbnxmLocalForceReader;
 struct gmx_ekindata_t;
 struct gmx_enerdata_t;
 enum class PbcType;
@@ -113,6 +114,7 @@ public:
      * \param[in]  updatePart       What should be updated, coordinates or velocities. This enum only used in VV integrator.
      * \param[in]  cr               Comunication record  (Old comment: these shouldn't be here -- need to think about it).
      * \param[in]  haveConstraints  If the system has constraints.
+     * \param[in]  deferredNonbondedForces  Local non-bonded forces not in \p f, can be nullptr.
      */
     void update_coords(const t_inputrec&                                inputRecord,
                        int64_t                                          step,
@@ -124,7 +126,8 @@ public:
                        const matrix                                     M,
                        int                                              updatePart,
                        const t_commrec*                                 cr,
-                       bool                                             haveConstraints);
+                       bool                                             haveConstraints,
+                       const NbnxmLocalForceReader*                     deferredNonbondedForces);
 
     /*! \brief Finalize the coordinate update.
      *
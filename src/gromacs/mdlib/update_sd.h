@@ -0,0 +1,155 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Declares the stochastic dynamics update kernels
+ *
+ * These are used by Update and are declared here so they can be tested.
+ *
+ * \ingroup module_mdlib
+ */
+#ifndef GMX_MDLIB_UPDATE_SD_H
+#define GMX_MDLIB_UPDATE_SD_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/real.h"
+
+struct t_inputrec;
+
+//! The SD friction constant per T-coupling group
+struct gmx_sd_const_t
+{
+    double em = 0;
+};
+
+//! The SD noise amplitude per T-coupling group
+struct gmx_sd_sigma_t
+{
+    real V = 0;
+};
+
+//! Data for the stochastic integrators and thermostats
+struct gmx_stochd_t
+{
+    /* BD stuff */
+    std::vector<real> bd_rf;
+    /* SD stuff */
+    std::vector<gmx_sd_const_t> sdc;
+    std::vector<gmx_sd_sigma_t> sdsig;
+    /* andersen temperature control stuff */
+    std::vector<bool> randomize_group;
+    std::vector<real> boltzfac;
+
+    explicit gmx_stochd_t(const t_inputrec& inputRecord);
+};
+
+/*! \brief Sets the SD update type */
+enum class SDUpdate : int
+{
+    ForcesOnly,
+    FrictionAndNoiseOnly,
+    Combined
+};
+
+/*! \brief SD integrator update
+ *
+ * Two phases are required in the general case of a constrained
+ * update, the first phase from the contribution of forces, before
+ * applying constraints, and then a second phase applying the friction
+ * and noise, and then further constraining. For details, see
+ * Goga2012.
+ *
+ * Without constraints, the two phases can be combined, for
+ * efficiency.
+ *
+ * Thus three instantiations of this templated function will be made,
+ * two with only one contribution, and one with both contributions. */
+template<SDUpdate updateType>
+void doSDUpdateGeneral(const gmx_stochd_t&  sd,
+                       int                  start,
+                       int                  nrend,
+                       real                 dt,
+                       const rvec           accel[],
+                       const ivec           nFreeze[],
+                       const real           invmass[],
+                       const unsigned short ptype[],
+                       const unsigned short cFREEZE[],
+                       const unsigned short cACC[],
+                       const unsigned short cTC[],
+                       const rvec           x[],
+                       rvec                 xprime[],
+                       rvec                 v[],
+                       const rvec           f[],
+                       int64_t              step,
+                       int                  seed,
+                       const int*           gatindex);
+
+/*! \brief SD integrator update, using SIMD where possible
+ *
+ * Produces the same result as doSDUpdateGeneral(), up to rounding.
+ * With SIMD support the atoms are processed in batches. For batches
+ * that contain only normal atoms without freezing or acceleration,
+ * the random numbers for all atoms are generated together and
+ * the update is done with SIMD. Other batches use doSDUpdateGeneral().
+ * The random streams are still keyed on step and global atom index,
+ * so results do not depend on the decomposition or on SIMD support.
+ *
+ * With SIMD, \p x, \p xprime, \p v, \p f and \p invmass should be
+ * padded and SIMD aligned.
+ */
+template<SDUpdate updateType>
+void doSDUpdate(const gmx_stochd_t&  sd,
+                int                  start,
+                int                  nrend,
+                real                 dt,
+                const rvec           accel[],
+                const ivec           nFreeze[],
+                const real           invmass[],
+                const unsigned short ptype[],
+                const unsigned short cFREEZE[],
+                const unsigned short cACC[],
+                const unsigned short cTC[],
+                const rvec           x[],
+                rvec                 xprime[],
+                rvec                 v[],
+                const rvec           f[],
+                int64_t              step,
+                int                  seed,
+                const int*           gatindex);
+
+#endif
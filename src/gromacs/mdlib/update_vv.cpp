@@ -138,8 +138,18 @@ void integrateVVFirstStep(int64_t                   step,
             trotter_update(ir, step, ekind, enerd, state, total_vir, mdatoms, MassQ, trotter_seq, ettTSEQ1);
         }
 
-        upd->update_coords(
-                *ir, step, mdatoms, state, f->view().forceWithPadding(), fcdata, ekind, M, etrtVELOCITY1, cr, constr != nullptr);
+        upd->update_coords(*ir,
+                           step,
+                           mdatoms,
+                           state,
+                           f->view().forceWithPadding(),
+                           fcdata,
+                           ekind,
+                           M,
+                           etrtVELOCITY1,
+                           cr,
+                           constr != nullptr,
+                           nullptr);
 
         wallcycle_stop(wcycle, ewcUPDATE);
         constrain_velocities(constr, do_log, do_ene, step, state, nullptr, bCalcVir, shake_vir);
@@ -333,8 +343,18 @@ void integrateVVSecondStep(int64_t                                  step,
                            gmx_wallcycle*                           wcycle)
 {
     /* velocity half-step update */
-    upd->update_coords(
-            *ir, step, mdatoms, state, f->view().forceWithPadding(), fcdata, ekind, M, etrtVELOCITY2, cr, constr != nullptr);
+    upd->update_coords(*ir,
+                       step,
+                       mdatoms,
+                       state,
+                       f->view().forceWithPadding(),
+                       fcdata,
+                       ekind,
+                       M,
+                       etrtVELOCITY2,
+                       cr,
+                       constr != nullptr,
+                       nullptr);
 
 
     /* Above, initialize just copies ekinh into ekin,
@@ -353,8 +373,18 @@ void integrateVVSecondStep(int64_t                                  step,
         updatePrevStepPullCom(pull_work, state);
     }
 
-    upd->update_coords(
-            *ir, step, mdatoms, state, f->view().forceWithPadding(), fcdata, ekind, M, etrtPOSITION, cr, constr != nullptr);
+    upd->update_coords(*ir,
+                       step,
+                       mdatoms,
+                       state,
+                       f->view().forceWithPadding(),
+                       fcdata,
+                       ekind,
+                       M,
+                       etrtPOSITION,
+                       cr,
+                       constr != nullptr,
+                       nullptr);
 
     wallcycle_stop(wcycle, ewcUPDATE);
 
@@ -397,8 +427,18 @@ void integrateVVSecondStep(int64_t                                  step,
         /* now we know the scaling, we can compute the positions again */
         std::copy(cbuf->begin(), cbuf->end(), state->x.begin());
 
-        upd->update_coords(
-                *ir, step, mdatoms, state, f->view().forceWithPadding(), fcdata, ekind, M, etrtPOSITION, cr, constr != nullptr);
+        upd->update_coords(*ir,
+                           step,
+                           mdatoms,
+                           state,
+                           f->view().forceWithPadding(),
+                           fcdata,
+                           ekind,
+                           M,
+                           etrtPOSITION,
+                           cr,
+                           constr != nullptr,
+                           nullptr);
         wallcycle_stop(wcycle, ewcUPDATE);
 
         /* do we need an extra constraint here? just need to copy out of as_rvec_array(state->v.data()) to upd->xp? */
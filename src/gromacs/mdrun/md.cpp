@@ -51,6 +51,7 @@
 #include <algorithm>
 #include <memory>
 #include <numeric>
+#include <optional>
 
 #include "gromacs/applied_forces/awh/awh.h"
 #include "gromacs/commandline/filenm.h"
@@ -128,8 +129,10 @@
 #include "gromacs/mdtypes/state.h"
 #include "gromacs/mdtypes/state_propagator_data_gpu.h"
 #include "gromacs/modularsimulator/energydata.h"
+#include "gromacs/nbnxm/atomdata.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
 #include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlist_tuning.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/output.h"
 #include "gromacs/pulling/pull.h"
@@ -483,6 +486,40 @@ void gmx::LegacySimulator::do_md()
         changePinningPolicy(&state->v, PinningPolicy::PinnedIfSupported);
     }
 
+    /* With CPU non-bondeds and the simple leap-frog update, the update can add
+     * the local non-bonded forces, which saves a pass over the force buffer.
+     * This requires that nothing uses the complete forces before the update.
+     */
+    const bool useFusedNonbondedUpdate =
+            (getenv("GMX_NBNXN_FUSED_UPDATE") != nullptr && ir->eI == eiMD && !useGpuForUpdate
+             && simulationWork.useCpuNonbonded && !fr->nbv->emulateGpu() && vsite == nullptr
+             && shellfc == nullptr && !fr->useMts && ir->etc != etcNOSEHOOVER
+             && ir->epc != epcPARRINELLORAHMAN && !ekind->bNEMD && ekind->cosacc.cos_accel == 0
+             && fr->print_force < 0);
+    if (useFusedNonbondedUpdate)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Adding the local non-bonded forces during the update at steps "
+                        "without virial or force output.");
+    }
+
+    /* The reduction of the energies and the force virial can be started
+     * directly after the force calculation, so it overlaps with the update
+     * and the constraints. The reduction is completed in compute_globals.
+     */
+    const bool startForceTermsReduction =
+            (getenv("GMX_ASYNC_GLOBAL_STAT") != nullptr && !EI_VV(ir->eI) && PAR(cr));
+    if (startForceTermsReduction)
+    {
+        GMX_LOG(mdlog.info)
+                .asParagraph()
+                .appendText(
+                        "Starting the global reduction of energies and the force virial "
+                        "directly after the force calculation.");
+    }
+
     // NOTE: The global state is no longer used at this point.
     // But state_global is still used as temporary storage space for writing
     // the global state to file and potentially for replica exchange.
@@ -536,6 +573,17 @@ void gmx::LegacySimulator::do_md()
                 &pme_loadbal, cr, mdlog, *ir, state->box, *fr->ic, *fr->nbv, fr->pmedata, fr->nbv->useGpu());
     }
 
+    /* Runtime tuning of nstlist and the pruning interval. This changes nstlist,
+     * which the PME load balancing and replica exchange do not support.
+     */
+    std::unique_ptr<PairlistTuner> pairlistTuner;
+    if (getenv("GMX_NSTLIST_AUTOTUNE") != nullptr && !mdrunOptions.reproducible
+        && !pme_loadbal_is_active(pme_loadbal) && !useReplicaExchange)
+    {
+        pairlistTuner =
+                std::make_unique<PairlistTuner>(mdlog, cr, *ir, *top_global, state->box, *fr);
+    }
+
     if (!ir->bContinuation)
     {
         if (state->flags & (1U << estV))
@@ -883,6 +931,11 @@ void gmx::LegacySimulator::do_md()
                            simulationWork.useGpuPmePpCommunication);
         }
 
+        if (pairlistTuner && pairlistTuner->isActive() && bNStList)
+        {
+            pairlistTuner->tune(mdlog, cr, ir, fr, state->box, state->x, wcycle, step);
+        }
+
         wallcycle_start(wcycle, ewcSTEP);
 
         bLastStep = (step_rel == ir->nsteps);
@@ -1091,6 +1144,10 @@ void gmx::LegacySimulator::do_md()
         {
             force_flags |= GMX_FORCE_DO_NOT_NEED_NORMAL_FORCE;
         }
+        if (useFusedNonbondedUpdate && !bCalcVir && !do_per_step(step, ir->nstfout))
+        {
+            force_flags |= GMX_FORCE_DEFER_LOCAL_NONBONDED_FORCES;
+        }
 
         if (shellfc)
         {
@@ -1178,6 +1235,13 @@ void gmx::LegacySimulator::do_md()
                      ddBalanceRegionHandler);
         }
 
+        if (startForceTermsReduction && bGStat && bCalcEner)
+        {
+            wallcycle_start(wcycle, ewcMoveE);
+            global_stat_start_force_terms(gstat, cr, *enerd, force_vir, *ir);
+            wallcycle_stop(wcycle, ewcMoveE);
+        }
+
         // VV integrators do not need the following velocity half step
         // if it is the first step after starting from a checkpoint.
         // That is, the half step is needed on all other steps, and
@@ -1513,8 +1577,25 @@ void gmx::LegacySimulator::do_md()
                         (fr->useMts && step % ir->mtsLevels[1].stepFactor == 0)
                                 ? f.view().forceMtsCombinedWithPadding()
                                 : f.view().forceWithPadding();
-                upd.update_coords(
-                        *ir, step, mdatoms, state, forceCombined, fcdata, ekind, M, etrtPOSITION, cr, constr != nullptr);
+                std::optional<NbnxmLocalForceReader> deferredNonbondedForces;
+                if (runScheduleWork->stepWork.deferLocalNonbondedForces)
+                {
+                    deferredNonbondedForces.emplace(fr->nbv->localForceReader());
+                }
+                const NbnxmLocalForceReader* deferredNonbondedForcesPtr =
+                        deferredNonbondedForces ? &deferredNonbondedForces.value() : nullptr;
+                upd.update_coords(*ir,
+                                  step,
+                                  mdatoms,
+                                  state,
+                                  forceCombined,
+                                  fcdata,
+                                  ekind,
+                                  M,
+                                  etrtPOSITION,
+                                  cr,
+                                  constr != nullptr,
+                                  deferredNonbondedForcesPtr);
 
                 wallcycle_stop(wcycle, ewcUPDATE);
 
@@ -83,6 +83,11 @@ public:
     bool computeListedForces = false;
     //! Whether this step DHDL needs to be computed
     bool computeDhdl = false;
+    /*! \brief Whether the local CPU non-bonded forces are left in the nbnxm buffer
+     *
+     * When set, these forces are added during the update instead of in do_force().
+     */
+    bool deferLocalNonbondedForces = false;
     /*! \brief Whether coordinate buffer ops are done on the GPU this step
      * \note This technically belongs to DomainLifetimeWorkload but due
      * to needing the flag before DomainLifetimeWorkload is built we keep
@@ -1450,6 +1450,43 @@ static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int
 }
 
 
+/* Reduce the force thread output buffers into buffer 0 */
+static void reduceThreadForceBuffers(nbnxn_atomdata_t* nbat, int nth)
+{
+    if (nbat->bUseTreeReduce)
+    {
+        nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbat, nth);
+    }
+    else
+    {
+        nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbat, nth);
+    }
+}
+
+/* Add the forces in buffer 0 of nbat for atoms a0 to a0 + na to f */
+static void addReducedForces(const nbnxn_atomdata_t& nbat,
+                             const Nbnxm::GridSet&   gridSet,
+                             const int               a0,
+                             const int               na,
+                             const int               nth,
+                             rvec*                   f)
+{
+#pragma omp parallel for num_threads(nth) schedule(static)
+    for (int th = 0; th < nth; th++)
+    {
+        try
+        {
+            nbnxn_atomdata_add_nbat_f_to_f_part(gridSet,
+                                                nbat,
+                                                nbat.out[0],
+                                                a0 + ((th + 0) * na) / nth,
+                                                a0 + ((th + 1) * na) / nth,
+                                                f);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
 /* Add the force array(s) from nbnxn_atomdata_t to f */
 void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, const Nbnxm::GridSet& gridSet, rvec* f)
 {
@@ -1476,24 +1513,56 @@ void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, cons
         /* Reduce the force thread output buffers into buffer 0, before adding
          * them to the, differently ordered, "real" force buffer.
          */
-        if (nbat->bUseTreeReduce)
-        {
-            nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbat, nth);
-        }
-        else
-        {
-            nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbat, nth);
-        }
+        reduceThreadForceBuffers(nbat, nth);
     }
-#pragma omp parallel for num_threads(nth) schedule(static)
-    for (int th = 0; th < nth; th++)
+
+    addReducedForces(*nbat, gridSet, a0, na, nth, f);
+}
+
+void reduceForcesDeferringLocal(nbnxn_atomdata_t* nbat, const Nbnxm::GridSet& gridSet, rvec* f)
+{
+    int nth = gmx_omp_nthreads_get(emntNonbonded);
+
+    if (nbat->out.size() > 1)
     {
-        try
-        {
-            nbnxn_atomdata_add_nbat_f_to_f_part(
-                    gridSet, *nbat, nbat->out[0], a0 + ((th + 0) * na) / nth, a0 + ((th + 1) * na) / nth, f);
-        }
-        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        /* Reduce for all atoms, the local forces are read from buffer 0 later */
+        reduceThreadForceBuffers(nbat, nth);
+    }
+
+    int a0 = 0;
+    int na = 0;
+
+    nbnxn_get_atom_range(gmx::AtomLocality::NonLocal, gridSet, &a0, &na);
+
+    if (na > 0)
+    {
+        addReducedForces(*nbat, gridSet, a0, na, nth, f);
+    }
+}
+
+NbnxmLocalForceReader::NbnxmLocalForceReader(const nbnxn_atomdata_t&  nbat,
+                                             gmx::ArrayRef<const int> cell) :
+    f_(nbat.out[0].f.data()), cell_(cell.data())
+{
+    switch (nbat.FFormat)
+    {
+        case nbatXYZ:
+        case nbatXYZQ:
+            packMask_        = 0;
+            packStride_      = nbat.fstride;
+            componentStride_ = 1;
+            break;
+        case nbatX4:
+            packMask_        = c_packX4 - 1;
+            packStride_      = DIM;
+            componentStride_ = c_packX4;
+            break;
+        case nbatX8:
+            packMask_        = c_packX8 - 1;
+            packStride_      = DIM;
+            componentStride_ = c_packX8;
+            break;
+        default: gmx_incons("Unsupported nbnxn_atomdata_t format");
     }
 }
 
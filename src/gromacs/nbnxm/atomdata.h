@@ -375,6 +375,42 @@ void nbnxn_atomdata_x_to_nbat_x_gpu(const Nbnxm::GridSet&   gridSet,
                                     DeviceBuffer<gmx::RVec> d_x,
                                     GpuEventSynchronizer*   xReadyOnDevice);
 
+/*! \libinternal
+ * \brief Read access to the non-bonded forces on local atoms in the original atom order
+ *
+ * This allows the addition of the local non-bonded forces to the total force
+ * to be fused with a later pass over the local atoms, such as the update.
+ * The forces are valid after reduceForcesDeferringLocal() has been called
+ * and until the next non-bonded force computation.
+ */
+class NbnxmLocalForceReader
+{
+public:
+    //! Constructor, \p cell gives the nbnxm atom index for each atom
+    NbnxmLocalForceReader(const nbnxn_atomdata_t& nbat, gmx::ArrayRef<const int> cell);
+
+    //! Returns the non-bonded force on atom \p a
+    gmx::RVec operator[](int a) const
+    {
+        const int c = cell_[a];
+        const int i = packStride_ * (c & ~packMask_) + (c & packMask_);
+
+        return { f_[i], f_[i + componentStride_], f_[i + 2 * componentStride_] };
+    }
+
+private:
+    //! The non-bonded force buffer
+    const real* f_;
+    //! The index in the non-bonded atom data for each atom
+    const int* cell_;
+    //! Mask for the index within a pack, 0 without packing
+    int packMask_;
+    //! The force buffer stride for atoms or, with packing, DIM
+    int packStride_;
+    //! The stride between force components
+    int componentStride_;
+};
+
 /*! \brief Add the computed forces to \p f, an internal reduction might be performed as well
  *
  * \param[in]  nbat        Atom data in NBNXM format.
@@ -384,6 +420,19 @@ void nbnxn_atomdata_x_to_nbat_x_gpu(const Nbnxm::GridSet&   gridSet,
  */
 void reduceForces(nbnxn_atomdata_t* nbat, gmx::AtomLocality locality, const Nbnxm::GridSet& gridSet, rvec* totalForce);
 
+/*! \brief Reduces the thread force buffers and adds the non-local forces to \p totalForce
+ *
+ * The local forces are not added to \p totalForce, but left in \p nbat,
+ * where they can be accessed through NbnxmLocalForceReader.
+ *
+ * \param[in]  nbat        Atom data in NBNXM format.
+ * \param[in]  gridSet     The grids data.
+ * \param[out] totalForce  Buffer to accumulate the non-local forces
+ */
+void reduceForcesDeferringLocal(nbnxn_atomdata_t*     nbat,
+                                const Nbnxm::GridSet& gridSet,
+                                rvec*                 totalForce);
+
 //! Add the fshift force stored in nbat to fshift
 void nbnxn_atomdata_add_nbat_fshift_to_fshift(const nbnxn_atomdata_t& nbat, gmx::ArrayRef<gmx::RVec> fshift);
 
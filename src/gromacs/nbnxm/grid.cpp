@@ -667,15 +667,16 @@ static void calc_bounding_box_xxxx_simd4(int na, const float* x, BoundingBox* bb
 #endif /* NBNXN_SEARCH_SIMD4_FLOAT_X_BB */
 
 
-/*! \brief Combines pairs of consecutive bounding boxes */
+/*! \brief Combines pairs of consecutive bounding boxes for the columns in \p columnRange */
 static void combine_bounding_box_pairs(const Grid&                      grid,
+                                       const gmx::Range<int>            columnRange,
                                        gmx::ArrayRef<const BoundingBox> bb,
                                        gmx::ArrayRef<BoundingBox>       bbj)
 {
     // TODO: During SIMDv2 transition only some archs use namespace (remove when done)
     using namespace gmx;
 
-    for (int i = 0; i < grid.numColumns(); i++)
+    for (int i : columnRange)
     {
         /* Starting bb in a column is expected to be 2-aligned */
         const int sc2 = grid.firstCellInColumn(i) >> 1;
@@ -1238,6 +1239,17 @@ void Grid::sortColumnsGpuGeometry(GridSetData*                   gridSetData,
     }
 }
 
+/*! \brief Returns the part of \p atomRange assigned to thread \p thread
+ *
+ * Note that the filling of the grid in Grid::setCellIndices() relies on
+ * the atom ranges being ordered by thread index.
+ */
+static gmx::Range<int> atomRangeForThread(const gmx::Range<int> atomRange, int thread, int nthread)
+{
+    return { *atomRange.begin() + static_cast<int>((thread + 0) * atomRange.size()) / nthread,
+             *atomRange.begin() + static_cast<int>((thread + 1) * atomRange.size()) / nthread };
+}
+
 /*! \brief Sets the cell index in the cell array for atom \p atomIndex and increments the atom count for the grid column */
 static void setCellAndAtomCount(gmx::ArrayRef<int> cell, int cellIndex, gmx::ArrayRef<int> cxy_na, int atomIndex)
 {
@@ -1259,18 +1271,17 @@ void Grid::calcColumnIndices(const Grid::Dimensions&        gridDims,
     const int numColumns = gridDims.numCells[XX] * gridDims.numCells[YY];
 
     /* We add one extra cell for particles which moved during DD */
-    for (int i = 0; i < numColumns; i++)
+    for (int i = 0; i < numColumns + 1; i++)
     {
         cxy_na[i] = 0;
     }
 
-    int taskAtomStart = *atomRange.begin() + static_cast<int>((thread + 0) * atomRange.size()) / nthread;
-    int taskAtomEnd = *atomRange.begin() + static_cast<int>((thread + 1) * atomRange.size()) / nthread;
+    const gmx::Range<int> taskAtomRange = atomRangeForThread(atomRange, thread, nthread);
 
     if (dd_zone == 0)
     {
         /* Home zone */
-        for (int i = taskAtomStart; i < taskAtomEnd; i++)
+        for (int i : taskAtomRange)
         {
             if (move == nullptr || move[i] >= 0)
             {
@@ -1325,7 +1336,7 @@ void Grid::calcColumnIndices(const Grid::Dimensions&        gridDims,
     else
     {
         /* Non-home zone */
-        for (int i = taskAtomStart; i < taskAtomEnd; i++)
+        for (int i : taskAtomRange)
         {
             int cx = static_cast<int>((x[i][XX] - gridDims.lowerCorner[XX]) * gridDims.invCellSize[XX]);
             int cy = static_cast<int>((x[i][YY] - gridDims.lowerCorner[YY]) * gridDims.invCellSize[YY]);
@@ -1385,34 +1396,46 @@ void Grid::setCellIndices(int                            ddZone,
 
     const int numAtomsPerCell = geometry_.numAtomsPerCell;
 
+    /* Sum the atom counts per column over the threads and convert the
+     * thread counts to offsets of the atoms of each thread in the column.
+     * Note that the last column contains the moved particles.
+     */
+    const int numColumnsWithMoved = numColumns() + 1;
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
+    {
+        for (int i = (thread * numColumnsWithMoved) / nthread;
+             i < ((thread + 1) * numColumnsWithMoved) / nthread;
+             i++)
+        {
+            int numAtomsInColumn = 0;
+            for (int t = 0; t < nthread; t++)
+            {
+                const int numAtomsOfThread        = gridWork[t].numAtomsPerColumn[i];
+                gridWork[t].numAtomsPerColumn[i] = numAtomsInColumn;
+                numAtomsInColumn += numAtomsOfThread;
+            }
+            cxy_na_[i] = numAtomsInColumn;
+        }
+    }
+
     /* Make the cell index as a function of x and y */
     int ncz_max = 0;
-    int ncz     = 0;
     cxy_ind_[0] = 0;
-    for (int i = 0; i < numColumns() + 1; i++)
+    for (int i = 0; i < numColumnsWithMoved; i++)
     {
-        /* We set ncz_max at the beginning of the loop iso at the end
-         * to skip i=grid->ncx*grid->numCells[YY] which are moved particles
-         * that do not need to be ordered on the grid.
-         */
-        if (ncz > ncz_max)
-        {
-            ncz_max = ncz;
-        }
-        int cxy_na_i = gridWork[0].numAtomsPerColumn[i];
-        for (int thread = 1; thread < nthread; thread++)
-        {
-            cxy_na_i += gridWork[thread].numAtomsPerColumn[i];
-        }
-        ncz = (cxy_na_i + numAtomsPerCell - 1) / numAtomsPerCell;
+        int ncz = (cxy_na_[i] + numAtomsPerCell - 1) / numAtomsPerCell;
         if (nbat->XFormat == nbatX8)
         {
             /* Make the number of cell a multiple of 2 */
             ncz = (ncz + 1) & ~1;
         }
         cxy_ind_[i + 1] = cxy_ind_[i] + ncz;
-        /* Clear cxy_na_, so we can reuse the array below */
-        cxy_na_[i] = 0;
+        /* Moved particles do not need to be ordered on the grid */
+        if (i < numColumns())
+        {
+            ncz_max = std::max(ncz_max, ncz);
+        }
     }
     numCellsTotal_     = cxy_ind_[numColumns()] - cxy_ind_[0];
     numCellsColumnMax_ = ncz_max;
@@ -1446,27 +1469,24 @@ void Grid::setCellIndices(int                            ddZone,
         }
     }
 
-    /* Make sure the work array for sorting is large enough */
-    const int worstCaseSortBufferSize = ncz_max * numAtomsPerCell * c_sortGridMaxSizeFactor;
-    if (worstCaseSortBufferSize > gmx::index(gridWork[0].sortBuffer.size()))
-    {
-        for (GridWork& work : gridWork)
-        {
-            /* Elements not in use should be -1 */
-            work.sortBuffer.resize(worstCaseSortBufferSize, -1);
-        }
-    }
-
     /* Now we know the dimensions we can fill the grid.
      * This is the first, unsorted fill. We sort the columns after this.
+     * Each thread fills in the atoms it assigned to columns, at the offsets
+     * for the thread computed above. As the atom ranges of the threads are
+     * ordered, this gives the same atom order as a serial fill.
      */
     gmx::ArrayRef<int> cells       = gridSetData->cells;
     gmx::ArrayRef<int> atomIndices = gridSetData->atomIndices;
-    for (int i : atomRange)
+#pragma omp parallel for num_threads(nthread) schedule(static)
+    for (int thread = 0; thread < nthread; thread++)
     {
-        /* At this point nbs->cell contains the local grid x,y indices */
-        const int cxy                                        = cells[i];
-        atomIndices[firstAtomInColumn(cxy) + cxy_na_[cxy]++] = i;
+        gmx::ArrayRef<int> columnOffset = gridWork[thread].numAtomsPerColumn;
+        for (int i : atomRangeForThread(atomRange, thread, nthread))
+        {
+            /* At this point nbs->cell contains the local grid x,y indices */
+            const int cxy                                             = cells[i];
+            atomIndices[firstAtomInColumn(cxy) + columnOffset[cxy]++] = i;
+        }
     }
 
     if (ddZone == 0)
@@ -1486,27 +1506,39 @@ void Grid::setCellIndices(int                            ddZone,
     {
         try
         {
+            /* Make sure the work array for sorting is large enough.
+             * We resize here, so the memory is first touched by the thread using it.
+             */
+            std::vector<int>& sortBuffer = gridWork[thread].sortBuffer;
+            const int         worstCaseSortBufferSize =
+                    ncz_max * numAtomsPerCell * c_sortGridMaxSizeFactor;
+            if (worstCaseSortBufferSize > gmx::index(sortBuffer.size()))
+            {
+                /* Elements not in use should be -1 */
+                sortBuffer.resize(worstCaseSortBufferSize, -1);
+            }
+
             gmx::Range<int> columnRange(((thread + 0) * numColumns()) / nthread,
                                         ((thread + 1) * numColumns()) / nthread);
             if (geometry_.isSimple)
             {
                 sortColumnsCpuGeometry(
-                        gridSetData, ddZone, atinfo, x, nbat, columnRange, gridWork[thread].sortBuffer);
+                        gridSetData, ddZone, atinfo, x, nbat, columnRange, sortBuffer);
+
+                if (nbat->XFormat == nbatX8)
+                {
+                    combine_bounding_box_pairs(*this, columnRange, bb_, bbj_);
+                }
             }
             else
             {
                 sortColumnsGpuGeometry(
-                        gridSetData, ddZone, atinfo, x, nbat, columnRange, gridWork[thread].sortBuffer);
+                        gridSetData, ddZone, atinfo, x, nbat, columnRange, sortBuffer);
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
-    if (geometry_.isSimple && nbat->XFormat == nbatX8)
-    {
-        combine_bounding_box_pairs(*this, bb_, bbj_);
-    }
-
     if (!geometry_.isSimple)
     {
         numClustersTotal_ = 0;
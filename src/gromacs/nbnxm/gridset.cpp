@@ -46,6 +46,8 @@
 
 #include "gridset.h"
 
+#include <algorithm>
+
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdlib/updategroupscog.h"
 #include "gromacs/nbnxm/atomdata.h"
@@ -196,14 +198,24 @@ void GridSet::putOnGrid(const matrix                   box,
     grid.setDimensions(
             ddZone, n - numAtomsMoved, lowerCorner, upperCorner, atomDensity, maxAtomGroupRadius, haveFep_, pinPolicy);
 
-    for (GridWork& work : gridWork_)
-    {
-        work.numAtomsPerColumn.resize(grid.numColumns() + 1);
-    }
-
-    /* Make space for the new cell indices */
+    /* Make space for the new cell indices. The elements are not initialized
+     * here, so the memory is first touched by the threads computing them.
+     */
     gridSetData_.cells.resize(*atomRange.end());
 
+    /* Make space for the atom indices of this grid, using an upper bound
+     * for the padding of the columns, including the column with moved atoms,
+     * to cells (pairs of cells with X8) and the storage of the moved atoms.
+     * The exact size is set in Grid::setCellIndices(), which does not
+     * reallocate. The elements are first touched by the threads below.
+     */
+    const int numAtomsPerCell = grid.geometry().numAtomsPerCell;
+    const gmx::Range<int> gridAtomIndices(
+            cellOffset * numAtomsPerCell,
+            cellOffset * numAtomsPerCell + n + 2 * (grid.numColumns() + 1) * numAtomsPerCell
+                    + numAtomsMoved);
+    gridSetData_.atomIndices.resize(*gridAtomIndices.end());
+
     const int nthread = gmx_omp_nthreads_get(emntPairsearch);
     GMX_ASSERT(nthread > 0, "We expect the OpenMP thread count to be set");
 
@@ -212,6 +224,20 @@ void GridSet::putOnGrid(const matrix                   box,
     {
         try
         {
+            /* Resize here, so the memory is first touched by the thread using it */
+            gridWork_[thread].numAtomsPerColumn.resize(grid.numColumns() + 1);
+
+            /* First touch of the atom indices, in the same static thread order as
+             * the column sorting, which accesses the atom indices most.
+             */
+            const int touchBegin =
+                    *gridAtomIndices.begin() + (gridAtomIndices.size() * thread) / nthread;
+            const int touchEnd =
+                    *gridAtomIndices.begin() + (gridAtomIndices.size() * (thread + 1)) / nthread;
+            std::fill(gridSetData_.atomIndices.begin() + touchBegin,
+                      gridSetData_.atomIndices.begin() + touchEnd,
+                      -1);
+
             Grid::calcColumnIndices(grid.dimensions(),
                                     updateGroupsCog,
                                     atomRange,
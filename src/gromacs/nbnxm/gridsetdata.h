@@ -50,10 +50,19 @@
 #include <vector>
 
 #include "gromacs/gpu_utils/hostallocator.h"
+#include "gromacs/utility/defaultinitializationallocator.h"
 
 namespace Nbnxm
 {
 
+/*! \brief Host vector that does not initialize elements on resize
+ *
+ * This allows the memory to be first touched by the threads that use it.
+ */
+template<typename T>
+using HostVectorWithoutInitialization =
+        std::vector<T, gmx::DefaultInitializationAllocator<T, gmx::HostAllocator<T>>>;
+
 /*! \internal
  * \brief Struct that holds grid data that is shared over all grids
  *
@@ -63,9 +72,9 @@ namespace Nbnxm
 struct GridSetData
 {
     //! The cell indices for all atoms
-    gmx::HostVector<int> cells;
+    HostVectorWithoutInitialization<int> cells;
     //! The atom indices for all atoms stored in cell order
-    gmx::HostVector<int> atomIndices;
+    HostVectorWithoutInitialization<int> atomIndices;
 };
 
 /*! \internal
@@ -97,10 +97,7 @@ enum
  *
  * The \p LJCUT_COMB refers to the LJ combination rule for the short range.
  * The \p EWALDCOMB refers to the combination rule for the grid part.
- * \p vdwktNR is the number of VdW treatments for the SIMD kernels.
- * \p vdwktNR_ref is the number of VdW treatments for the C reference kernels.
- * These two numbers differ, because currently only the reference kernels
- * support LB combination rules for the LJ-Ewald grid part.
+ * \p vdwktNR is the number of VdW treatments for the SIMD and C reference kernels.
  */
 enum
 {
@@ -111,8 +108,7 @@ enum
     vdwktLJPOTSWITCH,
     vdwktLJEWALDCOMBGEOM,
     vdwktLJEWALDCOMBLB,
-    vdwktNR = vdwktLJEWALDCOMBLB,
-    vdwktNR_ref
+    vdwktNR
 };
 
 /*! \brief Clears the force buffer.
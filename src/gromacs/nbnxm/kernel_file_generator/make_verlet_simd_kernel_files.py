@@ -111,6 +111,7 @@ VdwTreatmentDict['VdwLJ'] = { 'define' : '#define LJ_CUT\n/* Use full LJ combina
 VdwTreatmentDict['VdwLJFSw'] = { 'define' : '#define LJ_FORCE_SWITCH\n/* Use full LJ combination matrix */' }
 VdwTreatmentDict['VdwLJPSw'] = { 'define' : '#define LJ_POT_SWITCH\n/* Use full LJ combination matrix */' }
 VdwTreatmentDict['VdwLJEwCombGeom'] = { 'define' : '#define LJ_CUT\n#define LJ_EWALD_GEOM\n/* Use full LJ combination matrix + geometric rule for the grid correction */' }
+VdwTreatmentDict['VdwLJEwCombLB'] = { 'define' : '#define LJ_CUT\n#define LJ_EWALD_LB\n/* Use full LJ combination matrix + LB rule for the grid correction */' }
 
 # This is OK as an unordered dict
 EnergiesComputationDict = {
@@ -36,6 +36,8 @@
 
 #include "gmxpre.h"
 
+#include <vector>
+
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -225,10 +227,6 @@ static void nbnxn_kernel_cpu(const PairlistSet&         pairlistSet,
         else
         {
             vdwkt = vdwktLJEWALDCOMBLB;
-            /* At setup we (should have) selected the C reference kernel */
-            GMX_RELEASE_ASSERT(kernelSetup.kernelType == Nbnxm::KernelType::Cpu4x4_PlainC,
-                               "Only the C reference nbnxn SIMD kernel supports LJ-PME with LB "
-                               "combination rules");
         }
     }
     else
@@ -547,36 +545,32 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
      */
     if (fepvals->n_lambda > 0 && stepWork.computeDhdl && fepvals->sc_alpha != 0)
     {
-        real lam_i[efptNR];
-        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
-                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
-        kernel_data.lambda         = lam_i;
-        kernel_data.dvdl           = dvdl_nb;
-        kernel_data.energygrp_elec = enerd->foreign_grpp.ener[egCOULSR].data();
-        kernel_data.energygrp_vdw  = enerd->foreign_grpp.ener[egLJSR].data();
-
-        for (gmx::index i = 0; i < 1 + enerd->foreignLambdaTerms.numLambdas(); i++)
+        /* All lambda points are computed in a single pass over the lists */
+        const int         numLambdas = 1 + enerd->foreignLambdaTerms.numLambdas();
+        std::vector<real> lambdaCoul(numLambdas);
+        std::vector<real> lambdaVdw(numLambdas);
+        for (int i = 0; i < numLambdas; i++)
         {
-            std::fill(std::begin(dvdl_nb), std::end(dvdl_nb), 0);
-            for (int j = 0; j < efptNR; j++)
-            {
-                lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
-            }
-            reset_foreign_enerdata(enerd);
+            lambdaCoul[i] = (i == 0 ? lambda[efptCOUL] : fepvals->all_lambda[efptCOUL][i - 1]);
+            lambdaVdw[i]  = (i == 0 ? lambda[efptVDW] : fepvals->all_lambda[efptVDW][i - 1]);
+        }
+        std::vector<real> energy(numLambdas, 0);
+        std::vector<real> dvdl(numLambdas, 0);
+
 #pragma omp parallel for schedule(static) num_threads(nbl_fep.ssize())
-            for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        {
+            try
             {
-                try
-                {
-                    gmx_nb_free_energy_kernel(
-                            nbl_fep[th].get(), x, forceWithShiftForces, fr, &mdatoms, &kernel_data, nrnb);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                gmx_nb_free_energy_foreign_lambda_kernel(
+                        nbl_fep[th].get(), x, fr, &mdatoms, lambdaCoul, lambdaVdw, energy, dvdl, nrnb);
             }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
 
-            sum_epot(enerd->foreign_grpp, enerd->foreign_term);
-            enerd->foreignLambdaTerms.accumulate(
-                    i, enerd->foreign_term[F_EPOT], dvdl_nb[efptVDW] + dvdl_nb[efptCOUL]);
+        for (int i = 0; i < numLambdas; i++)
+        {
+            enerd->foreignLambdaTerms.accumulate(i, energy[i], dvdl[i]);
         }
     }
     wallcycle_sub_stop(wcycle_, ewcsNONBONDED_FEP);
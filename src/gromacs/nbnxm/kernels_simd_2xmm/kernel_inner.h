@@ -59,7 +59,7 @@
  * separately to as then it is easier to separate the energy and virial
  * contributions.
  */
-#if defined CHECK_EXCLS && (defined CALC_COULOMB || defined LJ_EWALD_GEOM)
+#if defined CHECK_EXCLS && (defined CALC_COULOMB || defined LJ_EWALD)
 #    define EXCL_FORCES
 #endif
 
@@ -181,7 +181,7 @@
     SimdReal c6s_j_S, c12s_j_S;
 #    endif
 
-#    if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD_GEOM
+#    if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD
     /* Index for loading LJ parameters, complicated when interleaving */
     int aj2;
 #    endif
@@ -211,7 +211,7 @@
 
     /* Atom indices (of the first atom in the cluster) */
     aj = cj * UNROLLJ;
-#if defined CALC_LJ && (defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD_GEOM)
+#if defined CALC_LJ && (defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD)
     aj2 = aj * 2;
 #endif
     ajx = aj * DIM;
@@ -701,9 +701,8 @@
 #        endif
 #    endif
 
-#    ifdef LJ_EWALD_GEOM
+#    ifdef LJ_EWALD
     {
-        SimdReal c6s_j_S;
         SimdReal c6grid_S0, rinvsix_nm_S0, cr2_S0, expmcr2_S0, poly_S0;
 #        ifndef HALF_LJ
         SimdReal c6grid_S2, rinvsix_nm_S2, cr2_S2, expmcr2_S2, poly_S2;
@@ -715,11 +714,28 @@
 #            endif
 #        endif
 
+#        ifdef LJ_EWALD_GEOM
         /* Determine C6 for the grid using the geometric combination rule */
-        c6s_j_S   = loadDuplicateHsimd(ljc + aj2);
-        c6grid_S0 = c6s_S0 * c6s_j_S;
-#        ifndef HALF_LJ
+        SimdReal c6s_j_S = loadDuplicateHsimd(ljc + aj2);
+        c6grid_S0        = c6s_S0 * c6s_j_S;
+#            ifndef HALF_LJ
         c6grid_S2 = c6s_S2 * c6s_j_S;
+#            endif
+#        else
+        /* Determine C6 for the grid using the Lorentz-Berthelot combination rule,
+         * sigma and epsilon are scaled to give 6*C6
+         */
+        SimdReal hsig_j_S = loadDuplicateHsimd(ljc + aj2);
+        SimdReal seps_j_S = loadDuplicateHsimd(ljc + aj2 + STRIDE);
+
+        SimdReal sigma_S0  = hsig_i_S0 + hsig_j_S;
+        SimdReal sigma2_S0 = sigma_S0 * sigma_S0;
+        c6grid_S0          = seps_i_S0 * seps_j_S * sigma2_S0 * sigma2_S0 * sigma2_S0;
+#            ifndef HALF_LJ
+        SimdReal sigma_S2  = hsig_i_S2 + hsig_j_S;
+        SimdReal sigma2_S2 = sigma_S2 * sigma_S2;
+        c6grid_S2          = seps_i_S2 * seps_j_S * sigma2_S2 * sigma2_S2 * sigma2_S2;
+#            endif
 #        endif
 
 #        ifdef CHECK_EXCLS
@@ -789,7 +805,7 @@
 #            endif
 #        endif /* CALC_ENERGIES */
     }
-#    endif /* LJ_EWALD_GEOM */
+#    endif /* LJ_EWALD */
 
 #    if defined VDW_CUTOFF_CHECK
     /* frLJ is multiplied later by rinvsq, which is masked for the Coulomb
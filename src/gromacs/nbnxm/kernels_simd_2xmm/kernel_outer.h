@@ -136,7 +136,7 @@
     SimdReal p6_6cpot_S, p12_12cpot_S;
 #    endif
 #endif
-#ifdef LJ_EWALD_GEOM
+#ifdef LJ_EWALD
     real     lj_ewaldcoeff2, lj_ewaldcoeff6_6;
     SimdReal half_S, lje_c2_S, lje_c6_6_S;
 #endif
@@ -165,7 +165,7 @@
 
     const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
 
-#if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD_GEOM
+#if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD
     const real* gmx_restrict ljc = nbatParams.lj_comb.data();
 #endif
 #if !(defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined FIX_LJ_C)
@@ -292,7 +292,7 @@
     }
 #    endif
 #endif
-#ifdef LJ_EWALD_GEOM
+#ifdef LJ_EWALD
     half_S           = SimdReal(0.5);
     lj_ewaldcoeff2   = ic->ewaldcoeff_lj * ic->ewaldcoeff_lj;
     lj_ewaldcoeff6_6 = lj_ewaldcoeff2 * lj_ewaldcoeff2 * lj_ewaldcoeff2 / 6;
@@ -371,13 +371,13 @@
 #if UNROLLJ <= 4
         int sci  = ci * STRIDE;
         int scix = sci * DIM;
-#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
+#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD
         int sci2 = sci * 2;
 #    endif
 #else
         int sci  = (ci >> 1) * STRIDE;
         int scix = sci * DIM + (ci & 1) * (STRIDE >> 1);
-#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
+#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD
         int sci2 = sci * 2 + (ci & 1) * (STRIDE >> 1);
 #    endif
         sci += (ci & 1) * (STRIDE >> 1);
@@ -408,7 +408,7 @@
 #endif
 
 #ifdef CALC_ENERGIES
-#    ifdef LJ_EWALD_GEOM
+#    ifdef LJ_EWALD
         gmx_bool do_self = TRUE;
 #    else
         gmx_bool do_self = do_coul;
@@ -454,7 +454,7 @@
                     }
                 }
 
-#    ifdef LJ_EWALD_GEOM
+#    ifdef LJ_EWALD
                 {
                     int ia;
 
@@ -546,6 +546,18 @@
             c6s_S2 = loadU1DualHsimd(ljc + sci2 + 2);
         }
 #endif
+#ifdef LJ_EWALD_LB
+        /* We need the Lorentz-Berthelot combined C6 for the PME grid correction */
+        SimdReal hsig_i_S0, seps_i_S0;
+        SimdReal hsig_i_S2, seps_i_S2;
+        hsig_i_S0 = loadU1DualHsimd(ljc + sci2);
+        seps_i_S0 = loadU1DualHsimd(ljc + sci2 + STRIDE);
+        if (!half_LJ)
+        {
+            hsig_i_S2 = loadU1DualHsimd(ljc + sci2 + 2);
+            seps_i_S2 = loadU1DualHsimd(ljc + sci2 + STRIDE + 2);
+        }
+#endif
 
         /* Zero the potential energy for this list */
 #ifdef CALC_ENERGIES
@@ -70,6 +70,11 @@ static_assert(UNROLLI == c_nbnxnCpuIClusterSize, "UNROLLI should match the i-clu
 #    define TAB_FDV0
 #endif
 
+/* LJ-PME with either the geometric or the Lorentz-Berthelot combination rule for the grid */
+#if defined LJ_EWALD_GEOM || defined LJ_EWALD_LB
+#    define LJ_EWALD
+#endif
+
 
 #ifdef UNROLLJ
 /* Add energy register to possibly multiple terms in the energy array */
@@ -141,7 +141,7 @@
     SimdReal p6_6cpot_S, p12_12cpot_S;
 #    endif
 #endif
-#ifdef LJ_EWALD_GEOM
+#ifdef LJ_EWALD
     real     lj_ewaldcoeff2, lj_ewaldcoeff6_6;
     SimdReal half_S, lje_c2_S, lje_c6_6_S;
 #endif
@@ -167,7 +167,7 @@
 
     const nbnxn_atomdata_t::Params& nbatParams = nbat->params();
 
-#if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD_GEOM
+#if defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined LJ_EWALD
     const real* gmx_restrict ljc = nbatParams.lj_comb.data();
 #endif
 #if !(defined LJ_COMB_GEOM || defined LJ_COMB_LB || defined FIX_LJ_C)
@@ -310,7 +310,7 @@
     }
 #    endif
 #endif
-#ifdef LJ_EWALD_GEOM
+#ifdef LJ_EWALD
     half_S           = SimdReal(0.5);
     lj_ewaldcoeff2   = ic->ewaldcoeff_lj * ic->ewaldcoeff_lj;
     lj_ewaldcoeff6_6 = lj_ewaldcoeff2 * lj_ewaldcoeff2 * lj_ewaldcoeff2 / 6;
@@ -392,13 +392,13 @@
 #if UNROLLJ <= 4
         int sci  = ci * STRIDE;
         int scix = sci * DIM;
-#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
+#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD
         int sci2 = sci * 2;
 #    endif
 #else
         int sci  = (ci >> 1) * STRIDE;
         int scix = sci * DIM + (ci & 1) * (STRIDE >> 1);
-#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD_GEOM
+#    if defined LJ_COMB_LB || defined LJ_COMB_GEOM || defined LJ_EWALD
         int sci2 = sci * 2 + (ci & 1) * (STRIDE >> 1);
 #    endif
         sci += (ci & 1) * (STRIDE >> 1);
@@ -429,7 +429,7 @@
 #endif
 
 #ifdef CALC_ENERGIES
-#    ifdef LJ_EWALD_GEOM
+#    ifdef LJ_EWALD
         gmx_bool do_self = TRUE;
 #    else
         gmx_bool do_self = do_coul;
@@ -478,7 +478,7 @@
                         }
                     }
 
-#    ifdef LJ_EWALD_GEOM
+#    ifdef LJ_EWALD
                     {
                         int ia;
 
@@ -496,7 +496,7 @@
                                     += 0.5 * c6_i * lj_ewaldcoeff6_6;
                         }
                     }
-#    endif /* LJ_EWALD_GEOM */
+#    endif /* LJ_EWALD */
                 }
 #endif
 
@@ -584,6 +584,22 @@
             c6s_S3 = SimdReal(ljc[sci2 + 3]);
         }
 #endif
+#ifdef LJ_EWALD_LB
+        /* We need the Lorentz-Berthelot combined C6 for the PME grid correction */
+        SimdReal hsig_i_S0 = SimdReal(ljc[sci2 + 0]);
+        SimdReal hsig_i_S1 = SimdReal(ljc[sci2 + 1]);
+        SimdReal seps_i_S0 = SimdReal(ljc[sci2 + STRIDE + 0]);
+        SimdReal seps_i_S1 = SimdReal(ljc[sci2 + STRIDE + 1]);
+        SimdReal hsig_i_S2, hsig_i_S3;
+        SimdReal seps_i_S2, seps_i_S3;
+        if (!half_LJ)
+        {
+            hsig_i_S2 = SimdReal(ljc[sci2 + 2]);
+            hsig_i_S3 = SimdReal(ljc[sci2 + 3]);
+            seps_i_S2 = SimdReal(ljc[sci2 + STRIDE + 2]);
+            seps_i_S3 = SimdReal(ljc[sci2 + STRIDE + 3]);
+        }
+#endif
 
         /* Zero the potential energy for this list */
 #ifdef CALC_ENERGIES
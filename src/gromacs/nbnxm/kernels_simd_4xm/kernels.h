@@ -48,30 +48,35 @@ nbk_func_noener nbnxm_kernel_ElecRF_VdwLJ_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecRF_VdwLJFSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecRF_VdwLJPSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecRF_VdwLJEwCombGeom_F_4xm;
+nbk_func_noener nbnxm_kernel_ElecRF_VdwLJEwCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJCombGeom_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJ_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJFSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJPSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_F_4xm;
+nbk_func_noener nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJ_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_F_4xm;
+nbk_func_noener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJCombGeom_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJ_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJFSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJPSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEw_VdwLJEwCombGeom_F_4xm;
+nbk_func_noener nbnxm_kernel_ElecEw_VdwLJEwCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJCombLB_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJ_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_F_4xm;
 nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_F_4xm;
+nbk_func_noener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_F_4xm;
 
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJCombGeom_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJCombLB_VF_4xm;
@@ -79,30 +84,35 @@ nbk_func_ener nbnxm_kernel_ElecRF_VdwLJ_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJFSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJPSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJEwCombGeom_VF_4xm;
+nbk_func_ener nbnxm_kernel_ElecRF_VdwLJEwCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJCombGeom_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJ_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJFSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJPSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_VF_4xm;
+nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJ_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VF_4xm;
+nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJCombGeom_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJ_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJFSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJPSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJEwCombGeom_VF_4xm;
+nbk_func_ener nbnxm_kernel_ElecEw_VdwLJEwCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJCombLB_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJ_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_VF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VF_4xm;
+nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_VF_4xm;
 
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJCombGeom_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJCombLB_VgrpF_4xm;
@@ -110,30 +120,35 @@ nbk_func_ener nbnxm_kernel_ElecRF_VdwLJ_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJFSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJPSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecRF_VdwLJEwCombGeom_VgrpF_4xm;
+nbk_func_ener nbnxm_kernel_ElecRF_VdwLJEwCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJCombGeom_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJ_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJFSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJPSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_VgrpF_4xm;
+nbk_func_ener nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJ_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VgrpF_4xm;
+nbk_func_ener nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJCombGeom_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJ_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJFSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJPSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEw_VdwLJEwCombGeom_VgrpF_4xm;
+nbk_func_ener nbnxm_kernel_ElecEw_VdwLJEwCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJCombLB_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJ_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_VgrpF_4xm;
 nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VgrpF_4xm;
+nbk_func_ener nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_VgrpF_4xm;
 
 
 #ifdef INCLUDE_KERNELFUNCTION_TABLES
@@ -150,6 +165,7 @@ static p_nbk_func_noener nbnxm_kernel_noener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecRF_VdwLJFSw_F_4xm,
             nbnxm_kernel_ElecRF_VdwLJPSw_F_4xm,
             nbnxm_kernel_ElecRF_VdwLJEwCombGeom_F_4xm,
+            nbnxm_kernel_ElecRF_VdwLJEwCombLB_F_4xm,
     },
     {
             nbnxm_kernel_ElecQSTab_VdwLJCombGeom_F_4xm,
@@ -158,6 +174,7 @@ static p_nbk_func_noener nbnxm_kernel_noener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTab_VdwLJFSw_F_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJPSw_F_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_F_4xm,
+            nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_F_4xm,
     },
     {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_F_4xm,
@@ -166,6 +183,7 @@ static p_nbk_func_noener nbnxm_kernel_noener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_F_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_F_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_F_4xm,
+            nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_F_4xm,
     },
     {
             nbnxm_kernel_ElecEw_VdwLJCombGeom_F_4xm,
@@ -174,6 +192,7 @@ static p_nbk_func_noener nbnxm_kernel_noener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEw_VdwLJFSw_F_4xm,
             nbnxm_kernel_ElecEw_VdwLJPSw_F_4xm,
             nbnxm_kernel_ElecEw_VdwLJEwCombGeom_F_4xm,
+            nbnxm_kernel_ElecEw_VdwLJEwCombLB_F_4xm,
     },
     {
             nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_F_4xm,
@@ -182,6 +201,7 @@ static p_nbk_func_noener nbnxm_kernel_noener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_F_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_F_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_F_4xm,
+            nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_F_4xm,
     },
 };
 
@@ -193,6 +213,7 @@ static p_nbk_func_ener nbnxm_kernel_ener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecRF_VdwLJFSw_VF_4xm,
             nbnxm_kernel_ElecRF_VdwLJPSw_VF_4xm,
             nbnxm_kernel_ElecRF_VdwLJEwCombGeom_VF_4xm,
+            nbnxm_kernel_ElecRF_VdwLJEwCombLB_VF_4xm,
     },
     {
             nbnxm_kernel_ElecQSTab_VdwLJCombGeom_VF_4xm,
@@ -201,6 +222,7 @@ static p_nbk_func_ener nbnxm_kernel_ener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTab_VdwLJFSw_VF_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJPSw_VF_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_VF_4xm,
+            nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_VF_4xm,
     },
     {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VF_4xm,
@@ -209,6 +231,7 @@ static p_nbk_func_ener nbnxm_kernel_ener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_VF_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_VF_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VF_4xm,
+            nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VF_4xm,
     },
     {
             nbnxm_kernel_ElecEw_VdwLJCombGeom_VF_4xm,
@@ -217,6 +240,7 @@ static p_nbk_func_ener nbnxm_kernel_ener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEw_VdwLJFSw_VF_4xm,
             nbnxm_kernel_ElecEw_VdwLJPSw_VF_4xm,
             nbnxm_kernel_ElecEw_VdwLJEwCombGeom_VF_4xm,
+            nbnxm_kernel_ElecEw_VdwLJEwCombLB_VF_4xm,
     },
     {
             nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_VF_4xm,
@@ -225,6 +249,7 @@ static p_nbk_func_ener nbnxm_kernel_ener_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_VF_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_VF_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VF_4xm,
+            nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_VF_4xm,
     },
 };
 
@@ -236,6 +261,7 @@ static p_nbk_func_ener nbnxm_kernel_energrp_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecRF_VdwLJFSw_VgrpF_4xm,
             nbnxm_kernel_ElecRF_VdwLJPSw_VgrpF_4xm,
             nbnxm_kernel_ElecRF_VdwLJEwCombGeom_VgrpF_4xm,
+            nbnxm_kernel_ElecRF_VdwLJEwCombLB_VgrpF_4xm,
     },
     {
             nbnxm_kernel_ElecQSTab_VdwLJCombGeom_VgrpF_4xm,
@@ -244,6 +270,7 @@ static p_nbk_func_ener nbnxm_kernel_energrp_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTab_VdwLJFSw_VgrpF_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJPSw_VgrpF_4xm,
             nbnxm_kernel_ElecQSTab_VdwLJEwCombGeom_VgrpF_4xm,
+            nbnxm_kernel_ElecQSTab_VdwLJEwCombLB_VgrpF_4xm,
     },
     {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJCombGeom_VgrpF_4xm,
@@ -252,6 +279,7 @@ static p_nbk_func_ener nbnxm_kernel_energrp_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJFSw_VgrpF_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJPSw_VgrpF_4xm,
             nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombGeom_VgrpF_4xm,
+            nbnxm_kernel_ElecQSTabTwinCut_VdwLJEwCombLB_VgrpF_4xm,
     },
     {
             nbnxm_kernel_ElecEw_VdwLJCombGeom_VgrpF_4xm,
@@ -260,6 +288,7 @@ static p_nbk_func_ener nbnxm_kernel_energrp_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEw_VdwLJFSw_VgrpF_4xm,
             nbnxm_kernel_ElecEw_VdwLJPSw_VgrpF_4xm,
             nbnxm_kernel_ElecEw_VdwLJEwCombGeom_VgrpF_4xm,
+            nbnxm_kernel_ElecEw_VdwLJEwCombLB_VgrpF_4xm,
     },
     {
             nbnxm_kernel_ElecEwTwinCut_VdwLJCombGeom_VgrpF_4xm,
@@ -268,6 +297,7 @@ static p_nbk_func_ener nbnxm_kernel_energrp_simd_4xm[coulktNR][vdwktNR] = {
             nbnxm_kernel_ElecEwTwinCut_VdwLJFSw_VgrpF_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJPSw_VgrpF_4xm,
             nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombGeom_VgrpF_4xm,
+            nbnxm_kernel_ElecEwTwinCut_VdwLJEwCombLB_VgrpF_4xm,
     },
 };
 
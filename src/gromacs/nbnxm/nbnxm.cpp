@@ -197,6 +197,24 @@ void nonbonded_verlet_t::atomdata_add_nbat_f_to_f(const gmx::AtomLocality  local
     wallcycle_stop(wcycle_, ewcNB_XF_BUF_OPS);
 }
 
+void nonbonded_verlet_t::atomdata_add_nbat_f_to_f_deferring_local(gmx::ArrayRef<gmx::RVec> force)
+{
+    GMX_ASSERT(pairlistIsSimple(), "Deferring the local force reduction requires CPU pairlists");
+
+    wallcycle_start(wcycle_, ewcNB_XF_BUF_OPS);
+    wallcycle_sub_start(wcycle_, ewcsNB_F_BUF_OPS);
+
+    reduceForcesDeferringLocal(nbat.get(), pairSearch_->gridSet(), as_rvec_array(force.data()));
+
+    wallcycle_sub_stop(wcycle_, ewcsNB_F_BUF_OPS);
+    wallcycle_stop(wcycle_, ewcNB_XF_BUF_OPS);
+}
+
+NbnxmLocalForceReader nonbonded_verlet_t::localForceReader() const
+{
+    return NbnxmLocalForceReader(*nbat, pairSearch_->gridSet().cells());
+}
+
 int nonbonded_verlet_t::getNumAtoms(const gmx::AtomLocality locality)
 {
     int numAtoms = 0;
@@ -235,6 +253,11 @@ void nonbonded_verlet_t::changePairlistRadii(real rlistOuter, real rlistInner)
     pairlistSets_->changePairlistRadii(rlistOuter, rlistInner);
 }
 
+void nonbonded_verlet_t::changePairlistParams(const PairlistParams& pairlistParams)
+{
+    pairlistSets_->changePairlistParams(pairlistParams);
+}
+
 void nonbonded_verlet_t::setupGpuShortRangeWork(const gmx::GpuBonded*          gpuBonded,
                                                 const gmx::InteractionLocality iLocality)
 {
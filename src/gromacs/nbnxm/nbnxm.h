@@ -129,8 +129,10 @@ struct NbnxmGpu;
 struct gmx_wallcycle;
 struct interaction_const_t;
 struct nbnxn_atomdata_t;
+class NbnxmLocalForceReader;
 struct nonbonded_verlet_t;
 class PairSearch;
+struct PairlistParams;
 class PairlistSets;
 struct t_commrec;
 struct t_lambda;
@@ -389,6 +391,18 @@ public:
      */
     void atomdata_add_nbat_f_to_f(gmx::AtomLocality locality, gmx::ArrayRef<gmx::RVec> force);
 
+    /*! \brief Add the non-local forces stored in nbat to f, the local forces are kept in nbat
+     *
+     * The local forces can be accessed using localForceReader(), which allows
+     * for fusing their reduction with the update.
+     *
+     * \param [inout] force         Force to be added to
+     */
+    void atomdata_add_nbat_f_to_f_deferring_local(gmx::ArrayRef<gmx::RVec> force);
+
+    //! Returns a reader for the local forces left in nbat by the deferring reduction above
+    NbnxmLocalForceReader localForceReader() const;
+
     /*! \brief Get the number of atoms for a given locality
      *
      * \param [in] locality   Local or non-local
@@ -414,6 +428,9 @@ public:
     //! Changes the pair-list outer and inner radius
     void changePairlistRadii(real rlistOuter, real rlistInner);
 
+    //! Changes the pair-list radii, pruning setup and lifetime, should be called at search steps
+    void changePairlistParams(const PairlistParams& pairlistParams);
+
     //! Set up internal flags that indicate what type of short-range work there is.
     void setupGpuShortRangeWork(const gmx::GpuBonded* gpuBonded, gmx::InteractionLocality iLocality);
 
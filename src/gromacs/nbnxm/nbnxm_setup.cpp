@@ -78,29 +78,6 @@ enum class NonbondedResource : int
     EmulateGpu
 };
 
-/*! \brief Returns whether CPU SIMD support exists for the given inputrec
- *
- * If the return value is FALSE and fplog/cr != NULL, prints a fallback
- * message to fplog/stderr.
- */
-static gmx_bool nbnxn_simd_supported(const gmx::MDLogger& mdlog, const t_inputrec* ir)
-{
-    if (ir->vdwtype == evdwPME && ir->ljpme_combination_rule == eljpmeLB)
-    {
-        /* LJ PME with LB combination rule does 7 mesh operations.
-         * This so slow that we don't compile SIMD non-bonded kernels
-         * for that. */
-        GMX_LOG(mdlog.warning)
-                .asParagraph()
-                .appendText(
-                        "LJ-PME with Lorentz-Berthelot is not supported with SIMD kernels, falling "
-                        "back to plain C kernels");
-        return FALSE;
-    }
-
-    return TRUE;
-}
-
 /*! \brief Returns the most suitable CPU kernel type and Ewald handling */
 static KernelSetup pick_nbnxn_kernel_cpu(const t_inputrec gmx_unused* ir,
                                          const gmx_hw_info_t gmx_unused& hardwareInfo)
@@ -256,7 +233,7 @@ static KernelSetup pick_nbnxn_kernel(const gmx::MDLogger&     mdlog,
     }
     else
     {
-        if (use_simd_kernels && nbnxn_simd_supported(mdlog, ir))
+        if (use_simd_kernels)
         {
             kernelSetup = pick_nbnxn_kernel_cpu(ir, hardwareInfo);
         }
@@ -2731,6 +2731,28 @@ static void combine_nblists(gmx::ArrayRef<const NbnxnPairlistGpu> nbls, NbnxnPai
     }
 }
 
+/*! \brief Returns an estimate of the cost of computing FEP i-entry with \p numPairs j-entries
+ *
+ * The cost is expressed in units of the cost of one (SIMD padded) pair.
+ * The free-energy kernel processes the j-entries in chunks of the SIMD width
+ * and spends time on i-particle setup and reductions, which makes that
+ * short i-entries are relatively more expensive than long ones.
+ */
+static inline int fepListEntryCost(int numPairs)
+{
+#if GMX_SIMD_HAVE_REAL
+    constexpr int c_pairChunkSize = GMX_SIMD_REAL_WIDTH;
+#else
+    constexpr int c_pairChunkSize = 1;
+#endif
+    /* The cost of the i-particle setup and reduction, in units of pairs */
+    constexpr int c_outerCostInPairs = 8;
+
+    const int numPaddedPairs = ((numPairs + c_pairChunkSize - 1) / c_pairChunkSize) * c_pairChunkSize;
+
+    return c_outerCostInPairs + numPaddedPairs;
+}
+
 static void balance_fep_lists(gmx::ArrayRef<std::unique_ptr<t_nblist>> fepLists,
                               gmx::ArrayRef<PairsearchWork>            work)
 {
@@ -2742,17 +2764,20 @@ static void balance_fep_lists(gmx::ArrayRef<std::unique_ptr<t_nblist>> fepLists,
         return;
     }
 
-    /* Count the total i-lists and pairs */
-    int nri_tot = 0;
-    int nrj_tot = 0;
+    /* Count the total i-lists, pairs and estimated cost */
+    int     nri_tot  = 0;
+    int     nrj_tot  = 0;
+    int64_t cost_tot = 0;
     for (const auto& list : fepLists)
     {
         nri_tot += list->nri;
         nrj_tot += list->nrj;
+        for (int i = 0; i < list->nri; i++)
+        {
+            cost_tot += fepListEntryCost(list->jindex[i + 1] - list->jindex[i]);
+        }
     }
 
-    const int nrj_target = (nrj_tot + numLists - 1) / numLists;
-
     GMX_ASSERT(gmx_omp_nthreads_get(emntNonbonded) == numLists,
                "We should have as many work objects as FEP lists");
 
@@ -2783,29 +2808,38 @@ static void balance_fep_lists(gmx::ArrayRef<std::unique_ptr<t_nblist>> fepLists,
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
 
-    /* Loop over the source lists and assign and copy i-entries */
-    int       th_dest = 0;
-    t_nblist* nbld    = work[th_dest].nbl_fep.get();
+    /* Loop over the source lists and assign and copy i-entries.
+     * We balance on the estimated cumulative cost, so the assignment of
+     * an entry depends only on the total cost of all preceding entries.
+     * This avoids that imbalances accumulate towards the last list.
+     */
+    int       th_dest   = 0;
+    t_nblist* nbld      = work[th_dest].nbl_fep.get();
+    int64_t   cost_done = 0;
     for (int th = 0; th < numLists; th++)
     {
         const t_nblist* nbls = fepLists[th].get();
 
         for (int i = 0; i < nbls->nri; i++)
         {
-            int nrj;
-
             /* The number of pairs in this i-entry */
-            nrj = nbls->jindex[i + 1] - nbls->jindex[i];
+            const int nrj = nbls->jindex[i + 1] - nbls->jindex[i];
+
+            const int64_t cost = fepListEntryCost(nrj);
 
             /* Decide if list th_dest is too large and we should procede
-             * to the next destination list.
+             * to the next destination list. We move on when the entry
+             * would end closer to the cost target of the next list
+             * than to the cost target of the current list.
              */
-            if (th_dest + 1 < numLists && nbld->nrj > 0
-                && nbld->nrj + nrj - nrj_target > nrj_target - nbld->nrj)
+            const int64_t cost_target = ((th_dest + 1) * cost_tot) / numLists;
+            if (th_dest + 1 < numLists && nbld->nri > 0
+                && cost_done + cost - cost_target > cost_target - cost_done)
             {
                 th_dest++;
                 nbld = work[th_dest].nbl_fep.get();
             }
+            cost_done += cost;
 
             nbld->iinr[nbld->nri]  = nbls->iinr[i];
             nbld->gid[nbld->nri]   = nbls->gid[i];
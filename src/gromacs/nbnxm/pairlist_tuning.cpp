@@ -50,18 +50,26 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <limits>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "gromacs/domdec/domdec.h"
+#include "gromacs/gmxlib/network.h"
 #include "gromacs/hardware/cpuinfo.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/calc_verletbuf.h"
+#include "gromacs/mdlib/forcerec.h"
 #include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/forcerec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/interaction_const.h"
 #include "gromacs/mdtypes/multipletimestepping.h"
 #include "gromacs/mdtypes/state.h"
+#include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/timing/wallcycle.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
@@ -394,6 +402,7 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
 /*! \brief Set the dynamic pairlist pruning parameters in \p ic
  *
  * \param[in]     ir          The input parameter record
+ * \param[in]     nstlist     The pair-list update interval
  * \param[in]     mtop        The global topology
  * \param[in]     box         The unit cell
  * \param[in]     useGpuList  Tells if we are using a GPU type pairlist
@@ -403,6 +412,7 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
  * \param[in,out] listParams  The list setup parameters
  */
 static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
+                                                const int                  nstlist,
                                                 const gmx_mtop_t*          mtop,
                                                 const matrix               box,
                                                 const bool                 useGpuList,
@@ -419,9 +429,9 @@ static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
 
     const int mtsFactor = listParams->mtsFactor;
 
-    GMX_RELEASE_ASSERT(ir->nstlist % mtsFactor == 0, "nstlist should be a multiple of mtsFactor");
+    GMX_RELEASE_ASSERT(nstlist % mtsFactor == 0, "nstlist should be a multiple of mtsFactor");
 
-    listParams->lifetime = ir->nstlist - mtsFactor;
+    listParams->lifetime = nstlist - mtsFactor;
 
     /* When nstlistPrune was set by the user, we need to execute one loop
      * iteration to determine rlistInner.
@@ -446,7 +456,7 @@ static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
          * so keep nstlistPrune a multiple of the interval.
          */
         tunedNstlistPrune += (useGpuList ? c_nbnxnGpuRollingListPruningInterval : 1) * mtsFactor;
-    } while (!userSetNstlistPrune && tunedNstlistPrune < ir->nstlist
+    } while (!userSetNstlistPrune && tunedNstlistPrune < nstlist
              && listParams->rlistInner == interactionCutoff);
 
     if (userSetNstlistPrune)
@@ -562,7 +572,7 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
         }
 
         setDynamicPairlistPruningParameters(
-                ir, mtop, box, useGpuList, ls, userSetNstlistPrune, ic, listParams);
+                ir, ir->nstlist, mtop, box, useGpuList, ls, userSetNstlistPrune, ic, listParams);
 
         if (listParams->useDynamicPruning && useGpuList)
         {
@@ -633,3 +643,442 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
 
     GMX_LOG(mdlog.info).asParagraph().appendText(mesg);
 }
+
+//! The number of search intervals to skip at the start of the run, while the performance stabilizes
+static const int c_numFirstTuningIntervalSkip = 5;
+//! The minimum number of steps to time each pair-list setup over
+static const int c_minNumStepsPerTiming = 200;
+//! Stop scanning longer intervals when a setup is more than this factor slower than the fastest
+static const double c_maxRelativeSlowdownAccepted = 1.1;
+//! The nstlist values to try
+static const int c_nstlistTune[] = { 10, 20, 25, 40, 50, 80, 100 };
+//! The pruning intervals to try, only values below the pair-list lifetime are used
+static const int c_nstlistPruneTune[] = { 4, 5, 6, 8, 10, 12, 15, 20, 25, 30, 40, 50, 60, 80 };
+
+namespace
+{
+
+//! Returns a string describing \p setup
+std::string formatTuningSetup(const PairlistTuningSetup& setup)
+{
+    std::string text =
+            gmx::formatString("nstlist %3d, rlist %.3f nm", setup.nstlist, setup.params.rlistOuter);
+    if (setup.params.useDynamicPruning)
+    {
+        text += gmx::formatString(", pruning every %2d steps, rlist %.3f nm",
+                                  setup.params.nstlistPrune,
+                                  setup.params.rlistInner);
+    }
+    else
+    {
+        text += ", no dynamic pruning";
+    }
+
+    return text;
+}
+
+} // namespace
+
+PairlistTuningScan::PairlistTuningScan(std::vector<PairlistTuningSetup> setups, const int nstlist) :
+    setups_(std::move(setups))
+{
+    std::sort(setups_.begin(), setups_.end(), [](const auto& a, const auto& b) {
+        return a.scanValue < b.scanValue;
+    });
+    current_ = std::find_if(setups_.begin(), setups_.end(), [nstlist](const auto& setup) {
+                   return setup.nstlist == nstlist;
+               })
+               - setups_.begin();
+    GMX_RELEASE_ASSERT(current_ < gmx::ssize(setups_), "The setup in use should be present");
+}
+
+bool PairlistTuningScan::addTiming(const int numSteps, const double cycles)
+{
+    PairlistTuningSetup& setup = setups_[current_];
+    setup.numSteps += numSteps;
+    setup.cycles += cycles;
+    if (setup.numSteps < std::max(c_minNumStepsPerTiming, 2 * setup.nstlist))
+    {
+        return false;
+    }
+
+    if (fastest_ < 0 || setup.cyclesPerStep() < setups_[fastest_].cyclesPerStep())
+    {
+        fastest_ = current_;
+    }
+
+    return true;
+}
+
+int PairlistTuningScan::nextSetup() const
+{
+    const PairlistTuningSetup& setup   = setups_[current_];
+    const PairlistTuningSetup& fastest = setups_[fastest_];
+
+    /* The cost is expected to increase monotonically beyond the optimum,
+     * so we stop when a longer interval is much slower than the fastest.
+     */
+    if (setup.scanValue > fastest.scanValue
+        && setup.cyclesPerStep() > c_maxRelativeSlowdownAccepted * fastest.cyclesPerStep())
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < gmx::ssize(setups_); i++)
+    {
+        if (setups_[i].isAvailable && setups_[i].numSteps == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+void PairlistTuningScan::startPruningStage(const PruningSetupMaker& makeSetup)
+{
+    const PairlistTuningSetup fastest = setups_[fastest_];
+
+    /* Dynamic pruning is done after the update, which makes
+     * nstlistPrune=nstlist-1 useless, see setDynamicPairlistPruningParameters()
+     */
+    const int lifetime = fastest.nstlist - 1;
+
+    setups_.clear();
+    setups_.push_back(fastest);
+    for (int nstlistPrune : c_nstlistPruneTune)
+    {
+        if (nstlistPrune < lifetime
+            && !(fastest.params.useDynamicPruning && nstlistPrune == fastest.params.nstlistPrune))
+        {
+            setups_.push_back(makeSetup(nstlistPrune));
+        }
+    }
+    if (fastest.params.useDynamicPruning)
+    {
+        setups_.push_back(makeSetup(-1));
+    }
+    for (auto& setup : setups_)
+    {
+        setup.scanValue = (setup.params.useDynamicPruning ? setup.params.nstlistPrune
+                                                          : std::numeric_limits<int>::max());
+    }
+    std::sort(setups_.begin(), setups_.end(), [](const auto& a, const auto& b) {
+        return a.scanValue < b.scanValue;
+    });
+    fastest_ = std::find_if(setups_.begin(), setups_.end(), [](const auto& setup) {
+                   return setup.numSteps > 0;
+               })
+               - setups_.begin();
+    current_ = fastest_;
+    stage_   = PairlistTuningStage::Pruning;
+}
+
+//! Implementation of PairlistTuner
+class PairlistTuner::Impl
+{
+public:
+    //! Constructor
+    Impl(const gmx::MDLogger& mdlog,
+         const t_commrec*     cr,
+         const t_inputrec&    ir,
+         const gmx_mtop_t&    mtop,
+         const matrix         box,
+         const t_forcerec&    fr);
+
+    /*! \brief Returns a setup with the buffers set for \p nstlist and \p nstlistPrune
+     *
+     * With \p nstlistPrune=0 the default pruning setup is used,
+     * with \p nstlistPrune<0 dynamic pruning is not used.
+     */
+    PairlistTuningSetup makeSetup(const t_inputrec&          ir,
+                                  const interaction_const_t& ic,
+                                  const matrix               box,
+                                  int                        nstlist,
+                                  int                        nstlistPrune) const;
+
+    //! Tries to switch to setup \p index, returns false when the box or DD does not allow it
+    bool switchSetup(t_commrec*                     cr,
+                     t_inputrec*                    ir,
+                     t_forcerec*                    fr,
+                     const matrix                   box,
+                     gmx::ArrayRef<const gmx::RVec> x,
+                     int                            index);
+
+    //! Whether we are tuning
+    bool isActive_ = false;
+    //! The global topology
+    const gmx_mtop_t& mtop_;
+    //! The initial pair-list parameters, the fixed parameters are taken from these
+    const PairlistParams initialParams_;
+    //! The list setup for the outer list buffer, same as used at setup for DD
+    VerletbufListSetup outerListSetup_;
+    //! The list setup for the inner list buffer
+    VerletbufListSetup innerListSetup_;
+    //! Whether we can use dynamic pruning
+    bool allowDynamicPruning_;
+    //! The scan over the setups, only present when tuning is supported
+    std::optional<PairlistTuningScan> scan_;
+    //! The number of intervals skipped at the start of the run
+    int numFirstIntervalsSkipped_ = 0;
+    //! Whether to skip the timing of the next interval, set after switching
+    bool skipNextInterval_ = false;
+    //! Step count of the step cycle counter at the previous call
+    int numStepsPrev_ = 0;
+    //! Cycle count of the step cycle counter at the previous call
+    double cyclesPrev_ = 0;
+};
+
+PairlistTuner::Impl::Impl(const gmx::MDLogger& mdlog,
+                          const t_commrec*     cr,
+                          const t_inputrec&    ir,
+                          const gmx_mtop_t&    mtop,
+                          const matrix         box,
+                          const t_forcerec&    fr) :
+    mtop_(mtop),
+    initialParams_(fr.nbv->pairlistSets().params()),
+    allowDynamicPruning_(getenv("GMX_DISABLE_DYNAMICPRUNING") == nullptr)
+{
+    const PairlistParams& params = initialParams_;
+
+    const char* reason = nullptr;
+    if (!wallcycle_have_counter())
+    {
+        reason = "no cycle counter is available";
+    }
+    else if (!fr.nbv->pairlistIsSimple())
+    {
+        reason = "only CPU pair-lists are supported";
+    }
+    else if (params.mtsFactor != 1)
+    {
+        reason = "multiple time stepping is used for the non-bonded interactions";
+    }
+    else if (!supportsDynamicPairlistGenerationInterval(ir) || ir.nstlist <= 1)
+    {
+        reason = "the pair-list buffer can not be changed with this setup";
+    }
+    else if (getenv("GMX_NSTLIST_DYNAMICPRUNING") != nullptr)
+    {
+        reason = "the pruning interval was set by the user";
+    }
+    else if (DOMAINDECOMP(cr) && inputrec2nboundeddim(&ir) < DIM)
+    {
+        reason = "domain decomposition with unbounded dimensions is used";
+    }
+    if (reason != nullptr)
+    {
+        GMX_LOG(mdlog.warning)
+                .asParagraph()
+                .appendTextFormatted(
+                        "NOTE: Pair-list tuning was requested, but is not supported as %s", reason);
+
+        return;
+    }
+
+    outerListSetup_ = verletbufGetSafeListSetup(ListSetupType::CpuSimdWhenSupported);
+    innerListSetup_ = { IClusterSizePerListType[params.pairlistType],
+                        JClusterSizePerListType[params.pairlistType] };
+
+    /* Scan nstlist starting from the current setup, which is timed first */
+    std::vector<PairlistTuningSetup> setups;
+    PairlistTuningSetup              initialSetup = { ir.nstlist, params };
+    initialSetup.scanValue                        = ir.nstlist;
+    setups.push_back(initialSetup);
+    for (int nstlist : c_nstlistTune)
+    {
+        if (nstlist == ir.nstlist)
+        {
+            continue;
+        }
+        PairlistTuningSetup setup =
+                makeSetup(ir, *fr.ic, box, nstlist, allowDynamicPruning_ ? 0 : -1);
+        setup.scanValue           = nstlist;
+        if (ir.pbcType == PbcType::No
+            || gmx::square(setup.params.rlistOuter) < max_cutoff2(ir.pbcType, box))
+        {
+            setups.push_back(setup);
+        }
+    }
+    scan_.emplace(std::move(setups), ir.nstlist);
+
+    isActive_ = true;
+
+    GMX_LOG(mdlog.info)
+            .asParagraph()
+            .appendTextFormatted(
+                    "Will tune the pair-list setup at runtime, starting with %s",
+                    formatTuningSetup(scan_->setups()[scan_->current()]).c_str());
+}
+
+PairlistTuningSetup PairlistTuner::Impl::makeSetup(const t_inputrec&          ir,
+                                                   const interaction_const_t& ic,
+                                                   const matrix               box,
+                                                   const int                  nstlist,
+                                                   const int                  nstlistPrune) const
+{
+    PairlistTuningSetup setup = { nstlist, initialParams_ };
+    PairlistParams&     params = setup.params;
+
+    params.rlistOuter =
+            calcVerletBufferSize(mtop_, det(box), ir, nstlist, nstlist - 1, -1, outerListSetup_);
+    if (nstlistPrune >= 0)
+    {
+        const bool setNstlistPrune = (nstlistPrune > 0);
+        params.nstlistPrune =
+                (setNstlistPrune ? nstlistPrune : c_nbnxnDynamicListPruningMinLifetime);
+        setDynamicPairlistPruningParameters(
+                &ir, nstlist, &mtop_, box, false, innerListSetup_, setNstlistPrune, &ic, &params);
+    }
+    else
+    {
+        params.useDynamicPruning = false;
+        params.nstlistPrune      = -1;
+        params.rlistInner        = params.rlistOuter;
+        params.lifetime          = nstlist - 1;
+    }
+
+    return setup;
+}
+
+bool PairlistTuner::Impl::switchSetup(t_commrec*                     cr,
+                                      t_inputrec*                    ir,
+                                      t_forcerec*                    fr,
+                                      const matrix                   box,
+                                      gmx::ArrayRef<const gmx::RVec> x,
+                                      const int                      index)
+{
+    const PairlistTuningSetup& setup = scan_->setups()[index];
+
+    /* The box might have changed since the setup was generated */
+    if (ir->pbcType != PbcType::No
+        && gmx::square(setup.params.rlistOuter) >= max_cutoff2(ir->pbcType, box))
+    {
+        return false;
+    }
+    if (DOMAINDECOMP(cr) && !change_dd_cutoff(cr, box, x, setup.params.rlistOuter))
+    {
+        return false;
+    }
+
+    ir->nstlist = setup.nstlist;
+    fr->nbv->changePairlistParams(setup.params);
+    /* Update deprecated rlist in forcerec to stay in sync with fr->nbv */
+    fr->rlist = setup.params.rlistOuter;
+    /* The Ewald tables should cover the pair-list cut-off */
+    init_interaction_const_tables(nullptr, fr->ic, setup.params.rlistOuter, ir->tabext);
+
+    scan_->setCurrent(index);
+    skipNextInterval_ = true;
+
+    return true;
+}
+
+PairlistTuner::PairlistTuner(const gmx::MDLogger& mdlog,
+                             const t_commrec*     cr,
+                             const t_inputrec&    ir,
+                             const gmx_mtop_t&    mtop,
+                             const matrix         box,
+                             const t_forcerec&    fr) :
+    impl_(new Impl(mdlog, cr, ir, mtop, box, fr))
+{
+}
+
+PairlistTuner::~PairlistTuner() = default;
+
+bool PairlistTuner::isActive() const
+{
+    return impl_->isActive_;
+}
+
+void PairlistTuner::tune(const gmx::MDLogger&           mdlog,
+                         t_commrec*                     cr,
+                         t_inputrec*                    ir,
+                         t_forcerec*                    fr,
+                         const matrix                   box,
+                         gmx::ArrayRef<const gmx::RVec> x,
+                         gmx_wallcycle*                 wcycle,
+                         const int64_t                  step)
+{
+    Impl& impl = *impl_;
+
+    if (!impl.isActive_)
+    {
+        return;
+    }
+
+    int    numSteps;
+    double cycles;
+    wallcycle_get(wcycle, ewcSTEP, &numSteps, &cycles);
+    const int numStepsInterval = numSteps - impl.numStepsPrev_;
+    double    cyclesInterval   = cycles - impl.cyclesPrev_;
+    impl.numStepsPrev_         = numSteps;
+    impl.cyclesPrev_           = cycles;
+
+    /* Skip the first intervals while the performance stabilizes
+     * and intervals during which the cycle counters were reset.
+     * After a switch the first interval is usually slower due to
+     * allocation and caching effects, so we skip that as well.
+     */
+    if (impl.numFirstIntervalsSkipped_ < c_numFirstTuningIntervalSkip || numStepsInterval <= 0)
+    {
+        impl.numFirstIntervalsSkipped_++;
+        return;
+    }
+    if (impl.skipNextInterval_)
+    {
+        impl.skipNextInterval_ = false;
+        return;
+    }
+
+    if (PAR(cr))
+    {
+        /* The sum is over the PP ranks only */
+        gmx_sumd(1, &cyclesInterval, cr);
+        cyclesInterval /= cr->nnodes - cr->npmenodes;
+    }
+
+    PairlistTuningScan& scan = *impl.scan_;
+    if (!scan.addTiming(numStepsInterval, cyclesInterval))
+    {
+        return;
+    }
+
+    char sbuf[STEPSTRSIZE];
+    GMX_LOG(mdlog.info)
+            .appendTextFormatted("step %s: timed pair-list setup %s: %.1f M-cycles",
+                                 gmx_step_str(step, sbuf),
+                                 formatTuningSetup(scan.setups()[scan.current()]).c_str(),
+                                 scan.setups()[scan.current()].cyclesPerStep() * 1e-6);
+
+    int next = scan.nextSetup();
+    if (next < 0 && scan.stage() == PairlistTuningStage::Nstlist && impl.allowDynamicPruning_)
+    {
+        const int nstlist = scan.setups()[scan.fastest()].nstlist;
+        scan.startPruningStage([&impl, ir, fr, box, nstlist](int nstlistPrune) {
+            return impl.makeSetup(*ir, *fr->ic, box, nstlist, nstlistPrune);
+        });
+        next = scan.nextSetup();
+    }
+    while (next >= 0 && !impl.switchSetup(cr, ir, fr, box, x, next))
+    {
+        scan.setUnavailable(next);
+        next = scan.nextSetup();
+    }
+    if (next >= 0)
+    {
+        return;
+    }
+
+    /* We are done, continue with the fastest setup, when still possible */
+    if (scan.current() != scan.fastest())
+    {
+        impl.switchSetup(cr, ir, fr, box, x, scan.fastest());
+    }
+    impl.isActive_ = false;
+
+    GMX_LOG(mdlog.info)
+            .asParagraph()
+            .appendTextFormatted("Finished pair-list tuning, using %s",
+                                 formatTuningSetup(scan.setups()[scan.current()]).c_str());
+}
@@ -48,7 +48,15 @@
 
 #include <stdio.h>
 
+#include <cstdint>
+
+#include <functional>
+#include <vector>
+
 #include "gromacs/math/vectypes.h"
+#include "gromacs/nbnxm/pairlistparams.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
 
 namespace gmx
 {
@@ -57,9 +65,10 @@ class MDLogger;
 } // namespace gmx
 
 struct gmx_mtop_t;
+struct gmx_wallcycle;
 struct interaction_const_t;
-struct PairlistParams;
 struct t_commrec;
+struct t_forcerec;
 struct t_inputrec;
 
 /*! \brief Try to increase nstlist when using the Verlet cut-off scheme
@@ -98,4 +107,153 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
                                  const interaction_const_t* ic,
                                  PairlistParams*            listParams);
 
+//! A pair-list setup along with its timing
+struct PairlistTuningSetup
+{
+    //! The pair-list update interval
+    int nstlist;
+    //! The pair-list parameters
+    PairlistParams params;
+    //! The value scanned over, nstlist or nstlistPrune, no pruning sorts last
+    int scanValue = 0;
+    //! Whether this setup could be used, can be false due to box or DD limitations
+    bool isAvailable = true;
+    //! The number of steps timed
+    int numSteps = 0;
+    //! The number of cycles spent in the timed steps, averaged over ranks
+    double cycles = 0;
+
+    //! Returns the average number of cycles per step
+    double cyclesPerStep() const { return cycles / numSteps; }
+};
+
+//! The pair-list tuning stages
+enum class PairlistTuningStage
+{
+    Nstlist, //!< Scanning nstlist with the default pruning interval
+    Pruning  //!< Scanning the pruning interval at the fastest nstlist
+};
+
+/*! \libinternal
+ * \brief The scan over pair-list setups performed by PairlistTuner
+ *
+ * Keeps track of the timings and decides which setup to time next.
+ * This does not depend on the simulation, so it can be tested with
+ * given cycle counts.
+ */
+class PairlistTuningScan
+{
+public:
+    //! Returns the setup at the fastest nstlist with \p nstlistPrune, -1 for no pruning
+    using PruningSetupMaker = std::function<PairlistTuningSetup(int nstlistPrune)>;
+
+    /*! \brief Constructor
+     *
+     * \param[in] setups   The setups to scan, will be sorted on scanValue
+     * \param[in] nstlist  The nstlist of the setup in use, which is timed first
+     */
+    PairlistTuningScan(std::vector<PairlistTuningSetup> setups, int nstlist);
+
+    /*! \brief Adds \p numSteps steps taking \p cycles cycles to the timing of the current setup
+     *
+     * Returns whether the current setup has now been timed over enough steps.
+     * The fastest setup is updated when this is the case.
+     */
+    bool addTiming(int numSteps, double cycles);
+
+    //! Returns the index of the next setup to time in the current stage, -1 when done
+    int nextSetup() const;
+
+    //! Sets up the pruning interval scan for the fastest nstlist
+    void startPruningStage(const PruningSetupMaker& makeSetup);
+
+    //! Sets the setup in use to \p index
+    void setCurrent(int index) { current_ = index; }
+
+    //! Marks setup \p index as not usable
+    void setUnavailable(int index) { setups_[index].isAvailable = false; }
+
+    //! Returns the setups for the current stage
+    gmx::ArrayRef<const PairlistTuningSetup> setups() const { return setups_; }
+
+    //! Returns the index of the setup in use
+    int current() const { return current_; }
+
+    //! Returns the index of the fastest setup, -1 when none has been timed
+    int fastest() const { return fastest_; }
+
+    //! Returns the current stage
+    PairlistTuningStage stage() const { return stage_; }
+
+private:
+    //! The current tuning stage
+    PairlistTuningStage stage_ = PairlistTuningStage::Nstlist;
+    //! The setups for the current stage, sorted on scanValue
+    std::vector<PairlistTuningSetup> setups_;
+    //! Index of the setup in use
+    int current_ = -1;
+    //! Index of the fastest setup, -1 when none has been timed
+    int fastest_ = -1;
+};
+
+/*! \libinternal
+ * \brief Tunes the pair-list update and pruning intervals at runtime
+ *
+ * increaseNstlist() and setupDynamicPairlistPruning() choose nstlist
+ * and nstlistPrune at startup using a cost model, which can be off
+ * by quite a bit on particular hardware. This tuner times the MD steps
+ * with different setups and continues with the fastest one. First
+ * nstlist is scanned, using the default pruning interval for each nstlist
+ * value, then the pruning interval is scanned at the fastest nstlist.
+ * All pair-list buffers are determined with calcVerletBufferSize(),
+ * so the verlet-buffer-tolerance is obeyed for all setups.
+ *
+ * Only CPU pair-lists without multiple time stepping are supported.
+ * The timings are averaged over all ranks, so all ranks change setup
+ * at the same steps.
+ */
+class PairlistTuner
+{
+public:
+    /*! \brief Constructor, the tuner is inactive when the setup is not supported
+     *
+     * \param[in] mdlog  MD logger
+     * \param[in] cr     The communication record
+     * \param[in] ir     The input parameter record
+     * \param[in] mtop   The global topology, should outlive the tuner
+     * \param[in] box    The unit cell
+     * \param[in] fr     The force record, with the initial pair-list setup
+     */
+    PairlistTuner(const gmx::MDLogger& mdlog,
+                  const t_commrec*     cr,
+                  const t_inputrec&    ir,
+                  const gmx_mtop_t&    mtop,
+                  const matrix         box,
+                  const t_forcerec&    fr);
+    ~PairlistTuner();
+
+    //! Returns whether we are still tuning
+    bool isActive() const;
+
+    /*! \brief Process the cycles of the last steps and switch setup when needed
+     *
+     * Should be called at every search step, before the ewcSTEP cycle
+     * counter is started. When switching setup, ir->nstlist, fr->rlist
+     * and the pair-list setup in fr->nbv are changed.
+     */
+    void tune(const gmx::MDLogger&           mdlog,
+              t_commrec*                     cr,
+              t_inputrec*                    ir,
+              t_forcerec*                    fr,
+              const matrix                   box,
+              gmx::ArrayRef<const gmx::RVec> x,
+              gmx_wallcycle*                 wcycle,
+              int64_t                        step);
+
+private:
+    class Impl;
+
+    gmx::PrivateImplPointer<Impl> impl_;
+};
+
 #endif /* NBNXM_PAIRLIST_TUNING_H */
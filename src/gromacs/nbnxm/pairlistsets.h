@@ -120,6 +120,20 @@ public:
         params_.rlistInner = rlistInner;
     }
 
+    /*! \brief Changes the pair-list radii, pruning setup and lifetime
+     *
+     * Should only be called before constructing new lists, as the lists
+     * in use have been prepared for the old pruning setup.
+     */
+    void changePairlistParams(const PairlistParams& pairlistParams)
+    {
+        GMX_ASSERT(pairlistParams.pairlistType == params_.pairlistType
+                           && pairlistParams.haveFep == params_.haveFep
+                           && pairlistParams.mtsFactor == params_.mtsFactor,
+                   "Only the radii, pruning and lifetime parameters can change");
+        params_ = pairlistParams;
+    }
+
     //! Returns the pair-list set for the given locality
     const PairlistSet& pairlistSet(gmx::InteractionLocality iLocality) const
     {
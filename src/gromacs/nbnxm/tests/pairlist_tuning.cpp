@@ -0,0 +1,220 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the scan over pair-list setups of the pair-list tuner.
+ *
+ * The cycle counts are given by the tests, so the decisions of the scan
+ * can be checked exactly.
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "gromacs/nbnxm/pairlist_tuning.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/pairlistparams.h"
+
+namespace
+{
+
+//! The number of steps over which each setup is timed in the tests
+const int c_numStepsPerTiming = 200;
+
+//! Returns a setup for \p nstlist with pruning interval \p nstlistPrune, no pruning with -1
+PairlistTuningSetup makeSetup(int nstlist, int nstlistPrune)
+{
+    const PairlistParams params(Nbnxm::KernelType::Cpu4x4_PlainC, false, 1.0, false);
+
+    PairlistTuningSetup setup      = { nstlist, params };
+    setup.params.useDynamicPruning = (nstlistPrune > 0);
+    setup.params.nstlistPrune      = nstlistPrune;
+    setup.scanValue                = nstlist;
+
+    return setup;
+}
+
+//! Returns setups for the nstlist values \p nstlists, all with pruning every 5 steps
+std::vector<PairlistTuningSetup> makeNstlistSetups(const std::vector<int>& nstlists)
+{
+    std::vector<PairlistTuningSetup> setups;
+    for (int nstlist : nstlists)
+    {
+        setups.push_back(makeSetup(nstlist, 5));
+    }
+
+    return setups;
+}
+
+/*! \brief Times the current setup of \p scan at \p cyclesPerStep and switches to the next setup
+ *
+ * \returns the index of the next setup, -1 when the scan is done
+ */
+int timeCurrentSetup(PairlistTuningScan* scan, double cyclesPerStep)
+{
+    EXPECT_TRUE(scan->addTiming(c_numStepsPerTiming, c_numStepsPerTiming * cyclesPerStep));
+
+    const int next = scan->nextSetup();
+    if (next >= 0)
+    {
+        scan->setCurrent(next);
+    }
+
+    return next;
+}
+
+TEST(PairlistTuningScanTest, StartsWithTheSetupInUse)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 40, 10, 25, 20 }), 25);
+
+    ASSERT_EQ(4, scan.setups().ssize());
+    EXPECT_EQ(10, scan.setups()[0].nstlist);
+    EXPECT_EQ(20, scan.setups()[1].nstlist);
+    EXPECT_EQ(25, scan.setups()[2].nstlist);
+    EXPECT_EQ(40, scan.setups()[3].nstlist);
+    EXPECT_EQ(2, scan.current());
+    EXPECT_EQ(-1, scan.fastest());
+    EXPECT_EQ(PairlistTuningStage::Nstlist, scan.stage());
+}
+
+TEST(PairlistTuningScanTest, TimesAtLeastTwoPairlistLifetimes)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 150 }), 150);
+
+    EXPECT_FALSE(scan.addTiming(150, 150 * 100.0));
+    EXPECT_EQ(-1, scan.fastest());
+    EXPECT_TRUE(scan.addTiming(150, 150 * 100.0));
+    EXPECT_EQ(0, scan.fastest());
+    EXPECT_EQ(300, scan.setups()[0].numSteps);
+    EXPECT_DOUBLE_EQ(100.0, scan.setups()[0].cyclesPerStep());
+}
+
+TEST(PairlistTuningScanTest, TimesAllSetupsWhenCostDecreases)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 10, 20, 25, 40 }), 10);
+
+    EXPECT_EQ(1, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(2, timeCurrentSetup(&scan, 90));
+    EXPECT_EQ(3, timeCurrentSetup(&scan, 85));
+    EXPECT_EQ(-1, timeCurrentSetup(&scan, 80));
+    EXPECT_EQ(3, scan.fastest());
+}
+
+TEST(PairlistTuningScanTest, StopsWhenLongerIntervalIsMuchSlower)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 10, 20, 25, 40, 50 }), 10);
+
+    EXPECT_EQ(1, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(2, timeCurrentSetup(&scan, 90));
+    // Less than 10% slower than the fastest, so we continue
+    EXPECT_EQ(3, timeCurrentSetup(&scan, 95));
+    // More than 10% slower than the fastest, so we stop
+    EXPECT_EQ(-1, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(1, scan.fastest());
+    EXPECT_EQ(0, scan.setups()[4].numSteps);
+}
+
+TEST(PairlistTuningScanTest, ScansShorterIntervalsAfterStartingInTheMiddle)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 10, 20, 40 }), 20);
+
+    EXPECT_EQ(0, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(2, timeCurrentSetup(&scan, 110));
+    EXPECT_EQ(-1, timeCurrentSetup(&scan, 105));
+    EXPECT_EQ(1, scan.fastest());
+}
+
+TEST(PairlistTuningScanTest, SkipsUnavailableSetups)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 10, 20, 25 }), 10);
+
+    EXPECT_TRUE(scan.addTiming(c_numStepsPerTiming, c_numStepsPerTiming * 100.0));
+    scan.setUnavailable(1);
+    EXPECT_EQ(2, scan.nextSetup());
+    scan.setUnavailable(2);
+    EXPECT_EQ(-1, scan.nextSetup());
+}
+
+TEST(PairlistTuningScanTest, StartPruningStageScansPruningIntervals)
+{
+    PairlistTuningScan scan(makeNstlistSetups({ 10, 20 }), 10);
+
+    EXPECT_EQ(1, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(-1, timeCurrentSetup(&scan, 90));
+    ASSERT_EQ(1, scan.fastest());
+
+    // Record which setups are requested, these should be at nstlist=20
+    std::vector<int> requestedNstlistPrunes;
+    scan.startPruningStage([&requestedNstlistPrunes](int nstlistPrune) {
+        requestedNstlistPrunes.push_back(nstlistPrune);
+        return makeSetup(20, nstlistPrune);
+    });
+
+    // Intervals below the list lifetime of 19, except 5 which has been timed,
+    // followed by no pruning
+    const std::vector<int> expectedNstlistPrunes = { 4, 6, 8, 10, 12, 15, -1 };
+    EXPECT_EQ(expectedNstlistPrunes, requestedNstlistPrunes);
+
+    EXPECT_EQ(PairlistTuningStage::Pruning, scan.stage());
+    ASSERT_EQ(8, scan.setups().ssize());
+    for (int i = 0; i < scan.setups().ssize(); i++)
+    {
+        EXPECT_EQ(20, scan.setups()[i].nstlist);
+    }
+    // The setups are sorted on pruning interval, no pruning last
+    EXPECT_EQ(5, scan.setups()[1].params.nstlistPrune);
+    EXPECT_FALSE(scan.setups()[7].params.useDynamicPruning);
+    // The timing of the fastest setup is kept
+    EXPECT_EQ(1, scan.fastest());
+    EXPECT_EQ(1, scan.current());
+    EXPECT_DOUBLE_EQ(90.0, scan.setups()[1].cyclesPerStep());
+
+    // The pruning interval is scanned from the shortest interval
+    EXPECT_EQ(0, scan.nextSetup());
+    scan.setCurrent(0);
+    EXPECT_EQ(2, timeCurrentSetup(&scan, 95));
+    EXPECT_EQ(3, timeCurrentSetup(&scan, 80));
+    EXPECT_EQ(4, timeCurrentSetup(&scan, 85));
+    EXPECT_EQ(-1, timeCurrentSetup(&scan, 100));
+    EXPECT_EQ(2, scan.fastest());
+    EXPECT_EQ(6, scan.setups()[2].params.nstlistPrune);
+}
+
+} // namespace
@@ -262,6 +262,15 @@ public:
     /*! \brief The parameter class (mean & stddev) of the normal distribution */
     param_type param() const { return param_; }
 
+    /*! \brief Return the table with values of the standard normal distribution
+     *
+     *  This can be used to sample many values using random bits generated
+     *  elsewhere, e.g. for a batch of atoms at once. The operator() uses
+     *  consecutive groups of \p tableBits random bits, starting from the
+     *  lowest bits, as indices into this table.
+     */
+    static const std::array<RealType, 1 << tableBits>& table() { return c_table_; }
+
     /*! \brief Clear all internal saved random bits from the random engine */
     void reset() { savedRandomBitsLeft_ = 0; }
 
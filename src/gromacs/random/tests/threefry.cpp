@@ -218,6 +218,41 @@ TEST_F(ThreeFry2x64Test, Discard)
     EXPECT_EQ(rngA, rngB);
 }
 
+TEST_F(ThreeFry2x64Test, FirstInBatchMatchesRestart)
+{
+    gmx::ThreeFry2x64<0>     rngA(123456, gmx::RandomDomain::UpdateCoordinates);
+    gmx::ThreeFry2x64Fast<0> rngB(123456, gmx::RandomDomain::UpdateCoordinates);
+
+    std::array<uint64_t, 7> ctr0, ctr1, resultA, resultB;
+    for (std::size_t i = 0; i < ctr0.size(); i++)
+    {
+        ctr0[i] = 1000 + i / 3;
+        ctr1[i] = 0xFFFFFFFFFFFFFFFF - 5 * i;
+    }
+    rngA.generateFirstInBatch(ctr0, ctr1, &resultA);
+    rngB.generateFirstInBatch(ctr0, ctr1, &resultB);
+
+    for (std::size_t i = 0; i < ctr0.size(); i++)
+    {
+        rngA.restart(ctr0[i], ctr1[i]);
+        EXPECT_EQ(rngA(), resultA[i]);
+        rngB.restart(ctr0[i], ctr1[i]);
+        EXPECT_EQ(rngB(), resultB[i]);
+    }
+}
+
+TEST_F(ThreeFry2x64Test, FirstInBatchInvalidCounter)
+{
+    gmx::ThreeFry2x64<10> rngA(123456, gmx::RandomDomain::Other);
+
+    std::array<uint64_t, 2> ctr0   = { { 0, 0xFFFFFFFFFFFFFFFF } };
+    std::array<uint64_t, 2> ctr1   = { { 0, 0xFFFFFFFFFFFFFFFF } };
+    std::array<uint64_t, 2> result = {};
+
+    // Highest 10 bits of counter reserved for the internal counter.
+    EXPECT_THROW_GMX(rngA.generateFirstInBatch(ctr0, ctr1, &result), gmx::InternalError);
+}
+
 
 TEST_F(ThreeFry2x64Test, InvalidCounter)
 {
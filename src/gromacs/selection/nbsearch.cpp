@@ -40,6 +40,11 @@
  *
  * High-level overview of the algorithm is at \ref page_analysisnbsearch.
  *
+ * Within each grid cell, the reference positions are stored in clusters of
+ * a fixed size with a bounding box for each cluster.  Clusters outside the
+ * cutoff are skipped with a single check, and distances to the positions in
+ * the other clusters are computed for the whole cluster at once with SIMD.
+ *
  * \todo
  * The grid implementation could still be optimized in several different ways:
  *   - A better heuristic for selecting the grid size or falling back to a
@@ -64,6 +69,8 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/simd/simd.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
@@ -79,6 +86,22 @@ namespace gmx
 namespace
 {
 
+#if GMX_SIMD_HAVE_REAL
+//! Number of reference positions in a grid cell cluster.
+constexpr int c_clusterSize = GMX_SIMD_REAL_WIDTH;
+#else
+//! Number of reference positions in a grid cell cluster.
+constexpr int c_clusterSize = 4;
+#endif
+
+/*! \brief
+ * Relative margin on the cutoff for the cluster bounding box check.
+ *
+ * Guards against rounding making a bounding box distance larger than the
+ * distance to the closest position in the cluster.
+ */
+constexpr real c_clusterBoundsMargin = 1 + 10 * GMX_REAL_EPS;
+
 /*! \brief
  * Computes the bounding box for a set of positions.
  *
@@ -124,6 +147,8 @@ public:
     typedef AnalysisNeighborhoodPairSearch::ImplPointer PairSearchImplPointer;
     typedef std::vector<PairSearchImplPointer>          PairSearchList;
     typedef std::vector<std::vector<int>>               CellList;
+    //! Coordinate storage for clusters, aligned for SIMD loads.
+    typedef std::vector<real, AlignedAllocator<real>> ClusterCoordinates;
 
     explicit AnalysisNeighborhoodSearchImpl(real cutoff);
     ~AnalysisNeighborhoodSearchImpl();
@@ -207,6 +232,22 @@ private:
      * produces.
      */
     void addToGridCell(const rvec cell, int i);
+    /*! \brief
+     * Sets up the cluster storage of the grid cells.
+     *
+     * Copies the positions in each cell into clusters of \c c_clusterSize
+     * positions (in the order of \p cells_, padded with copies of the last
+     * position) and computes the bounding box of each cluster.
+     */
+    void initCellClusters();
+    /*! \brief
+     * Checks whether any position in a cluster can be within the cutoff.
+     *
+     * \param[in] cluster  Index of the cluster.
+     * \param[in] xtest    Test position.
+     * \param[in] shift    Periodic shift for the cell of the cluster.
+     */
+    bool clusterWithinCutoff(int cluster, const rvec xtest, const rvec shift) const;
     /*! \brief
      * Initializes a cell pair loop for a dimension.
      *
@@ -319,6 +360,16 @@ private:
     ivec ncelldim_;
     //! Data structure to hold the grid cell contents.
     CellList cells_;
+    /*! \brief
+     * Start of each cell in the cluster storage (with one extra element).
+     *
+     * Always a multiple of \c c_clusterSize.
+     */
+    std::vector<int> cellStart_;
+    //! Coordinates of the positions in \p cells_, per dimension, in clusters.
+    ClusterCoordinates clusterX_[DIM];
+    //! Lower (first \c DIM values) and upper corners of each cluster bounding box.
+    std::vector<real> clusterBounds_;
 
     Mutex          createPairSearchMutex_;
     PairSearchList pairSearchList_;
@@ -353,6 +404,8 @@ public:
     //! Searches for the next neighbor.
     template<class Action>
     bool searchNext(Action action);
+    //! Searches for the next pairs, up to the size of \p pairs.
+    int searchNextPairs(ArrayRef<AnalysisNeighborhoodPair> pairs);
     //! Initializes a pair representing the pair found by searchNext().
     void initFoundPair(AnalysisNeighborhoodPair* pair) const;
     //! Advances to the next test position, skipping any remaining pairs.
@@ -363,6 +416,15 @@ private:
     void reset(int testIndex);
     //! Checks whether a reference positiong should be excluded.
     bool isExcluded(int j);
+    /*! \brief
+     * Computes distances from the test position to a cluster.
+     *
+     * \param[in]  cluster  Index of the cluster.
+     * \param[in]  shift    Periodic shift for the cell of the cluster.
+     * \param[out] r2       Distances squared.
+     * \param[out] dx       Distance vectors, per dimension.
+     */
+    void computeClusterDistances(int cluster, const rvec shift, real* r2, real* dx[DIM]) const;
 
     //! Parent search object.
     const AnalysisNeighborhoodSearchImpl& search_;
@@ -714,6 +776,71 @@ void AnalysisNeighborhoodSearchImpl::addToGridCell(const rvec cell, int i)
     cells_[ci].push_back(i);
 }
 
+void AnalysisNeighborhoodSearchImpl::initCellClusters()
+{
+    const int cellCount = ncelldim_[XX] * ncelldim_[YY] * ncelldim_[ZZ];
+    cellStart_.resize(cellCount + 1);
+    int clusteredCount = 0;
+    for (int ci = 0; ci < cellCount; ++ci)
+    {
+        cellStart_[ci] = clusteredCount;
+        const int cellSize = ssize(cells_[ci]);
+        clusteredCount += (cellSize + c_clusterSize - 1) / c_clusterSize * c_clusterSize;
+    }
+    cellStart_[cellCount] = clusteredCount;
+    for (int dd = 0; dd < DIM; ++dd)
+    {
+        clusterX_[dd].resize(clusteredCount);
+    }
+    clusterBounds_.resize(clusteredCount / c_clusterSize * 2 * DIM);
+    for (int ci = 0; ci < cellCount; ++ci)
+    {
+        const int cellSize = ssize(cells_[ci]);
+        for (int k = cellStart_[ci]; k < cellStart_[ci + 1]; ++k)
+        {
+            const int i = cells_[ci][std::min(k - cellStart_[ci], cellSize - 1)];
+            for (int dd = 0; dd < DIM; ++dd)
+            {
+                clusterX_[dd][k] = xref_[i][dd];
+            }
+        }
+        for (int k = cellStart_[ci]; k < cellStart_[ci + 1]; k += c_clusterSize)
+        {
+            real* bounds = &clusterBounds_[k / c_clusterSize * 2 * DIM];
+            for (int dd = 0; dd < DIM; ++dd)
+            {
+                const auto first = clusterX_[dd].begin() + k;
+                const auto range = std::minmax_element(first, first + c_clusterSize);
+                bounds[dd]       = *range.first;
+                bounds[DIM + dd] = *range.second;
+            }
+        }
+    }
+}
+
+bool AnalysisNeighborhoodSearchImpl::clusterWithinCutoff(int cluster, const rvec xtest, const rvec shift) const
+{
+    const real* bounds = &clusterBounds_[cluster * 2 * DIM];
+    const int   dimMax = bXY_ ? ZZ : DIM;
+    real        r2     = 0;
+    for (int dd = 0; dd < dimMax; ++dd)
+    {
+        // Computed in the same order as the pair distances, so that the
+        // distance is never larger than that to any position in the cluster.
+        const real lower = (bounds[dd] - xtest[dd]) - shift[dd];
+        const real upper = (bounds[DIM + dd] - xtest[dd]) - shift[dd];
+        if (lower > 0)
+        {
+            r2 += lower * lower;
+        }
+        else if (upper < 0)
+        {
+            r2 += upper * upper;
+        }
+    }
+    return r2 <= cutoff2_ * c_clusterBoundsMargin;
+}
+
 void AnalysisNeighborhoodSearchImpl::initCellRange(const rvec centerCell, ivec currCell, ivec upperBound, int dim) const
 {
     RVec shiftedCenter(centerCell);
@@ -922,6 +1049,7 @@ void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     m
             mapPointToGridCell(positions.x_[ii], refcell, xrefAlloc_[i]);
             addToGridCell(refcell, i);
         }
+        initCellClusters();
     }
     else if (refIndices_ != nullptr)
     {
@@ -1027,6 +1155,41 @@ bool AnalysisNeighborhoodPairSearchImpl::isExcluded(int j)
     return false;
 }
 
+void AnalysisNeighborhoodPairSearchImpl::computeClusterDistances(int        cluster,
+                                                                 const rvec shift,
+                                                                 real*      r2,
+                                                                 real*      dx[DIM]) const
+{
+    const int offset = cluster * c_clusterSize;
+#if GMX_SIMD_HAVE_REAL
+    SimdReal r2S = setZero();
+    for (int dd = 0; dd < DIM; ++dd)
+    {
+        const SimdReal x  = load<SimdReal>(search_.clusterX_[dd].data() + offset);
+        const SimdReal dS = (x - SimdReal(xtest_[dd])) - SimdReal(shift[dd]);
+        store(dx[dd], dS);
+        if (dd < ZZ || !search_.bXY_)
+        {
+            r2S = r2S + dS * dS;
+        }
+    }
+    store(r2, r2S);
+#else
+    for (int k = 0; k < c_clusterSize; ++k)
+    {
+        r2[k] = 0;
+        for (int dd = 0; dd < DIM; ++dd)
+        {
+            dx[dd][k] = (search_.clusterX_[dd][offset + k] - xtest_[dd]) - shift[dd];
+            if (dd < ZZ || !search_.bXY_)
+            {
+                r2[k] += dx[dd][k] * dx[dd][k];
+            }
+        }
+    }
+#endif
+}
+
 void AnalysisNeighborhoodPairSearchImpl::startSearch(const AnalysisNeighborhoodPositions& positions)
 {
     selfSearchMode_   = false;
@@ -1078,31 +1241,49 @@ bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
                 {
                     continue;
                 }
-                const int cellSize = ssize(search_.cells_[ci]);
-                for (; cai < cellSize; ++cai)
+                const int cellSize  = ssize(search_.cells_[ci]);
+                const int cellStart = search_.cellStart_[ci];
+                while (cai < cellSize)
                 {
-                    const int i = search_.cells_[ci][cai];
-                    if (selfSearchMode_ && ci == testCellIndex_ && i >= testIndex_)
+                    // The cluster is recomputed when a search continues
+                    // after returning a pair from the middle of it.
+                    const int clusterStart = cai - cai % c_clusterSize;
+                    const int clusterEnd   = std::min(clusterStart + c_clusterSize, cellSize);
+                    const int cluster      = (cellStart + clusterStart) / c_clusterSize;
+                    if (!search_.clusterWithinCutoff(cluster, xtest_, shift))
                     {
+                        cai = clusterEnd;
                         continue;
                     }
-                    if (isExcluded(i))
+                    alignas(GMX_SIMD_ALIGNMENT) real clusterR2[c_clusterSize];
+                    alignas(GMX_SIMD_ALIGNMENT) real clusterDx[DIM][c_clusterSize];
+                    real* clusterDxPtr[DIM] = { clusterDx[XX], clusterDx[YY], clusterDx[ZZ] };
+                    computeClusterDistances(cluster, shift, clusterR2, clusterDxPtr);
+                    for (; cai < clusterEnd; ++cai)
                     {
-                        continue;
-                    }
-                    rvec dx;
-                    rvec_sub(search_.xref_[i], xtest_, dx);
-                    rvec_sub(dx, shift, dx);
-                    const real r2 = search_.bXY_ ? dx[XX] * dx[XX] + dx[YY] * dx[YY] : norm2(dx);
-                    if (r2 <= search_.cutoff2_)
-                    {
-                        if (action(i, r2, dx))
+                        const int i = search_.cells_[ci][cai];
+                        if (selfSearchMode_ && ci == testCellIndex_ && i >= testIndex_)
+                        {
+                            continue;
+                        }
+                        const int  k  = cai - clusterStart;
+                        const real r2 = clusterR2[k];
+                        // Exclusions are only checked for pairs within the
+                        // cutoff; isExcluded() only requires that the
+                        // indices are increasing within a cell.
+                        if (r2 <= search_.cutoff2_ && !isExcluded(i))
                         {
-                            prevcai_ = cai;
-                            previ_   = i;
-                            prevr2_  = r2;
-                            copy_rvec(dx, prevdx_);
-                            return true;
+                            const rvec dx = { clusterDx[XX][k],
+                                              clusterDx[YY][k],
+                                              clusterDx[ZZ][k] };
+                            if (action(i, r2, dx))
+                            {
+                                prevcai_ = cai;
+                                previ_   = i;
+                                prevr2_  = r2;
+                                copy_rvec(dx, prevdx_);
+                                return true;
+                            }
                         }
                     }
                 }
@@ -1145,6 +1326,23 @@ bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
     return false;
 }
 
+int AnalysisNeighborhoodPairSearchImpl::searchNextPairs(ArrayRef<AnalysisNeighborhoodPair> pairs)
+{
+    const int maxCount = pairs.ssize();
+    int       count    = 0;
+    if (maxCount > 0)
+    {
+        // Stops the search when the buffer is full, such that the state is
+        // as if the last stored pair had been returned by searchNext().
+        searchNext([this, pairs, maxCount, &count](int i, real r2, const rvec dx) {
+            pairs[count] = AnalysisNeighborhoodPair(i, testIndex_, r2, dx);
+            ++count;
+            return count == maxCount;
+        });
+    }
+    return count;
+}
+
 void AnalysisNeighborhoodPairSearchImpl::initFoundPair(AnalysisNeighborhoodPair* pair) const
 {
     if (previ_ < 0)
@@ -1412,6 +1610,11 @@ bool AnalysisNeighborhoodPairSearch::findNextPair(AnalysisNeighborhoodPair* pair
     return bFound;
 }
 
+int AnalysisNeighborhoodPairSearch::findNextPairs(ArrayRef<AnalysisNeighborhoodPair> pairs)
+{
+    return impl_->searchNextPairs(pairs);
+}
+
 void AnalysisNeighborhoodPairSearch::skipRemainingPairsForTestPosition()
 {
     impl_->nextTestPosition();
@@ -602,6 +602,20 @@ public:
      * \see AnalysisNeighborhoodSearch::startPairSearch()
      */
     bool findNextPair(AnalysisNeighborhoodPair* pair);
+    /*! \brief
+     * Finds the next pairs within the cutoff, a block at a time.
+     *
+     * \param[out] pairs  Buffer to store the found pairs in.
+     * \returns    Number of pairs stored in \p pairs.
+     *
+     * Finds the same pairs in the same order as repeated calls to
+     * findNextPair(), but without the overhead of a call for each pair.
+     * If the return value is smaller than the size of \p pairs, there
+     * were no more pairs.
+     * skipRemainingPairsForTestPosition() applies to the test position of
+     * the last pair stored.
+     */
+    int findNextPairs(ArrayRef<AnalysisNeighborhoodPair> pairs);
     /*! \brief
      * Skip remaining pairs for a test position in the search.
      *
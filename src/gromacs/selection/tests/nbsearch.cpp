@@ -1097,6 +1097,44 @@ TEST_F(NeighborhoodSearchTest, HandlesSkippingPairs)
     }
 }
 
+TEST_F(NeighborhoodSearchTest, FindsPairsInBlocks)
+{
+    const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
+
+    nb_.setCutoff(data.cutoff_);
+    nb_.setMode(gmx::AnalysisNeighborhood::eSearchMode_Grid);
+    gmx::AnalysisNeighborhoodSearch search = nb_.initSearch(&data.pbc_, data.refPositions());
+    ASSERT_EQ(gmx::AnalysisNeighborhood::eSearchMode_Grid, search.mode());
+
+    std::vector<gmx::AnalysisNeighborhoodPair> expectedPairs;
+    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(data.testPositions());
+    gmx::AnalysisNeighborhoodPair       pair;
+    while (pairSearch.findNextPair(&pair))
+    {
+        expectedPairs.push_back(pair);
+    }
+    ASSERT_FALSE(expectedPairs.empty());
+
+    // Use a block size that does not divide the number of pairs.
+    std::vector<gmx::AnalysisNeighborhoodPair> block(7);
+    std::vector<gmx::AnalysisNeighborhoodPair> pairs;
+    gmx::AnalysisNeighborhoodPairSearch blockSearch = search.startPairSearch(data.testPositions());
+    int                                 count       = 0;
+    do
+    {
+        count = blockSearch.findNextPairs(block);
+        pairs.insert(pairs.end(), block.begin(), block.begin() + count);
+    } while (count == gmx::ssize(block));
+
+    ASSERT_EQ(expectedPairs.size(), pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i)
+    {
+        EXPECT_EQ(expectedPairs[i].refIndex(), pairs[i].refIndex());
+        EXPECT_EQ(expectedPairs[i].testIndex(), pairs[i].testIndex());
+        EXPECT_EQ(expectedPairs[i].distance2(), pairs[i].distance2());
+    }
+}
+
 TEST_F(NeighborhoodSearchTest, SimpleSearchExclusions)
 {
     const NeighborhoodSearchTestData& data = RandomBoxFullPBCData::get();
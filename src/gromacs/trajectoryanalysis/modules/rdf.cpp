@@ -450,6 +450,7 @@ public:
         TrajectoryAnalysisModuleData(module, opt, selections)
     {
         surfaceDist2_.resize(surfaceGroupCount);
+        pairs_.resize(c_pairBlockSize);
     }
 
     void finish() override { finishDataHandles(); }
@@ -466,6 +467,12 @@ public:
      * the RDF from these numbers.
      */
     std::vector<real> surfaceDist2_;
+    //! Buffer for pairs from the neighborhood search.
+    std::vector<AnalysisNeighborhoodPair> pairs_;
+
+private:
+    //! Number of pairs requested from the neighborhood search at a time.
+    static constexpr int c_pairBlockSize = 256;
 };
 
 TrajectoryAnalysisModuleDataPointer Rdf::startFrames(const AnalysisDataParallelOptions& opt,
@@ -570,19 +577,24 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
         {
             // Standard neighborhood search over all pairs within the cutoff
             // for the -surf no case.
-            AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-            AnalysisNeighborhoodPair       pair;
-            while (pairSearch.findNextPair(&pair))
+            AnalysisNeighborhoodPairSearch         pairSearch = nbsearch.startPairSearch(sel[g]);
+            std::vector<AnalysisNeighborhoodPair>& pairs      = frameData.pairs_;
+            int                                    pairCount  = 0;
+            do
             {
-                const real r2 = pair.distance2();
-                if (r2 > cut2_)
+                pairCount = pairSearch.findNextPairs(pairs);
+                for (int p = 0; p < pairCount; ++p)
                 {
-                    // TODO: Consider whether the histogramming could be done with
-                    // less overhead (after first measuring the overhead).
-                    dh.setPoint(0, std::sqrt(r2));
-                    dh.finishPointSet();
+                    const real r2 = pairs[p].distance2();
+                    if (r2 > cut2_)
+                    {
+                        // TODO: Consider whether the histogramming could be done with
+                        // less overhead (after first measuring the overhead).
+                        dh.setPoint(0, std::sqrt(r2));
+                        dh.finishPointSet();
+                    }
                 }
-            }
+            } while (pairCount == ssize(pairs));
         }
         // Normalization factor for the number density (only used without
         // -surf, but does not hurt to populate otherwise).
@@ -44,11 +44,19 @@
 
 #include "runnercommon.h"
 
+#include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
+#include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/oenv.h"
 #include "gromacs/fileio/timecontrol.h"
 #include "gromacs/fileio/trxio.h"
@@ -77,6 +85,161 @@
 namespace gmx
 {
 
+namespace
+{
+
+/*! \internal \brief
+ * Runs a frame reading function on a background thread.
+ *
+ * Only one frame is read at a time: startReading() may only be called again
+ * after waitForFrame() has returned for the previous frame.  This is enough
+ * to overlap reading and decompressing the next frame with the analysis of
+ * the current one, which leaves frame processing itself in order and on the
+ * calling thread.
+ *
+ * \ingroup module_trajectoryanalysis
+ */
+class FramePrefetcher
+{
+public:
+    /*! \brief
+     * Starts the reader thread.
+     *
+     * \param[in] readFrame  Function that reads the next frame, and returns
+     *     false if there are no more frames.
+     */
+    explicit FramePrefetcher(std::function<bool()> readFrame) : readFrame_(std::move(readFrame))
+    {
+        thread_ = std::thread(&FramePrefetcher::threadLoop, this);
+    }
+    //! Finishes any frame being read and stops the reader thread.
+    ~FramePrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        stateChanged_.notify_all();
+        thread_.join();
+    }
+
+    //! Starts reading the next frame in the background.
+    void startReading()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            GMX_ASSERT(!readRequested_ && !readFinished_, "Previous frame has not been waited for");
+            readRequested_ = true;
+        }
+        stateChanged_.notify_all();
+    }
+    /*! \brief
+     * Waits for the frame started with startReading().
+     *
+     * \returns The value returned by the reading function.
+     *
+     * Exceptions from the reading function are rethrown here.
+     */
+    bool waitForFrame()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stateChanged_.wait(lock, [this] { return readFinished_; });
+        readFinished_ = false;
+        if (exception_)
+        {
+            std::exception_ptr exception = exception_;
+            exception_                   = nullptr;
+            std::rethrow_exception(exception);
+        }
+        return result_;
+    }
+
+private:
+    void threadLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            stateChanged_.wait(lock, [this] { return readRequested_ || stop_; });
+            if (!readRequested_)
+            {
+                return;
+            }
+            readRequested_ = false;
+            lock.unlock();
+            bool               result = false;
+            std::exception_ptr exception;
+            try
+            {
+                result = readFrame_();
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            lock.lock();
+            result_       = result;
+            exception_    = exception;
+            readFinished_ = true;
+            stateChanged_.notify_all();
+        }
+    }
+
+    std::function<bool()> readFrame_;
+    std::mutex            mutex_;
+    //! Signals changes in any of the flags below.
+    std::condition_variable stateChanged_;
+    bool                    readRequested_ = false;
+    bool                    readFinished_  = false;
+    bool                    stop_          = false;
+    bool                    result_        = false;
+    std::exception_ptr      exception_;
+    std::thread             thread_;
+};
+
+//! Frees a frame allocated by read_first_frame() or duplicateFrame().
+void freeFrame(t_trxframe* fr)
+{
+    // There doesn't seem to be a function for freeing frame data
+    sfree(fr->x);
+    sfree(fr->v);
+    sfree(fr->f);
+    sfree(fr->index);
+    sfree(fr);
+}
+
+//! Returns a copy of \p fr with its own coordinate, velocity, force and index arrays.
+t_trxframe* duplicateFrame(const t_trxframe& fr)
+{
+    t_trxframe* copy;
+    snew(copy, 1);
+    *copy       = fr;
+    copy->x     = nullptr;
+    copy->v     = nullptr;
+    copy->f     = nullptr;
+    copy->index = nullptr;
+    if (fr.x != nullptr)
+    {
+        snew(copy->x, fr.natoms);
+    }
+    if (fr.v != nullptr)
+    {
+        snew(copy->v, fr.natoms);
+    }
+    if (fr.f != nullptr)
+    {
+        snew(copy->f, fr.natoms);
+    }
+    if (fr.index != nullptr)
+    {
+        snew(copy->index, fr.natoms);
+        std::copy(fr.index, fr.index + fr.natoms, copy->index);
+    }
+    return copy;
+}
+
+} // namespace
+
 class TrajectoryAnalysisRunnerCommon::Impl : public ITopologyProvider
 {
 public:
@@ -88,6 +251,8 @@ public:
     void initTopology(bool required);
     void initFirstFrame();
     void initFrameIndexGroup();
+    void initFrame();
+    bool readNextFrame();
     void finishTrajectory();
 
     // From ITopologyProvider
@@ -132,6 +297,12 @@ public:
     //! The current frame, or \p NULL if no frame loaded yet.
     t_trxframe* fr;
     gmx_rmpbc_t gpbc_;
+    //! Whether common initialization has already been done for \p fr.
+    bool bFrameInitialized_;
+    //! Frame that the next frame is read into in the background, or \p NULL.
+    t_trxframe* nextFrame_;
+    //! Reads frames in the background, or \p NULL if not (yet) used.
+    std::unique_ptr<FramePrefetcher> prefetcher_;
     //! Used to store the status variable from read_first_frame().
     t_trxstatus*      status_;
     gmx_output_env_t* oenv_;
@@ -149,6 +320,8 @@ TrajectoryAnalysisRunnerCommon::Impl::Impl(TrajectoryAnalysisSettings* settings)
     bTrajOpen_(false),
     fr(nullptr),
     gpbc_(nullptr),
+    bFrameInitialized_(false),
+    nextFrame_(nullptr),
     status_(nullptr),
     oenv_(nullptr)
 {
@@ -160,12 +333,11 @@ TrajectoryAnalysisRunnerCommon::Impl::~Impl()
     finishTrajectory();
     if (fr != nullptr)
     {
-        // There doesn't seem to be a function for freeing frame data
-        sfree(fr->x);
-        sfree(fr->v);
-        sfree(fr->f);
-        sfree(fr->index);
-        sfree(fr);
+        freeFrame(fr);
+    }
+    if (nextFrame_ != nullptr)
+    {
+        freeFrame(nextFrame_);
     }
     if (oenv_ != nullptr)
     {
@@ -290,8 +462,66 @@ void TrajectoryAnalysisRunnerCommon::Impl::initFrameIndexGroup()
     std::copy(trajectoryGroup_.atomIndices().begin(), trajectoryGroup_.atomIndices().end(), fr->index);
 }
 
+void TrajectoryAnalysisRunnerCommon::Impl::initFrame()
+{
+    if (gpbc_ != nullptr && !bFrameInitialized_)
+    {
+        gmx_rmpbc_trxfr(gpbc_, fr);
+    }
+    bFrameInitialized_ = true;
+
+    // Read the next frame while the current one is being analyzed.  This
+    // is only done for the binary trajectory formats, where reading only
+    // fills the coordinate arrays of the frame.  The reader thread also
+    // makes the molecules whole, which needs to happen in frame order.
+    if (prefetcher_ == nullptr && bTrajOpen_)
+    {
+        const int  ftp       = fn2ftp(trjfile_.c_str());
+        const bool bPrefetch = (ftp == efXTC || ftp == efTRR || ftp == efTNG);
+        if (bPrefetch && std::getenv("GMX_NO_TRAJECTORY_PREFETCH") == nullptr)
+        {
+            nextFrame_  = duplicateFrame(*fr);
+            prefetcher_ = std::make_unique<FramePrefetcher>([this]() {
+                const bool bOK = read_next_frame(oenv_, status_, nextFrame_);
+                if (bOK && gpbc_ != nullptr)
+                {
+                    gmx_rmpbc_trxfr(gpbc_, nextFrame_);
+                }
+                return bOK;
+            });
+            prefetcher_->startReading();
+        }
+    }
+}
+
+bool TrajectoryAnalysisRunnerCommon::Impl::readNextFrame()
+{
+    if (!hasTrajectory())
+    {
+        return false;
+    }
+    if (prefetcher_ == nullptr)
+    {
+        bFrameInitialized_ = false;
+        return read_next_frame(oenv_, status_, fr);
+    }
+    if (!prefetcher_->waitForFrame())
+    {
+        return false;
+    }
+    // The caller is done with the current frame, so it can be reused for
+    // reading the one after the new frame.
+    std::swap(fr, nextFrame_);
+    bFrameInitialized_ = true;
+    prefetcher_->startReading();
+    return true;
+}
+
 void TrajectoryAnalysisRunnerCommon::Impl::finishTrajectory()
 {
+    // Stop the reader thread before the trajectory and the PBC data it
+    // uses are closed.
+    prefetcher_.reset();
     if (bTrajOpen_)
     {
         close_trx(status_);
@@ -440,11 +670,7 @@ void TrajectoryAnalysisRunnerCommon::initFrameIndexGroup()
 
 bool TrajectoryAnalysisRunnerCommon::readNextFrame()
 {
-    bool bContinue = false;
-    if (hasTrajectory())
-    {
-        bContinue = read_next_frame(impl_->oenv_, impl_->status_, impl_->fr);
-    }
+    const bool bContinue = impl_->readNextFrame();
     if (!bContinue)
     {
         impl_->finishTrajectory();
@@ -455,10 +681,7 @@ bool TrajectoryAnalysisRunnerCommon::readNextFrame()
 
 void TrajectoryAnalysisRunnerCommon::initFrame()
 {
-    if (impl_->gpbc_ != nullptr)
-    {
-        gmx_rmpbc_trxfr(impl_->gpbc_, impl_->fr);
-    }
+    impl_->initFrame();
 }
 
 
@@ -43,11 +43,19 @@
 
 #include "gromacs/trajectoryanalysis/cmdlinerunner.h"
 
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "gromacs/commandline/cmdlinemodule.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/timecontrol.h"
+#include "gromacs/fileio/trxio.h"
 #include "gromacs/options/basicoptions.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/trajectory/trajectoryframe.h"
@@ -58,6 +66,7 @@
 
 #include "testutils/cmdlinetest.h"
 #include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
 
 namespace
 {
@@ -159,4 +168,83 @@ TEST_F(TrajectoryAnalysisCommandLineRunnerTest, FailsWithTrajectorySubsetWithout
     EXPECT_THROW_GMX(runTest(CommandLine(cmdline)), gmx::InconsistentInputError);
 }
 
+//! The step and the first coordinate of a frame
+using FrameSummary = std::pair<int64_t, real>;
+
+//! Reads the frames of \p filename up to time \p endTime without the analysis runner
+std::vector<FrameSummary> readFramesDirectly(const char* filename, real endTime)
+{
+    gmx_output_env_t* oenv = nullptr;
+    output_env_init_default(&oenv);
+    const std::string path = gmx::test::TestFileManager::getInputFilePath(filename);
+
+    std::vector<FrameSummary> frames;
+    t_trxstatus*              status;
+    t_trxframe                fr;
+    bool haveFrame = read_first_frame(oenv, &status, path.c_str(), &fr, TRX_NEED_X);
+    while (haveFrame && fr.time <= endTime)
+    {
+        frames.emplace_back(fr.step, fr.x[0][XX]);
+        haveFrame = read_next_frame(oenv, status, &fr);
+    }
+    close_trx(status);
+    done_frame(&fr);
+    output_env_done(oenv);
+
+    return frames;
+}
+
+/*! \brief Runs the mock module on a binary trajectory, which is read ahead on
+ * a separate thread, and checks that all frames up to \p endTime are analyzed
+ * exactly once and in order.
+ */
+void checkPrefetchedFrames(TrajectoryAnalysisCommandLineRunnerTest* test,
+                           real                                     endTime,
+                           const CommandLine&                       args)
+{
+    using ::testing::_;
+    using ::testing::Invoke;
+
+    std::vector<FrameSummary> analyzedFrames;
+    int                       nextFrameNumber = 0;
+    int                       finishedFrames  = -1;
+    EXPECT_CALL(*test->mockModule_, initOptions(_, _));
+    EXPECT_CALL(*test->mockModule_, initAnalysis(_, _));
+    auto recordFrame = [&](int                                frnr,
+                           const t_trxframe&                  fr,
+                           t_pbc*                             /*pbc*/,
+                           gmx::TrajectoryAnalysisModuleData* /*pdata*/) {
+        EXPECT_EQ(frnr, nextFrameNumber++);
+        analyzedFrames.emplace_back(fr.step, fr.x[0][XX]);
+    };
+    EXPECT_CALL(*test->mockModule_, analyzeFrame(_, _, _, _)).WillRepeatedly(Invoke(recordFrame));
+    EXPECT_CALL(*test->mockModule_, finishAnalysis(_)).WillOnce(Invoke([&](int nframes) {
+        finishedFrames = nframes;
+    }));
+    EXPECT_CALL(*test->mockModule_, writeOutput());
+
+    test->setInputFile("-f", "extract_cluster.trr");
+    EXPECT_NO_THROW_GMX(test->runTest(args));
+
+    const auto referenceFrames = readFramesDirectly("extract_cluster.trr", endTime);
+    ASSERT_GT(referenceFrames.size(), 2U);
+    EXPECT_EQ(analyzedFrames, referenceFrames);
+    EXPECT_EQ(finishedFrames, static_cast<int>(referenceFrames.size()));
+}
+
+TEST_F(TrajectoryAnalysisCommandLineRunnerTest, AnalyzesAllPrefetchedFramesInOrder)
+{
+    // The last frame is read while the previous one is analyzed
+    checkPrefetchedFrames(this, GMX_REAL_MAX, CommandLine());
+}
+
+TEST_F(TrajectoryAnalysisCommandLineRunnerTest, StopsPrefetchingAtEndTime)
+{
+    // The reader thread reads the frame after the end time, which should not be analyzed
+    const char* const cmdline[] = { "-e", "0.021" };
+    checkPrefetchedFrames(this, 0.021, CommandLine(cmdline));
+    // -e sets the global end time, which should not apply to later tests
+    unsetTimeValue(TEND);
+}
+
 } // namespace
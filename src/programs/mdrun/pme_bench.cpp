@@ -0,0 +1,160 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief This file contains the main function for the PME stage benchmark
+ */
+
+#include "gmxpre.h"
+
+#include "pme_bench.h"
+
+#include <vector>
+
+#include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/ewald/benchmark/pme_bench.h"
+#include "gromacs/options/basicoptions.h"
+#include "gromacs/options/filenameoption.h"
+#include "gromacs/options/ioptionscontainer.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+class PmeBenchmark : public ICommandLineOptionsModule
+{
+public:
+    PmeBenchmark() {}
+
+    // From ICommandLineOptionsModule
+    void init(CommandLineModuleSettings* /*settings*/) override {}
+    void initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings) override;
+    void optionsFinished() override {}
+    int  run() override;
+
+private:
+    int             sizeFactor_ = 1;
+    PmeBenchOptions benchmarkOptions_;
+};
+
+void PmeBenchmark::initOptions(IOptionsContainer* options, ICommandLineOptionsModuleSettings* settings)
+{
+    std::vector<const char*> desc = {
+        "[THISMODULE] runs benchmarks for the stages of the CPU",
+        "implementation of smooth PME for Coulomb interactions:",
+        "spreading the charges on the grid, the forward 3D FFT,",
+        "solving in reciprocal space, the backward 3D FFT and gathering",
+        "the forces. Each stage is timed separately, so the effect of",
+        "the number of threads, the grid size and the interpolation order",
+        "on each of them can be studied in isolation.[PAR]",
+        "The system is a cubic box of randomly oriented rigid water",
+        "molecules at the density of liquid water. The number of",
+        "molecules is 1000 times the value of [TT]-size[tt].",
+        "The grid size is determined from the Fourier spacing in the",
+        "same way as [TT]gmx grompp[tt] does. Multiple values can be given",
+        "for [TT]-nt[tt], [TT]-order[tt] and [TT]-spacing[tt],",
+        "all combinations are then benchmarked.[PAR]",
+        "Each setup is run for [TT]-warmup[tt] untimed iterations",
+        "followed by [TT]-iter[tt] timed iterations. The reported times",
+        "are the average wall-clock times per iteration in microseconds.",
+        "Spreading includes the reduction of the thread-local grids and",
+        "gathering includes copying back and unwrapping the grid.",
+        "Every stage runs in its own OpenMP parallel region, whereas",
+        "mdrun runs the FFTs and the solver in a single region.",
+        "The results are also written in csv format to [TT]-o[tt].[PAR]",
+        "As with any benchmark, it is best to run with locked CPU",
+        "clocks and thread affinities set, e.g. through the",
+        "OMP_PROC_BIND environment variable."
+    };
+
+    settings->setHelpText(desc);
+
+    options->addOption(
+            IntegerOption("size").store(&sizeFactor_).description("The system size is 1000 water molecules times this value"));
+    options->addOption(IntegerOption("nt")
+                               .storeVector(&benchmarkOptions_.numThreads)
+                               .multiValue()
+                               .description("The numbers of OpenMP threads to use"));
+    options->addOption(IntegerOption("order")
+                               .storeVector(&benchmarkOptions_.pmeOrders)
+                               .multiValue()
+                               .description("The PME interpolation orders"));
+    options->addOption(RealOption("spacing")
+                               .storeVector(&benchmarkOptions_.fourierSpacings)
+                               .multiValue()
+                               .description("The Fourier grid spacings (nm)"));
+    options->addOption(RealOption("cutoff")
+                               .store(&benchmarkOptions_.cutoff)
+                               .description("The real-space cut-off that sets the Ewald coefficient"));
+    options->addOption(RealOption("ewald-rtol")
+                               .store(&benchmarkOptions_.ewaldRTol)
+                               .description("The relative Ewald interaction at the cut-off"));
+    options->addOption(BooleanOption("energy")
+                               .store(&benchmarkOptions_.computeEnergyAndVirial)
+                               .description("Compute the energy and virial in the solver"));
+    options->addOption(IntegerOption("iter")
+                               .store(&benchmarkOptions_.numIterations)
+                               .description("The number of timed iterations for each setup"));
+    options->addOption(IntegerOption("warmup")
+                               .store(&benchmarkOptions_.numWarmupIterations)
+                               .description("The number of untimed iterations before each setup"));
+    options->addOption(FileNameOption("o")
+                               .filetype(eftCsv)
+                               .outputFile()
+                               .store(&benchmarkOptions_.outputFile)
+                               .defaultBasename("pme-benchmark")
+                               .description("Also output results in csv format"));
+}
+
+int PmeBenchmark::run()
+{
+    pmeBench(sizeFactor_, benchmarkOptions_);
+
+    return 0;
+}
+
+} // namespace
+
+const char PmeBenchmarkInfo::name[]             = "pme-benchmark";
+const char PmeBenchmarkInfo::shortDescription[] = "Benchmarking tool for the CPU PME stages.";
+
+ICommandLineOptionsModulePointer PmeBenchmarkInfo::create()
+{
+    return ICommandLineOptionsModulePointer(std::make_unique<PmeBenchmark>());
+}
+
+} // namespace gmx
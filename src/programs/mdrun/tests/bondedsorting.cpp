@@ -0,0 +1,135 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests sorting the listed interactions on atom index for the
+ * multi-threaded force calculation
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for sorting the listed interactions
+class BondedSortingTest : public MdrunTestFixture
+{
+};
+
+/*! \brief Checks that sorting the listed interactions does not change
+ * the energies and forces
+ *
+ * Sorting is only used when the interactions are distributed over
+ * more threads than GMX_BONDED_NTHREAD_UNIFORM. With domain decomposition
+ * the local atom order follows the grid, so the local interactions are
+ * not ordered on atom index. Sorting changes the assignment of
+ * interactions to threads and thereby the order of summation, so the
+ * results agree within the summation tolerance.
+ */
+TEST_F(BondedSortingTest, MatchesUnsortedEnergiesAndForces)
+{
+    runner_.useStringAsMdpFile(
+            "integrator     = md\n"
+            "nsteps         = 0\n"
+            "nstcalcenergy  = 1\n"
+            "nstenergy      = 1\n"
+            "nstfout        = 1\n"
+            "coulombtype    = reaction-field\n"
+            "rcoulomb       = 0.9\n"
+            "rvdw           = 0.9\n");
+    runner_.useTopGroAndNdxFromDatabase("alanine_vsite_solvated");
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    gmxSetenv("GMX_BONDED_NTHREAD_UNIFORM", "1", true);
+
+    const std::string sortedEdrFileName      = fileManager_.getTemporaryFilePath("sorted.edr");
+    const std::string sortedTrrFileName      = fileManager_.getTemporaryFilePath("sorted.trr");
+    runner_.edrFileName_                     = sortedEdrFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = sortedTrrFileName;
+    const int sortedStatus                   = runner_.callMdrun();
+
+    const std::string unsortedEdrFileName    = fileManager_.getTemporaryFilePath("unsorted.edr");
+    const std::string unsortedTrrFileName    = fileManager_.getTemporaryFilePath("unsorted.trr");
+    runner_.edrFileName_                     = unsortedEdrFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = unsortedTrrFileName;
+    gmxSetenv("GMX_NO_BONDED_SORTING", "1", true);
+    const int unsortedStatus = runner_.callMdrun();
+    gmxUnsetenv("GMX_NO_BONDED_SORTING");
+
+    gmxUnsetenv("GMX_BONDED_NTHREAD_UNIFORM");
+    ASSERT_EQ(0, sortedStatus);
+    ASSERT_EQ(0, unsortedStatus);
+
+    const auto tolerance = relativeToleranceAsUlp(10.0, 50);
+    compareEnergies(sortedEdrFileName,
+                    unsortedEdrFileName,
+                    { { interaction_function[F_ANGLES].longname, tolerance },
+                      { interaction_function[F_PDIHS].longname, tolerance },
+                      { interaction_function[F_LJ14].longname, tolerance },
+                      { interaction_function[F_COUL14].longname, tolerance },
+                      { interaction_function[F_EPOT].longname, tolerance } });
+
+    const TrajectoryFrameMatchSettings matchSettings{ true,
+                                                      true,
+                                                      true,
+                                                      ComparisonConditions::NoComparison,
+                                                      ComparisonConditions::NoComparison,
+                                                      ComparisonConditions::MustCompare };
+    compareTrajectories(sortedTrrFileName,
+                        unsortedTrrFileName,
+                        TrajectoryComparison(matchSettings,
+                                             TrajectoryComparison::s_defaultTrajectoryTolerances));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
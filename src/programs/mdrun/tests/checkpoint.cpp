@@ -1,7 +1,7 @@
 /*
  * This file is part of the GROMACS molecular simulation package.
  *
- * Copyright (c) 2020, by the GROMACS development team, led by
+ * Copyright (c) 2020,2021, by the GROMACS development team, led by
  * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
  * and including many others, as listed in the AUTHORS file in the
  * top-level source directory and at http://www.gromacs.org.
@@ -48,6 +48,7 @@
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringutil.h"
 
+#include "testutils/setenv.h"
 #include "testutils/simulationdatabase.h"
 
 #include "moduletest.h"
@@ -104,54 +105,69 @@ public:
         EXPECT_FALSE(cptReader.readNextFrame());
         EXPECT_FALSE(trrReader.readNextFrame());
     }
+
+    //! Runs a short simulation and checks that its checkpoint matches the last frame
+    void checkCheckpointMatchesTrajectory()
+    {
+        const auto& params              = GetParam();
+        const auto& simulationName      = std::get<0>(params);
+        const auto& integrator          = std::get<1>(params);
+        const auto& temperatureCoupling = std::get<2>(params);
+        const auto& pressureCoupling    = std::get<3>(params);
+
+        // Specify how trajectory frame matching must work.
+        TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                              true,
+                                                              true,
+                                                              ComparisonConditions::MustCompare,
+                                                              ComparisonConditions::MustCompare,
+                                                              ComparisonConditions::NoComparison,
+                                                              MaxNumFrames::compareAllFrames() };
+        if (integrator == "md-vv")
+        {
+            // When using md-vv and modular simulator, the velocities are expected to be off by
+            // 1/2 dt between checkpoint (top of the loop) and trajectory (full time step state)
+            trajectoryMatchSettings.velocitiesComparison = ComparisonConditions::NoComparison;
+        }
+        const TrajectoryTolerances trajectoryTolerances{ defaultRealTolerance(),
+                                                         defaultRealTolerance(),
+                                                         defaultRealTolerance(),
+                                                         defaultRealTolerance() };
+
+        const auto mdpFieldValues = prepareMdpFieldValues(
+                simulationName, integrator, temperatureCoupling, pressureCoupling);
+        runner_.useTopGroAndNdxFromDatabase(simulationName);
+        // Set file names
+        const auto cptFileName = fileManager_.getTemporaryFilePath(".cpt");
+        const auto trrFileName = fileManager_.getTemporaryFilePath(".trr");
+
+        SCOPED_TRACE(formatString(
+                "Checking the sanity of the checkpointed coordinates using system '%s' "
+                "with integrator '%s', '%s' temperature coupling, and '%s' pressure coupling ",
+                simulationName.c_str(),
+                integrator.c_str(),
+                temperatureCoupling.c_str(),
+                pressureCoupling.c_str()));
+
+        SCOPED_TRACE("End of trajectory sanity");
+        // Running a few steps - we expect the checkpoint to be equal
+        // to the final configuration
+        runSimulation(mdpFieldValues, 16, trrFileName, cptFileName);
+        compareCptAndTrr(
+                trrFileName, cptFileName, { trajectoryMatchSettings, trajectoryTolerances });
+    }
 };
 
 TEST_P(CheckpointCoordinatesSanityChecks, WithinTolerances)
 {
-    const auto& params              = GetParam();
-    const auto& simulationName      = std::get<0>(params);
-    const auto& integrator          = std::get<1>(params);
-    const auto& temperatureCoupling = std::get<2>(params);
-    const auto& pressureCoupling    = std::get<3>(params);
-
-    // Specify how trajectory frame matching must work.
-    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
-                                                          true,
-                                                          true,
-                                                          ComparisonConditions::MustCompare,
-                                                          ComparisonConditions::MustCompare,
-                                                          ComparisonConditions::NoComparison,
-                                                          MaxNumFrames::compareAllFrames() };
-    if (integrator == "md-vv")
-    {
-        // When using md-vv and modular simulator, the velocities are expected to be off by
-        // 1/2 dt between checkpoint (top of the loop) and trajectory (full time step state)
-        trajectoryMatchSettings.velocitiesComparison = ComparisonConditions::NoComparison;
-    }
-    const TrajectoryTolerances trajectoryTolerances{
-        defaultRealTolerance(), defaultRealTolerance(), defaultRealTolerance(), defaultRealTolerance()
-    };
-
-    const auto mdpFieldValues =
-            prepareMdpFieldValues(simulationName, integrator, temperatureCoupling, pressureCoupling);
-    runner_.useTopGroAndNdxFromDatabase(simulationName);
-    // Set file names
-    const auto cptFileName = fileManager_.getTemporaryFilePath(".cpt");
-    const auto trrFileName = fileManager_.getTemporaryFilePath(".trr");
-
-    SCOPED_TRACE(formatString(
-            "Checking the sanity of the checkpointed coordinates using system '%s' "
-            "with integrator '%s', '%s' temperature coupling, and '%s' pressure coupling ",
-            simulationName.c_str(),
-            integrator.c_str(),
-            temperatureCoupling.c_str(),
-            pressureCoupling.c_str()));
-
-    SCOPED_TRACE("End of trajectory sanity");
-    // Running a few steps - we expect the checkpoint to be equal
-    // to the final configuration
-    runSimulation(mdpFieldValues, 16, trrFileName, cptFileName);
-    compareCptAndTrr(trrFileName, cptFileName, { trajectoryMatchSettings, trajectoryTolerances });
+    checkCheckpointMatchesTrajectory();
+}
+
+TEST_P(CheckpointCoordinatesSanityChecks, WithinTolerancesWithAsyncCheckpointing)
+{
+    gmxSetenv("GMX_ASYNC_CHECKPOINT", "1", 1);
+    checkCheckpointMatchesTrajectory();
+    gmxUnsetenv("GMX_ASYNC_CHECKPOINT");
 }
 
 #if !GMX_GPU_OPENCL
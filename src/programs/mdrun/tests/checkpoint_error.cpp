@@ -0,0 +1,106 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief Tests for errors while completing checkpoints in the background
+ *
+ * When mdrun throws after thread-MPI has been started, thread-MPI stays
+ * initialized, so later simulations in the same process fail. These
+ * tests therefore have their own test binary.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "config.h"
+
+#ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#endif
+
+#include <string>
+
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/path.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+#include "testutils/testasserts.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx::test
+{
+namespace
+{
+
+#if defined HAVE_UNISTD_H && !GMX_NATIVE_WINDOWS && !GMX_NO_RENAME
+//! Test fixture for errors while completing checkpoints in the background
+using AsyncCheckpointErrorTest = MdrunTestFixture;
+
+TEST_F(AsyncCheckpointErrorTest, ThrowsWhenCheckpointCannotBeWritten)
+{
+    // The error is thrown on the master rank only
+    if (getNumberOfTestMpiRanks() > 1)
+    {
+        return;
+    }
+
+    auto mdpFieldValues      = prepareMdpFieldValues("spc2", "md", "no", "no");
+    mdpFieldValues["nsteps"] = "4";
+    runner_.useTopGroAndNdxFromDatabase("spc2");
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner_);
+
+    // The checkpoint is written to a temporary file name with the step number
+    // first, let that be a device that is always full
+    const std::string cptFileName     = fileManager_.getTemporaryFilePath("state.cpt");
+    const std::string tempCptFileName = fileManager_.getTemporaryFilePath("state_step4.cpt");
+    ASSERT_EQ(symlink("/dev/full", tempCptFileName.c_str()), 0);
+
+    CommandLine mdrunCaller;
+    mdrunCaller.addOption("-cpo", cptFileName);
+    gmxSetenv("GMX_ASYNC_CHECKPOINT", "1", 1);
+    EXPECT_THROW_GMX(runner_.callMdrun(mdrunCaller), FileIOError);
+    gmxUnsetenv("GMX_ASYNC_CHECKPOINT");
+
+    EXPECT_FALSE(File::exists(cptFileName, File::returnFalseOnError));
+}
+#endif
+
+} // namespace
+} // namespace gmx::test
@@ -46,9 +46,13 @@
 
 #include <gtest/gtest.h>
 
+#include "gromacs/topology/ifunc.h"
+
 #include "testutils/cmdlinetest.h"
+#include "testutils/setenv.h"
 
 #include "moduletest.h"
+#include "simulatorcomparison.h"
 
 namespace
 {
@@ -74,4 +78,48 @@ TEST_F(DomainDecompositionSpecialCasesTest, AnEmptyDomainWorks)
     ASSERT_EQ(0, runner_.callMdrun());
 }
 
+/*! \brief Checks that the incrementally updated local topology gives
+ * the same energies as a full rebuild at every partitioning
+ *
+ * The bonded energies are only identical when exactly the same local
+ * interactions are assigned, in the same order.
+ */
+TEST_F(DomainDecompositionSpecialCasesTest, IncrementalLocalTopologyMatchesFullRebuild)
+{
+    runner_.useStringAsMdpFile(
+            "integrator    = md\n"
+            "nsteps        = 40\n"
+            "nstlist       = 5\n"
+            "nstcalcenergy = 5\n"
+            "nstenergy     = 5\n"
+            "coulombtype   = reaction-field\n"
+            "rcoulomb      = 0.7\n"
+            "rvdw          = 0.7\n"
+            "gen-vel       = yes\n"
+            "gen-temp      = 600\n"
+            "gen-seed      = 1993\n");
+    runner_.useTopGroAndNdxFromDatabase("alanine_vsite_solvated");
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    const std::string fullRebuildEdrFileName = fileManager_.getTemporaryFilePath("full.edr");
+    runner_.edrFileName_                     = fullRebuildEdrFileName;
+    gmx::test::gmxSetenv("GMX_DD_NO_INCREMENTAL_TOP", "1", true);
+    const int fullRebuildStatus = runner_.callMdrun();
+    gmx::test::gmxUnsetenv("GMX_DD_NO_INCREMENTAL_TOP");
+    ASSERT_EQ(0, fullRebuildStatus);
+
+    const std::string incrementalEdrFileName = fileManager_.getTemporaryFilePath("incremental.edr");
+    runner_.edrFileName_                     = incrementalEdrFileName;
+    ASSERT_EQ(0, runner_.callMdrun());
+
+    const auto tolerance = gmx::test::ulpTolerance(0);
+    gmx::test::compareEnergies(fullRebuildEdrFileName,
+                               incrementalEdrFileName,
+                               { { interaction_function[F_ANGLES].longname, tolerance },
+                                 { interaction_function[F_PDIHS].longname, tolerance },
+                                 { interaction_function[F_LJ14].longname, tolerance },
+                                 { interaction_function[F_COUL14].longname, tolerance },
+                                 { interaction_function[F_EPOT].longname, tolerance } });
+}
+
 } // namespace
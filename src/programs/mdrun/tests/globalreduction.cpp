@@ -0,0 +1,131 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the reduction of the global energy terms over ranks
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for the global reduction of energy terms
+class GlobalReductionTest : public MdrunTestFixture
+{
+};
+
+/*! \brief Checks that starting the reduction of the force terms after
+ * the force call gives the same energies as the blocking reduction
+ *
+ * Uses constraints, free-energy perturbation with foreign lambdas and
+ * pressure coupling, so all terms in the started and the completing
+ * reductions contribute.
+ */
+TEST_F(GlobalReductionTest, StartedReductionOfForceTermsMatchesBlockingReduction)
+{
+    runner_.useStringAsMdpFile(
+            "integrator        = md\n"
+            "nsteps            = 20\n"
+            "nstcalcenergy     = 5\n"
+            "nstenergy         = 5\n"
+            "coulombtype       = reaction-field\n"
+            "rcoulomb          = 0.7\n"
+            "rvdw              = 0.7\n"
+            "constraints       = h-bonds\n"
+            "tcoupl            = berendsen\n"
+            "tc-grps           = System\n"
+            "tau-t             = 0.1\n"
+            "ref-t             = 300\n"
+            "pcoupl            = berendsen\n"
+            "nstpcouple        = 5\n"
+            "tau-p             = 1\n"
+            "compressibility   = 4.5e-5\n"
+            "ref-p             = 1\n"
+            "free-energy       = yes\n"
+            "fep-lambdas       = 0 0.5 1\n"
+            "init-lambda-state = 1\n"
+            "nstdhdl           = 5\n"
+            "gen-vel           = yes\n"
+            "gen-temp          = 300\n"
+            "gen-seed          = 1993\n");
+    runner_.useTopGroAndNdxFromDatabase("alanine_vsite_solvated");
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    const std::string blockingEdrFileName = fileManager_.getTemporaryFilePath("blocking.edr");
+    runner_.edrFileName_                  = blockingEdrFileName;
+    ASSERT_EQ(0, runner_.callMdrun());
+
+    const std::string startedEdrFileName = fileManager_.getTemporaryFilePath("started.edr");
+    runner_.edrFileName_                 = startedEdrFileName;
+    gmxSetenv("GMX_ASYNC_GLOBAL_STAT", "1", true);
+    const int startedStatus = runner_.callMdrun();
+    gmxUnsetenv("GMX_ASYNC_GLOBAL_STAT");
+    ASSERT_EQ(0, startedStatus);
+
+    // The sums only differ in the size of the reduced buffers, which
+    // MPI libraries could use to choose a different summation order
+    const auto tolerance = relativeToleranceAsFloatingPoint(1000.0, 1e-5);
+    compareEnergies(blockingEdrFileName,
+                    startedEdrFileName,
+                    { { interaction_function[F_EPOT].longname, tolerance },
+                      { interaction_function[F_EKIN].longname, tolerance },
+                      { interaction_function[F_PRES].longname, tolerance },
+                      { interaction_function[F_DVDL].longname, tolerance },
+                      { "Vir-XX", tolerance },
+                      { "Vir-YY", tolerance },
+                      { "Vir-ZZ", tolerance } });
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,153 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests overlapping the coordinate halo exchange with the local non-bonded work
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <cstdio>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/testasserts.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for the non-blocking coordinate halo exchange
+class NonblockingHaloTest : public MdrunTestFixture
+{
+};
+
+/*! \brief Checks that the non-blocking coordinate halo exchange gives
+ * the same energies and forces as the blocking exchange
+ *
+ * The decomposition has cells along two dimensions, and the cells along x
+ * are smaller than the cut-off, so there are two pulses along x. Only the
+ * first pulse along x is overlapped, so this covers both the overlapped
+ * pulse and the pulses completed after the local non-bonded work.
+ */
+TEST_F(NonblockingHaloTest, MatchesBlockingExchangeWithMultiplePulses)
+{
+    const int numRanksAvailable = getNumberOfTestMpiRanks();
+    if (numRanksAvailable != 6)
+    {
+        fprintf(stdout, "This test requires 6 ranks, but %d are available.\n", numRanksAvailable);
+        return;
+    }
+
+    runner_.useStringAsMdpFile(
+            "integrator     = md\n"
+            "nsteps         = 20\n"
+            "nstlist        = 10\n"
+            "nstcalcenergy  = 5\n"
+            "nstenergy      = 5\n"
+            "nstxout        = 5\n"
+            "nstvout        = 5\n"
+            "nstfout        = 5\n"
+            "coulombtype    = reaction-field\n"
+            "rcoulomb       = 0.7\n"
+            "rvdw           = 0.7\n"
+            "gen-vel        = yes\n"
+            "gen-temp       = 300\n"
+            "gen-seed       = 1993\n");
+    runner_.useTopGroAndNdxFromDatabase("spc216");
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    // spc216 has a box of 1.86 nm, so cells along x are 0.62 nm wide
+    CommandLine decomposition;
+    decomposition.append("-dd");
+    decomposition.append("3");
+    decomposition.append("2");
+    decomposition.append("1");
+    decomposition.addOption("-npme", 0);
+    decomposition.addOption("-dlb", "no");
+
+    const std::string blockingEdrFileName    = fileManager_.getTemporaryFilePath("blocking.edr");
+    const std::string blockingTrrFileName    = fileManager_.getTemporaryFilePath("blocking.trr");
+    runner_.edrFileName_                     = blockingEdrFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = blockingTrrFileName;
+    ASSERT_EQ(0, runner_.callMdrun(decomposition));
+
+    const std::string nonblockingEdrFileName = fileManager_.getTemporaryFilePath("nonblocking.edr");
+    const std::string nonblockingTrrFileName = fileManager_.getTemporaryFilePath("nonblocking.trr");
+    runner_.edrFileName_                     = nonblockingEdrFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = nonblockingTrrFileName;
+    gmxSetenv("GMX_DD_NONBLOCKING_HALO", "1", true);
+    const int nonblockingStatus = runner_.callMdrun(decomposition);
+    gmxUnsetenv("GMX_DD_NONBLOCKING_HALO");
+    ASSERT_EQ(0, nonblockingStatus);
+
+    // The same coordinates are communicated and the same kernels are run
+    // in the same order, so the results should be identical
+    const auto tolerance = ulpTolerance(0);
+    compareEnergies(blockingEdrFileName,
+                    nonblockingEdrFileName,
+                    { { interaction_function[F_EPOT].longname, tolerance },
+                      { interaction_function[F_EKIN].longname, tolerance },
+                      { interaction_function[F_PRES].longname, tolerance } });
+
+    const TrajectoryFrameMatchSettings matchSettings{ true,
+                                                      true,
+                                                      true,
+                                                      ComparisonConditions::MustCompare,
+                                                      ComparisonConditions::MustCompare,
+                                                      ComparisonConditions::MustCompare };
+
+    const TrajectoryTolerances trajectoryTolerances{ tolerance, tolerance, tolerance, tolerance };
+    compareTrajectories(blockingTrrFileName,
+                        nonblockingTrrFileName,
+                        TrajectoryComparison(matchSettings, trajectoryTolerances));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
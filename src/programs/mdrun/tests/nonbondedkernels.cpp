@@ -0,0 +1,170 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the SIMD non-bonded kernels agree with the plain-C reference kernels.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/nbnxm/nbnxm_simd.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! The environment variables selecting the SIMD kernel layouts that are compiled in
+const std::vector<std::string> c_simdKernelLayoutEnvVars = {
+#ifdef GMX_NBNXN_SIMD_4XN
+    "GMX_NBNXN_SIMD_4XN",
+#endif
+#ifdef GMX_NBNXN_SIMD_2XNN
+    "GMX_NBNXN_SIMD_2XNN",
+#endif
+};
+
+/*! \brief Test fixture for comparing the SIMD and plain-C non-bonded kernels
+ *
+ * The parameter is the mdp setting for lj-pme-comb-rule.
+ */
+class LjPmeKernelComparisonTest :
+    public MdrunTestFixture,
+    public ::testing::WithParamInterface<std::string>
+{
+};
+
+TEST_P(LjPmeKernelComparisonTest, SimdKernelsMatchReferenceKernels)
+{
+    const std::string combinationRule = GetParam();
+
+    if (c_simdKernelLayoutEnvVars.empty())
+    {
+        fprintf(stdout, "No SIMD non-bonded kernels are compiled in, nothing to compare\n");
+        return;
+    }
+
+    const auto mdpOptions = formatString(
+            "integrator       = md\n"
+            "nsteps           = 0\n"
+            "coulombtype      = PME\n"
+            "vdwtype          = PME\n"
+            "lj-pme-comb-rule = %s\n"
+            "rcoulomb         = 0.9\n"
+            "rvdw             = 0.9\n"
+            "nstcalcenergy    = 1\n"
+            "nstenergy        = 1\n"
+            "nstxout          = 0\n"
+            "nstvout          = 0\n"
+            "nstfout          = 1\n",
+            combinationRule.c_str());
+
+    // The kernels sum in different orders, so we can only expect agreement within rounding
+    const EnergyTermsToCompare energyTermsToCompare{
+        { { interaction_function[F_LJ].longname, relativeToleranceAsFloatingPoint(1000.0, 1e-4) },
+          { interaction_function[F_COUL_SR].longname,
+            relativeToleranceAsFloatingPoint(10000.0, 1e-4) },
+          { interaction_function[F_EPOT].longname,
+            relativeToleranceAsFloatingPoint(10000.0, 1e-4) },
+          { "Vir-XX", relativeToleranceAsFloatingPoint(1000.0, 1e-3) },
+          { "Vir-YY", relativeToleranceAsFloatingPoint(1000.0, 1e-3) },
+          { "Vir-ZZ", relativeToleranceAsFloatingPoint(1000.0, 1e-3) } }
+    };
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryTolerances trajectoryTolerances = TrajectoryComparison::s_defaultTrajectoryTolerances;
+    trajectoryTolerances.forces               = relativeToleranceAsFloatingPoint(100.0, 1e-3);
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings, trajectoryTolerances };
+
+    runner_.useTopGroAndNdxFromDatabase("ala");
+    runner_.useStringAsMdpFile(mdpOptions);
+    runGrompp(&runner_);
+
+    // The reference run uses the plain-C kernels
+    const auto referenceTrajectoryFileName = fileManager_.getTemporaryFilePath("reference.trr");
+    const auto referenceEdrFileName        = fileManager_.getTemporaryFilePath("reference.edr");
+    runner_.fullPrecisionTrajectoryFileName_ = referenceTrajectoryFileName;
+    runner_.edrFileName_                     = referenceEdrFileName;
+    gmxSetenv("GMX_DISABLE_SIMD_KERNELS", "1", true);
+    runMdrun(&runner_);
+    gmxUnsetenv("GMX_DISABLE_SIMD_KERNELS");
+
+    for (const std::string& envVar : c_simdKernelLayoutEnvVars)
+    {
+        SCOPED_TRACE(formatString("Comparing kernels selected by %s with the reference kernels",
+                                  envVar.c_str()));
+
+        const auto simdTrajectoryFileName = fileManager_.getTemporaryFilePath(envVar + ".trr");
+        const auto simdEdrFileName        = fileManager_.getTemporaryFilePath(envVar + ".edr");
+        runner_.fullPrecisionTrajectoryFileName_ = simdTrajectoryFileName;
+        runner_.edrFileName_                     = simdEdrFileName;
+        gmxSetenv(envVar.c_str(), "1", true);
+        runMdrun(&runner_);
+        gmxUnsetenv(envVar.c_str());
+
+        compareEnergies(referenceEdrFileName, simdEdrFileName, energyTermsToCompare);
+        compareTrajectories(
+                referenceTrajectoryFileName, simdTrajectoryFileName, trajectoryComparison);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(LjPmeCombinationRules,
+                        LjPmeKernelComparisonTest,
+                        ::testing::Values("Geometric", "Lorentz-Berthelot"));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2021, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider code modification or any other derived work
+ * interpreted as an integral part of GROMACS as the basis for
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * This implements basic PME bench tests.
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include "programs/mdrun/pme_bench.h"
+
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(PmeBenchTest, BasicEndToEndTest)
+{
+    TestFileManager   fileManager;
+    const std::string csvFileName = fileManager.getTemporaryFilePath(".csv");
+
+    const char* const command[] = { "pme-benchmark" };
+    CommandLine       cmdline(command);
+    cmdline.addOption("-size", 1);
+    cmdline.addOption("-nt", 1);
+    cmdline.addOption("-order", 4);
+    cmdline.addOption("-spacing", "0.2");
+    cmdline.addOption("-iter", 1);
+    cmdline.addOption("-warmup", 0);
+    cmdline.addOption("-energy");
+    cmdline.addOption("-o", csvFileName);
+    EXPECT_EQ(0,
+              gmx::test::CommandLineTestHelper::runModuleFactory(&gmx::PmeBenchmarkInfo::create,
+                                                                 &cmdline));
+
+    // A header line and one line for the single setup
+    const auto lines = TextReader::readFileToString(csvFileName);
+    EXPECT_NE(lines.find('\n'), std::string::npos);
+    EXPECT_NE(lines.find('\n', lines.find('\n') + 1), std::string::npos);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx